@@ -1,5 +1,4 @@
 #include "algo.hpp"
-#include "clonevisitor.hh"
 
 #include <vector>
 #include <set>
@@ -13,66 +12,75 @@ using namespace std;
  * Helper logic
  * ============================================================ */
 
-unique_ptr<Expr> convert1(
-    const unique_ptr<Expr>& expr,
+// Rewrites every element of a list; false when each came back as it was
+template <typename F>
+static bool rewriteAll(const vector<Ref<Expr>>& in, vector<Ref<Expr>>& out, F rewrite) {
+    bool changed = false;
+    out.reserve(in.size());
+    for (const auto& e : in) {
+        out.push_back(rewrite(e));
+        changed |= out.back().get() != e.get();
+    }
+    return changed;
+}
+
+Ref<Expr> convert1(
+    const Ref<Expr>& expr,
     SymbolTable* symtable,
     const string& suffix
 ) {
     if (!expr) return nullptr;
 
+    auto rename = [&](const Ref<Expr>& e) { return convert1(e, symtable, suffix); };
+    vector<Ref<Expr>> elems;
+
+    // One switch on the tag; untouched subtrees are shared, not copied
+    switch (expr->exprType) {
+
     // -------- Variable --------
-    if (auto var = dynamic_cast<Var*>(expr.get())) {
-        string name = var->name;
+    case ExprType::VAR: {
+        string name = static_cast<const Var &>(*expr).name;
         if (symtable && symtable->hasKey(&name)) {
-            return make_unique<Var>(name + suffix);
+            return makeRef<Var>(name + suffix);
         }
-        return make_unique<Var>(name);
+        return expr;
     }
 
     // -------- Function Call --------
-    if (auto func = dynamic_cast<FuncCall*>(expr.get())) {
-        vector<unique_ptr<Expr>> args;
-        for (const auto& arg : func->args) {
-            args.push_back(convert1(arg, symtable, suffix));
-        }
-        return make_unique<FuncCall>(func->name, move(args));
+    case ExprType::FUNCCALL: {
+        const auto &func = static_cast<const FuncCall &>(*expr);
+        if (!rewriteAll(func.args, elems, rename)) return expr;
+        return makeRef<FuncCall>(func.name, move(elems));
     }
 
     // -------- Number --------
-    if (auto num = dynamic_cast<Num*>(expr.get())) {
-        return make_unique<Num>(num->value);
-    }
+    case ExprType::NUM:
+        return expr;
 
     // -------- Set --------
-    if (auto set = dynamic_cast<Set*>(expr.get())) {
-        vector<unique_ptr<Expr>> elems;
-        for (const auto& e : set->elements) {
-            elems.push_back(convert1(e, symtable, suffix));
-        }
-        return make_unique<Set>(move(elems));
-    }
+    case ExprType::SET:
+        if (!rewriteAll(static_cast<const Set &>(*expr).elements, elems, rename)) return expr;
+        return makeRef<Set>(move(elems));
 
     // -------- Tuple --------
-    if (auto tup = dynamic_cast<Tuple*>(expr.get())) {
-        vector<unique_ptr<Expr>> elems;
-        for (const auto& e : tup->exprs) {
-            elems.push_back(convert1(e, symtable, suffix));
-        }
-        return make_unique<Tuple>(move(elems));
-    }
+    case ExprType::TUPLE:
+        if (!rewriteAll(static_cast<const Tuple &>(*expr).exprs, elems, rename)) return expr;
+        return makeRef<Tuple>(move(elems));
 
-    return nullptr;
+    default:
+        return nullptr;
+    }
 }
 
 void addthedashexpr(
-    const unique_ptr<Expr>& expr,
+    const Ref<Expr>& expr,
     set<string>& res
 ) {
     if (!expr) return;
 
-    if (auto func = dynamic_cast<FuncCall*>(expr.get())) {
+    if (auto func = expr->as<FuncCall>()) {
         if (func->name == "'") {
-            if (auto v = dynamic_cast<Var*>(func->args[0].get())) {
+            if (auto v = func->args[0]->as<Var>()) {
                 res.insert(v->name);
             }
             return;
@@ -83,42 +91,32 @@ void addthedashexpr(
     }
 }
 
-unique_ptr<Expr> removethedashexpr(
-    const unique_ptr<Expr>& expr,
+Ref<Expr> removethedashexpr(
+    const Ref<Expr>& expr,
     set<string>& res,
     int flag
 ) {
     if (!expr) return nullptr;
 
-    if (auto var = dynamic_cast<Var*>(expr.get())) {
-        if (flag) return make_unique<Var>(var->name);
-        if (res.count(var->name)) {
-            return make_unique<Var>(var->name + "_old");
+    if (auto var = expr->as<Var>()) {
+        if (!flag && res.count(var->name)) {
+            return makeRef<Var>(var->name + "_old");
         }
-        return make_unique<Var>(var->name);
+        return expr;
     }
 
-    if (auto func = dynamic_cast<FuncCall*>(expr.get())) {
+    if (auto func = expr->as<FuncCall>()) {
         if (func->name == "'") {
             return removethedashexpr(func->args[0], res, 1);
         }
-        vector<unique_ptr<Expr>> args;
-        for (const auto& arg : func->args) {
-            args.push_back(removethedashexpr(arg, res));
-        }
-        return make_unique<FuncCall>(func->name, move(args));
-    }
-
-    if (auto num = dynamic_cast<Num*>(expr.get())) {
-        return make_unique<Num>(num->value);
-    }
-
-    if (auto str = dynamic_cast<String*>(expr.get())) {
-        return make_unique<String>(str->value);
+        vector<Ref<Expr>> args;
+        auto rewrite = [&](const Ref<Expr>& e) { return removethedashexpr(e, res); };
+        if (!rewriteAll(func->args, args, rewrite)) return expr;
+        return makeRef<FuncCall>(func->name, move(args));
     }
 
-    if (auto bc = dynamic_cast<BoolConst*>(expr.get())) {
-        return make_unique<BoolConst>(bc->value);
+    if (expr->is<Num>() || expr->is<String>() || expr->is<BoolConst>()) {
+        return expr;
     }
 
     return nullptr;
@@ -128,95 +126,59 @@ unique_ptr<Expr> removethedashexpr(
  * Replace result variable name in expression
  * ============================================================ */
 
-unique_ptr<Expr> replaceResultVar(
-    unique_ptr<Expr> expr,
+Ref<Expr> replaceResultVar(
+    const Ref<Expr>& expr,
     const string& oldName,
     const string& newName
 ) {
     if (!expr) return nullptr;
 
+    auto replace = [&](const Ref<Expr>& e) { return replaceResultVar(e, oldName, newName); };
+    vector<Ref<Expr>> elems;
+
     // -------- Variable --------
-    if (auto var = dynamic_cast<Var*>(expr.get())) {
+    if (auto var = expr->as<Var>()) {
         if (var->name == oldName) {
-            return make_unique<Var>(newName);
+            return makeRef<Var>(newName);
         }
-        return make_unique<Var>(var->name);
+        return expr;
     }
 
     // -------- Function Call --------
-    if (auto func = dynamic_cast<FuncCall*>(expr.get())) {
-        vector<unique_ptr<Expr>> args;
-        for (const auto& arg : func->args) {
-            // Need to clone first, then replace
-            CloneVisitor cloner;
-            auto cloned = cloner.cloneExpr(arg.get());
-            args.push_back(replaceResultVar(move(cloned), oldName, newName));
-        }
-        return make_unique<FuncCall>(func->name, move(args));
-    }
-
-    // -------- Number --------
-    if (auto num = dynamic_cast<Num*>(expr.get())) {
-        return make_unique<Num>(num->value);
-    }
-
-    // -------- String --------
-    if (auto str = dynamic_cast<String*>(expr.get())) {
-        return make_unique<String>(str->value);
+    if (auto func = expr->as<FuncCall>()) {
+        if (!rewriteAll(func->args, elems, replace)) return expr;
+        return makeRef<FuncCall>(func->name, move(elems));
     }
 
     // -------- Set --------
-    if (auto set = dynamic_cast<Set*>(expr.get())) {
-        vector<unique_ptr<Expr>> elems;
-        for (const auto& e : set->elements) {
-            CloneVisitor cloner;
-            auto cloned = cloner.cloneExpr(e.get());
-            elems.push_back(replaceResultVar(move(cloned), oldName, newName));
-        }
-        return make_unique<Set>(move(elems));
+    if (auto set = expr->as<Set>()) {
+        if (!rewriteAll(set->elements, elems, replace)) return expr;
+        return makeRef<Set>(move(elems));
     }
 
     // -------- Tuple --------
-    if (auto tup = dynamic_cast<Tuple*>(expr.get())) {
-        vector<unique_ptr<Expr>> elems;
-        for (const auto& e : tup->exprs) {
-            CloneVisitor cloner;
-            auto cloned = cloner.cloneExpr(e.get());
-            elems.push_back(replaceResultVar(move(cloned), oldName, newName));
-        }
-        return make_unique<Tuple>(move(elems));
-    }
-
-    // -------- BoolConst --------
-    if (auto bc = dynamic_cast<BoolConst*>(expr.get())) {
-        return make_unique<BoolConst>(bc->value);
+    if (auto tup = expr->as<Tuple>()) {
+        if (!rewriteAll(tup->exprs, elems, replace)) return expr;
+        return makeRef<Tuple>(move(elems));
     }
 
     // -------- BinaryOpExpr --------
-    if (auto binop = dynamic_cast<BinaryOpExpr*>(expr.get())) {
-        CloneVisitor cloner;
-        auto leftClone = cloner.cloneExpr(binop->left.get());
-        auto rightClone = cloner.cloneExpr(binop->right.get());
-        return make_unique<BinaryOpExpr>(
-            binop->op,
-            replaceResultVar(move(leftClone), oldName, newName),
-            replaceResultVar(move(rightClone), oldName, newName)
-        );
+    if (auto binop = expr->as<BinaryOpExpr>()) {
+        Ref<Expr> left = replace(binop->left);
+        Ref<Expr> right = replace(binop->right);
+        if (left.get() == binop->left.get() && right.get() == binop->right.get()) return expr;
+        return makeRef<BinaryOpExpr>(binop->op, move(left), move(right));
     }
 
     // -------- UnaryOpExpr --------
-    if (auto unop = dynamic_cast<UnaryOpExpr*>(expr.get())) {
-        CloneVisitor cloner;
-        auto operandClone = cloner.cloneExpr(unop->operand.get());
-        return make_unique<UnaryOpExpr>(
-            unop->op,
-            replaceResultVar(move(operandClone), oldName, newName)
-        );
+    if (auto unop = expr->as<UnaryOpExpr>()) {
+        Ref<Expr> operand = replace(unop->operand);
+        if (operand.get() == unop->operand.get()) return expr;
+        return makeRef<UnaryOpExpr>(unop->op, move(operand));
     }
 
-    // Default: clone as-is
-    CloneVisitor cloner;
-    return cloner.cloneExpr(expr.get());
+    // Default: literals and maps are left as they are
+    return expr;
 }
 
 /* ============================================================
@@ -231,7 +193,7 @@ unique_ptr<Stmt> makeInputStmt(unique_ptr<Var> var) {
 }
 
 void getInputVars(
-    const unique_ptr<Expr>& expr,
+    const Ref<Expr>& expr,
     vector<unique_ptr<Expr>>& inputVars,
     const string& suffix,
     SymbolTable* symtable,
@@ -240,7 +202,7 @@ void getInputVars(
     if (!expr) return;
 
     // -------- Variable --------
-    if (auto v = dynamic_cast<Var*>(expr.get())) {
+    if (auto v = expr->as<Var>()) {
         string name = v->name;
 
         // Free variable → input
@@ -255,7 +217,7 @@ void getInputVars(
     }
 
     // -------- Function Call --------
-    if (auto f = dynamic_cast<FuncCall*>(expr.get())) {
+    if (auto f = expr->as<FuncCall>()) {
         for (const auto& arg : f->args) {
             getInputVars(arg, inputVars, suffix, symtable, localTM);
         }
@@ -263,7 +225,7 @@ void getInputVars(
     }
 
     // -------- Set --------
-    if (auto s = dynamic_cast<Set*>(expr.get())) {
+    if (auto s = expr->as<Set>()) {
         for (const auto& e : s->elements) {
             getInputVars(e, inputVars, suffix, symtable, localTM);
         }
@@ -271,7 +233,7 @@ void getInputVars(
     }
 
     // -------- Tuple --------
-    if (auto t = dynamic_cast<Tuple*>(expr.get())) {
+    if (auto t = expr->as<Tuple>()) {
         for (const auto& e : t->exprs) {
             getInputVars(e, inputVars, suffix, symtable, localTM);
         }
@@ -279,7 +241,7 @@ void getInputVars(
     }
 
     // -------- Map --------
-    if (auto m = dynamic_cast<Map*>(expr.get())) {
+    if (auto m = expr->as<Map>()) {
 
         for (const auto& kv : m->value) {
             // key is Var
@@ -308,7 +270,6 @@ vector<unique_ptr<Stmt>> genInit(
     TypeMap* globalTM
 ) {
     vector<unique_ptr<Stmt>> stmts;
-    CloneVisitor cloner;
 
     for (const auto& init : spec.init) {
 
@@ -323,7 +284,7 @@ vector<unique_ptr<Stmt>> genInit(
         stmts.push_back(
             make_unique<Assign>(
                 make_unique<Var>(*key),
-                cloner.cloneExpr(init->expr.get())
+                init->expr
             )
         );
     }
@@ -336,93 +297,119 @@ vector<unique_ptr<Stmt>> genInit(
  * ATC construction
  * ============================================================ */
 
-Program buildATCFromBlockSequence(
-    const vector<const API*>& blockSeq
+string checkpointId(const vector<string>& testString, size_t n) {
+    string id;
+    for (size_t i = 0; i < n && i < testString.size(); i++) {
+        if (i > 0) id += "|";
+        id += testString[i];
+    }
+    return id;
+}
+
+void appendBlockStmts(
+    const API* api,
+    const string& idx,
+    vector<unique_ptr<Stmt>>& stmts
 ) {
-    vector<unique_ptr<Stmt>> stmts;
     SymbolTable globalST(nullptr);
     TypeMap globalTM(nullptr);
+    SymbolTable blockST(&globalST);
+    TypeMap blockTM(&globalTM);
 
-    // Global init
-    // (caller guarantees spec init already handled if needed)
+    // The block's own expressions are shared; renaming copies only the
+    // paths that change
+    const Ref<Expr>& pre = api->pre;
+    const Ref<Expr>& post = api->response.ResponseExpr;
+    Ref<Expr> call = api->call->call;
 
-    for (size_t i = 0; i < blockSeq.size(); i++) {
-        const API* api = blockSeq[i];
-        string idx = to_string(i);
+    // -------- INPUTS --------
+    vector<unique_ptr<Expr>> inputs;
 
-        SymbolTable blockST(&globalST);
-        TypeMap blockTM(&globalTM);
+    auto* callExpr = call->as<FuncCall>();
+    if (!callExpr) {
+        throw runtime_error("API call must be FuncCall");
+    }
 
-        CloneVisitor cloner;
+    for (const auto& arg : callExpr->args) {
+        getInputVars(arg, inputs, idx, &blockST, blockTM);
+    }
 
-        auto pre  = api->pre
-            ? cloner.cloneExpr(api->pre.get())
-            : nullptr;
+    for (auto& in : inputs) {
+        auto* v = in->as<Var>();
+        stmts.push_back(makeInputStmt(make_unique<Var>(v->name)));
+    }
 
-        auto post = api->response.ResponseExpr
-            ? cloner.cloneExpr(api->response.ResponseExpr.get())
-            : nullptr;
+    // -------- RENAME --------
+    Ref<Expr> pre1  = pre  ? convert1(pre,  &blockST, idx) : nullptr;
+    Ref<Expr> call1 = convert1(call, &blockST, idx);
+    Ref<Expr> post1 = post ? convert1(post, &blockST, idx) : nullptr;
 
-        auto call = cloner.cloneExpr(api->call->call.get());
+    // -------- PRIMED VARS --------
+    set<string> primed;
+    if (post1) addthedashexpr(post1, primed);
 
-        // -------- INPUTS --------
-        vector<unique_ptr<Expr>> inputs;
+    // -------- SNAPSHOT --------
+    for (const auto& v : primed) {
+        stmts.push_back(
+            make_unique<Assign>(
+                make_unique<Var>(v + "_old"),
+                make_unique<Var>(v)
+            )
+        );
+    }
 
-        auto* callExpr = dynamic_cast<FuncCall*>(call.get());
-        if (!callExpr) {
-            throw runtime_error("API call must be FuncCall");
-        }
+    // -------- ASSUME --------
+    if (pre1) {
+        stmts.push_back(make_unique<Assume>(move(pre1)));
+    }
 
-        for (const auto& arg : callExpr->args) {
-            getInputVars(arg, inputs, idx, &blockST, blockTM);
-        }
+    // -------- CALL --------
+    // Use named result variable instead of "_" so postcondition can reference it
+    string resultVar = "_result" + idx;
+    stmts.push_back(
+        make_unique<Assign>(
+            make_unique<Var>(resultVar),
+            move(call1)
+        )
+    );
 
-        for (auto& in : inputs) {
-            auto* v = dynamic_cast<Var*>(in.get());
-            stmts.push_back(makeInputStmt(make_unique<Var>(v->name)));
-        }
+    // -------- ASSERT --------
+    if (post1) {
+        post1 = removethedashexpr(post1, primed);
+        // Replace "_result" with "_result{idx}" in postcondition
+        post1 = replaceResultVar(post1, "_result", resultVar);
+        stmts.push_back(make_unique<Assert>(move(post1)));
+    }
+}
 
-        // -------- RENAME --------
-        auto pre1  = pre  ? convert1(pre,  &blockST, idx) : nullptr;
-        auto call1 = convert1(call, &blockST, idx);
-        auto post1 = post ? convert1(post, &blockST, idx) : nullptr;
+Program buildATCFromBlockSequence(
+    const vector<const API*>& blockSeq,
+    bool checkpoints
+) {
+    vector<string> names;
+    for (const API* api : blockSeq) {
+        names.push_back(api->name);
+    }
 
-        // -------- PRIMED VARS --------
-        set<string> primed;
-        if (post1) addthedashexpr(post1, primed);
+    vector<unique_ptr<Stmt>> stmts;
+
+    // Global init
+    // (caller guarantees spec init already handled if needed)
+
+    for (size_t i = 0; i < blockSeq.size(); i++) {
+        appendBlockStmts(blockSeq[i], to_string(i), stmts);
 
-        // -------- SNAPSHOT --------
-        for (const auto& v : primed) {
+        // -------- CHECKPOINT --------
+        if (checkpoints) {
+            vector<unique_ptr<Expr>> args;
+            args.push_back(make_unique<String>(checkpointId(names, i + 1)));
             stmts.push_back(
                 make_unique<Assign>(
-                    make_unique<Var>(v + "_old"),
-                    make_unique<Var>(v)
+                    make_unique<Var>("_"),
+                    make_unique<FuncCall>("checkpoint", move(args))
                 )
             );
         }
-
-        // -------- ASSUME --------
-        if (pre1) {
-            stmts.push_back(make_unique<Assume>(move(pre1)));
-        }
-
-        // -------- CALL --------
-        // Use named result variable instead of "_" so postcondition can reference it
-        string resultVar = "_result" + idx;
-        stmts.push_back(
-            make_unique<Assign>(
-                make_unique<Var>(resultVar),
-                move(call1)
-            )
-        );
-
-        // -------- ASSERT --------
-        if (post1) {
-            post1 = removethedashexpr(post1, primed);
-            // Replace "_result" with "_result{idx}" in postcondition
-            post1 = replaceResultVar(move(post1), "_result", resultVar);
-            stmts.push_back(make_unique<Assert>(move(post1)));
-        }
     }
 
     return Program(move(stmts));
@@ -434,7 +421,8 @@ Program buildATCFromBlockSequence(
 
 Program genATC(
     const Spec& spec,
-    const vector<string>& testString
+    const vector<string>& testString,
+    bool checkpoints
 ) {
     vector<const API*> blocks;
 
@@ -455,19 +443,12 @@ Program genATC(
     SymbolTable globalST(nullptr);
     TypeMap globalTM(nullptr);
 
-    vector<unique_ptr<Stmt>> stmts;
-
     //  1. Global init first
-    auto initStmts = genInit(spec, &globalST, &globalTM);
-    for (auto& s : initStmts) {
-        stmts.push_back(move(s));
-    }
+    vector<Ref<Stmt>> stmts = adoptAll(genInit(spec, &globalST, &globalTM));
 
     //  2. API blocks
-    Program body = buildATCFromBlockSequence(blocks);
-    for (auto& s : body.statements) {
-        stmts.push_back(move(const_cast<unique_ptr<Stmt>&>(s)));
-    }
+    Program body = buildATCFromBlockSequence(blocks, checkpoints);
+    stmts.insert(stmts.end(), body.statements.begin(), body.statements.end());
 
     return Program(move(stmts));
 }
@@ -21,21 +21,21 @@ using namespace std;
  * ============================================================ */
 
 // Rename variables based on block suffix (e.g., uid → uid0)
-unique_ptr<Expr> convert1(
-    const unique_ptr<Expr>& expr,
+Ref<Expr> convert1(
+    const Ref<Expr>& expr,
     SymbolTable* symtable,
     const string& suffix
 );
 
 // Collect primed variables (U', T', etc.)
 void addthedashexpr(
-    const unique_ptr<Expr>& expr,
+    const Ref<Expr>& expr,
     set<string>& res
 );
 
 // Remove prime notation and introduce _old variables
-unique_ptr<Expr> removethedashexpr(
-    const unique_ptr<Expr>& expr,
+Ref<Expr> removethedashexpr(
+    const Ref<Expr>& expr,
     set<string>& res,
     int flag = 0
 );
@@ -47,7 +47,7 @@ unique_ptr<Stmt> makeInputStmt(
 
 // Collect free (input) variables from expressions
 void getInputVars(
-    const unique_ptr<Expr>& expr,
+    const Ref<Expr>& expr,
     vector<unique_ptr<Expr>>& inputVars,
     const string& suffix,
     SymbolTable* symtable,
@@ -66,19 +66,33 @@ vector<unique_ptr<Stmt>> genInit(
 );
 
 // Replace a variable name in expression (for result variable renaming)
-unique_ptr<Expr> replaceResultVar(
-    unique_ptr<Expr> expr,
+Ref<Expr> replaceResultVar(
+    const Ref<Expr>& expr,
     const string& oldName,
     const string& newName
 );
 
-// Build ATC from a resolved sequence of API blocks
+// Checkpoint id for the first n blocks of a sequence: "b0|b1|...|b{n-1}"
+string checkpointId(const vector<string>& testString, size_t n);
+
+// Append the logical ATC of one block at position `idx` (inputs, _old
+// snapshots, assume, call, assert); `idx` suffixes inputs and _result
+void appendBlockStmts(
+    const API* api,
+    const string& idx,
+    vector<unique_ptr<Stmt>>& stmts
+);
+
+// Build ATC from a resolved sequence of API blocks.
+// With checkpoints, `_ := checkpoint(id)` follows every block.
 Program buildATCFromBlockSequence(
-    const vector<const API*>& blockSeq
+    const vector<const API*>& blockSeq,
+    bool checkpoints = false
 );
 
 // Main entry point: Spec + test string → ATC
 Program genATC(
     const Spec& spec,
-    const vector<string>& testString
+    const vector<string>& testString,
+    bool checkpoints = false
 );
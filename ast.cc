@@ -1,4 +1,5 @@
 #include "ast.hh"
+#include <cctype>
 
 TypeExpr::TypeExpr(TypeExprType typeExprType) : typeExprType(typeExprType) {}
 
@@ -71,6 +72,10 @@ bool Var::operator<(const Var &v) const {
 }
 
 FuncCall::FuncCall(string name, vector<unique_ptr<Expr>> args)
+    : FuncCall(std::move(name), adoptAll(std::move(args))) {
+}
+
+FuncCall::FuncCall(string name, vector<Ref<Expr>> args)
     : Expr(ExprType::FUNCCALL),
       name(std::move(name)), args(std::move(args)) {
 }
@@ -79,13 +84,47 @@ Num::Num(int value) : Expr(ExprType::NUM), value(value) {}
 
 String::String(string value) : Expr(ExprType::STRING), value(value) {}
 
+String::String(string value, bool placeholder)
+    : Expr(ExprType::STRING), value(value), placeholder(placeholder) {}
+
+Placeholder::Placeholder(string global, string marker)
+    : String(marker, true), global(global) {}
+
+string Placeholder::fallback() const
+{
+    // "__NEEDS_BOOK_CODE__" -> "book"
+    string entity = value.substr(string("__NEEDS_").size());
+    entity = entity.substr(0, entity.find('_'));
+    for (auto &c : entity)
+        c = tolower(c);
+    return "no_" + entity + "_available";
+}
+
 Set::Set(vector<unique_ptr<Expr>> elements)
+    : Set(adoptAll(std::move(elements))) {}
+
+Set::Set(vector<Ref<Expr>> elements)
     : Expr(ExprType::SET), elements(std::move(elements)) {}
 
+static vector<pair<Ref<Var>, Ref<Expr>>> adoptEntries(vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> v)
+{
+    vector<pair<Ref<Var>, Ref<Expr>>> out;
+    out.reserve(v.size());
+    for (auto &kv : v)
+        out.emplace_back(std::move(kv.first), std::move(kv.second));
+    return out;
+}
+
 Map::Map(vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> v)
+    : Map(adoptEntries(std::move(v))) {}
+
+Map::Map(vector<pair<Ref<Var>, Ref<Expr>>> v)
     : Expr(ExprType::MAP), value(std::move(v)) {}
 
 Tuple::Tuple(vector<unique_ptr<Expr>> exprs) :
+    Tuple(adoptAll(std::move(exprs))) {}
+
+Tuple::Tuple(vector<Ref<Expr>> exprs) :
     Expr(ExprType::TUPLE), exprs(std::move(exprs)) {}
 
 APIFuncDecl::APIFuncDecl(string name,
@@ -93,19 +132,19 @@ APIFuncDecl::APIFuncDecl(string name,
          pair<HTTPResponseCode, vector<unique_ptr<TypeExpr>>> returnType)
     : name(std::move(name)), params(std::move(params)), returnType(std::move(returnType)) {}
 
-Init::Init(string varName, unique_ptr<Expr> expression)
+Init::Init(string varName, Ref<Expr> expression)
     : varName(std::move(varName)), expr(std::move(expression)) {}
 
-Response::Response(unique_ptr<Expr> expr) {
+Response::Response(Ref<Expr> expr) {
     // Build ResponseExpr that includes the response code as part of the expression
     // Format: _RESPONSE_CODE_200, _RESPONSE_CODE_201, etc.
     ResponseExpr = std::move(expr);
 }
 
-APIcall::APIcall(unique_ptr<FuncCall> Call, Response Response) :
+APIcall::APIcall(Ref<FuncCall> Call, Response Response) :
 	call(std::move(Call)), response(std::move(Response)) {}
 
-API::API(unique_ptr<Expr> precondition,
+API::API(Ref<Expr> precondition,
     unique_ptr<APIcall> functionCall,
     Response response, string name)
     : pre(std::move(precondition)), call(std::move(functionCall)),
@@ -121,12 +160,15 @@ Spec::Spec(vector<unique_ptr<Decl>> globals,
 
 Stmt::Stmt(StmtType type) : statementType(type) {}
 
-Assign::Assign(unique_ptr<Expr> left, unique_ptr<Expr> right)
+Assign::Assign(Ref<Expr> left, Ref<Expr> right)
     : Stmt(StmtType::ASSIGN), left(std::move(left)), right(std::move(right)) {}
 
-Assume::Assume(unique_ptr<Expr> e) : Stmt(StmtType::ASSUME), expr(std::move(e)) {}
+Assume::Assume(Ref<Expr> e) : Stmt(StmtType::ASSUME), expr(std::move(e)) {}
 
-Assert::Assert(unique_ptr<Expr> e) : Stmt(StmtType::ASSERT), expr(std::move(e)) {}
+Assert::Assert(Ref<Expr> e) : Stmt(StmtType::ASSERT), expr(std::move(e)) {}
 
 Program::Program(vector<unique_ptr<Stmt>> Statements)
+    : statements(adoptAll(std::move(Statements))) {}
+
+Program::Program(vector<Ref<Stmt>> Statements)
     : statements(std::move(Statements)) {}
\ No newline at end of file
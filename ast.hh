@@ -1,6 +1,8 @@
 #ifndef AST_HH
 #define AST_HH
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -80,7 +82,150 @@ enum class StmtType
     DECL
 };
 
-class TypeExpr
+/*
+ * Expression and statement nodes are immutable once built and may be shared
+ * between programs: each carries an intrusive reference count and parents
+ * hold their children through Ref<>. A rewrite rebuilds only the path down
+ * to what it changes and points at the untouched subtrees it started from,
+ * so its cost follows the size of the edit rather than of the program.
+ *
+ * unique_ptr<Expr> still works for building nodes; it converts to a Ref when
+ * handed to a parent. Never wrap a node a unique_ptr still owns in a Ref.
+ */
+class RefCounted
+{
+public:
+    void retain() const { refs.fetch_add(1, memory_order_relaxed); }
+    // True when this dropped the last reference
+    bool release() const { return refs.fetch_sub(1, memory_order_acq_rel) == 1; }
+    unsigned useCount() const { return refs.load(memory_order_relaxed); }
+
+protected:
+    RefCounted() = default;
+    RefCounted(const RefCounted &) {}       // a copy starts unshared
+    RefCounted &operator=(const RefCounted &) { return *this; }
+    ~RefCounted() = default;
+
+private:
+    mutable atomic<unsigned> refs{0};
+};
+
+template <typename T>
+class Ref
+{
+public:
+    Ref() = default;
+    Ref(nullptr_t) {}
+    // Shares a node that Refs (or an explicit retain) already keep alive
+    explicit Ref(T *node) : node(node) { acquire(); }
+    template <typename U>
+    Ref(unique_ptr<U> &&owned) : node(owned.release()) { acquire(); }
+    Ref(const Ref &other) : node(other.node) { acquire(); }
+    template <typename U>
+    Ref(const Ref<U> &other) : node(other.get()) { acquire(); }
+    Ref(Ref &&other) noexcept : node(other.node) { other.node = nullptr; }
+    template <typename U>
+    Ref(Ref<U> &&other) noexcept : node(other.get()) { acquire(); other.reset(); }
+    ~Ref() { drop(); }
+
+    Ref &operator=(Ref other) noexcept
+    {
+        swap(node, other.node);
+        return *this;
+    }
+
+    T *get() const { return node; }
+    T *operator->() const { return node; }
+    T &operator*() const { return *node; }
+    explicit operator bool() const { return node != nullptr; }
+    bool operator==(nullptr_t) const { return node == nullptr; }
+    bool operator!=(nullptr_t) const { return node != nullptr; }
+
+    void reset()
+    {
+        drop();
+        node = nullptr;
+    }
+
+private:
+    T *node = nullptr;
+
+    void acquire()
+    {
+        if (node)
+            node->retain();
+    }
+    void drop()
+    {
+        if (node && node->release())
+            delete node;
+    }
+};
+
+template <typename T, typename... Args>
+Ref<T> makeRef(Args &&...args)
+{
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+// Another reference to a node that Refs already keep alive, for code that
+// only holds the node itself (visitors, as<>() results)
+template <typename T>
+Ref<T> shareNode(const T *node)
+{
+    return Ref<T>(const_cast<T *>(node));
+}
+
+// Takes over a list of freshly built nodes
+template <typename T>
+vector<Ref<T>> adoptAll(vector<unique_ptr<T>> owned)
+{
+    vector<Ref<T>> out;
+    out.reserve(owned.size());
+    for (auto &node : owned)
+        out.emplace_back(std::move(node));
+    return out;
+}
+
+/*
+ * Kind-checked downcasts for the node hierarchies (Expr, TypeExpr, Stmt).
+ * Every node class says which tag it carries in a static classof(), so
+ * these cost a compare and a static_cast where dynamic_cast walks RTTI:
+ *
+ *   if (auto fc = e->as<FuncCall>()) ...     // nullptr on another kind
+ *   const Var &v = e.cast<Var>();            // throws on another kind
+ */
+template <typename Base>
+class KindCast
+{
+public:
+    template <typename T> bool is() const { return T::classof(self()); }
+
+    template <typename T> T *as() { return is<T>() ? static_cast<T *>(&self()) : nullptr; }
+    template <typename T> const T *as() const
+    {
+        return is<T>() ? static_cast<const T *>(&self()) : nullptr;
+    }
+
+    template <typename T> T &cast()
+    {
+        if (!is<T>())
+            throw runtime_error("AST node is not of the expected kind");
+        return static_cast<T &>(self());
+    }
+    template <typename T> const T &cast() const
+    {
+        if (!is<T>())
+            throw runtime_error("AST node is not of the expected kind");
+        return static_cast<const T &>(self());
+    }
+
+private:
+    Base &self() { return static_cast<Base &>(*this); }
+    const Base &self() const { return static_cast<const Base &>(*this); }
+};
+
+class TypeExpr : public KindCast<TypeExpr>
 {
 public:
     TypeExprType typeExprType;
@@ -106,6 +251,7 @@ public:
 class TypeConst : public TypeExpr
 {
 public:
+    static bool classof(const TypeExpr &n) { return n.typeExprType == TypeExprType::TYPE_CONST; }
     const string name;
 public:
     TypeConst(string name);
@@ -116,6 +262,7 @@ public:
 class FuncType : public TypeExpr
 {
 public:
+    static bool classof(const TypeExpr &n) { return n.typeExprType == TypeExprType::FUNC_TYPE; }
     const vector<unique_ptr<TypeExpr>> params;
     const unique_ptr<TypeExpr> returnType;
 public:
@@ -126,6 +273,7 @@ public:
 class MapType : public TypeExpr
 {
 public:
+    static bool classof(const TypeExpr &n) { return n.typeExprType == TypeExprType::MAP_TYPE; }
     const unique_ptr<TypeExpr> domain;
     const unique_ptr<TypeExpr> range;
 public:
@@ -136,6 +284,7 @@ public:
 class TupleType : public TypeExpr
 {
 public:
+    static bool classof(const TypeExpr &n) { return n.typeExprType == TypeExprType::TUPLE_TYPE; }
     const vector<unique_ptr<TypeExpr>> elements;
 public:
     explicit TupleType(vector<unique_ptr<TypeExpr>>);
@@ -145,6 +294,7 @@ public:
 class SetType : public TypeExpr
 {
 public:
+    static bool classof(const TypeExpr &n) { return n.typeExprType == TypeExprType::SET_TYPE; }
     unique_ptr<TypeExpr> elementType;
 public:
     explicit SetType(unique_ptr<TypeExpr>);
@@ -164,7 +314,7 @@ public:
 };
 
 // Expressions
-class Expr
+class Expr : public RefCounted, public KindCast<Expr>
 {
 public:
     ExprType exprType;
@@ -178,29 +328,35 @@ public:
 
 class Input : public Expr {
 public:
+    static bool classof(const Expr &n) { return n.exprType == ExprType::INPUT; }
     Input();
 };
 
 class FuncCall : public Expr
 {
 public:
+    static bool classof(const Expr &n) { return n.exprType == ExprType::FUNCCALL; }
     const string name;
-    const vector<unique_ptr<Expr>> args;
+    const vector<Ref<Expr>> args;
 public:
     FuncCall(string, vector<unique_ptr<Expr>>);
+    FuncCall(string, vector<Ref<Expr>>);
 };
 
 class Map : public Expr
 {
 public:
-    const vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> value;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::MAP; }
+    const vector<pair<Ref<Var>, Ref<Expr>>> value;
 public:
     explicit Map(vector<pair<unique_ptr<Var>, unique_ptr<Expr>>>);
+    explicit Map(vector<pair<Ref<Var>, Ref<Expr>>>);
 };
 
 class Num : public Expr
 {
 public:
+    static bool classof(const Expr &n) { return n.exprType == ExprType::NUM; }
     const int value;
 public:
     explicit Num(int);
@@ -209,9 +365,11 @@ public:
 class Set : public Expr
 {
 public:
-    const vector<unique_ptr<Expr>> elements;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::SET; }
+    const vector<Ref<Expr>> elements;
 public:
     explicit Set(vector<unique_ptr<Expr>>);
+    explicit Set(vector<Ref<Expr>>);
 };
 
 
@@ -219,13 +377,35 @@ public:
 class String : public Expr
 {
 public:
+    static bool classof(const Expr &n) { return n.exprType == ExprType::STRING; }
     const string value;
+    const bool placeholder = false;     // a Placeholder; shares the STRING tag
 public:
     explicit String(string);
+protected:
+    String(string, bool placeholder);
+};
+
+// Deferred ID for an input slot: a key of the latest materialized map of
+// `global` (R, M, B, ...). Carries its legacy "__NEEDS_*__" marker as the
+// string value, so printers and backends see exactly what they saw before.
+class Placeholder : public String
+{
+public:
+    static bool classof(const Expr &n)
+    {
+        return n.exprType == ExprType::STRING && static_cast<const String &>(n).placeholder;
+    }
+    const string global;
+public:
+    Placeholder(string global, string marker);
+    // Fallback when the map never materializes: "no_<entity>_available"
+    string fallback() const;
 };
 
 class BoolConst : public Expr {
 public:
+    static bool classof(const Expr &n) { return n.exprType == ExprType::BOOL_CONST; }
     bool value;
     
     BoolConst(bool v) : Expr(ExprType::BOOL_CONST), value(v) {}
@@ -233,35 +413,40 @@ public:
 
 class BinaryOpExpr : public Expr {
 public:
-    BinOp op;
-    unique_ptr<Expr> left;
-    unique_ptr<Expr> right;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::BINARY_OP; }
+    const BinOp op;
+    const Ref<Expr> left;
+    const Ref<Expr> right;
     
-    BinaryOpExpr(BinOp o, unique_ptr<Expr> l, unique_ptr<Expr> r)
+    BinaryOpExpr(BinOp o, Ref<Expr> l, Ref<Expr> r)
         : Expr(ExprType::BINARY_OP), op(o), left(std::move(l)), right(std::move(r)) {}
 };
 
 class UnaryOpExpr : public Expr {
 public:
-    UnOp op;
-    unique_ptr<Expr> operand;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::UNARY_OP; }
+    const UnOp op;
+    const Ref<Expr> operand;
     
-    UnaryOpExpr(UnOp o, unique_ptr<Expr> e)
+    UnaryOpExpr(UnOp o, Ref<Expr> e)
         : Expr(ExprType::UNARY_OP), op(o), operand(std::move(e)) {}
 };
 
 class Tuple : public Expr
 {
 public:
-    const vector<unique_ptr<Expr>> exprs;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::TUPLE; }
+    const vector<Ref<Expr>> exprs;
 public:
     explicit Tuple(vector<unique_ptr<Expr>> exprs);
+    explicit Tuple(vector<Ref<Expr>> exprs);
 };
 
 class Var : public Expr
 {
 public:
-    string name;
+    static bool classof(const Expr &n) { return n.exprType == ExprType::VAR; }
+    const string name;
 public:
     explicit Var(string);
     bool operator<(const Var &v) const;
@@ -285,27 +470,27 @@ class Init
 {
 public:
     const string varName;
-    const unique_ptr<Expr> expr;
+    const Ref<Expr> expr;
 public:
-    Init(string, unique_ptr<Expr>);
+    Init(string, Ref<Expr>);
 };
 
 class Response
 {
 public:
-    unique_ptr<Expr> ResponseExpr;
+    Ref<Expr> ResponseExpr;
 public:
-    Response( unique_ptr<Expr>);
+    Response(Ref<Expr>);
 };
 
 class APIcall
 {
 public:
-    const unique_ptr<FuncCall> call;
+    const Ref<FuncCall> call;
     const Response response;
 
 public:
-    APIcall(unique_ptr<FuncCall>, Response);
+    APIcall(Ref<FuncCall>, Response);
 };
 
 // API
@@ -314,11 +499,11 @@ class API
 public:
 
     string name; // Optional name for the API block
-    unique_ptr<Expr> pre;
+    Ref<Expr> pre;
     unique_ptr<APIcall> call;
     Response response;
 public:
-    API(unique_ptr<Expr>, unique_ptr<APIcall>, Response, string name="");
+    API(Ref<Expr>, unique_ptr<APIcall>, Response, string name="");
 };
 
 // Block class (placeholder as it wasn't fully specified in the grammar)
@@ -337,7 +522,7 @@ public:
          vector<unique_ptr<API>>);
 };
 
-class Stmt
+class Stmt : public RefCounted, public KindCast<Stmt>
 {
 public:
     const StmtType statementType;
@@ -351,36 +536,40 @@ protected:
 class Assign : public Stmt
 {
 public:
-    const unique_ptr<Expr> left;  // Changed from Var to Expr to support tuples
-    const unique_ptr<Expr> right;
+    static bool classof(const Stmt &n) { return n.statementType == StmtType::ASSIGN; }
+    const Ref<Expr> left;  // Changed from Var to Expr to support tuples
+    const Ref<Expr> right;
 public:
-    Assign(unique_ptr<Expr>, unique_ptr<Expr>);
+    Assign(Ref<Expr>, Ref<Expr>);
 };
 
 // Assume statement: assume(c)
 class Assume : public Stmt
 {
 public:
-    const unique_ptr<Expr> expr;
+    static bool classof(const Stmt &n) { return n.statementType == StmtType::ASSUME; }
+    const Ref<Expr> expr;
 public:
-    Assume(unique_ptr<Expr>);
+    Assume(Ref<Expr>);
 };
 
 // Assert statement: assert(c)
 class Assert : public Stmt
 {
 public:
-    const unique_ptr<Expr> expr;
+    static bool classof(const Stmt &n) { return n.statementType == StmtType::ASSERT; }
+    const Ref<Expr> expr;
 public:
-    Assert(unique_ptr<Expr>);
+    Assert(Ref<Expr>);
 };
 
 //    is the root of our AST
 class Program
 {
 public:
-    const vector<unique_ptr<Stmt>> statements;
+    const vector<Ref<Stmt>> statements;
 public:
     explicit Program(vector<unique_ptr<Stmt>>);
+    explicit Program(vector<Ref<Stmt>>);
 };
 #endif
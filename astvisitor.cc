@@ -1,87 +1,71 @@
 #include "astvisitor.hh"
 #include "ast.hh"
 
+// Dispatch goes through one table per node hierarchy, indexed by the node's
+// tag, instead of a chain of compares and RTTI casts. A null entry is a tag
+// the visitor has no handler for (INPUT, SYMVAR, ...).
+
 // Centralized dispatch for TypeExpr nodes
 void ASTVisitor::visit(const TypeExpr* node) {
+    using Handler = void (*)(ASTVisitor &, const TypeExpr &);
+    static const Handler table[] = {
+        &dispatch<TypeExpr, TypeConst, &ASTVisitor::visitTypeConst>,    // TYPE_CONST
+        nullptr,                                                        // TYPE_VARIABLE
+        &dispatch<TypeExpr, FuncType, &ASTVisitor::visitFuncType>,      // FUNC_TYPE
+        &dispatch<TypeExpr, MapType, &ASTVisitor::visitMapType>,        // MAP_TYPE
+        &dispatch<TypeExpr, SetType, &ASTVisitor::visitSetType>,        // SET_TYPE
+        &dispatch<TypeExpr, TupleType, &ASTVisitor::visitTupleType>,    // TUPLE_TYPE
+    };
+
     if (!node)
         throw std::runtime_error("Null TypeExpr node in visitor");
-
-    if (node->typeExprType == TypeExprType::TYPE_CONST) {
-        visitTypeConst(*dynamic_cast<const TypeConst*>(node));
-    }
-    else if (node->typeExprType == TypeExprType::FUNC_TYPE) {
-        visitFuncType(*dynamic_cast<const FuncType*>(node));
-    }
-    else if (node->typeExprType == TypeExprType::MAP_TYPE) {
-        visitMapType(*dynamic_cast<const MapType*>(node));
-    }
-    else if (node->typeExprType == TypeExprType::TUPLE_TYPE) {
-        visitTupleType(*dynamic_cast<const TupleType*>(node));
-    }
-    else if (node->typeExprType == TypeExprType::SET_TYPE) {
-        visitSetType(*dynamic_cast<const SetType*>(node));
-    }
-    else {
+    size_t tag = static_cast<size_t>(node->typeExprType);
+    if (tag >= sizeof(table) / sizeof(table[0]) || !table[tag])
         throw std::runtime_error("Unknown TypeExpr type in visitor");
-    }
+    table[tag](*this, *node);
 }
 
 // Centralized dispatch for Expr nodes
 void ASTVisitor::visit(const Expr* node) {
+    using Handler = void (*)(ASTVisitor &, const Expr &);
+    static const Handler table[] = {
+        nullptr,                                                        // INPUT
+        &dispatch<Expr, FuncCall, &ASTVisitor::visitFuncCall>,          // FUNCCALL
+        &dispatch<Expr, Map, &ASTVisitor::visitMap>,                    // MAP
+        &dispatch<Expr, Num, &ASTVisitor::visitNum>,                    // NUM
+        nullptr,                                                        // POLYFUNCCALL
+        &dispatch<Expr, Set, &ASTVisitor::visitSet>,                    // SET
+        &dispatch<Expr, String, &ASTVisitor::visitString>,              // STRING
+        nullptr,                                                        // SYMVAR
+        &dispatch<Expr, Tuple, &ASTVisitor::visitTuple>,                // TUPLE
+        &dispatch<Expr, Var, &ASTVisitor::visitVar>,                    // VAR
+        &dispatch<Expr, BoolConst, &ASTVisitor::visitBoolConst>,        // BOOL_CONST
+        &dispatch<Expr, BinaryOpExpr, &ASTVisitor::visitBinaryOpExpr>,  // BINARY_OP
+        &dispatch<Expr, UnaryOpExpr, &ASTVisitor::visitUnaryOpExpr>,    // UNARY_OP
+    };
+
     if (!node)
         throw std::runtime_error("Null Expr node in visitor");
-
-    if (node->exprType == ExprType::VAR) {
-        visitVar(*dynamic_cast<const Var*>(node));
-    }
-    else if (node->exprType == ExprType::FUNCCALL) {
-        visitFuncCall(*dynamic_cast<const FuncCall*>(node));
-    }
-    else if (node->exprType == ExprType::NUM) {
-        visitNum(*dynamic_cast<const Num*>(node));
-    }
-    else if (node->exprType == ExprType::STRING) {
-        visitString(*dynamic_cast<const String*>(node));
-    }
-    else if (node->exprType == ExprType::SET) {
-        visitSet(*dynamic_cast<const Set*>(node));
-    }
-    else if (node->exprType == ExprType::MAP) {
-        visitMap(*dynamic_cast<const Map*>(node));
-    }
-    else if (node->exprType == ExprType::TUPLE) {
-        visitTuple(*dynamic_cast<const Tuple*>(node));
-    }
-    // NEW: Add these three cases
-    else if (node->exprType == ExprType::BOOL_CONST) {
-        visitBoolConst(*dynamic_cast<const BoolConst*>(node));
-    }
-    else if (node->exprType == ExprType::BINARY_OP) {
-        visitBinaryOpExpr(*dynamic_cast<const BinaryOpExpr*>(node));
-    }
-    else if (node->exprType == ExprType::UNARY_OP) {
-        visitUnaryOpExpr(*dynamic_cast<const UnaryOpExpr*>(node));
-    }
-    else {
+    size_t tag = static_cast<size_t>(node->exprType);
+    if (tag >= sizeof(table) / sizeof(table[0]) || !table[tag])
         throw std::runtime_error("Unknown Expr type in visitor");
-    }
+    table[tag](*this, *node);
 }
 
 // Centralized dispatch for Stmt nodes
 void ASTVisitor::visit(const Stmt* node) {
+    using Handler = void (*)(ASTVisitor &, const Stmt &);
+    static const Handler table[] = {
+        &dispatch<Stmt, Assign, &ASTVisitor::visitAssign>,              // ASSIGN
+        &dispatch<Stmt, Assume, &ASTVisitor::visitAssume>,              // ASSUME
+        &dispatch<Stmt, Assert, &ASTVisitor::visitAssert>,              // ASSERT
+        nullptr,                                                        // DECL
+    };
+
     if (!node)
         throw std::runtime_error("Null Stmt node in visitor");
-
-    if (node->statementType == StmtType::ASSIGN) {
-        visitAssign(*dynamic_cast<const Assign*>(node));
-    }
-    else if (node->statementType == StmtType::ASSUME) {
-        visitAssume(*dynamic_cast<const Assume*>(node));
-    }
-    else if (node->statementType == StmtType::ASSERT) {
-    visitAssert(*dynamic_cast<const Assert*>(node));
-}
-    else {
+    size_t tag = static_cast<size_t>(node->statementType);
+    if (tag >= sizeof(table) / sizeof(table[0]) || !table[tag])
         throw std::runtime_error("Unknown Stmt type in visitor");
-    }
+    table[tag](*this, *node);
 }
@@ -49,6 +49,14 @@ public:
     void visit(const Expr* node);
     void visit(const Stmt* node);
 
+private:
+    // Entries of the per-hierarchy dispatch tables, indexed by node tag
+    template <typename Base, typename Node, void (ASTVisitor::*Visit)(const Node &)>
+    static void dispatch(ASTVisitor &visitor, const Base &node)
+    {
+        (visitor.*Visit)(static_cast<const Node &>(node));
+    }
+
 protected:
     // Type Expression visitors - to be implemented by concrete visitors
     virtual void visitTypeConst(const TypeConst &node) = 0;
@@ -0,0 +1,598 @@
+#include "atcsimplifier.hh"
+
+#include <iostream>
+#include <set>
+
+using namespace std;
+
+namespace {
+
+/* ============================================================
+ * Literals and operator families
+ * ============================================================ */
+
+enum class Junction { NONE, AND, OR };
+
+// Num, BoolConst and plain strings; a placeholder is only resolved later
+bool isLiteral(const Expr *e)
+{
+    switch (e->exprType) {
+    case ExprType::NUM:
+    case ExprType::BOOL_CONST:
+        return true;
+    case ExprType::STRING:
+        return !e->is<Placeholder>();
+    default:
+        return false;
+    }
+}
+
+const BoolConst *boolLiteral(const Expr *e)
+{
+    return e ? e->as<BoolConst>() : nullptr;
+}
+
+// assume(true) and the generator's assume(1)
+bool isTrivialTruth(const Expr *e)
+{
+    if (auto b = e->as<BoolConst>())
+        return b->value;
+    if (auto n = e->as<Num>())
+        return n->value == 1;
+    return false;
+}
+
+Junction junctionOf(const Expr *e)
+{
+    if (auto fc = e->as<FuncCall>()) {
+        const string &n = fc->name;
+        if (n == "And" || n == "and" || n == "&&" || n == "AND")
+            return Junction::AND;
+        if (n == "Or" || n == "or" || n == "||" || n == "OR")
+            return Junction::OR;
+    } else if (auto b = e->as<BinaryOpExpr>()) {
+        if (b->op == BinOp::AND)
+            return Junction::AND;
+        if (b->op == BinOp::OR)
+            return Junction::OR;
+    }
+    return Junction::NONE;
+}
+
+bool isNotCall(const FuncCall *fc)
+{
+    return (fc->name == "Not" || fc->name == "not" || fc->name == "!") && fc->args.size() == 1;
+}
+
+// The operand of a negation, nullptr for anything else
+const Ref<Expr> *negated(const Expr *e)
+{
+    if (auto fc = e->as<FuncCall>())
+        return isNotCall(fc) ? &fc->args[0] : nullptr;
+    if (auto u = e->as<UnaryOpExpr>())
+        return u->op == UnOp::NOT ? &u->operand : nullptr;
+    return nullptr;
+}
+
+enum class Cmp { NONE, EQ, NEQ, LT, LE, GT, GE };
+
+Cmp comparisonOf(const string &name)
+{
+    if (name == "Eq" || name == "=" || name == "==") return Cmp::EQ;
+    if (name == "Neq" || name == "!=" || name == "<>") return Cmp::NEQ;
+    if (name == "Lt" || name == "<") return Cmp::LT;
+    if (name == "Le" || name == "<=") return Cmp::LE;
+    if (name == "Gt" || name == ">") return Cmp::GT;
+    if (name == "Ge" || name == ">=") return Cmp::GE;
+    return Cmp::NONE;
+}
+
+Cmp comparisonOf(BinOp op)
+{
+    switch (op) {
+    case BinOp::EQ: return Cmp::EQ;
+    case BinOp::NEQ: return Cmp::NEQ;
+    case BinOp::LT: return Cmp::LT;
+    case BinOp::LE: return Cmp::LE;
+    case BinOp::GT: return Cmp::GT;
+    case BinOp::GE: return Cmp::GE;
+    default: return Cmp::NONE;
+    }
+}
+
+// Decide a comparison of two literals of the same kind; false when it
+// cannot be decided statically (mixed kinds are left to the solver)
+bool compareLiterals(Cmp cmp, const Expr *l, const Expr *r, bool &result)
+{
+    if (cmp == Cmp::NONE || !isLiteral(l) || !isLiteral(r) || l->exprType != r->exprType)
+        return false;
+
+    int order;
+    switch (l->exprType) {
+    case ExprType::NUM: {
+        int a = l->as<Num>()->value, b = r->as<Num>()->value;
+        order = a < b ? -1 : a > b ? 1 : 0;
+        break;
+    }
+    case ExprType::STRING:
+        if (cmp != Cmp::EQ && cmp != Cmp::NEQ)
+            return false;
+        order = l->as<String>()->value == r->as<String>()->value ? 0 : 1;
+        break;
+    case ExprType::BOOL_CONST:
+        if (cmp != Cmp::EQ && cmp != Cmp::NEQ)
+            return false;
+        order = l->as<BoolConst>()->value == r->as<BoolConst>()->value ? 0 : 1;
+        break;
+    default:
+        return false;
+    }
+
+    switch (cmp) {
+    case Cmp::EQ: result = order == 0; break;
+    case Cmp::NEQ: result = order != 0; break;
+    case Cmp::LT: result = order < 0; break;
+    case Cmp::LE: result = order <= 0; break;
+    case Cmp::GT: result = order > 0; break;
+    case Cmp::GE: result = order >= 0; break;
+    default: return false;
+    }
+    return true;
+}
+
+/* ============================================================
+ * Folding
+ * ============================================================ */
+
+// Fold each operand; true when any of them changed
+bool foldAll(const vector<Ref<Expr>> &in, vector<Ref<Expr>> &out)
+{
+    bool changed = false;
+    out.reserve(in.size());
+    for (const auto &e : in) {
+        out.push_back(foldExpr(e));
+        changed |= out.back().get() != e.get();
+    }
+    return changed;
+}
+
+// Operands of a nested And/Or chain, folded; `changed` is set when any
+// operand folded
+void collectJunction(const Ref<Expr> &e, Junction j, vector<Ref<Expr>> &leaves, bool &changed)
+{
+    if (junctionOf(e.get()) == j) {
+        if (auto fc = e->as<FuncCall>()) {
+            for (const auto &arg : fc->args)
+                collectJunction(arg, j, leaves, changed);
+        } else {
+            auto b = e->as<BinaryOpExpr>();
+            collectJunction(b->left, j, leaves, changed);
+            collectJunction(b->right, j, leaves, changed);
+        }
+        return;
+    }
+    Ref<Expr> folded = foldExpr(e);
+    changed |= folded.get() != e.get();
+    leaves.push_back(move(folded));
+}
+
+// And/Or: drop the neutral literal, short-circuit on the absorbing one and
+// rebuild what is left as a right-nested binary chain of the same spelling
+Ref<Expr> foldJunction(const Ref<Expr> &e, Junction j)
+{
+    const bool neutral = j == Junction::AND;
+    vector<Ref<Expr>> leaves;
+    bool changed = false;
+    collectJunction(e, j, leaves, changed);
+
+    vector<Ref<Expr>> kept;
+    for (auto &leaf : leaves) {
+        const BoolConst *b = boolLiteral(leaf.get());
+        if (!b) {
+            kept.push_back(move(leaf));
+            continue;
+        }
+        if (b->value != neutral)
+            return makeRef<BoolConst>(!neutral);
+        changed = true;
+    }
+
+    if (kept.empty())
+        return makeRef<BoolConst>(neutral);
+    if (kept.size() == 1)
+        return kept[0];
+    if (!changed)
+        return e;
+
+    Ref<Expr> chain = kept.back();
+    for (int i = (int)kept.size() - 2; i >= 0; i--) {
+        if (auto fc = e->as<FuncCall>()) {
+            vector<Ref<Expr>> args;
+            args.push_back(kept[i]);
+            args.push_back(move(chain));
+            chain = makeRef<FuncCall>(fc->name, move(args));
+        } else {
+            chain = makeRef<BinaryOpExpr>(e->as<BinaryOpExpr>()->op, kept[i], move(chain));
+        }
+    }
+    return chain;
+}
+
+// Not(literal) and Not(Not(x)); nullptr when neither applies
+Ref<Expr> foldNegation(const Ref<Expr> &operand)
+{
+    if (auto b = boolLiteral(operand.get()))
+        return makeRef<BoolConst>(!b->value);
+    if (const Ref<Expr> *inner = negated(operand.get()))
+        return *inner;
+    return nullptr;
+}
+
+} // namespace
+
+Ref<Expr> foldExpr(const Ref<Expr> &e)
+{
+    if (!e)
+        return e;
+
+    Junction j = junctionOf(e.get());
+    if (j != Junction::NONE)
+        return foldJunction(e, j);
+
+    switch (e->exprType) {
+    case ExprType::FUNCCALL: {
+        auto fc = static_cast<const FuncCall *>(e.get());
+        vector<Ref<Expr>> args;
+        bool changed = foldAll(fc->args, args);
+
+        bool result;
+        if (args.size() == 2 && compareLiterals(comparisonOf(fc->name), args[0].get(), args[1].get(), result))
+            return makeRef<BoolConst>(result);
+        if (isNotCall(fc)) {
+            if (Ref<Expr> folded = foldNegation(args[0]))
+                return folded;
+        }
+        if (!changed)
+            return e;
+        return makeRef<FuncCall>(fc->name, move(args));
+    }
+    case ExprType::BINARY_OP: {
+        auto b = static_cast<const BinaryOpExpr *>(e.get());
+        Ref<Expr> left = foldExpr(b->left);
+        Ref<Expr> right = foldExpr(b->right);
+
+        bool result;
+        if (compareLiterals(comparisonOf(b->op), left.get(), right.get(), result))
+            return makeRef<BoolConst>(result);
+        if (b->op == BinOp::IMPLIES) {
+            if (auto premise = boolLiteral(left.get()))
+                return premise->value ? right : Ref<Expr>(makeRef<BoolConst>(true));
+        }
+        if (left.get() == b->left.get() && right.get() == b->right.get())
+            return e;
+        return makeRef<BinaryOpExpr>(b->op, move(left), move(right));
+    }
+    case ExprType::UNARY_OP: {
+        auto u = static_cast<const UnaryOpExpr *>(e.get());
+        Ref<Expr> operand = foldExpr(u->operand);
+        if (u->op == UnOp::NOT) {
+            if (Ref<Expr> folded = foldNegation(operand))
+                return folded;
+        }
+        if (operand.get() == u->operand.get())
+            return e;
+        return makeRef<UnaryOpExpr>(u->op, move(operand));
+    }
+    case ExprType::SET: {
+        vector<Ref<Expr>> elements;
+        if (!foldAll(static_cast<const Set *>(e.get())->elements, elements))
+            return e;
+        return makeRef<Set>(move(elements));
+    }
+    case ExprType::TUPLE: {
+        vector<Ref<Expr>> exprs;
+        if (!foldAll(static_cast<const Tuple *>(e.get())->exprs, exprs))
+            return e;
+        return makeRef<Tuple>(move(exprs));
+    }
+    case ExprType::MAP: {
+        vector<pair<Ref<Var>, Ref<Expr>>> entries;
+        bool changed = false;
+        for (const auto &kv : static_cast<const Map *>(e.get())->value) {
+            entries.emplace_back(kv.first, foldExpr(kv.second));
+            changed |= entries.back().second.get() != kv.second.get();
+        }
+        if (!changed)
+            return e;
+        return makeRef<Map>(move(entries));
+    }
+    default:
+        return e;
+    }
+}
+
+/* ============================================================
+ * Redundant reads
+ * ============================================================ */
+
+namespace {
+
+void collectPrimed(const Expr *e, set<string> &primed)
+{
+    if (!e)
+        return;
+    switch (e->exprType) {
+    case ExprType::FUNCCALL: {
+        auto fc = static_cast<const FuncCall *>(e);
+        if (fc->name == "'" && fc->args.size() == 1 && fc->args[0]->is<Var>()) {
+            primed.insert(fc->args[0]->as<Var>()->name);
+            return;
+        }
+        for (const auto &a : fc->args)
+            collectPrimed(a.get(), primed);
+        return;
+    }
+    case ExprType::SET:
+        for (const auto &a : static_cast<const Set *>(e)->elements)
+            collectPrimed(a.get(), primed);
+        return;
+    case ExprType::TUPLE:
+        for (const auto &a : static_cast<const Tuple *>(e)->exprs)
+            collectPrimed(a.get(), primed);
+        return;
+    case ExprType::MAP:
+        for (const auto &kv : static_cast<const Map *>(e)->value)
+            collectPrimed(kv.second.get(), primed);
+        return;
+    case ExprType::BINARY_OP:
+        collectPrimed(static_cast<const BinaryOpExpr *>(e)->left.get(), primed);
+        collectPrimed(static_cast<const BinaryOpExpr *>(e)->right.get(), primed);
+        return;
+    case ExprType::UNARY_OP:
+        collectPrimed(static_cast<const UnaryOpExpr *>(e)->operand.get(), primed);
+        return;
+    default:
+        return;
+    }
+}
+
+// `tmp_G_n := get_G()`: the global read, "" for any other statement
+string readGlobal(const Assign &assign)
+{
+    const FuncCall *fc = assign.right->as<FuncCall>();
+    if (!assign.left->is<Var>() || !fc || !fc->args.empty() || fc->name.compare(0, 4, "get_") != 0)
+        return "";
+    return fc->name.substr(4);
+}
+
+// Forward pass: `avail` holds, per global, a temp that still equals the
+// backend's copy. A business call drops the globals it writes, set_G drops
+// G, reset/restore and unknown calls drop everything, and a temp that is
+// itself assigned (tmp[k] := v) stops standing for its global.
+vector<Ref<Stmt>> reuseReads(const vector<Ref<Stmt>> &stmts, const WriteSets &writes, SimplifyStats &st)
+{
+    map<string, string> avail;
+    vector<Ref<Stmt>> out;
+    out.reserve(stmts.size());
+
+    for (const auto &stmt : stmts) {
+        const Assign *as = stmt->as<Assign>();
+        if (!as) {
+            out.push_back(stmt);
+            continue;
+        }
+
+        const Var *lhs = as->left->as<Var>();
+        const Var *target = lhs;
+        if (!target) {
+            if (auto index = as->left->as<FuncCall>())
+                target = index->args.empty() ? nullptr : index->args[0]->as<Var>();
+        }
+        if (target) {
+            for (auto it = avail.begin(); it != avail.end();) {
+                it = it->second == target->name ? avail.erase(it) : next(it);
+            }
+        }
+
+        string global = readGlobal(*as);
+        if (!global.empty()) {
+            auto it = avail.find(global);
+            if (it != avail.end()) {
+                out.push_back(makeRef<Assign>(as->left, makeRef<Var>(it->second)));
+                st.reusedReads++;
+            } else {
+                avail[global] = lhs->name;
+                out.push_back(stmt);
+            }
+            continue;
+        }
+        out.push_back(stmt);
+
+        const FuncCall *call = as->right->as<FuncCall>();
+        if (!call || call->name == "input" || call->name == "checkpoint")
+            continue;
+        if (call->name.compare(0, 4, "set_") == 0) {
+            avail.erase(call->name.substr(4));
+            continue;
+        }
+        auto written = writes.find(call->name);
+        if (written == writes.end()) {
+            avail.clear();
+            continue;
+        }
+        for (const auto &g : written->second)
+            avail.erase(g);
+    }
+    return out;
+}
+
+} // namespace
+
+WriteSets specWriteSets(const Spec &spec)
+{
+    WriteSets writes;
+    for (const auto &block : spec.blocks) {
+        if (!block->call || !block->call->call)
+            continue;
+        set<string> &w = writes[block->call->call->name];
+        collectPrimed(block->response.ResponseExpr.get(), w);
+        collectPrimed(block->call->response.ResponseExpr.get(), w);
+    }
+    return writes;
+}
+
+/* ============================================================
+ * Dead assignments
+ * ============================================================ */
+
+namespace {
+
+void collectReads(const Expr *e, set<string> &reads)
+{
+    if (!e)
+        return;
+    switch (e->exprType) {
+    case ExprType::VAR:
+        reads.insert(static_cast<const Var *>(e)->name);
+        return;
+    case ExprType::FUNCCALL:
+        for (const auto &a : static_cast<const FuncCall *>(e)->args)
+            collectReads(a.get(), reads);
+        return;
+    case ExprType::SET:
+        for (const auto &a : static_cast<const Set *>(e)->elements)
+            collectReads(a.get(), reads);
+        return;
+    case ExprType::TUPLE:
+        for (const auto &a : static_cast<const Tuple *>(e)->exprs)
+            collectReads(a.get(), reads);
+        return;
+    case ExprType::MAP:
+        for (const auto &kv : static_cast<const Map *>(e)->value) {
+            reads.insert(kv.first->name);
+            collectReads(kv.second.get(), reads);
+        }
+        return;
+    case ExprType::BINARY_OP:
+        collectReads(static_cast<const BinaryOpExpr *>(e)->left.get(), reads);
+        collectReads(static_cast<const BinaryOpExpr *>(e)->right.get(), reads);
+        return;
+    case ExprType::UNARY_OP:
+        collectReads(static_cast<const UnaryOpExpr *>(e)->operand.get(), reads);
+        return;
+    default:
+        return;
+    }
+}
+
+// email0 -> email, as SEE maps unsuffixed reads to the latest suffixed name
+string baseName(const string &name)
+{
+    size_t end = name.find_last_not_of("0123456789");
+    return end == string::npos ? name : name.substr(0, end + 1);
+}
+
+// `x := y` or `tmp_G_n := get_G()`: no effect but binding x
+bool isRemovable(const Assign &assign)
+{
+    const Var *lhs = assign.left->as<Var>();
+    if (!lhs)
+        return false;
+    if (assign.right->is<Var>())
+        return true;
+    const FuncCall *fc = assign.right->as<FuncCall>();
+    if (!fc || !fc->args.empty() || fc->name.compare(0, 4, "get_") != 0)
+        return false;
+    string temp = "tmp_" + fc->name.substr(4) + "_";
+    return lhs->name.compare(0, temp.size(), temp) == 0;
+}
+
+} // namespace
+
+unique_ptr<Program> simplifyATC(const Program &atc, const WriteSets *writes, SimplifyStats *stats)
+{
+    SimplifyStats st;
+
+    vector<Ref<Stmt>> reads = writes ? reuseReads(atc.statements, *writes, st) : atc.statements;
+
+    // Forward: fold every expression, drop trivially true assumptions
+    vector<Ref<Stmt>> folded;
+    folded.reserve(reads.size());
+    for (const auto &stmt : reads) {
+        if (auto as = stmt->as<Assign>()) {
+            Ref<Expr> right = foldExpr(as->right);
+            if (right.get() == as->right.get()) {
+                folded.push_back(stmt);
+            } else {
+                folded.push_back(makeRef<Assign>(as->left, move(right)));
+                st.foldedExprs++;
+            }
+        } else if (auto am = stmt->as<Assume>()) {
+            Ref<Expr> expr = foldExpr(am->expr);
+            if (isTrivialTruth(expr.get())) {
+                st.droppedAssumes++;
+                continue;
+            }
+            if (expr.get() == am->expr.get()) {
+                folded.push_back(stmt);
+            } else {
+                folded.push_back(makeRef<Assume>(move(expr)));
+                st.foldedExprs++;
+            }
+        } else if (auto at = stmt->as<Assert>()) {
+            Ref<Expr> expr = foldExpr(at->expr);
+            if (expr.get() == at->expr.get()) {
+                folded.push_back(stmt);
+            } else {
+                folded.push_back(makeRef<Assert>(move(expr)));
+                st.foldedExprs++;
+            }
+        } else {
+            folded.push_back(stmt);
+        }
+    }
+
+    // Backward: drop copies and temp reads whose target is never read again
+    set<string> live;
+    vector<bool> keep(folded.size(), true);
+    for (size_t i = folded.size(); i-- > 0;) {
+        const Stmt *stmt = folded[i].get();
+        if (auto as = stmt->as<Assign>()) {
+            if (const Var *lhs = as->left->as<Var>()) {
+                bool read = live.count(lhs->name) || live.count(baseName(lhs->name));
+                if (!read && isRemovable(*as)) {
+                    keep[i] = false;
+                    st.droppedAssigns++;
+                    continue;
+                }
+                live.erase(lhs->name);
+            } else {
+                // tmp[k] := v reads and updates tmp
+                collectReads(as->left.get(), live);
+            }
+            collectReads(as->right.get(), live);
+        } else if (auto am = stmt->as<Assume>()) {
+            collectReads(am->expr.get(), live);
+        } else if (auto at = stmt->as<Assert>()) {
+            collectReads(at->expr.get(), live);
+        }
+    }
+
+    vector<Ref<Stmt>> out;
+    out.reserve(folded.size());
+    for (size_t i = 0; i < folded.size(); i++) {
+        if (keep[i])
+            out.push_back(move(folded[i]));
+    }
+
+    if (stats) {
+        stats->reusedReads += st.reusedReads;
+        stats->foldedExprs += st.foldedExprs;
+        stats->droppedAssumes += st.droppedAssumes;
+        stats->droppedAssigns += st.droppedAssigns;
+    }
+    cout << "[Simplify] " << atc.statements.size() << " -> " << out.size() << " statements ("
+         << st.reusedReads << " reads reused, " << st.droppedAssumes << " assumes, " << st.droppedAssigns << " dead assignments dropped, "
+         << st.foldedExprs << " folded)" << endl;
+    return make_unique<Program>(move(out));
+}
@@ -0,0 +1,57 @@
+#ifndef ATCSIMPLIFIER_HH
+#define ATCSIMPLIFIER_HH
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "ast.hh"
+
+using namespace std;
+
+/**
+ * ATCSimplifier - partial evaluation of test-API ATCs before SEE runs
+ *
+ * After RewriteGlobalsVisitor an ATC is full of statically decidable
+ * pieces. The simplifier
+ *   - folds comparisons of literals and boolean operators over literals:
+ *     Eq("a", "a") -> true, Lt(1, 2) -> true, Not(false) -> true
+ *   - flattens nested And/Or chains, dropping neutral operands
+ *     (And(true, x) -> x) and short-circuiting absorbing ones
+ *   - with the spec's write sets, turns a `tmp_G_j := get_G()` that no
+ *     call since the last read can have changed into `tmp_G_j := tmp_G_i`
+ *   - drops assume(true) and assume(1)
+ *   - drops copies and temps nothing after them reads: `B_old := tmp_B_0`
+ *     whose snapshot the assertion ignores, then `tmp_B_0 := get_B()`
+ *
+ * input(), API calls and placeholders are never touched, so the inputs and
+ * the business calls of the test are the same; only get_G() reads go.
+ * A name counts as read when it or its base name (bookTitle for
+ * bookTitle0) appears later, matching how SEE resolves unsuffixed names.
+ * Untouched statements and subtrees are shared with the input program.
+ */
+struct SimplifyStats {
+    size_t reusedReads = 0;       // get_G() answered by an earlier temp
+    size_t foldedExprs = 0;       // statements whose expressions folded
+    size_t droppedAssumes = 0;
+    size_t droppedAssigns = 0;
+};
+
+// API function -> globals a call may change: the primed variables in the
+// postconditions of every block that calls it. reset/restore and set_G
+// are known; any other call is taken to change everything.
+typedef map<string, set<string>> WriteSets;
+
+WriteSets specWriteSets(const Spec &spec);
+
+// Counts of this call are added to `stats`. Without write sets every get_G()
+// is kept.
+unique_ptr<Program> simplifyATC(const Program &atc, const WriteSets *writes = nullptr,
+                                SimplifyStats *stats = nullptr);
+
+// Constant folding and boolean flattening of one expression; returns `e`
+// itself when nothing folds
+Ref<Expr> foldExpr(const Ref<Expr> &e);
+
+#endif // ATCSIMPLIFIER_HH
@@ -0,0 +1,355 @@
+#include "atctemplate.hh"
+#include "algo.hpp"
+#include "rewrite_globals_visitor.hh"
+
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+using namespace std;
+
+// Slot markers; neither can appear in a spec identifier
+static const string SUFFIX_MARK = "\x01";
+static const string TEMP_MARK = "\x02";
+
+/* ============================================================
+ * Renaming (copy-on-write)
+ * ============================================================ */
+
+typedef unordered_map<string, string> Renames;
+
+// The node itself when nothing under it is renamed, else a rebuilt copy
+// that shares every untouched subtree
+static Ref<Expr> renamed(const Ref<Expr>& e, const Renames& renames);
+
+static bool renamedAll(const vector<Ref<Expr>>& es, const Renames& renames, vector<Ref<Expr>>& out) {
+    bool changed = false;
+    out.reserve(es.size());
+    for (const auto& e : es) {
+        out.push_back(renamed(e, renames));
+        changed |= out.back().get() != e.get();
+    }
+    return changed;
+}
+
+static Ref<Var> renamedVar(const Ref<Var>& v, const Renames& renames) {
+    if (v->name.find_first_of(SUFFIX_MARK + TEMP_MARK) != string::npos) {
+        auto it = renames.find(v->name);
+        if (it != renames.end()) {
+            return makeRef<Var>(it->second);
+        }
+    }
+    return v;
+}
+
+static Ref<Expr> renamed(const Ref<Expr>& e, const Renames& renames) {
+    if (!e) return nullptr;
+
+    switch (e->exprType) {
+    case ExprType::VAR:
+        return renamedVar(shareNode(static_cast<const Var*>(e.get())), renames);
+    case ExprType::FUNCCALL: {
+        auto fc = static_cast<const FuncCall*>(e.get());
+        vector<Ref<Expr>> args;
+        if (!renamedAll(fc->args, renames, args)) return e;
+        return makeRef<FuncCall>(fc->name, move(args));
+    }
+    case ExprType::SET: {
+        vector<Ref<Expr>> elements;
+        if (!renamedAll(static_cast<const Set*>(e.get())->elements, renames, elements)) return e;
+        return makeRef<Set>(move(elements));
+    }
+    case ExprType::TUPLE: {
+        vector<Ref<Expr>> exprs;
+        if (!renamedAll(static_cast<const Tuple*>(e.get())->exprs, renames, exprs)) return e;
+        return makeRef<Tuple>(move(exprs));
+    }
+    case ExprType::MAP: {
+        vector<pair<Ref<Var>, Ref<Expr>>> entries;
+        bool changed = false;
+        for (const auto& kv : static_cast<const Map*>(e.get())->value) {
+            entries.emplace_back(renamedVar(kv.first, renames), renamed(kv.second, renames));
+            changed |= entries.back().first.get() != kv.first.get() ||
+                       entries.back().second.get() != kv.second.get();
+        }
+        if (!changed) return e;
+        return makeRef<Map>(move(entries));
+    }
+    case ExprType::BINARY_OP: {
+        auto b = static_cast<const BinaryOpExpr*>(e.get());
+        auto left = renamed(b->left, renames);
+        auto right = renamed(b->right, renames);
+        if (left.get() == b->left.get() && right.get() == b->right.get()) return e;
+        return makeRef<BinaryOpExpr>(b->op, move(left), move(right));
+    }
+    case ExprType::UNARY_OP: {
+        auto u = static_cast<const UnaryOpExpr*>(e.get());
+        auto operand = renamed(u->operand, renames);
+        if (operand.get() == u->operand.get()) return e;
+        return makeRef<UnaryOpExpr>(u->op, move(operand));
+    }
+    default:
+        // Literals carry no slots
+        return e;
+    }
+}
+
+static Ref<Stmt> renamed(const Ref<Stmt>& s, const Renames& renames) {
+    if (auto as = s->as<Assign>()) {
+        auto left = renamed(as->left, renames);
+        auto right = renamed(as->right, renames);
+        if (left.get() == as->left.get() && right.get() == as->right.get()) return s;
+        return makeRef<Assign>(move(left), move(right));
+    }
+    if (auto am = s->as<Assume>()) {
+        auto expr = renamed(am->expr, renames);
+        if (expr.get() == am->expr.get()) return s;
+        return makeRef<Assume>(move(expr));
+    }
+    if (auto at = s->as<Assert>()) {
+        auto expr = renamed(at->expr, renames);
+        if (expr.get() == at->expr.get()) return s;
+        return makeRef<Assert>(move(expr));
+    }
+    return s;
+}
+
+/* ============================================================
+ * Slot collection
+ * ============================================================ */
+
+static void collectNames(const Expr* e, set<string>& names) {
+    if (!e) return;
+    switch (e->exprType) {
+    case ExprType::VAR:
+        names.insert(static_cast<const Var*>(e)->name);
+        return;
+    case ExprType::FUNCCALL:
+        for (const auto& a : static_cast<const FuncCall*>(e)->args) collectNames(a.get(), names);
+        return;
+    case ExprType::SET:
+        for (const auto& a : static_cast<const Set*>(e)->elements) collectNames(a.get(), names);
+        return;
+    case ExprType::TUPLE:
+        for (const auto& a : static_cast<const Tuple*>(e)->exprs) collectNames(a.get(), names);
+        return;
+    case ExprType::MAP:
+        for (const auto& kv : static_cast<const Map*>(e)->value) {
+            names.insert(kv.first->name);
+            collectNames(kv.second.get(), names);
+        }
+        return;
+    case ExprType::BINARY_OP:
+        collectNames(static_cast<const BinaryOpExpr*>(e)->left.get(), names);
+        collectNames(static_cast<const BinaryOpExpr*>(e)->right.get(), names);
+        return;
+    case ExprType::UNARY_OP:
+        collectNames(static_cast<const UnaryOpExpr*>(e)->operand.get(), names);
+        return;
+    default:
+        return;
+    }
+}
+
+static void collectNames(const Stmt* s, set<string>& names) {
+    if (auto as = s->as<Assign>()) {
+        collectNames(as->left.get(), names);
+        collectNames(as->right.get(), names);
+    } else if (auto am = s->as<Assume>()) {
+        collectNames(am->expr.get(), names);
+    } else if (auto at = s->as<Assert>()) {
+        collectNames(at->expr.get(), names);
+    }
+}
+
+/* ============================================================
+ * Compilation
+ * ============================================================ */
+
+ATCTemplates::Template ATCTemplates::compile(
+    vector<unique_ptr<Stmt>> logical,
+    size_t skip,
+    const map<string, int>& tempBase
+) {
+    Program program(move(logical));
+
+    RewriteGlobalsVisitor rewriter;
+    rewriter.setTempMarker(TEMP_MARK);
+    rewriter.visitProgram(program);
+
+    const auto& rewritten = rewriter.rewrittenProgram->statements;
+    if (rewritten.size() < skip) {
+        throw runtime_error("ATCTemplates: rewritten block is shorter than its prelude");
+    }
+
+    Template t;
+    t.stmts.assign(rewritten.begin() + skip, rewritten.end());
+
+    set<string> names;
+    for (const auto& s : t.stmts) {
+        collectNames(s.get(), names);
+    }
+
+    for (const auto& name : names) {
+        size_t tempAt = name.find(TEMP_MARK);
+        if (tempAt != string::npos) {
+            // tmp_<G>_\x02<n>
+            Slot slot;
+            slot.name = name;
+            slot.isTemp = true;
+            slot.global = name.substr(4, tempAt - 5);
+            auto base = tempBase.find(slot.global);
+            slot.local = stoi(name.substr(tempAt + 1)) -
+                         (base == tempBase.end() ? 0 : base->second);
+            int& used = t.temps[slot.global];
+            used = max(used, slot.local + 1);
+            t.slots.push_back(move(slot));
+            continue;
+        }
+        if (name.find(SUFFIX_MARK) != string::npos) {
+            Slot slot;
+            slot.name = name;
+            size_t from = 0, at;
+            while ((at = name.find(SUFFIX_MARK, from)) != string::npos) {
+                slot.parts.push_back(name.substr(from, at - from));
+                from = at + 1;
+            }
+            slot.parts.push_back(name.substr(from));
+            t.slots.push_back(move(slot));
+        }
+    }
+    return t;
+}
+
+ATCTemplates::ATCTemplates(const Spec& spec) {
+    auto logicalInit = [&spec]() {
+        SymbolTable st(nullptr);
+        TypeMap tm(nullptr);
+        return genInit(spec, &st, &tm);
+    };
+
+    // Prelude: init statements that are not `G := {}` survive the rewrite
+    prelude = compile(logicalInit(), 1, {});
+
+    for (size_t i = 0; i < spec.blocks.size(); i++) {
+        const API* api = spec.blocks[i].get();
+        vector<unique_ptr<Stmt>> logical = logicalInit();
+        appendBlockStmts(api, SUFFIX_MARK, logical);
+        blocks.push_back(compile(move(logical), 1 + prelude.stmts.size(), prelude.temps));
+
+        // First block with a name wins, like genATC's search
+        index.emplace(api->name, i);
+    }
+
+    writes = specWriteSets(spec);
+
+    cout << "[ATCTemplates] Compiled " << blocks.size() << " block templates" << endl;
+}
+
+static mutex cacheLock;
+static unordered_map<const Spec*, unique_ptr<ATCTemplates>> cache;
+
+const ATCTemplates& ATCTemplates::forSpec(const Spec& spec) {
+    lock_guard<mutex> guard(cacheLock);
+    auto& entry = cache[&spec];
+    if (!entry) {
+        entry = make_unique<ATCTemplates>(spec);
+    }
+    return *entry;
+}
+
+void ATCTemplates::release(const Spec& spec) {
+    lock_guard<mutex> guard(cacheLock);
+    cache.erase(&spec);
+}
+
+/* ============================================================
+ * Instantiation
+ * ============================================================ */
+
+size_t ATCTemplates::blockIndex(const string& name) const {
+    auto it = index.find(name);
+    if (it == index.end()) {
+        throw runtime_error("Block not found: " + name);
+    }
+    return it->second;
+}
+
+void ATCTemplates::appendInstance(
+    const Template& t,
+    const string& idx,
+    map<string, int>& tempBase,
+    vector<Ref<Stmt>>& out
+) {
+    Renames renames;
+    for (const auto& slot : t.slots) {
+        string name;
+        if (slot.isTemp) {
+            name = "tmp_" + slot.global + "_" + to_string(tempBase[slot.global] + slot.local);
+        } else {
+            name = slot.parts[0];
+            for (size_t i = 1; i < slot.parts.size(); i++) {
+                name += idx;
+                name += slot.parts[i];
+            }
+        }
+        renames.emplace(slot.name, move(name));
+    }
+
+    for (const auto& s : t.stmts) {
+        out.push_back(renamed(s, renames));
+    }
+    for (const auto& used : t.temps) {
+        tempBase[used.first] += used.second;
+    }
+}
+
+unique_ptr<Program> ATCTemplates::instantiate(
+    const vector<string>& sequence,
+    bool checkpoints,
+    const string& restoreId,
+    const vector<Ref<Stmt>>* restorePrefix
+) const {
+    vector<size_t> ids;
+    ids.reserve(sequence.size());
+    for (const auto& name : sequence) {
+        ids.push_back(blockIndex(name));
+    }
+
+    vector<Ref<Stmt>> stmts;
+
+    // _ := reset()  /  _ := restore(id)
+    {
+        vector<Ref<Expr>> args;
+        string fname = "reset";
+        if (!restoreId.empty()) {
+            fname = "restore";
+            args.push_back(make_unique<String>(restoreId));
+        }
+        stmts.push_back(make_unique<Assign>(
+            make_unique<Var>("_"),
+            make_unique<FuncCall>(fname, move(args))));
+    }
+
+    map<string, int> tempBase;
+    appendInstance(prelude, "", tempBase, stmts);
+
+    for (size_t i = 0; i < ids.size(); i++) {
+        appendInstance(blocks[ids[i]], to_string(i), tempBase, stmts);
+
+        if (checkpoints) {
+            vector<Ref<Expr>> args;
+            args.push_back(make_unique<String>(checkpointId(sequence, i + 1)));
+            stmts.push_back(make_unique<Assign>(
+                make_unique<Var>("_"),
+                make_unique<FuncCall>("checkpoint", move(args))));
+        }
+    }
+
+    if (!restoreId.empty() && restorePrefix) {
+        RewriteGlobalsVisitor::spliceRestorePrefix(stmts, restoreId, *restorePrefix);
+    }
+
+    return make_unique<Program>(move(stmts));
+}
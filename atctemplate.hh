@@ -0,0 +1,90 @@
+#ifndef ATCTEMPLATE_HH
+#define ATCTEMPLATE_HH
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.hh"
+#include "atcsimplifier.hh"
+
+using namespace std;
+
+/**
+ * ATCTemplates - per-block test-API ATC templates
+ *
+ * Each spec block goes through appendBlockStmts + RewriteGlobalsVisitor
+ * exactly once, with symbolic slots in place of what depends on its
+ * position in a sequence:
+ *   - the block index suffix (email0, _result0)   -> email<#>, _result<#>
+ *   - the per-global temp counters (tmp_U_3)       -> tmp_U_<base+k>
+ *
+ * A sequence's test-API ATC is then `_ := reset()`, the rewritten init
+ * prelude, and the block templates in order with their slots filled in
+ * (plus checkpoints). Statements without slots are shared with the
+ * template, and filled-in ones share every subtree that holds no slot. The
+ * result is statement-for-statement identical to genATC followed by
+ * RewriteGlobalsVisitor.
+ */
+class ATCTemplates {
+public:
+    explicit ATCTemplates(const Spec& spec);
+
+    // Shared templates for a spec, compiled on first use (thread-safe).
+    // The spec must outlive the process-wide cache, as shared specs do.
+    static const ATCTemplates& forSpec(const Spec& spec);
+
+    // Drop the cached templates of a spec that is about to be destroyed
+    static void release(const Spec& spec);
+
+    // Test-API ATC for a block sequence. With a restore id the leading
+    // reset() becomes restore(id) and the statements up to its checkpoint
+    // are replaced by `restorePrefix`.
+    unique_ptr<Program> instantiate(
+        const vector<string>& sequence,
+        bool checkpoints,
+        const string& restoreId = "",
+        const vector<Ref<Stmt>>* restorePrefix = nullptr) const;
+
+    // Index of a block by name; throws "Block not found: <name>"
+    size_t blockIndex(const string& name) const;
+
+    size_t blockCount() const { return blocks.size(); }
+
+    // Globals each API function may change (see specWriteSets)
+    const WriteSets& writeSets() const { return writes; }
+
+private:
+    // A name that changes per instantiation
+    struct Slot {
+        string name;          // as written in the template
+        bool isTemp = false;
+        string global;        // temp: tmp_<global>_<base + local>
+        int local = 0;
+        vector<string> parts; // suffix: parts joined by the block index
+    };
+
+    struct Template {
+        vector<Ref<Stmt>> stmts;
+        map<string, int> temps;   // temps used per global
+        vector<Slot> slots;
+    };
+
+    Template prelude;             // non-empty init statements, rewritten
+    vector<Template> blocks;
+    unordered_map<string, size_t> index;
+    WriteSets writes;
+
+    static Template compile(vector<unique_ptr<Stmt>> logical,
+                            size_t skip,
+                            const map<string, int>& tempBase);
+
+    static void appendInstance(const Template& t,
+                               const string& idx,
+                               map<string, int>& tempBase,
+                               vector<Ref<Stmt>>& out);
+};
+
+#endif // ATCTEMPLATE_HH
@@ -0,0 +1,483 @@
+#include "batch.hh"
+#include "daemon.hh"
+#include "specbinary.hh"
+#include "specfingerprint.hh"
+#include "specs/SharedSpecs.hpp"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * Inputs
+ * ============================================================ */
+
+namespace {
+
+struct BatchOptions {
+    size_t shard = 0;       // 0-based internally
+    size_t shards = 1;
+    string outPrefix = "batch-results";
+    string historyPath;
+    string reusePath;
+    string mode = "full";
+    bool checkpoints = false;
+    DaemonOptions daemon;
+    vector<pair<string, string>> inputs;   // app -> sequence file, in order
+};
+
+void parseShard(const string &value, BatchOptions &options)
+{
+    size_t slash = value.find('/');
+    size_t i = 0, n = 0;
+    try {
+        if (slash == string::npos)
+            throw invalid_argument(value);
+        i = stoul(value.substr(0, slash));
+        n = stoul(value.substr(slash + 1));
+    } catch (const logic_error &) {
+        throw runtime_error("--shard expects i/n, got '" + value + "'");
+    }
+    if (n == 0 || i == 0 || i > n)
+        throw runtime_error("--shard " + value + ": need 1 <= i <= n");
+    options.shard = i - 1;
+    options.shards = n;
+}
+
+BatchOptions parseBatchArgs(int argc, char *argv[], int first)
+{
+    BatchOptions options;
+    auto splitPair = [](const string &flag, const string &value) {
+        size_t eq = value.find('=');
+        if (eq == string::npos || eq == 0)
+            throw runtime_error(flag + " expects app=value, got '" + value + "'");
+        return make_pair(value.substr(0, eq), value.substr(eq + 1));
+    };
+    for (int i = first; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--shard" && hasValue)
+            parseShard(argv[++i], options);
+        else if (arg == "--out" && hasValue)
+            options.outPrefix = argv[++i];
+        else if (arg == "--history" && hasValue)
+            options.historyPath = argv[++i];
+        else if (arg == "--reuse" && hasValue)
+            options.reusePath = argv[++i];
+        else if (arg == "--mode" && hasValue)
+            options.mode = argv[++i];
+        else if (arg == "--checkpoints")
+            options.checkpoints = true;
+        else if (arg == "--verbose")
+            options.daemon.verbose = true;
+        else if (arg == "--url" && hasValue)
+            options.daemon.urls.insert(splitPair(arg, argv[++i]));
+        else if (arg == "--spec" && hasValue)
+            options.daemon.specFiles.insert(splitPair(arg, argv[++i]));
+        else if (arg.compare(0, 2, "--") != 0 && arg.find('=') != string::npos)
+            options.inputs.push_back(splitPair("input", arg));
+        else
+            throw runtime_error("Unknown batch argument: " + arg);
+    }
+    if (options.inputs.empty())
+        throw runtime_error("batch needs at least one app=SEQUENCES.jsonl input");
+    return options;
+}
+
+/* ============================================================
+ * Cost model
+ * ============================================================ */
+
+// Latency per exact sequence, plus per-app ms-per-call for unseen ones
+void estimateCosts(vector<BatchItem> &items, const string &historyPath)
+{
+    map<string, double> seen;
+    map<string, pair<double, size_t>> perCall;   // app -> (ms, calls)
+    pair<double, size_t> allCalls{0, 0};
+
+    if (!historyPath.empty()) {
+        ifstream in(historyPath);
+        if (!in)
+            throw runtime_error("Cannot read history file: " + historyPath);
+        string line;
+        while (getline(in, line)) {
+            if (line.empty())
+                continue;
+            json record = json::parse(line, nullptr, false);
+            if (!record.is_object() || !record.contains("ms") || !record.contains("sequence"))
+                continue;
+            string app = record.value("app", "");
+            auto sequence = record["sequence"].get<vector<string>>();
+            double ms = record["ms"].get<double>();
+            seen[batchSequenceKey(app, sequence)] = ms;
+            perCall[app].first += ms;
+            perCall[app].second += sequence.size();
+            allCalls.first += ms;
+            allCalls.second += sequence.size();
+        }
+        cout << "[Batch] History: " << seen.size() << " timed sequences from " << historyPath << endl;
+    }
+
+    // Without any history every cost is a depth, so units stay comparable
+    double fallback = allCalls.second ? allCalls.first / allCalls.second : 1.0;
+    for (auto &item : items) {
+        auto hit = seen.find(batchSequenceKey(item.app, item.sequence));
+        if (hit != seen.end()) {
+            item.cost = hit->second;
+            continue;
+        }
+        auto app = perCall.find(item.app);
+        double msPerCall = (app != perCall.end() && app->second.second)
+                               ? app->second.first / app->second.second
+                               : fallback;
+        // reset() is paid even by an empty sequence
+        item.cost = msPerCall * (item.sequence.size() + 1);
+    }
+}
+
+/* ============================================================
+ * Reuse
+ * ============================================================ */
+
+// Dependency fingerprints per sequence, against the spec the daemon will load
+class SpecDependencies {
+public:
+    explicit SpecDependencies(const DaemonOptions &options) : options(options) {}
+
+    // Empty when the app has no spec here; such sequences are never reused
+    json of(const BatchItem &item)
+    {
+        auto it = apps.find(item.app);
+        if (it == apps.end())
+            it = apps.emplace(item.app, load(item.app)).first;
+        if (!it->second.spec)
+            return json::object();
+        return sequenceDependencies(*it->second.spec, it->second.fingerprints, item.sequence);
+    }
+
+private:
+    struct AppSpec {
+        shared_ptr<const Spec> spec;
+        map<string, string> fingerprints;
+    };
+
+    const DaemonOptions &options;
+    map<string, AppSpec> apps;
+
+    AppSpec load(const string &app) const
+    {
+        AppSpec loaded;
+        auto file = options.specFiles.find(app);
+        if (file != options.specFiles.end())
+            loaded.spec = loadSpecFile(file->second);
+        else
+            loaded.spec = builtinSpec(app);
+        if (loaded.spec)
+            loaded.fingerprints = fingerprintSpec(*loaded.spec);
+        return loaded;
+    }
+};
+
+// Records of an earlier run whose dependencies are unchanged, by item index
+map<size_t, json> findReusable(const string &path, const vector<BatchItem> &items,
+                               const vector<json> &deps, const string &mode)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot read results to reuse: " + path);
+    map<string, json> previous;
+    string line;
+    while (getline(in, line)) {
+        json record = json::parse(line, nullptr, false);
+        if (!record.is_object() || !record.contains("sequence") || !record.contains("deps"))
+            continue;
+        // Errors say nothing about the spec; run those again
+        if (record.value("mode", "") != mode || record.value("status", "error") == "error")
+            continue;
+        string key = batchSequenceKey(record.value("app", ""), record["sequence"].get<vector<string>>());
+        previous[key] = move(record);
+    }
+
+    map<size_t, json> reusable;
+    set<string> changed;
+    size_t unseen = 0;
+    for (const auto &item : items) {
+        const json &now = deps[item.index];
+        auto it = previous.find(batchSequenceKey(item.app, item.sequence));
+        if (it == previous.end() || now.empty()) {
+            unseen++;
+            continue;
+        }
+        const json &then = it->second["deps"];
+        if (then == now) {
+            reusable[item.index] = it->second;
+            continue;
+        }
+        for (const auto &kv : now.items())
+            if (!then.contains(kv.key()) || then[kv.key()] != kv.value())
+                changed.insert(kv.key());
+        for (const auto &kv : then.items())
+            if (!now.contains(kv.key()))
+                changed.insert(kv.key());
+    }
+
+    cout << "[Batch] Reuse: " << reusable.size() << " of " << items.size()
+         << " sequences unchanged since " << path << ", " << unseen << " new";
+    if (!changed.empty()) {
+        cout << "; changed:";
+        for (const auto &key : changed)
+            cout << " " << key;
+    }
+    cout << endl;
+    return reusable;
+}
+
+/* ============================================================
+ * Merge
+ * ============================================================ */
+
+int runMerge(int argc, char *argv[], int first)
+{
+    if (argc - first < 2)
+        throw runtime_error("usage: batch merge OUT.jsonl SHARD.jsonl...");
+
+    string outPath = argv[first];
+    map<size_t, json> records;
+    size_t total = 0, shards = 0;
+    vector<bool> shardSeen;
+
+    for (int i = first + 1; i < argc; i++) {
+        ifstream in(argv[i]);
+        if (!in)
+            throw runtime_error(string("Cannot read shard file: ") + argv[i]);
+        string line;
+        while (getline(in, line)) {
+            if (line.empty())
+                continue;
+            json record = json::parse(line);
+            if (record.contains("meta")) {
+                const json &meta = record["meta"];
+                size_t n = meta["shards"].get<size_t>();
+                size_t t = meta["total"].get<size_t>();
+                if (shards == 0) {
+                    shards = n;
+                    total = t;
+                    shardSeen.assign(n, false);
+                } else if (n != shards || t != total) {
+                    throw runtime_error(string("Shard file from a different split: ") + argv[i]);
+                }
+                size_t shard = meta["shard"].get<size_t>() - 1;
+                if (shard >= n || shardSeen[shard])
+                    throw runtime_error(string("Duplicate shard file: ") + argv[i]);
+                shardSeen[shard] = true;
+                continue;
+            }
+            size_t index = record["index"].get<size_t>();
+            if (!records.emplace(index, move(record)).second)
+                throw runtime_error("Sequence " + to_string(index) + " appears in more than one shard");
+        }
+    }
+
+    ofstream out(outPath);
+    if (!out)
+        throw runtime_error("Cannot write merged results: " + outPath);
+    map<string, size_t> byStatus;
+    for (const auto &kv : records) {
+        out << kv.second.dump() << "\n";
+        byStatus[kv.second.value("status", "?")]++;
+    }
+
+    size_t missingShards = count(shardSeen.begin(), shardSeen.end(), false);
+    cout << "[Batch] Merged " << records.size() << "/" << total << " sequences from "
+         << (shards - missingShards) << "/" << shards << " shards into " << outPath << endl;
+    for (const auto &kv : byStatus)
+        cout << "[Batch]   " << kv.first << ": " << kv.second << endl;
+
+    if (missingShards || records.size() != total) {
+        cerr << "[Batch] Incomplete merge: missing shards or sequences" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================
+ * Run
+ * ============================================================ */
+
+int runShard(const BatchOptions &options)
+{
+    vector<BatchItem> items = readBatchInputs(options.inputs);
+    size_t total = items.size();
+
+    SpecDependencies specs(options.daemon);
+    vector<json> deps;
+    for (const auto &item : items)
+        deps.push_back(specs.of(item));
+    map<size_t, json> reusable;
+    if (!options.reusePath.empty())
+        reusable = findReusable(options.reusePath, items, deps, options.mode);
+
+    estimateCosts(items, options.historyPath);
+    // Reused results cost nothing, so the shards balance what actually runs
+    for (auto &item : items)
+        if (reusable.count(item.index))
+            item.cost = 0;
+
+    vector<vector<BatchItem>> shards = partitionBatch(move(items), options.shards);
+    const vector<BatchItem> &mine = shards[options.shard];
+
+    double myCost = 0, maxCost = 0;
+    for (size_t s = 0; s < shards.size(); s++) {
+        double c = 0;
+        for (const auto &item : shards[s])
+            c += item.cost;
+        maxCost = max(maxCost, c);
+        if (s == options.shard)
+            myCost = c;
+    }
+
+    string outPath = options.outPrefix + ".shard-" + to_string(options.shard + 1) +
+                     "-of-" + to_string(options.shards) + ".jsonl";
+    ofstream out(outPath);
+    if (!out)
+        throw runtime_error("Cannot write shard results: " + outPath);
+
+    cout << "[Batch] Shard " << options.shard + 1 << "/" << options.shards << ": "
+         << mine.size() << " of " << total << " sequences, estimated cost "
+         << myCost << " (largest shard " << maxCost << ")" << endl;
+
+    out << json{{"meta", {{"shard", options.shard + 1}, {"shards", options.shards},
+                          {"total", total}, {"assigned", mine.size()},
+                          {"estimated_cost", myCost}}}}.dump() << "\n";
+
+    DaemonSession session(options.daemon);
+    map<string, size_t> byStatus;
+    for (const auto &item : mine) {
+        json record;
+        auto reused = reusable.find(item.index);
+        if (reused != reusable.end()) {
+            record = reused->second;
+            record["reused"] = true;
+        } else {
+            json request = {{"id", item.index}, {"app", item.app}, {"sequence", item.sequence},
+                            {"mode", options.mode}, {"checkpoints", options.checkpoints}};
+            json response = json::parse(session.handleLine(request.dump()));
+            record = {{"app", item.app}, {"sequence", item.sequence}, {"mode", options.mode},
+                      {"status", response.value("status", "error")}, {"deps", deps[item.index]}};
+            for (const char *field : {"ms", "statements", "error"})
+                if (response.contains(field))
+                    record[field] = response[field];
+        }
+        record["index"] = item.index;
+        record["shard"] = options.shard + 1;
+        out << record.dump() << "\n";
+        out.flush();
+
+        byStatus[record["status"].get<string>()]++;
+        cout << "[Batch] #" << item.index << " " << item.app << " depth "
+             << item.sequence.size() << ": " << record["status"].get<string>()
+             << (reused != reusable.end() ? " (reused)" : "") << endl;
+    }
+
+    cout << "[Batch] Wrote " << outPath;
+    for (const auto &kv : byStatus)
+        cout << " | " << kv.first << " " << kv.second;
+    cout << endl;
+    return 0;
+}
+
+} // namespace
+
+string batchSequenceKey(const string &app, const vector<string> &sequence)
+{
+    string key = app;
+    for (const auto &block : sequence) {
+        key += '|';
+        key += block;
+    }
+    return key;
+}
+
+vector<BatchItem> readBatchInputs(const vector<pair<string, string>> &inputs)
+{
+    vector<BatchItem> items;
+    for (const auto &input : inputs) {
+        ifstream in(input.second);
+        if (!in)
+            throw runtime_error("Cannot read sequence file: " + input.second);
+        string line, comment;
+        size_t lineNo = 0;
+        while (getline(in, line)) {
+            lineNo++;
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == string::npos) {
+                comment.clear();
+                continue;
+            }
+            if (line[start] == '#') {
+                size_t text = line.find_first_not_of(" \t", start + 1);
+                comment = text == string::npos ? "" : line.substr(text);
+                continue;
+            }
+            BatchItem item;
+            item.name = move(comment);
+            comment.clear();
+            try {
+                item.sequence = json::parse(line).get<vector<string>>();
+            } catch (const exception &e) {
+                throw runtime_error(input.second + ":" + to_string(lineNo) +
+                                    ": expected a JSON array of block names (" + e.what() + ")");
+            }
+            item.index = items.size();
+            item.app = input.first;
+            items.push_back(move(item));
+        }
+    }
+    return items;
+}
+
+vector<vector<BatchItem>> partitionBatch(vector<BatchItem> items, size_t shards)
+{
+    if (shards == 0)
+        throw runtime_error("partitionBatch: need at least one shard");
+
+    // Longest processing time first; ties broken by index so every shard
+    // process arrives at the same assignment
+    sort(items.begin(), items.end(), [](const BatchItem &a, const BatchItem &b) {
+        return a.cost != b.cost ? a.cost > b.cost : a.index < b.index;
+    });
+
+    vector<vector<BatchItem>> out(shards);
+    vector<double> load(shards, 0);
+    for (auto &item : items) {
+        size_t target = min_element(load.begin(), load.end()) - load.begin();
+        load[target] += item.cost;
+        out[target].push_back(move(item));
+    }
+
+    // Input order within a shard keeps shared prefixes adjacent for --checkpoints
+    for (auto &shard : out)
+        sort(shard.begin(), shard.end(), [](const BatchItem &a, const BatchItem &b) {
+            return a.index < b.index;
+        });
+    return out;
+}
+
+int runBatch(int argc, char *argv[], int first)
+{
+    try {
+        if (first < argc && string(argv[first]) == "merge")
+            return runMerge(argc, argv, first + 1);
+        return runShard(parseBatchArgs(argc, argv, first));
+    } catch (const exception &e) {
+        cerr << "[Batch] " << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_HH
+#define BATCH_HH
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Batch mode: run sequence lists from files, optionally as one shard of many.
+ *
+ *   batch [--shard i/n] [--out PREFIX] [--history FILE] [--reuse FILE]
+ *         [--mode full|rewrite|atc]
+ *         [--checkpoints] [--verbose] [--url app=URL] [--spec app=FILE]
+ *         app=SEQUENCES.jsonl...
+ *   batch merge OUT.jsonl SHARD.jsonl...
+ *
+ * A sequence file holds one JSON array of block names per line (blank lines
+ * and lines starting with '#' are skipped; a comment right above a sequence
+ * names it). Sequences are numbered in the
+ * order the inputs are given, and every shard computes the same partition:
+ * longest-estimated-first onto the least loaded shard. The estimate is the
+ * latency recorded for that exact sequence in --history (a merged result
+ * file from an earlier run), else its depth times the historical per-call
+ * average. Shard i writes PREFIX.shard-i-of-n.jsonl; merging orders records
+ * by index and checks that every sequence ran exactly once.
+ *
+ * Every record carries the spec fingerprints its sequence depends on (see
+ * specfingerprint.hh). With --reuse, a result file from an earlier run in
+ * the same mode supplies the records of sequences whose blocks, globals and
+ * functions are unchanged; only the rest are generated and executed again.
+ */
+
+struct BatchItem {
+    size_t index = 0;
+    string app;
+    vector<string> sequence;
+    string name;        // from a "# name" comment line directly above, if any
+    double cost = 0;
+};
+
+// "app|block|block..." - identifies a sequence across runs
+string batchSequenceKey(const string &app, const vector<string> &sequence);
+
+// Reads app -> sequence-file inputs; items are numbered in input order
+vector<BatchItem> readBatchInputs(const vector<pair<string, string>> &inputs);
+
+// Deterministic cost-balanced split; returns the items of each shard in index order
+vector<vector<BatchItem>> partitionBatch(vector<BatchItem> items, size_t shards);
+
+int runBatch(int argc, char *argv[], int first);
+
+#endif
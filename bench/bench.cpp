@@ -0,0 +1,484 @@
+#include "benchharness.hh"
+#include "loopbackserver.hh"
+
+#include "ast.hh"
+#include "algo.hpp"
+#include "atctemplate.hh"
+#include "atcsimplifier.hh"
+#include "clonevisitor.hh"
+#include "env.hh"
+#include "rewrite_globals_visitor.hh"
+#include "see/see.hh"
+#include "see/httpclient.hh"
+#include "see/stubfunctionfactory.hh"
+#include "see/z3solver.hh"
+#include "typemap.hh"
+#include "specs/SharedSpecs.hpp"
+#include "specs/SyntheticSpec.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+// ============================================
+// BENCHMARK DRIVER
+//
+//   testgen_bench [--filter S] [--min-time MS] [--depths 1,2,4,8,16]
+//                 [--json OUT.json] [--compare BASE.json] [--threshold PCT]
+//                 [--synthetic globals=100,blocks=500,terms=3,mapsize=0,deps=0.5,seed=1]...
+//
+// Stages over every bundled spec at increasing sequence depths:
+//   genATC, rewrite (RewriteGlobalsVisitor), clone (CloneVisitor::cloneExpr),
+//   see (SEE::execute on a StubFunctionFactory), solve (Z3Solver::solve of
+//   the resulting path constraint), solve-maps (membership and lookups on
+//   typed maps, array vs finite-domain encoding), solve-strings (equality-only
+//   strings, String sort vs uninterpreted sort), solve-enum (m models by
+//   re-solving vs one Z3Solver::enumerate session), plus HttpResponse::getJson
+//   and HttpClient against a loopback stub server. Each --synthetic adds a
+//   generated spec (see SyntheticSpec.hpp), labelled syn-g<globals>-b<blocks>...
+// A selected stage that throws on its input is listed as FAILED and the run
+// exits 1, as does a --compare regression.
+// ============================================
+
+static const vector<string> APPS = {"restaurant", "ecommerce", "library", "tripvault", "ghostsocket", "serveez"};
+
+// Pipeline chatter is part of what is measured, but not what is shown
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+// Blocks in spec order, wrapping around: deterministic and touches every block
+static vector<string> sequenceOf(const Spec &spec, size_t depth)
+{
+    vector<string> seq;
+    for (size_t i = 0; i < depth; i++)
+        seq.push_back(spec.blocks[i % spec.blocks.size()]->name);
+    return seq;
+}
+
+static vector<const Expr *> exprsOf(const Program &program)
+{
+    vector<const Expr *> exprs;
+    for (const auto &s : program.statements)
+    {
+        if (auto as = s->as<Assign>())
+        {
+            exprs.push_back(as->left.get());
+            exprs.push_back(as->right.get());
+        }
+        else if (auto am = s->as<Assume>())
+            exprs.push_back(am->expr.get());
+        else if (auto at = s->as<Assert>())
+            exprs.push_back(at->expr.get());
+    }
+    return exprs;
+}
+
+static unique_ptr<Program> cloneProgram(const Program &program)
+{
+    CloneVisitor cloner;
+    vector<unique_ptr<Stmt>> stmts;
+    for (const auto &s : program.statements)
+        stmts.push_back(cloner.cloneStmt(s.get()));
+    return make_unique<Program>(std::move(stmts));
+}
+
+// ============================================
+// PIPELINE STAGES
+// ============================================
+
+// Bundled specs wrap around their blocks; synthetic ones get dependency-respecting sequences
+struct BenchSpec
+{
+    string label;
+    shared_ptr<const Spec> spec;
+    bool synthetic = false;
+    unsigned seed = 1;
+};
+
+static void benchSpec(BenchRunner &runner, const BenchSpec &target, const vector<size_t> &depths)
+{
+    shared_ptr<const Spec> spec = target.spec;
+    const ATCTemplates &templates = ATCTemplates::forSpec(*spec);
+
+    for (size_t depth : depths)
+    {
+        string suffix = "/" + target.label + "/d" + to_string(depth);
+        vector<string> seq = target.synthetic
+                                 ? makeSyntheticSequences(*spec, 1, depth, target.seed)[0]
+                                 : sequenceOf(*spec, depth);
+
+        runner.run("genATC" + suffix, [&] {
+            Program atc = genATC(*spec, seq);
+        });
+
+        Program atc = genATC(*spec, seq);
+        runner.run("rewrite" + suffix, [&] {
+            RewriteGlobalsVisitor rewriter;
+            rewriter.visitProgram(atc);
+        });
+
+        vector<const Expr *> exprs = exprsOf(atc);
+        runner.run("clone" + suffix, [&] {
+            CloneVisitor cloner;
+            for (const Expr *e : exprs)
+                cloner.cloneExpr(e);
+        });
+
+        unique_ptr<Program> rewritten = templates.instantiate(seq, false);
+        runner.run("simplify" + suffix, [&] {
+            simplifyATC(*rewritten, &templates.writeSets());
+        });
+
+        // SEE mutates what it executes: every op gets a fresh test-API ATC
+        unique_ptr<Program> testApiATC = simplifyATC(*rewritten, &templates.writeSets());
+        StubFunctionFactory stub;
+        unique_ptr<Expr> pathConstraint;
+        try
+        {
+            SEE see(&stub);
+            SymbolTable st(nullptr);
+            unique_ptr<Program> program = cloneProgram(*testApiATC);
+            see.execute(*program, st);
+            pathConstraint = see.computePathConstraint();
+        }
+        catch (const exception &e)
+        {
+            runner.fail("see" + suffix, e.what());
+            runner.fail("solve" + suffix, e.what());
+            continue;
+        }
+
+        runner.run<unique_ptr<Program>>(
+            "see" + suffix,
+            [&] { return cloneProgram(*testApiATC); },
+            [&](unique_ptr<Program> &program) {
+                SEE see(&stub);
+                SymbolTable st(nullptr);
+                see.execute(*program, st);
+            });
+
+        if (!pathConstraint)
+            continue;
+        Z3Solver solver;
+        try
+        {
+            CloneVisitor cloner;
+            solver.solve(cloner.cloneExpr(pathConstraint.get()));
+        }
+        catch (const exception &e)
+        {
+            runner.fail("solve" + suffix, e.what());
+            continue;
+        }
+        runner.run<unique_ptr<Expr>>(
+            "solve" + suffix,
+            [&] { CloneVisitor cloner; return cloner.cloneExpr(pathConstraint.get()); },
+            [&](unique_ptr<Expr> &formula) { solver.solve(std::move(formula)); });
+    }
+}
+
+// ============================================
+// MAP ENCODINGS
+// ============================================
+
+static unique_ptr<Expr> call(const string &name, unique_ptr<Expr> a, unique_ptr<Expr> b)
+{
+    vector<unique_ptr<Expr>> args;
+    args.push_back(std::move(a));
+    args.push_back(std::move(b));
+    return make_unique<FuncCall>(name, std::move(args));
+}
+
+static unique_ptr<Expr> domOf(const string &map)
+{
+    vector<unique_ptr<Expr>> args;
+    args.push_back(make_unique<Var>(map));
+    return make_unique<FuncCall>("dom", std::move(args));
+}
+
+// n known users in U with their passwords; the last one logs in with a
+// symbolic pw and must not hold a token yet
+static unique_ptr<Expr> loginFormula(size_t n)
+{
+    string last = "u" + to_string(n - 1);
+    unique_ptr<Expr> f = call("not_in", make_unique<String>(last), domOf("T"));
+    f = call("And", std::move(f), call("in", make_unique<String>(last), domOf("U")));
+    f = call("And", std::move(f),
+             call("=", call("[]", make_unique<Var>("U"), make_unique<String>(last)), make_unique<Var>("pw")));
+    f = call("And", std::move(f), call("!=", make_unique<Var>("pw"), make_unique<String>("pw0")));
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        string user = "u" + to_string(i);
+        f = call("And", std::move(f), call("in", make_unique<String>(user), domOf("U")));
+        f = call("And", std::move(f),
+                 call("=", call("[]", make_unique<Var>("U"), make_unique<String>(user)),
+                      make_unique<String>("pw" + to_string(i))));
+        if (i % 2 == 0)
+            f = call("And", std::move(f), call("in", make_unique<String>(user), domOf("T")));
+    }
+    return f;
+}
+
+static void benchMapSolve(BenchRunner &runner)
+{
+    auto str = [] { return make_unique<TypeConst>("string"); };
+    auto mapType = make_unique<MapType>(str(), str());
+    auto strType = str();
+    TypeMap types(nullptr);
+    types.setValue("U", mapType.get());
+    types.setValue("T", mapType.get());
+    types.setValue("pw", strType.get());
+
+    for (size_t n : {2, 4, 8, 16})
+    {
+        set<string> users;
+        for (size_t i = 0; i < n; i++)
+            users.insert("u" + to_string(i));
+        unique_ptr<Expr> formula = loginFormula(n);
+
+        for (size_t limit : {size_t(0), size_t(32)})
+        {
+            Z3Solver solver(&types);
+            solver.setKeyUniverse({{"U", users}, {"T", users}});
+            solver.setFiniteMapLimit(limit);
+            runner.run<unique_ptr<Expr>>(
+                string("solve-maps/") + (limit ? "finite" : "array") + "/k" + to_string(n),
+                [&] { CloneVisitor cloner; return cloner.cloneExpr(formula.get()); },
+                [&](unique_ptr<Expr> &f) { solver.solve(std::move(f)); });
+        }
+    }
+}
+
+// n symbolic e-mails, pairwise distinct, none of them a known user, each
+// holding a token: only =, != and membership touch the strings
+static unique_ptr<Expr> distinctUsersFormula(size_t n)
+{
+    unique_ptr<Expr> f = make_unique<BoolConst>(true);
+    for (size_t i = 0; i < n; i++)
+    {
+        string email = "email" + to_string(i);
+        f = call("And", std::move(f), call("in", make_unique<Var>(email), domOf("T")));
+        for (size_t j = 0; j < i; j++)
+            f = call("And", std::move(f), call("!=", make_unique<Var>(email), make_unique<Var>("email" + to_string(j))));
+        for (size_t j = 0; j < n; j++)
+            f = call("And", std::move(f), call("!=", make_unique<Var>(email), make_unique<String>("u" + to_string(j))));
+    }
+    return f;
+}
+
+static void benchStringSolve(BenchRunner &runner)
+{
+    auto str = [] { return make_unique<TypeConst>("string"); };
+    auto mapType = make_unique<MapType>(str(), str());
+    auto strType = str();
+    TypeMap types(nullptr);
+    types.setValue("T", mapType.get());
+    for (size_t i = 0; i < 16; i++)
+        types.setValue("email" + to_string(i), strType.get());
+
+    for (size_t n : {2, 4, 8, 16})
+    {
+        unique_ptr<Expr> formula = distinctUsersFormula(n);
+        for (bool euf : {false, true})
+        {
+            Z3Solver solver(&types);
+            solver.setStringAbstraction(euf);
+            runner.run<unique_ptr<Expr>>(
+                string("solve-strings/") + (euf ? "uninterpreted" : "string") + "/v" + to_string(n),
+                [&] { CloneVisitor cloner; return cloner.cloneExpr(formula.get()); },
+                [&](unique_ptr<Expr> &f) { solver.solve(std::move(f)); });
+        }
+    }
+}
+
+// m distinct models of one formula: m fresh solves, each excluding the
+// email0 values seen so far, against one incremental enumerate session
+static void benchEnumerate(BenchRunner &runner)
+{
+    auto str = [] { return make_unique<TypeConst>("string"); };
+    auto mapType = make_unique<MapType>(str(), str());
+    auto strType = str();
+    TypeMap types(nullptr);
+    types.setValue("T", mapType.get());
+    for (size_t i = 0; i < 4; i++)
+        types.setValue("email" + to_string(i), strType.get());
+    unique_ptr<Expr> formula = distinctUsersFormula(4);
+
+    for (size_t m : {1, 8, 32})
+    {
+        Z3Solver solver(&types);
+        solver.setStringAbstraction(false);
+        runner.run("solve-enum/resolve/m" + to_string(m), [&] {
+            CloneVisitor cloner;
+            unique_ptr<Expr> blocked = cloner.cloneExpr(formula.get());
+            for (size_t i = 0; i < m; i++)
+            {
+                Result r = solver.solve(cloner.cloneExpr(blocked.get()));
+                auto it = r.model.find("email0");
+                if (!r.isSat || it == r.model.end())
+                    break;
+                const string &seen = static_cast<const StringResultValue &>(*it->second).value;
+                blocked = call("And", std::move(blocked),
+                               call("!=", make_unique<Var>("email0"), make_unique<String>(seen)));
+            }
+        });
+        runner.run<unique_ptr<Expr>>(
+            "solve-enum/session/m" + to_string(m),
+            [&] { CloneVisitor cloner; return cloner.cloneExpr(formula.get()); },
+            [&](unique_ptr<Expr> &f) { solver.enumerate(std::move(f), m, [](const Result &) { return true; }); });
+    }
+}
+
+// ============================================
+// HTTP LAYER
+// ============================================
+
+static string recordsJson(size_t n)
+{
+    ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i)
+            out << ",";
+        out << "{\"id\":" << i << ",\"code\":\"B" << i << "\",\"title\":\"Title " << i
+            << "\",\"author\":\"Author\",\"available\":true,\"copies\":" << (i % 7) << "}";
+    }
+    out << "]";
+    return out.str();
+}
+
+static void benchHttp(BenchRunner &runner)
+{
+    for (size_t n : {1, 100, 1000})
+    {
+        HttpResponse resp;
+        resp.statusCode = 200;
+        resp.body = n == 1 ? recordsJson(1).substr(1, recordsJson(1).size() - 2) : recordsJson(n);
+        runner.run("getJson/records" + to_string(n), [&] { resp.getJson(); });
+    }
+
+    if (!runner.selected("http/"))
+        return;
+    LoopbackServer server(recordsJson(10));
+    HttpClient client(server.url());
+    json body = {{"code", "B1"}, {"title", "Title"}, {"author", "Author"}, {"copies", 3}};
+    runner.run("http/get", [&] { client.get("/api/books"); });
+    runner.run("http/post", [&] { client.post("/api/books", body); });
+}
+
+// ============================================
+// MAIN
+// ============================================
+
+static vector<size_t> parseDepths(const string &list)
+{
+    vector<size_t> depths;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ','))
+        depths.push_back(stoul(item));
+    if (depths.empty())
+        throw runtime_error("--depths needs at least one depth");
+    return depths;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    vector<size_t> depths = {1, 2, 4, 8, 16};
+    string jsonPath, comparePath;
+    double threshold = 10.0;
+    vector<BenchSpec> specs;
+    for (const auto &app : APPS)
+        specs.push_back({app, builtinSpec(app)});
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--filter" && hasValue)
+                options.filter = argv[++i];
+            else if (arg == "--min-time" && hasValue)
+                options.minTimeMs = stod(argv[++i]);
+            else if (arg == "--depths" && hasValue)
+                depths = parseDepths(argv[++i]);
+            else if (arg == "--json" && hasValue)
+                jsonPath = argv[++i];
+            else if (arg == "--compare" && hasValue)
+                comparePath = argv[++i];
+            else if (arg == "--threshold" && hasValue)
+                threshold = stod(argv[++i]);
+            else if (arg == "--synthetic" && hasValue)
+            {
+                SyntheticSpecOptions so = parseSyntheticSpecOptions(argv[++i]);
+                string label = "syn-g" + to_string(so.globals) + "-b" + to_string(so.blocks) +
+                               "-t" + to_string(so.preconditionTerms) + "-m" + to_string(so.initialMapSize) +
+                               "-s" + to_string(so.seed);
+                specs.push_back({label, shared_ptr<const Spec>(makeSyntheticSpec(so)), true, so.seed});
+            }
+            else
+                throw runtime_error("Unknown argument: " + arg);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "[Bench] " << e.what() << "\n"
+             << "usage: " << argv[0] << " [--filter S] [--min-time MS] [--depths 1,2,4]"
+             << " [--json OUT] [--compare BASE.json] [--threshold PCT] [--synthetic OPTS]" << endl;
+        return 2;
+    }
+
+    ostream report(cout.rdbuf());
+    NullBuffer quiet;
+    cout.rdbuf(&quiet);
+
+    BenchRunner runner(options, report);
+    int status = 0;
+    try
+    {
+        for (const auto &target : specs)
+            benchSpec(runner, target, depths);
+        benchMapSolve(runner);
+        benchStringSolve(runner);
+        benchEnumerate(runner);
+        benchHttp(runner);
+
+        if (!jsonPath.empty())
+        {
+            ofstream out(jsonPath);
+            if (!out)
+                throw runtime_error("Cannot write " + jsonPath);
+            writeBenchJson(runner.results(), out);
+            report << "[Bench] Wrote " << runner.results().size() << " results to " << jsonPath << endl;
+        }
+        if (!comparePath.empty() &&
+            compareBench(readBenchJson(comparePath), runner.results(), threshold, report) > 0)
+            status = 1;
+        if (!runner.failures().empty())
+        {
+            report << "[Bench] " << runner.failures().size() << " benchmark(s) failed:";
+            for (const auto &name : runner.failures())
+                report << " " << name;
+            report << endl;
+            status = 1;
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "[Bench] " << e.what() << endl;
+        status = 1;
+    }
+
+    cout.rdbuf(report.rdbuf());
+    return status;
+}
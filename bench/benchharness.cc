@@ -0,0 +1,190 @@
+#include "benchharness.hh"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * Allocation counting
+ * ============================================================ */
+
+static atomic<size_t> allocCount{0};
+static atomic<size_t> allocBytes{0};
+
+size_t benchAllocCount() { return allocCount.load(memory_order_relaxed); }
+size_t benchAllocBytes() { return allocBytes.load(memory_order_relaxed); }
+
+void *operator new(size_t size)
+{
+    allocCount.fetch_add(1, memory_order_relaxed);
+    allocBytes.fetch_add(size, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// The deletes match the news above, but once GCC inlines a delete into a
+// delete-expression it only sees free() on memory from new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/* ============================================================
+ * Runner
+ * ============================================================ */
+
+bool BenchRunner::selected(const string &name) const
+{
+    return options.filter.empty() || name.find(options.filter) != string::npos;
+}
+
+void BenchRunner::fail(const string &name, const string &why)
+{
+    if (!selected(name))
+        return;
+    failed.push_back(name);
+    char line[256];
+    snprintf(line, sizeof(line), "%-44s FAILED: ", name.c_str());
+    report << line << why << endl;
+}
+
+static double percentile(const vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t at = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(at, sorted.size() - 1)];
+}
+
+void BenchRunner::record(const string &name, vector<double> &samples, size_t allocs, size_t bytes)
+{
+    sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double s : samples)
+        total += s;
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = samples.size();
+    r.nsPerOp = total / samples.size();
+    r.allocsPerOp = (double)allocs / samples.size();
+    r.bytesPerOp = (double)bytes / samples.size();
+    r.p50 = percentile(samples, 0.50);
+    r.p90 = percentile(samples, 0.90);
+    r.p99 = percentile(samples, 0.99);
+    r.min = samples.front();
+    r.max = samples.back();
+    done.push_back(r);
+
+    char line[256];
+    snprintf(line, sizeof(line), "%-44s %8zu it %14.0f ns/op %10.1f allocs/op %12.0f p50 %12.0f p99",
+             name.c_str(), r.iterations, r.nsPerOp, r.allocsPerOp, r.p50, r.p99);
+    report << line << endl;
+}
+
+/* ============================================================
+ * Result files
+ * ============================================================ */
+
+void writeBenchJson(const vector<BenchResult> &results, ostream &out)
+{
+    json list = json::array();
+    for (const auto &r : results) {
+        list.push_back({
+            {"name", r.name},
+            {"iterations", r.iterations},
+            {"ns_per_op", r.nsPerOp},
+            {"allocs_per_op", r.allocsPerOp},
+            {"bytes_per_op", r.bytesPerOp},
+            {"p50_ns", r.p50},
+            {"p90_ns", r.p90},
+            {"p99_ns", r.p99},
+            {"min_ns", r.min},
+            {"max_ns", r.max},
+        });
+    }
+    out << json{{"version", 1}, {"benchmarks", list}}.dump(2) << "\n";
+}
+
+vector<BenchResult> readBenchJson(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot read benchmark results: " + path);
+    json doc = json::parse(in);
+
+    vector<BenchResult> results;
+    for (const auto &b : doc.at("benchmarks")) {
+        BenchResult r;
+        r.name = b.at("name").get<string>();
+        r.iterations = b.value("iterations", (size_t)0);
+        r.nsPerOp = b.value("ns_per_op", 0.0);
+        r.allocsPerOp = b.value("allocs_per_op", 0.0);
+        r.bytesPerOp = b.value("bytes_per_op", 0.0);
+        r.p50 = b.value("p50_ns", 0.0);
+        r.p90 = b.value("p90_ns", 0.0);
+        r.p99 = b.value("p99_ns", 0.0);
+        r.min = b.value("min_ns", 0.0);
+        r.max = b.value("max_ns", 0.0);
+        results.push_back(r);
+    }
+    return results;
+}
+
+size_t compareBench(const vector<BenchResult> &baseline,
+                    const vector<BenchResult> &current,
+                    double thresholdPct,
+                    ostream &report)
+{
+    map<string, const BenchResult *> base;
+    for (const auto &r : baseline)
+        base[r.name] = &r;
+
+    size_t regressions = 0;
+    report << "\n" << left << setw(44) << "benchmark" << right
+           << setw(14) << "base p50" << setw(14) << "new p50" << setw(10) << "delta"
+           << setw(12) << "allocs" << endl;
+    for (const auto &r : current) {
+        auto it = base.find(r.name);
+        if (it == base.end() || it->second->p50 <= 0)
+            continue;
+        const BenchResult &b = *it->second;
+        double delta = (r.p50 - b.p50) / b.p50 * 100.0;
+        // Allocation counts are deterministic, so any growth is a regression
+        bool slower = delta > thresholdPct;
+        bool moreAllocs = r.allocsPerOp > b.allocsPerOp * 1.01 + 0.5;
+        if (slower || moreAllocs)
+            regressions++;
+
+        char line[256];
+        snprintf(line, sizeof(line), "%-44s %14.0f%14.0f %+8.1f%% %5.0f->%-5.0f%s",
+                 r.name.c_str(), b.p50, r.p50, delta, b.allocsPerOp, r.allocsPerOp,
+                 slower ? "  SLOWER" : moreAllocs ? "  ALLOCS" : "");
+        report << line << endl;
+    }
+    report << "\n" << regressions << " regression(s) beyond " << thresholdPct << "%" << endl;
+    return regressions;
+}
@@ -0,0 +1,118 @@
+#ifndef BENCHHARNESS_HH
+#define BENCHHARNESS_HH
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Minimal benchmark harness.
+ *
+ * Each benchmark is timed one operation at a time, so besides ns/op the
+ * result carries percentiles over the individual samples. Allocations are
+ * counted by the global operator new in benchharness.cc.
+ */
+
+struct BenchResult {
+    string name;
+    size_t iterations = 0;
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    double bytesPerOp = 0;
+    double p50 = 0, p90 = 0, p99 = 0, min = 0, max = 0;
+};
+
+struct BenchOptions {
+    double minTimeMs = 200;       // per benchmark, after warm-up
+    size_t maxIterations = 100000;
+    string filter;                // substring of the benchmark name
+};
+
+// Allocations made by this process so far
+size_t benchAllocCount();
+size_t benchAllocBytes();
+
+class BenchRunner {
+public:
+    BenchRunner(const BenchOptions &options, ostream &report) : options(options), report(report) {}
+
+    bool selected(const string &name) const;
+
+    // `op` is timed; `setup` runs before each op and is not
+    template <typename State>
+    void run(const string &name, function<State()> setup, function<void(State &)> op);
+
+    void run(const string &name, function<void()> op)
+    {
+        run<int>(name, [] { return 0; }, [&op](int &) { op(); });
+    }
+
+    // A selected benchmark that could not run; it fails the whole run
+    void fail(const string &name, const string &why);
+
+    const vector<BenchResult> &results() const { return done; }
+    const vector<string> &failures() const { return failed; }
+
+private:
+    BenchOptions options;
+    ostream &report;
+    vector<BenchResult> done;
+    vector<string> failed;
+
+    void record(const string &name, vector<double> &samples, size_t allocs, size_t bytes);
+};
+
+template <typename State>
+void BenchRunner::run(const string &name, function<State()> setup, function<void(State &)> op)
+{
+    if (!selected(name))
+        return;
+
+    using clock = chrono::steady_clock;
+    auto budget = chrono::duration<double, milli>(options.minTimeMs);
+
+    // Warm-up: caches, lazily compiled templates, connection setup
+    auto warmEnd = clock::now() + budget / 10;
+    for (size_t i = 0; i < 3 || clock::now() < warmEnd; i++) {
+        State state = setup();
+        op(state);
+        if (i >= options.maxIterations)
+            break;
+    }
+
+    vector<double> samples;
+    size_t allocs = 0, bytes = 0;
+    clock::duration spent{};
+    while (samples.size() < options.maxIterations && (spent < budget || samples.size() < 5)) {
+        State state = setup();
+        size_t a0 = benchAllocCount(), b0 = benchAllocBytes();
+        auto t0 = clock::now();
+        op(state);
+        auto t1 = clock::now();
+        allocs += benchAllocCount() - a0;
+        bytes += benchAllocBytes() - b0;
+        spent += t1 - t0;
+        samples.push_back(chrono::duration<double, nano>(t1 - t0).count());
+    }
+    record(name, samples, allocs, bytes);
+}
+
+/* ============================================================
+ * Result files
+ * ============================================================ */
+
+void writeBenchJson(const vector<BenchResult> &results, ostream &out);
+vector<BenchResult> readBenchJson(const string &path);
+
+// Compares p50 per benchmark; returns the number of regressions beyond
+// `thresholdPct` and prints a table of every benchmark present in both
+size_t compareBench(const vector<BenchResult> &baseline,
+                    const vector<BenchResult> &current,
+                    double thresholdPct,
+                    ostream &report);
+
+#endif // BENCHHARNESS_HH
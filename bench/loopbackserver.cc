@@ -0,0 +1,99 @@
+#include "loopbackserver.hh"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+LoopbackServer::LoopbackServer(const string &body)
+{
+    response = "HTTP/1.1 200 OK\r\n"
+               "Content-Type: application/json\r\n"
+               "Connection: keep-alive\r\n"
+               "Content-Length: " + to_string(body.size()) + "\r\n\r\n" + body;
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw runtime_error("LoopbackServer: cannot create socket");
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;   // any free port
+    socklen_t len = sizeof(addr);
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listener, 8) != 0 ||
+        getsockname(listener, (sockaddr *)&addr, &len) != 0) {
+        close(listener);
+        throw runtime_error("LoopbackServer: cannot listen on 127.0.0.1");
+    }
+    port = ntohs(addr.sin_port);
+    worker = thread(&LoopbackServer::serve, this);
+}
+
+LoopbackServer::~LoopbackServer()
+{
+    stopping = true;
+    worker.join();
+    close(listener);
+}
+
+// Polls so the destructor is never stuck behind accept()/read()
+static bool readable(int fd)
+{
+    pollfd p{fd, POLLIN, 0};
+    return poll(&p, 1, 50) > 0;
+}
+
+void LoopbackServer::serve()
+{
+    while (!stopping) {
+        if (!readable(listener))
+            continue;
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        serveConnection(fd);
+        close(fd);
+    }
+}
+
+void LoopbackServer::serveConnection(int fd)
+{
+    string pending;
+    char buf[8192];
+    while (!stopping) {
+        size_t headerEnd = pending.find("\r\n\r\n");
+        if (headerEnd != string::npos) {
+            // Skip the request body, if any
+            size_t bodyLen = 0;
+            size_t at = 0;
+            while ((at = pending.find("\r\n", at)) != string::npos && at < headerEnd) {
+                at += 2;
+                if (strncasecmp(pending.c_str() + at, "Content-Length:", 15) == 0)
+                    bodyLen = stoul(pending.substr(at + 15));
+            }
+            size_t total = headerEnd + 4 + bodyLen;
+            if (pending.size() >= total) {
+                pending.erase(0, total);
+                if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) != (ssize_t)response.size())
+                    return;
+                served++;
+                continue;
+            }
+        }
+        if (!readable(fd))
+            continue;
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0)
+            return;
+        pending.append(buf, (size_t)n);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef LOOPBACKSERVER_HH
+#define LOOPBACKSERVER_HH
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+/*
+ * LoopbackServer - HTTP/1.1 stub on 127.0.0.1 for HttpClient benchmarks
+ *
+ * Answers every request with the same JSON body and keeps connections
+ * alive, so a benchmark sees the client's own cost plus one loopback round
+ * trip. One connection is served at a time.
+ */
+class LoopbackServer {
+public:
+    explicit LoopbackServer(const string &body);
+    ~LoopbackServer();
+
+    string url() const { return "http://127.0.0.1:" + to_string(port); }
+    size_t requestsServed() const { return served.load(); }
+
+private:
+    int listener = -1;
+    int port = 0;
+    string response;
+    atomic<bool> stopping{false};
+    atomic<size_t> served{0};
+    thread worker;
+
+    void serve();
+    void serveConnection(int fd);
+};
+
+#endif // LOOPBACKSERVER_HH
@@ -10,7 +10,7 @@ vector<unique_ptr<TypeExpr>> CloneVisitor::cloneTypeExprVector(const vector<uniq
     return result;
 }
 
-vector<unique_ptr<Expr>> CloneVisitor::cloneExprVector(const vector<unique_ptr<Expr>>& vec) {
+vector<unique_ptr<Expr>> CloneVisitor::cloneExprVector(const vector<Ref<Expr>>& vec) {
     vector<unique_ptr<Expr>> result;
     for (const auto& elem : vec) {
         result.push_back(cloneExpr(elem.get()));
@@ -24,15 +24,15 @@ unique_ptr<TypeExpr> CloneVisitor::cloneTypeExpr(const TypeExpr* node) {
     
     switch (node->typeExprType) {
         case TypeExprType::TYPE_CONST:
-            return cloneTypeConst(dynamic_cast<const TypeConst&>(*node));
+            return cloneTypeConst(node->cast<TypeConst>());
         case TypeExprType::FUNC_TYPE:
-            return cloneFuncType(dynamic_cast<const FuncType&>(*node));
+            return cloneFuncType(node->cast<FuncType>());
         case TypeExprType::MAP_TYPE:
-            return cloneMapType(dynamic_cast<const MapType&>(*node));
+            return cloneMapType(node->cast<MapType>());
         case TypeExprType::TUPLE_TYPE:
-            return cloneTupleType(dynamic_cast<const TupleType&>(*node));
+            return cloneTupleType(node->cast<TupleType>());
         case TypeExprType::SET_TYPE:
-            return cloneSetType(dynamic_cast<const SetType&>(*node));
+            return cloneSetType(node->cast<SetType>());
         default:
             throw runtime_error("Unknown TypeExpr type in cloneTypeExpr");
     }
@@ -43,29 +43,29 @@ unique_ptr<Expr> CloneVisitor::cloneExpr(const Expr* node) {
     
     switch (node->exprType) {
         case ExprType::VAR:
-            return cloneVar(dynamic_cast<const Var&>(*node));
+            return cloneVar(node->cast<Var>());
         case ExprType::FUNCCALL:
-            return cloneFuncCall(dynamic_cast<const FuncCall&>(*node));
+            return cloneFuncCall(node->cast<FuncCall>());
         case ExprType::NUM:
-            return cloneNum(dynamic_cast<const Num&>(*node));
+            return cloneNum(node->cast<Num>());
         case ExprType::STRING:
-            return cloneString(dynamic_cast<const String&>(*node));
+            return cloneString(node->cast<String>());
         case ExprType::SET:
-            return cloneSet(dynamic_cast<const Set&>(*node));
+            return cloneSet(node->cast<Set>());
         case ExprType::MAP:
-            return cloneMap(dynamic_cast<const Map&>(*node));
+            return cloneMap(node->cast<Map>());
         case ExprType::TUPLE:
-            return cloneTuple(dynamic_cast<const Tuple&>(*node));
+            return cloneTuple(node->cast<Tuple>());
         case ExprType::SYMVAR:
-            return cloneSymVar(dynamic_cast<const SymVar&>(*node));
+            return cloneSymVar(node->cast<SymVar>());
         case ExprType::INPUT:
-            return cloneInput(dynamic_cast<const Input&>(*node));
+            return cloneInput(node->cast<Input>());
             case ExprType::BOOL_CONST:
-            return cloneBoolConst(dynamic_cast<const BoolConst&>(*node));
+            return cloneBoolConst(node->cast<BoolConst>());
         case ExprType::BINARY_OP:
-            return cloneBinaryOpExpr(dynamic_cast<const BinaryOpExpr&>(*node));
+            return cloneBinaryOpExpr(node->cast<BinaryOpExpr>());
         case ExprType::UNARY_OP:
-            return cloneUnaryOpExpr(dynamic_cast<const UnaryOpExpr&>(*node));
+            return cloneUnaryOpExpr(node->cast<UnaryOpExpr>());
         default:
             throw runtime_error("Unknown Expr type in cloneExpr");
     }
@@ -76,11 +76,11 @@ unique_ptr<Stmt> CloneVisitor::cloneStmt(const Stmt* node) {
     
     switch (node->statementType) {
         case StmtType::ASSIGN:
-            return cloneAssign(dynamic_cast<const Assign&>(*node));
+            return cloneAssign(node->cast<Assign>());
         case StmtType::ASSUME:
-            return cloneAssume(dynamic_cast<const Assume&>(*node));
+            return cloneAssume(node->cast<Assume>());
         case StmtType::ASSERT:
-            return cloneAssert(dynamic_cast<const Assert&>(*node));
+            return cloneAssert(node->cast<Assert>());
         default:
             throw runtime_error("Unknown Stmt type in cloneStmt");
     }
@@ -128,6 +128,9 @@ unique_ptr<Expr> CloneVisitor::cloneNum(const Num &node) {
 }
 
 unique_ptr<Expr> CloneVisitor::cloneString(const String &node) {
+    if (auto ph = node.as<Placeholder>()) {
+        return make_unique<Placeholder>(ph->global, ph->value);
+    }
     return make_unique<String>(node.value);
 }
 
@@ -141,7 +144,7 @@ unique_ptr<Expr> CloneVisitor::cloneMap(const Map &node) {
     
     for (const auto& element : node.value) {
         unique_ptr<Expr> clonedKeyExpr = cloneExpr(element.first.get());
-        Var* keyPtr = dynamic_cast<Var*>(clonedKeyExpr.get());
+        Var* keyPtr = clonedKeyExpr->as<Var>();
         
         if (!keyPtr) {
             throw runtime_error("Map key is not of type Var");
@@ -48,7 +48,7 @@ private:
 
     // Helper to clone vectors
     vector<unique_ptr<TypeExpr>> cloneTypeExprVector(const vector<unique_ptr<TypeExpr>>& vec);
-    vector<unique_ptr<Expr>> cloneExprVector(const vector<unique_ptr<Expr>>& vec);
+    vector<unique_ptr<Expr>> cloneExprVector(const vector<Ref<Expr>>& vec);
 };
 
 #endif // CLONEVISITOR_HH
@@ -0,0 +1,506 @@
+#include "daemon.hh"
+#include "algo.hpp"
+#include "atctemplate.hh"
+#include "env.hh"
+#include "printvisitor.hh"
+#include "specbinary.hh"
+#include "tester/tester.hh"
+#include "see/see.hh"
+#include "see/restaurantfunctionfactory.hh"
+#include "see/ecommercefunctionfactory.hh"
+#include "see/libraryfunctionfactory.hh"
+#include "see/tripvaultfunctionfactory.hh"
+#include "see/ghostsocketfunctionfactory.hh"
+#include "see/serveezfunctionfactory.hh"
+#include "specs/SharedSpecs.hpp"
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * App table
+ * ============================================================ */
+
+namespace {
+
+typedef shared_ptr<FunctionFactory> (*FactoryMaker)(const string &url);
+
+struct AppInfo {
+    const char *name;
+    const char *url;
+    FactoryMaker makeFactory;
+};
+
+// Same backends and default URLs as the suites in main()
+const vector<AppInfo> &appTable()
+{
+    // shared_ptr keeps the concrete deleter; FunctionFactory has no virtual dtor
+    static const vector<AppInfo> apps = {
+        {"restaurant", "http://localhost:5002",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<RestaurantFunctionFactory>(u); }},
+        {"ecommerce", "http://localhost:3000",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<Ecommerce::EcommerceFunctionFactory>(u); }},
+        {"library", "http://localhost:8080",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<Library::LibraryFunctionFactory>(u); }},
+        {"tripvault", "http://localhost:4001",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<TripVault::TripVaultFunctionFactory>(u); }},
+        {"ghostsocket", "http://localhost:4002",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<GhostSocket::GhostSocketFunctionFactory>(u); }},
+        {"serveez", "http://localhost:8083",
+         [](const string &u) -> shared_ptr<FunctionFactory> { return make_shared<Serveez::ServeezFunctionFactory>(u); }},
+    };
+    return apps;
+}
+
+// Swallows pipeline output nobody asked for
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+// Redirects cout for the lifetime of the object
+class CoutRedirect {
+    streambuf *saved;
+public:
+    explicit CoutRedirect(streambuf *target) : saved(cout.rdbuf(target)) {}
+    ~CoutRedirect() { cout.rdbuf(saved); }
+};
+
+/* ============================================================
+ * Daemon
+ * ============================================================ */
+
+class Daemon {
+    struct App {
+        const AppInfo *info = nullptr;
+        string url;
+        shared_ptr<FunctionFactory> factory;   // warm HTTP connection, created on first use
+        shared_ptr<z3::context> solverContext; // every request's solves, created on first use
+        shared_ptr<const Spec> spec;
+        string specPath;                       // "" = built-in spec
+        time_t specMtime = 0;
+        size_t requests = 0;
+    };
+
+    DaemonOptions options;
+    map<string, App> apps;
+    string checkpointOwner;                    // app whose checkpoints SEE holds
+    NullBuffer nullBuffer;
+    size_t served = 0;
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+public:
+    bool stopping = false;
+
+    explicit Daemon(const DaemonOptions &opts) : options(opts)
+    {
+        for (const auto &info : appTable()) {
+            App &app = apps[info.name];
+            app.info = &info;
+            auto url = options.urls.find(info.name);
+            app.url = url != options.urls.end() ? url->second : info.url;
+            auto spec = options.specFiles.find(info.name);
+            if (spec != options.specFiles.end())
+                app.specPath = spec->second;
+        }
+        for (const auto &kv : options.urls)
+            if (!apps.count(kv.first))
+                throw runtime_error("Unknown app in --url: " + kv.first);
+        for (const auto &kv : options.specFiles)
+            if (!apps.count(kv.first))
+                throw runtime_error("Unknown app in --spec: " + kv.first);
+    }
+
+    // One request line -> one response line
+    string handleLine(const string &line)
+    {
+        json request;
+        try {
+            request = json::parse(line);
+        } catch (const exception &e) {
+            return json{{"status", "error"}, {"error", string("bad request: ") + e.what()}}.dump();
+        }
+        json response;
+        try {
+            response = handle(request);
+        } catch (const exception &e) {
+            response = {{"status", "error"}, {"error", e.what()}};
+        }
+        if (request.is_object() && request.contains("id"))
+            response["id"] = request["id"];
+        return response.dump();
+    }
+
+private:
+    App &appFor(const json &request)
+    {
+        string name = request.value("app", "");
+        auto it = apps.find(name);
+        if (it == apps.end())
+            throw runtime_error("Unknown app: '" + name + "'");
+        return it->second;
+    }
+
+    static time_t mtimeOf(const string &path)
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            throw runtime_error("Cannot stat spec file: " + path);
+        return st.st_mtime;
+    }
+
+    void dropSpec(App &app)
+    {
+        if (app.spec)
+            ATCTemplates::release(*app.spec);
+        app.spec.reset();
+        // Checkpoint ids are block names; they mean nothing under a new spec
+        if (checkpointOwner == app.info->name) {
+            SEE::clearCheckpoints();
+            checkpointOwner.clear();
+        }
+    }
+
+    void loadSpec(App &app)
+    {
+        if (app.specPath.empty()) {
+            app.spec = builtinSpec(app.info->name);
+            app.specMtime = 0;
+            return;
+        }
+        time_t mtime = mtimeOf(app.specPath);
+        auto spec = loadSpecFile(app.specPath);
+        dropSpec(app);
+        app.spec = std::move(spec);
+        app.specMtime = mtime;
+        cerr << "[Daemon] Loaded " << app.info->name << " spec from " << app.specPath << endl;
+    }
+
+    // Hot reload: pick up spec files edited since they were loaded
+    const Spec &currentSpec(App &app)
+    {
+        if (!app.spec || (!app.specPath.empty() && mtimeOf(app.specPath) != app.specMtime))
+            loadSpec(app);
+        return *app.spec;
+    }
+
+    json handle(const json &request)
+    {
+        if (!request.is_object())
+            throw runtime_error("request must be a JSON object");
+
+        string op = request.value("op", "run");
+        if (op == "run")
+            return run(request);
+        if (op == "ping")
+            return {{"status", "ok"}};
+        if (op == "shutdown") {
+            stopping = true;
+            return {{"status", "ok"}};
+        }
+        if (op == "reload")
+            return reload(request);
+        if (op == "stats")
+            return stats();
+        throw runtime_error("Unknown op: " + op);
+    }
+
+    json reload(const json &request)
+    {
+        vector<App *> targets;
+        if (request.contains("app"))
+            targets.push_back(&appFor(request));
+        else
+            for (auto &kv : apps)
+                targets.push_back(&kv.second);
+
+        if (request.contains("spec")) {
+            if (targets.size() != 1)
+                throw runtime_error("reload with \"spec\" needs an \"app\"");
+            targets[0]->specPath = request["spec"].get<string>();
+        }
+
+        json reloaded = json::array();
+        for (App *app : targets) {
+            dropSpec(*app);
+            if (request.contains("app"))
+                loadSpec(*app);   // load eagerly so a broken file fails here
+            reloaded.push_back(app->info->name);
+        }
+        return {{"status", "ok"}, {"reloaded", reloaded}};
+    }
+
+    json stats()
+    {
+        json perApp = json::object();
+        for (auto &kv : apps) {
+            const App &app = kv.second;
+            perApp[kv.first] = {
+                {"url", app.url},
+                {"requests", app.requests},
+                {"spec", app.specPath.empty() ? "builtin" : app.specPath},
+                {"loaded", (bool)app.spec},
+                {"connected", (bool)app.factory},
+            };
+        }
+        double uptime = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return {{"status", "ok"}, {"served", served}, {"uptime_s", uptime}, {"apps", perApp}};
+    }
+
+    json run(const json &request)
+    {
+        App &app = appFor(request);
+        if (!request.contains("sequence") || !request["sequence"].is_array())
+            throw runtime_error("\"sequence\" must be an array of block names");
+        vector<string> sequence = request["sequence"].get<vector<string>>();
+        string mode = request.value("mode", "full");
+        if (mode != "full" && mode != "rewrite" && mode != "atc")
+            throw runtime_error("Unknown mode: " + mode);
+        bool checkpoints = request.value("checkpoints", false);
+        bool wantLog = request.value("log", false);
+
+        const Spec &spec = currentSpec(app);
+        if (checkpoints && checkpointOwner != app.info->name) {
+            SEE::clearCheckpoints();
+            checkpointOwner = app.info->name;
+        }
+        Tester::setCheckpointsEnabled(checkpoints);
+
+        ostringstream log;
+        streambuf *sink = wantLog ? log.rdbuf() : options.verbose ? cerr.rdbuf() : &nullBuffer;
+
+        json response = {{"app", app.info->name}};
+        auto t0 = chrono::steady_clock::now();
+        {
+            CoutRedirect redirect(sink);
+            try {
+                if (!app.factory)
+                    app.factory = app.info->makeFactory(app.url);
+                execute(app, spec, sequence, mode, response);
+            } catch (const exception &e) {
+                string msg = e.what();
+                response["status"] = msg.find("UNSAT") != string::npos ? "unsat" : "fail";
+                response["error"] = msg;
+            }
+        }
+        response["ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (wantLog)
+            response["log"] = log.str();
+
+        app.requests++;
+        served++;
+        return response;
+    }
+
+    static string printed(const Program &program)
+    {
+        ostringstream text;
+        CoutRedirect redirect(text.rdbuf());
+        PrintVisitor printer;
+        printer.visitProgram(program);
+        return text.str();
+    }
+
+    // Mirrors the executors' ORIGINAL / REWRITE_ONLY / FULL_PIPELINE modes
+    static void execute(App &app, const Spec &spec, const vector<string> &sequence,
+                        const string &mode, json &response)
+    {
+        if (mode == "atc") {
+            Program atc = genATC(spec, sequence);
+            response["status"] = "pass";
+            response["statements"] = atc.statements.size();
+            response["ctc"] = printed(atc);
+            return;
+        }
+
+        Tester tester(app.factory.get());
+        if (!app.solverContext)
+            app.solverContext = make_shared<z3::context>();
+        tester.getSolver().shareContext(app.solverContext);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, sequence);
+        if (mode == "rewrite") {
+            response["status"] = "pass";
+            response["statements"] = testApiATC->statements.size();
+            response["ctc"] = printed(*testApiATC);
+            return;
+        }
+
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp(app.info->name));
+        ValueEnvironment valueEnv(nullptr);
+        unique_ptr<Program> ctc = tester.generateCTC(std::move(testApiATC), {}, &valueEnv);
+        if (!ctc) {
+            response["status"] = "unsat";
+            response["error"] = "UNSAT: Preconditions not satisfiable";
+            return;
+        }
+        // A false concrete assertion is how a faulty backend shows up
+        size_t failed = tester.getSEE().getFailedAssertions();
+        response["status"] = failed ? "fail" : "pass";
+        if (failed)
+            response["error"] = to_string(failed) + " assertion(s) failed";
+        response["assertions_failed"] = failed;
+        response["statements"] = ctc->statements.size();
+        response["ctc"] = printed(*ctc);
+    }
+};
+
+/* ============================================================
+ * Transports
+ * ============================================================ */
+
+int serveStdin(Daemon &daemon, ostream &out)
+{
+    string line;
+    while (!daemon.stopping && getline(cin, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            continue;
+        out << daemon.handleLine(line) << "\n";
+        out.flush();
+    }
+    return 0;
+}
+
+bool sendAll(int fd, const string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Serves one client until it disconnects; requests are answered in order
+void serveClient(Daemon &daemon, int fd)
+{
+    string pending;
+    char buf[4096];
+    while (!daemon.stopping) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0)
+            return;
+        pending.append(buf, (size_t)n);
+        size_t nl;
+        while (!daemon.stopping && (nl = pending.find('\n')) != string::npos) {
+            string line = pending.substr(0, nl);
+            pending.erase(0, nl + 1);
+            if (line.find_first_not_of(" \t\r") == string::npos)
+                continue;
+            if (!sendAll(fd, daemon.handleLine(line) + "\n"))
+                return;
+        }
+    }
+}
+
+int serveSocket(Daemon &daemon, const string &path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw runtime_error("Socket path too long: " + path);
+    path.copy(addr.sun_path, path.size());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0)
+        throw runtime_error("Cannot create socket");
+    unlink(path.c_str());
+    if (bind(server, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(server, 16) != 0) {
+        close(server);
+        throw runtime_error("Cannot listen on " + path);
+    }
+    cerr << "[Daemon] Listening on " << path << endl;
+
+    while (!daemon.stopping) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+            continue;
+        serveClient(daemon, client);
+        close(client);
+    }
+    close(server);
+    unlink(path.c_str());
+    return 0;
+}
+
+} // namespace
+
+/* ============================================================
+ * Session
+ * ============================================================ */
+
+struct DaemonSession::Impl {
+    Daemon daemon;
+    explicit Impl(const DaemonOptions &options) : daemon(options) {}
+};
+
+DaemonSession::DaemonSession(const DaemonOptions &options) : impl(new Impl(options)) {}
+
+DaemonSession::~DaemonSession() = default;
+
+string DaemonSession::handleLine(const string &line)
+{
+    return impl->daemon.handleLine(line);
+}
+
+bool DaemonSession::stopping() const
+{
+    return impl->daemon.stopping;
+}
+
+/* ============================================================
+ * Entry points
+ * ============================================================ */
+
+DaemonOptions parseDaemonArgs(int argc, char *argv[], int first)
+{
+    DaemonOptions options;
+    auto splitPair = [](const string &flag, const string &value, map<string, string> &into) {
+        size_t eq = value.find('=');
+        if (eq == string::npos || eq == 0)
+            throw runtime_error(flag + " expects app=value, got '" + value + "'");
+        into[value.substr(0, eq)] = value.substr(eq + 1);
+    };
+    for (int i = first; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (arg == "--verbose")
+            options.verbose = true;
+        else if (arg == "--url" && hasValue)
+            splitPair(arg, argv[++i], options.urls);
+        else if (arg == "--spec" && hasValue)
+            splitPair(arg, argv[++i], options.specFiles);
+        else
+            throw runtime_error("Unknown daemon argument: " + arg);
+    }
+    return options;
+}
+
+int runDaemon(const DaemonOptions &options)
+{
+    Daemon daemon(options);
+
+    // Responses own stdout; stray pipeline output must never reach it
+    ostream out(cout.rdbuf());
+    NullBuffer quiet;
+    CoutRedirect redirect(options.verbose ? cerr.rdbuf() : &quiet);
+    if (options.socketPath.empty()) {
+        cerr << "[Daemon] Reading JSONL requests from stdin" << endl;
+        return serveStdin(daemon, out);
+    }
+    return serveSocket(daemon, options.socketPath);
+}
@@ -0,0 +1,60 @@
+#ifndef DAEMON_HH
+#define DAEMON_HH
+
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+/*
+ * Daemon mode: one long-lived process answers JSONL test requests, so specs,
+ * ATC templates, checkpoints, Z3 contexts and HTTP connections stay warm
+ * between them.
+ *
+ * Requests (one JSON object per line):
+ *   {"id": 7, "app": "library", "sequence": ["saveBookOk", "getBookByCodeOk"],
+ *    "mode": "full" | "rewrite" | "atc", "checkpoints": false, "log": false}
+ *   {"op": "reload", "app": "library", "spec": "lib.specb"}   spec optional
+ *   {"op": "ping"} | {"op": "stats"} | {"op": "shutdown"}
+ *
+ * Responses (one line each, in request order):
+ *   {"id": 7, "app": "library", "status": "pass" | "unsat" | "fail" | "error",
+ *    "error": "...", "ms": 12.5, "statements": 9, "assertions_failed": 0,
+ *    "ctc": "...", "log": "..."}
+ *
+ * In full mode a run whose concrete assertions do not all hold is "fail".
+ *
+ * Pipeline chatter goes to stderr with --verbose, into "log" when the
+ * request asks for it, and nowhere otherwise. Requests are served one at a
+ * time: Tester/SEE state such as checkpoints is process-wide.
+ */
+
+struct DaemonOptions {
+    string socketPath;              // "" = stdin/stdout
+    bool verbose = false;
+    map<string, string> urls;       // app -> backend URL override
+    map<string, string> specFiles;  // app -> .spec/.specb, hot-reloaded on change
+};
+
+// The daemon's resident state without a transport: one request line in,
+// one response line out. Batch mode drives this directly.
+class DaemonSession {
+public:
+    explicit DaemonSession(const DaemonOptions &options);
+    ~DaemonSession();
+
+    string handleLine(const string &line);
+    bool stopping() const;
+
+private:
+    struct Impl;
+    unique_ptr<Impl> impl;
+};
+
+// Parses `daemon [--socket PATH] [--verbose] [--url app=URL] [--spec app=FILE]`
+DaemonOptions parseDaemonArgs(int argc, char *argv[], int first);
+
+int runDaemon(const DaemonOptions &options);
+
+#endif
@@ -87,12 +87,12 @@ void ValueEnvironment::print() {
         if (d.second) {
             // Print expression type or value
             if (d.second->exprType == ExprType::NUM) {
-                Num* num = dynamic_cast<Num*>(d.second);
+                Num* num = d.second->as<Num>();
                 cout << num->value;
             } else if (d.second->exprType == ExprType::SYMVAR) {
                 cout << "SymVar";
             } else if (d.second->exprType == ExprType::FUNCCALL) {
-                FuncCall* fc = dynamic_cast<FuncCall*>(d.second);
+                FuncCall* fc = d.second->as<FuncCall>();
                 cout << fc->name << "(...)";
             } else {
                 cout << "Expr";
@@ -149,12 +149,12 @@ void ConcValEnv::print() {
         if (d.second) {
             // Print expression type or value
             if (d.second->exprType == ExprType::NUM) {
-                Num* num = dynamic_cast<Num*>(d.second);
+                Num* num = d.second->as<Num>();
                 cout << num->value;
             } else if (d.second->exprType == ExprType::SYMVAR) {
                 cout << "SymVar";
             } else if (d.second->exprType == ExprType::FUNCCALL) {
-                FuncCall* fc = dynamic_cast<FuncCall*>(d.second);
+                FuncCall* fc = d.second->as<FuncCall>();
                 cout << fc->name << "(...)";
             } else {
                 cout << "Expr";
@@ -197,5 +197,6 @@ bool ConcValEnv::hasValue(const string& varName) {
     return false;
 }
 
-// Explicit template instantiation for TypeMap
+// Explicit template instantiations for TypeMap and ValueEnvironment
 template class Env<string, TypeExpr>;
+template class Env<string, Expr>;
@@ -0,0 +1,316 @@
+#include "metrics.hh"
+
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sys/resource.h>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * LatencyHistogram
+ * ============================================================ */
+
+int LatencyHistogram::bucketOf(uint64_t micros) {
+    if (micros < SUB_BUCKETS) return (int)micros;
+    int e = 63 - __builtin_clzll(micros);           // >= 4
+    int magnitude = e - 3;
+    int sub = (int)(micros >> (e - 4)) - SUB_BUCKETS;
+    if (magnitude >= MAGNITUDES) return MAGNITUDES * SUB_BUCKETS - 1;
+    return magnitude * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::upperBound(int bucket) {
+    int magnitude = bucket / SUB_BUCKETS;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    if (magnitude == 0) return sub;
+    int shift = magnitude - 1;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketOf(micros)]++;
+    total++;
+    sumMicros += micros;
+    if (micros > maxMicros) maxMicros = micros;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < MAGNITUDES * SUB_BUCKETS; i++) buckets[i] += other.buckets[i];
+    total += other.total;
+    sumMicros += other.sumMicros;
+    if (other.maxMicros > maxMicros) maxMicros = other.maxMicros;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(p * total + 0.999999);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < MAGNITUDES * SUB_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) return min(upperBound(i), maxMicros);
+    }
+    return maxMicros;
+}
+
+/* ============================================================
+ * Per-thread shards
+ * ============================================================ */
+
+namespace {
+
+struct EndpointStats {
+    LatencyHistogram latency;
+    map<int, uint64_t> statuses;
+};
+
+struct Shard {
+    // Scalars: written by the owner, read by the reporter
+    atomic<uint64_t> statements{0};
+    atomic<uint64_t> ctcIterations{0};
+
+    // Keyed stats: only the owner and a report ever take this lock. The
+    // report runs once, at the end, so the owner's lock is uncontended: an
+    // atomic exchange each way, nothing next to the HTTP call or solve it
+    // records. Going lock-free here would mean atomic histogram buckets
+    // (hundreds per endpoint) and a concurrent map for the keys.
+    mutex lock;
+    map<string, uint64_t> functionCalls;
+    map<string, EndpointStats> endpoints;   // "GET /api/books/:id"
+    LatencyHistogram solve;
+
+    Shard* next = nullptr;
+};
+
+atomic<Shard*> shards{nullptr};
+string outputPath;
+
+// Shards are pushed once per thread and never freed, so a report can walk
+// the list without coordinating with threads that come and go
+Shard& localShard() {
+    thread_local Shard* shard = nullptr;
+    if (!shard) {
+        shard = new Shard();
+        Shard* head = shards.load(memory_order_relaxed);
+        do {
+            shard->next = head;
+        } while (!shards.compare_exchange_weak(head, shard, memory_order_release, memory_order_relaxed));
+    }
+    return *shard;
+}
+
+struct Totals {
+    uint64_t statements = 0;
+    uint64_t ctcIterations = 0;
+    map<string, uint64_t> functionCalls;
+    map<string, EndpointStats> endpoints;
+    LatencyHistogram solve;
+};
+
+Totals aggregate() {
+    Totals t;
+    for (Shard* s = shards.load(memory_order_acquire); s; s = s->next) {
+        t.statements += s->statements.load(memory_order_relaxed);
+        t.ctcIterations += s->ctcIterations.load(memory_order_relaxed);
+        lock_guard<mutex> guard(s->lock);
+        for (const auto& kv : s->functionCalls) t.functionCalls[kv.first] += kv.second;
+        for (const auto& kv : s->endpoints) {
+            EndpointStats& e = t.endpoints[kv.first];
+            e.latency.merge(kv.second.latency);
+            for (const auto& st : kv.second.statuses) e.statuses[st.first] += st.second;
+        }
+        t.solve.merge(s->solve);
+    }
+    return t;
+}
+
+uint64_t peakRssBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (uint64_t)usage.ru_maxrss * 1024;   // kilobytes on Linux
+}
+
+} // namespace
+
+/* ============================================================
+ * Recording
+ * ============================================================ */
+
+void Metrics::start(const string& path) {
+    static bool hooked = false;
+    outputPath = path;
+    enabled = true;
+    if (!hooked) {
+        hooked = true;
+        atexit([] { Metrics::finish(); });
+    }
+}
+
+void Metrics::finish() {
+    if (!enabled) return;
+    enabled = false;
+
+    ofstream out(outputPath);
+    if (!out) {
+        cerr << "[Metrics] Cannot write " << outputPath << endl;
+        return;
+    }
+    bool prometheus = outputPath.size() >= 5 &&
+                      outputPath.compare(outputPath.size() - 5, 5, ".prom") == 0;
+    if (prometheus)
+        writePrometheus(out);
+    else
+        writeJson(out);
+    cerr << "[Metrics] Wrote " << outputPath << endl;
+}
+
+void Metrics::countFunctionCall(const string& function) {
+    Shard& s = localShard();
+    lock_guard<mutex> guard(s.lock);
+    s.functionCalls[function]++;
+}
+
+void Metrics::countStatement() {
+    localShard().statements.fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::countCTCIteration() {
+    localShard().ctcIterations.fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::recordHttp(const char* method, const string& endpoint, uint64_t micros, int status) {
+    string key = string(method) + " " + endpointTemplate(endpoint);
+    Shard& s = localShard();
+    lock_guard<mutex> guard(s.lock);
+    EndpointStats& e = s.endpoints[key];
+    e.latency.record(micros);
+    e.statuses[status]++;
+}
+
+void Metrics::recordSolve(uint64_t micros) {
+    Shard& s = localShard();
+    lock_guard<mutex> guard(s.lock);
+    s.solve.record(micros);
+}
+
+string Metrics::endpointTemplate(const string& endpoint) {
+    string path = endpoint.substr(0, endpoint.find('?'));
+    string out;
+    size_t at = 0;
+    while (at < path.size()) {
+        size_t slash = path.find('/', at);
+        if (slash == string::npos) slash = path.size();
+        string segment = path.substr(at, slash - at);
+        bool hasDigit = false;
+        for (char c : segment) hasDigit = hasDigit || isdigit((unsigned char)c);
+        // Resource ids carry digits; route names do not
+        out += hasDigit ? ":id" : segment;
+        if (slash < path.size()) out += '/';
+        at = slash + 1;
+    }
+    return out;
+}
+
+/* ============================================================
+ * Reports
+ * ============================================================ */
+
+static json latencyJson(const LatencyHistogram& h) {
+    return {
+        {"count", h.count()},
+        {"p50_us", h.percentile(0.50)},
+        {"p90_us", h.percentile(0.90)},
+        {"p99_us", h.percentile(0.99)},
+        {"max_us", h.max()},
+        {"total_us", h.sum()},
+    };
+}
+
+void Metrics::writeJson(ostream& out) {
+    Totals t = aggregate();
+
+    json endpoints = json::object();
+    for (const auto& kv : t.endpoints) {
+        json entry = latencyJson(kv.second.latency);
+        json statuses = json::object();
+        for (const auto& st : kv.second.statuses) statuses[to_string(st.first)] = st.second;
+        entry["statuses"] = statuses;
+        endpoints[kv.first] = entry;
+    }
+
+    out << json{
+        {"http", endpoints},
+        {"function_calls", t.functionCalls},
+        {"see_statements", t.statements},
+        {"ctc_iterations", t.ctcIterations},
+        {"solver", latencyJson(t.solve)},
+        {"peak_rss_bytes", peakRssBytes()},
+    }.dump(2) << "\n";
+}
+
+static string label(const string& value) {
+    string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') { out += "\\n"; continue; }
+        out += c;
+    }
+    return out;
+}
+
+static void summary(ostream& out, const string& name, const string& labels, const LatencyHistogram& h) {
+    string sep = labels.empty() ? "" : ",";
+    for (double q : {0.5, 0.9, 0.99})
+        out << name << "{" << labels << sep << "quantile=\"" << q << "\"} " << h.percentile(q) / 1e6 << "\n";
+    string braces = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << braces << " " << h.sum() / 1e6 << "\n";
+    out << name << "_count" << braces << " " << h.count() << "\n";
+}
+
+void Metrics::writePrometheus(ostream& out) {
+    Totals t = aggregate();
+
+    out << "# HELP testgen_http_requests_total HTTP requests by endpoint and status.\n"
+        << "# TYPE testgen_http_requests_total counter\n";
+    for (const auto& kv : t.endpoints)
+        for (const auto& st : kv.second.statuses)
+            out << "testgen_http_requests_total{endpoint=\"" << label(kv.first) << "\",status=\""
+                << st.first << "\"} " << st.second << "\n";
+
+    out << "# HELP testgen_http_latency_seconds HTTP request latency by endpoint.\n"
+        << "# TYPE testgen_http_latency_seconds summary\n";
+    for (const auto& kv : t.endpoints)
+        summary(out, "testgen_http_latency_seconds", "endpoint=\"" + label(kv.first) + "\"", kv.second.latency);
+
+    out << "# HELP testgen_http_latency_max_seconds Slowest HTTP request by endpoint.\n"
+        << "# TYPE testgen_http_latency_max_seconds gauge\n";
+    for (const auto& kv : t.endpoints)
+        out << "testgen_http_latency_max_seconds{endpoint=\"" << label(kv.first) << "\"} "
+            << kv.second.latency.max() / 1e6 << "\n";
+
+    out << "# HELP testgen_function_calls_total API function calls made through a FunctionFactory.\n"
+        << "# TYPE testgen_function_calls_total counter\n";
+    for (const auto& kv : t.functionCalls)
+        out << "testgen_function_calls_total{function=\"" << label(kv.first) << "\"} " << kv.second << "\n";
+
+    out << "# HELP testgen_see_statements_total Statements executed by SEE.\n"
+        << "# TYPE testgen_see_statements_total counter\n"
+        << "testgen_see_statements_total " << t.statements << "\n"
+        << "# HELP testgen_ctc_iterations_total generateCTC iterations.\n"
+        << "# TYPE testgen_ctc_iterations_total counter\n"
+        << "testgen_ctc_iterations_total " << t.ctcIterations << "\n";
+
+    out << "# HELP testgen_solve_seconds Z3Solver::solve time.\n"
+        << "# TYPE testgen_solve_seconds summary\n";
+    summary(out, "testgen_solve_seconds", "", t.solve);
+
+    out << "# HELP testgen_peak_rss_bytes Peak resident set size.\n"
+        << "# TYPE testgen_peak_rss_bytes gauge\n"
+        << "testgen_peak_rss_bytes " << peakRssBytes() << "\n";
+}
@@ -0,0 +1,107 @@
+#ifndef METRICS_HH
+#define METRICS_HH
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/**
+ * LatencyHistogram - HDR-style log-linear histogram of microseconds
+ *
+ * 16 linear sub-buckets per power of two: every recorded value is kept to
+ * within ~6%, from 1us to days, in a fixed 1 KiB-ish table.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int MAGNITUDES = 40;
+
+    void record(uint64_t micros);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total; }
+    uint64_t sum() const { return sumMicros; }
+    uint64_t max() const { return maxMicros; }
+    // Upper bound of the bucket holding the p-quantile (0 < p <= 1)
+    uint64_t percentile(double p) const;
+
+private:
+    uint64_t buckets[MAGNITUDES * SUB_BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t sumMicros = 0;
+    uint64_t maxMicros = 0;
+
+    static int bucketOf(uint64_t micros);
+    static uint64_t upperBound(int bucket);
+};
+
+/**
+ * Metrics - end-of-run report of where the time went
+ *
+ *   - HTTP requests per endpoint (ids folded to :id) with latency histograms
+ *   - API function calls, SEE statements, generateCTC iterations
+ *   - solver calls and solve times, peak RSS
+ *
+ * Each thread updates its own shard; shards hang off a lock-free list and
+ * are only summed when a report is written. Keyed stats sit behind a
+ * per-shard lock that only the report contends for (see metrics.cc). Enable with --metrics FILE or
+ * TESTGEN_METRICS=FILE (".prom" selects Prometheus text, anything else
+ * JSON); disabled, every hook is a branch on a static bool.
+ */
+class Metrics {
+public:
+    static inline bool enabled = false;
+
+    // The report is written by finish() or at exit
+    static void start(const string& path);
+    static void finish();
+
+    static void countFunctionCall(const string& function);
+    static void countStatement();
+    static void countCTCIteration();
+    static void recordHttp(const char* method, const string& endpoint, uint64_t micros, int status);
+    static void recordSolve(uint64_t micros);
+
+    static void writeJson(ostream& out);
+    static void writePrometheus(ostream& out);
+
+    // "/api/books/B12/loans/7" -> "/api/books/:id/loans/:id"
+    static string endpointTemplate(const string& endpoint);
+};
+
+// Measures from construction; does nothing unless metrics are enabled
+class MetricsStopwatch {
+public:
+    MetricsStopwatch() {
+        if (Metrics::enabled) started = chrono::steady_clock::now();
+    }
+    uint64_t micros() const {
+        return (uint64_t)chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - started).count();
+    }
+    void http(const char* method, const string& endpoint, int status) const {
+        if (Metrics::enabled) Metrics::recordHttp(method, endpoint, micros(), status);
+    }
+
+private:
+    chrono::steady_clock::time_point started;
+};
+
+// Records one solver call on scope exit, whichever way the solve ends
+class MetricsSolveTimer {
+public:
+    MetricsSolveTimer() = default;
+    ~MetricsSolveTimer() {
+        if (Metrics::enabled) Metrics::recordSolve(watch.micros());
+    }
+    MetricsSolveTimer(const MetricsSolveTimer&) = delete;
+    MetricsSolveTimer& operator=(const MetricsSolveTimer&) = delete;
+
+private:
+    MetricsStopwatch watch;
+};
+
+#endif // METRICS_HH
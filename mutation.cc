@@ -0,0 +1,987 @@
+#include "mutation.hh"
+#include "daemon.hh"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <z3++.h>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * Kill matrix
+ * ============================================================ */
+
+bool KillMatrix::killed(const MutantResult &mutant, size_t sequence) const
+{
+    auto it = mutant.results.find(sequence);
+    return it != mutant.results.end() && it->second == "fail";
+}
+
+static json mutantToJson(const MutantResult &m)
+{
+    json results = json::object();
+    for (const auto &kv : m.results)
+        results[to_string(kv.first)] = kv.second;
+    json out = {{"id", m.id}, {"app", m.app}, {"operator", m.op}, {"dir", m.dir},
+                {"status", m.status}, {"killed_by", m.killedBy}, {"results", results},
+                {"ms", m.ms}};
+    if (!m.error.empty())
+        out["error"] = m.error;
+    return out;
+}
+
+static MutantResult mutantFromJson(const json &j)
+{
+    MutantResult m;
+    m.id = j.value("id", "");
+    m.app = j.value("app", "");
+    m.op = j.value("operator", "");
+    m.dir = j.value("dir", "");
+    m.status = j.value("status", "error");
+    m.error = j.value("error", "");
+    m.ms = j.value("ms", 0.0);
+    if (j.contains("killed_by"))
+        m.killedBy = j["killed_by"].get<vector<size_t>>();
+    if (j.contains("results"))
+        for (const auto &kv : j["results"].items())
+            m.results[stoul(kv.key())] = kv.value().get<string>();
+    return m;
+}
+
+KillMatrix readKillMatrix(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot read kill matrix: " + path);
+    json doc;
+    try {
+        doc = json::parse(in);
+    } catch (const exception &e) {
+        throw runtime_error(path + ": not a kill matrix (" + e.what() + ")");
+    }
+
+    KillMatrix matrix;
+    const json &meta = doc.value("meta", json::object());
+    matrix.fullMatrix = meta.value("full_matrix", false);
+    if (meta.contains("excluded"))
+        matrix.excluded = meta["excluded"].get<vector<size_t>>();
+    for (const auto &s : doc.value("sequences", json::array())) {
+        BatchItem item;
+        item.index = s.value("index", matrix.sequences.size());
+        item.app = s.value("app", "");
+        item.name = s.value("name", "");
+        item.sequence = s["sequence"].get<vector<string>>();
+        matrix.sequences.push_back(move(item));
+    }
+    for (const auto &m : doc.value("mutants", json::array()))
+        matrix.mutants.push_back(mutantFromJson(m));
+    return matrix;
+}
+
+void writeKillMatrix(const KillMatrix &matrix, const string &path)
+{
+    size_t killed = 0, survived = 0, errors = 0;
+    json mutants = json::array();
+    for (const auto &m : matrix.mutants) {
+        killed += m.status == "killed";
+        survived += m.status == "survived";
+        errors += m.status == "error";
+        mutants.push_back(mutantToJson(m));
+    }
+    json sequences = json::array();
+    for (const auto &item : matrix.sequences) {
+        json entry = {{"index", item.index}, {"app", item.app}, {"sequence", item.sequence}};
+        if (!item.name.empty())
+            entry["name"] = item.name;
+        sequences.push_back(entry);
+    }
+
+    // Errors are left out of the score: the mutant was never really tested
+    double score = killed + survived ? (double)killed / (killed + survived) : 0.0;
+    json doc = {{"meta", {{"mutants", matrix.mutants.size()}, {"killed", killed},
+                          {"survived", survived}, {"errors", errors}, {"score", score},
+                          {"full_matrix", matrix.fullMatrix}, {"excluded", matrix.excluded}}},
+                {"sequences", sequences},
+                {"mutants", mutants}};
+
+    ofstream out(path);
+    if (!out)
+        throw runtime_error("Cannot write kill matrix: " + path);
+    out << doc.dump(1) << "\n";
+}
+
+/* ============================================================
+ * Minimization and prioritization
+ * ============================================================ */
+
+namespace {
+
+// An app's killed mutants as sets of their (non-excluded) killers
+struct CoverProblem {
+    vector<size_t> columns;                 // sequence indexes, file order
+    vector<vector<size_t>> killers;         // per killable mutant
+    map<size_t, vector<size_t>> kills;      // sequence -> killable mutants
+};
+
+CoverProblem coverProblem(const KillMatrix &matrix, const string &app)
+{
+    set<size_t> excluded(matrix.excluded.begin(), matrix.excluded.end());
+    CoverProblem problem;
+    for (const auto &item : matrix.sequences)
+        if (item.app == app && !excluded.count(item.index))
+            problem.columns.push_back(item.index);
+
+    for (const auto &mutant : matrix.mutants) {
+        if (mutant.app != app)
+            continue;
+        vector<size_t> killers;
+        for (size_t column : problem.columns)
+            if (matrix.killed(mutant, column))
+                killers.push_back(column);
+        if (killers.empty())
+            continue;
+        for (size_t column : killers)
+            problem.kills[column].push_back(problem.killers.size());
+        problem.killers.push_back(move(killers));
+    }
+    return problem;
+}
+
+// Most additional kills first; shorter, then earlier, sequences win ties.
+// Once everything is covered the rest follow by total kills.
+vector<size_t> additionalGreedy(const KillMatrix &matrix, const CoverProblem &problem,
+                                const vector<size_t> &candidates, bool stopWhenCovered)
+{
+    vector<bool> covered(problem.killers.size(), false);
+    size_t uncovered = covered.size();
+    vector<size_t> remaining = candidates, order;
+
+    auto killsOf = [&](size_t column) -> const vector<size_t> & {
+        static const vector<size_t> none;
+        auto it = problem.kills.find(column);
+        return it == problem.kills.end() ? none : it->second;
+    };
+    auto better = [&](size_t a, size_t gainA, size_t b, size_t gainB) {
+        if (gainA != gainB)
+            return gainA > gainB;
+        size_t depthA = matrix.sequences[a].sequence.size(), depthB = matrix.sequences[b].sequence.size();
+        return depthA != depthB ? depthA < depthB : a < b;
+    };
+
+    while (!remaining.empty()) {
+        size_t bestAt = 0, bestGain = 0;
+        for (size_t i = 0; i < remaining.size(); i++) {
+            size_t gain = 0;
+            for (size_t mutant : killsOf(remaining[i]))
+                gain += uncovered ? !covered[mutant] : 1;
+            if (i == 0 || better(remaining[i], gain, remaining[bestAt], bestGain)) {
+                bestAt = i;
+                bestGain = gain;
+            }
+        }
+        if (stopWhenCovered && (!uncovered || bestGain == 0))
+            break;
+        size_t pick = remaining[bestAt];
+        remaining.erase(remaining.begin() + bestAt);
+        order.push_back(pick);
+        for (size_t mutant : killsOf(pick))
+            if (!covered[mutant]) {
+                covered[mutant] = true;
+                uncovered--;
+            }
+    }
+    return order;
+}
+
+// Greedy cover, then drop picks whose kills the other picks already make
+vector<size_t> greedyCover(const KillMatrix &matrix, const CoverProblem &problem)
+{
+    vector<size_t> picked = additionalGreedy(matrix, problem, problem.columns, true);
+    for (size_t i = picked.size(); i-- > 0;) {
+        vector<size_t> others = picked;
+        others.erase(others.begin() + i);
+        bool redundant = true;
+        for (const auto &killers : problem.killers) {
+            bool hit = false;
+            for (size_t column : killers)
+                hit = hit || find(others.begin(), others.end(), column) != others.end();
+            redundant = redundant && hit;
+        }
+        if (redundant)
+            picked = others;
+    }
+    return picked;
+}
+
+// Minimum cover as a pseudo-boolean optimization; empty when Z3 gives up
+vector<size_t> exactCover(const CoverProblem &problem)
+{
+    z3::context ctx;
+    z3::optimize opt(ctx);
+    map<size_t, z3::expr> chosen;
+    z3::expr count = ctx.int_val(0);
+    for (size_t column : problem.columns) {
+        z3::expr x = ctx.bool_const(("seq" + to_string(column)).c_str());
+        chosen.emplace(column, x);
+        count = count + z3::ite(x, ctx.int_val(1), ctx.int_val(0));
+    }
+    for (const auto &killers : problem.killers) {
+        z3::expr_vector any(ctx);
+        for (size_t column : killers)
+            any.push_back(chosen.at(column));
+        opt.add(z3::mk_or(any));
+    }
+    opt.minimize(count);
+    if (opt.check() != z3::sat)
+        return {};
+
+    z3::model model = opt.get_model();
+    vector<size_t> picked;
+    for (const auto &kv : chosen)
+        if (model.eval(kv.second, true).is_true())
+            picked.push_back(kv.first);
+    return picked;
+}
+
+} // namespace
+
+double apfd(const KillMatrix &matrix, const string &app, const vector<size_t> &order)
+{
+    CoverProblem problem = coverProblem(matrix, app);
+    size_t n = order.size(), m = problem.killers.size();
+    if (n == 0 || m == 0)
+        return 0;
+    // A mutant the order never kills is charged position n + 1
+    double firstKills = 0;
+    for (const auto &killers : problem.killers) {
+        size_t position = n + 1;
+        for (size_t i = 0; i < n && position > n; i++)
+            if (find(killers.begin(), killers.end(), order[i]) != killers.end())
+                position = i + 1;
+        firstKills += position;
+    }
+    return 1.0 - firstKills / (n * m) + 1.0 / (2 * n);
+}
+
+vector<SuitePlan> planSuites(const KillMatrix &matrix, bool exact)
+{
+    set<string> apps;
+    for (const auto &item : matrix.sequences)
+        apps.insert(item.app);
+
+    vector<SuitePlan> plans;
+    for (const auto &app : apps) {
+        CoverProblem problem = coverProblem(matrix, app);
+        SuitePlan plan;
+        plan.app = app;
+        plan.sequences = problem.columns.size();
+        plan.killable = problem.killers.size();
+        plan.prioritized = additionalGreedy(matrix, problem, problem.columns, false);
+
+        vector<size_t> cover;
+        if (exact && plan.killable) {
+            cover = exactCover(problem);
+            plan.exact = !cover.empty();
+            if (!plan.exact)
+                cout << "[Mutate] " << app << ": Z3 found no optimum, falling back to greedy" << endl;
+        }
+        if (!plan.exact)
+            cover = greedyCover(matrix, problem);
+        // Run the reduced suite in prioritized order as well
+        for (size_t column : plan.prioritized)
+            if (find(cover.begin(), cover.end(), column) != cover.end())
+                plan.minimized.push_back(column);
+
+        plan.apfd = apfd(matrix, app, plan.prioritized);
+        plan.apfdSuiteOrder = apfd(matrix, app, problem.columns);
+        plans.push_back(move(plan));
+    }
+    return plans;
+}
+
+/* ============================================================
+ * Options and mutant discovery
+ * ============================================================ */
+
+namespace {
+
+struct LaunchSpec {
+    string command;
+    int readyTimeout = 0;   // 0 = --ready-timeout
+};
+
+struct MutateOptions {
+    string launchPath;
+    string root = "mutation_testing";
+    string outPath = "kill-matrix.json";
+    string historyPath;
+    set<string> only;
+    size_t jobs = 4;
+    int portBase = 9100;
+    int readyTimeout = 120;
+    string mode = "full";
+    bool checkpoints = false;
+    bool fullMatrix = false;
+    bool baseline = false;
+    bool verbose = false;
+    vector<pair<string, string>> inputs;   // app -> sequence file
+};
+
+// One worker's assignment: a mutant (or the original) and its test order
+struct Job {
+    MutantResult mutant;
+    string file;                // mutated source, "" if none shipped
+    vector<size_t> order;
+    bool fullMatrix = false;
+};
+
+MutateOptions parseMutateArgs(int argc, char *argv[], int first)
+{
+    MutateOptions options;
+    auto number = [](const string &flag, const string &value) {
+        try {
+            return stoi(value);
+        } catch (const logic_error &) {
+            throw runtime_error(flag + " expects a number, got '" + value + "'");
+        }
+    };
+    for (int i = first; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "-j" || arg == "--jobs") && hasValue) {
+            int jobs = number(arg, argv[++i]);
+            if (jobs < 1)
+                throw runtime_error(arg + " needs at least one worker");
+            options.jobs = jobs;
+        } else if (arg == "--launch" && hasValue)
+            options.launchPath = argv[++i];
+        else if (arg == "--root" && hasValue)
+            options.root = argv[++i];
+        else if (arg == "--out" && hasValue)
+            options.outPath = argv[++i];
+        else if (arg == "--history" && hasValue)
+            options.historyPath = argv[++i];
+        else if (arg == "--only" && hasValue) {
+            stringstream ids(argv[++i]);
+            string id;
+            while (getline(ids, id, ','))
+                if (!id.empty())
+                    options.only.insert(id);
+        } else if (arg == "--port-base" && hasValue)
+            options.portBase = number(arg, argv[++i]);
+        else if (arg == "--ready-timeout" && hasValue)
+            options.readyTimeout = number(arg, argv[++i]);
+        else if (arg == "--mode" && hasValue)
+            options.mode = argv[++i];
+        else if (arg == "--checkpoints")
+            options.checkpoints = true;
+        else if (arg == "--full-matrix")
+            options.fullMatrix = true;
+        else if (arg == "--baseline")
+            options.baseline = true;
+        else if (arg == "--verbose")
+            options.verbose = true;
+        else if (arg.compare(0, 1, "-") != 0 && arg.find('=') != string::npos) {
+            size_t eq = arg.find('=');
+            options.inputs.emplace_back(arg.substr(0, eq), arg.substr(eq + 1));
+        } else
+            throw runtime_error("Unknown mutate argument: " + arg);
+    }
+    if (options.launchPath.empty())
+        throw runtime_error("mutate needs --launch LAUNCH.json");
+    if (options.inputs.empty())
+        throw runtime_error("mutate needs at least one app=SEQUENCES.jsonl input");
+    if (options.mode != "full" && options.mode != "rewrite")
+        throw runtime_error("mutate --mode must be full or rewrite");
+    return options;
+}
+
+map<string, LaunchSpec> readLaunchSpecs(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot read launch config: " + path);
+    json doc = json::parse(in);
+    map<string, LaunchSpec> specs;
+    for (const auto &kv : doc.items()) {
+        LaunchSpec spec;
+        if (kv.value().is_string())
+            spec.command = kv.value().get<string>();
+        else {
+            spec.command = kv.value().value("command", "");
+            spec.readyTimeout = kv.value().value("ready_timeout", 0);
+        }
+        if (spec.command.empty())
+            throw runtime_error(path + ": no command for " + kv.key());
+        specs[kv.key()] = spec;
+    }
+    return specs;
+}
+
+vector<string> listDir(const string &path)
+{
+    vector<string> names;
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+        return names;
+    while (dirent *entry = readdir(dir))
+        if (entry->d_name[0] != '.')
+            names.push_back(entry->d_name);
+    closedir(dir);
+    sort(names.begin(), names.end());
+    return names;
+}
+
+bool isRegularFile(const string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// "LI_M01_CDL_saveBook_..." -> id LI_M01, operator CDL
+vector<Job> discoverMutants(const MutateOptions &options, const string &app)
+{
+    vector<Job> jobs;
+    string base = options.root + "/" + app + "/mutants";
+    for (const auto &name : listDir(base)) {
+        size_t first = name.find('_');
+        size_t second = first == string::npos ? first : name.find('_', first + 1);
+        if (second == string::npos)
+            continue;
+        size_t third = name.find('_', second + 1);
+
+        Job job;
+        job.mutant.id = name.substr(0, second);
+        job.mutant.op = name.substr(second + 1, third == string::npos ? string::npos : third - second - 1);
+        job.mutant.app = app;
+        job.mutant.dir = base + "/" + name;
+        if (!options.only.empty() && !options.only.count(job.mutant.id))
+            continue;
+        for (const auto &entry : listDir(job.mutant.dir))
+            if (entry.find(".mutant") != string::npos && isRegularFile(job.mutant.dir + "/" + entry))
+                job.file = job.mutant.dir + "/" + entry;
+        jobs.push_back(move(job));
+    }
+    return jobs;
+}
+
+/* ============================================================
+ * Test order
+ * ============================================================ */
+
+// Kill counts per sequence, from earlier campaigns and finished workers
+class KillRates {
+public:
+    void add(const KillMatrix &matrix, const MutantResult &mutant)
+    {
+        for (const auto &cell : mutant.results) {
+            if (cell.first >= matrix.sequences.size())
+                continue;
+            const BatchItem &item = matrix.sequences[cell.first];
+            auto &counts = stats[batchSequenceKey(item.app, item.sequence)];
+            counts.second++;
+            if (cell.second == "fail")
+                counts.first++;
+        }
+    }
+
+    // Laplace-smoothed: an unseen sequence ranks at 0.5
+    double rate(const BatchItem &item) const
+    {
+        auto it = stats.find(batchSequenceKey(item.app, item.sequence));
+        if (it == stats.end())
+            return 0.5;
+        return (it->second.first + 1.0) / (it->second.second + 2.0);
+    }
+
+    size_t size() const { return stats.size(); }
+
+private:
+    map<string, pair<size_t, size_t>> stats;   // key -> (kills, runs)
+};
+
+// Likeliest killer first; cheaper (shorter) sequences break ties
+vector<size_t> testOrder(const KillMatrix &matrix, const string &app, const KillRates &rates)
+{
+    set<size_t> excluded(matrix.excluded.begin(), matrix.excluded.end());
+    vector<pair<double, size_t>> ranked;
+    for (const auto &item : matrix.sequences)
+        if (item.app == app && !excluded.count(item.index))
+            ranked.emplace_back(rates.rate(item), item.index);
+    stable_sort(ranked.begin(), ranked.end(), [&](const pair<double, size_t> &a, const pair<double, size_t> &b) {
+        if (a.first != b.first)
+            return a.first > b.first;
+        return matrix.sequences[a.second].sequence.size() < matrix.sequences[b.second].sequence.size();
+    });
+    vector<size_t> order;
+    for (const auto &r : ranked)
+        order.push_back(r.second);
+    return order;
+}
+
+/* ============================================================
+ * Worker: one backend, one mutant
+ * ============================================================ */
+
+volatile sig_atomic_t backendGroup = 0;
+
+void killBackendAndExit(int)
+{
+    if (backendGroup > 0)
+        kill(-backendGroup, SIGKILL);
+    _exit(130);
+}
+
+string substitute(string text, const map<string, string> &values)
+{
+    for (const auto &kv : values) {
+        string key = "{" + kv.first + "}";
+        for (size_t at = text.find(key); at != string::npos; at = text.find(key, at + kv.second.size())) {
+            text.replace(at, key.size(), kv.second);
+        }
+    }
+    return text;
+}
+
+bool portAccepts(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool ok = connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+    close(fd);
+    return ok;
+}
+
+// A backend in its own process group, torn down on scope exit
+class BackendProcess {
+public:
+    BackendProcess(const string &command, const string &logPath)
+    {
+        pid = fork();
+        if (pid < 0)
+            throw runtime_error(string("fork failed: ") + strerror(errno));
+        if (pid == 0) {
+            setpgid(0, 0);
+            int log = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            int null = open("/dev/null", O_RDONLY);
+            if (log >= 0) {
+                dup2(log, STDOUT_FILENO);
+                dup2(log, STDERR_FILENO);
+            }
+            if (null >= 0)
+                dup2(null, STDIN_FILENO);
+            execl("/bin/sh", "sh", "-c", command.c_str(), (char *)nullptr);
+            _exit(127);
+        }
+        setpgid(pid, pid);
+        backendGroup = pid;
+    }
+
+    ~BackendProcess()
+    {
+        kill(-pid, SIGTERM);
+        for (int i = 0; i < 50 && !exited(); i++)
+            this_thread::sleep_for(chrono::milliseconds(100));
+        if (!exited()) {
+            kill(-pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        // Stragglers that left the group's leader behind
+        kill(-pid, SIGKILL);
+        backendGroup = 0;
+    }
+
+    bool exited()
+    {
+        if (reaped)
+            return true;
+        reaped = waitpid(pid, nullptr, WNOHANG) == pid;
+        return reaped;
+    }
+
+    void waitReady(int port, int timeoutSeconds, const string &logPath)
+    {
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(timeoutSeconds);
+        while (!portAccepts(port)) {
+            if (exited())
+                throw runtime_error("backend exited during startup, see " + logPath);
+            if (chrono::steady_clock::now() > deadline)
+                throw runtime_error("backend not listening on port " + to_string(port) + " after " +
+                                    to_string(timeoutSeconds) + "s, see " + logPath);
+            this_thread::sleep_for(chrono::milliseconds(200));
+        }
+    }
+
+private:
+    pid_t pid = -1;
+    bool reaped = false;
+};
+
+void runJob(Job &job, const KillMatrix &matrix, const MutateOptions &options,
+            const LaunchSpec &launch, int port, const string &workDir)
+{
+    MutantResult &result = job.mutant;
+    auto t0 = chrono::steady_clock::now();
+
+    if (portAccepts(port))
+        throw runtime_error("port " + to_string(port) + " is already in use");
+
+    string logPath = workDir + "/" + result.id + ".backend.log";
+    string command = substitute(launch.command, {{"port", to_string(port)},
+                                                 {"mutant_id", result.id},
+                                                 {"mutant_dir", result.dir},
+                                                 {"mutant_file", job.file},
+                                                 {"work_dir", workDir}});
+    BackendProcess backend(command, logPath);
+    backend.waitReady(port, launch.readyTimeout ? launch.readyTimeout : options.readyTimeout, logPath);
+    cout << "[Mutate] " << result.id << ": backend ready on port " << port << " after "
+         << chrono::duration<double>(chrono::steady_clock::now() - t0).count() << "s" << endl;
+
+    DaemonOptions daemonOptions;
+    daemonOptions.verbose = options.verbose;
+    daemonOptions.urls[result.app] = "http://localhost:" + to_string(port);
+    DaemonSession session(daemonOptions);
+
+    for (size_t index : job.order) {
+        const BatchItem &item = matrix.sequences[index];
+        json request = {{"id", index}, {"app", item.app}, {"sequence", item.sequence},
+                        {"mode", options.mode}, {"checkpoints", options.checkpoints}};
+        json response = json::parse(session.handleLine(request.dump()));
+        string status = response.value("status", "error");
+        result.results[index] = status;
+        if (status == "fail") {
+            result.killedBy.push_back(index);
+            if (!job.fullMatrix)
+                break;
+        }
+        if (backend.exited()) {
+            result.error = "backend exited after sequence #" + to_string(index);
+            break;
+        }
+    }
+
+    if (!result.killedBy.empty())
+        result.status = "killed";
+    else
+        result.status = result.error.empty() ? "survived" : "error";
+}
+
+// Runs in the forked worker; the parent only ever sees the result file
+[[noreturn]] void workerMain(Job &job, const KillMatrix &matrix, const MutateOptions &options,
+                             const LaunchSpec &launch, int port, const string &workDir,
+                             const string &resultPath)
+{
+    signal(SIGINT, killBackendAndExit);
+    signal(SIGTERM, killBackendAndExit);
+    auto t0 = chrono::steady_clock::now();
+    try {
+        runJob(job, matrix, options, launch, port, workDir);
+    } catch (const exception &e) {
+        job.mutant.status = "error";
+        job.mutant.error = e.what();
+    }
+    job.mutant.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    ofstream out(resultPath);
+    out << mutantToJson(job.mutant).dump() << "\n";
+    out.close();
+    cout.flush();
+    cerr.flush();
+    // Skip atexit handlers: trace/metrics files belong to the parent
+    _exit(out ? 0 : 1);
+}
+
+/* ============================================================
+ * Scheduler
+ * ============================================================ */
+
+class Campaign {
+public:
+    Campaign(const MutateOptions &options, KillMatrix &matrix, const map<string, LaunchSpec> &launch,
+             KillRates &rates, const string &workDir)
+        : options(options), matrix(matrix), launch(launch), rates(rates), workDir(workDir) {}
+
+    // Runs jobs with at most --jobs workers, each on its own port
+    vector<MutantResult> run(vector<Job> jobs, const char *phase)
+    {
+        struct Running {
+            size_t job;
+            int slot;
+        };
+        map<pid_t, Running> running;
+        vector<bool> busy(options.jobs, false);
+        vector<MutantResult> done;
+        size_t next = 0;
+
+        while (next < jobs.size() || !running.empty()) {
+            while (running.size() < options.jobs && next < jobs.size()) {
+                int slot = find(busy.begin(), busy.end(), false) - busy.begin();
+                Job &job = jobs[next];
+                // Ordered at launch, so kills seen so far steer later mutants
+                if (job.order.empty())
+                    job.order = testOrder(matrix, job.mutant.app, rates);
+                string resultPath = resultFile(job);
+                unlink(resultPath.c_str());
+
+                cout.flush();
+                cerr.flush();
+                pid_t pid = fork();
+                if (pid < 0)
+                    throw runtime_error(string("fork failed: ") + strerror(errno));
+                if (pid == 0)
+                    workerMain(job, matrix, options, launch.at(job.mutant.app),
+                               options.portBase + slot, workDir, resultPath);
+                busy[slot] = true;
+                running[pid] = {next++, slot};
+            }
+
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, 0);
+            if (pid < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw runtime_error(string("waitpid failed: ") + strerror(errno));
+            }
+            auto it = running.find(pid);
+            if (it == running.end())
+                continue;
+            Job &job = jobs[it->second.job];
+            busy[it->second.slot] = false;
+            running.erase(it);
+
+            MutantResult result = collect(job, status);
+            rates.add(matrix, result);
+            done.push_back(result);
+            report(result, phase, done.size(), jobs.size());
+        }
+        return done;
+    }
+
+private:
+    const MutateOptions &options;
+    KillMatrix &matrix;
+    const map<string, LaunchSpec> &launch;
+    KillRates &rates;
+    string workDir;
+
+    string resultFile(const Job &job) const
+    {
+        return workDir + "/" + job.mutant.app + "." + job.mutant.id + ".result.json";
+    }
+
+    MutantResult collect(const Job &job, int status) const
+    {
+        ifstream in(resultFile(job));
+        string line;
+        if (in && getline(in, line)) {
+            json parsed = json::parse(line, nullptr, false);
+            if (parsed.is_object())
+                return mutantFromJson(parsed);
+        }
+        MutantResult result = job.mutant;
+        result.status = "error";
+        result.error = WIFSIGNALED(status) ? "worker killed by signal " + to_string(WTERMSIG(status))
+                                           : "worker exited with status " + to_string(WEXITSTATUS(status));
+        return result;
+    }
+
+    static void report(const MutantResult &r, const char *phase, size_t finished, size_t total)
+    {
+        cout << "[Mutate] " << phase << " " << finished << "/" << total << " " << r.app << " "
+             << r.id << ": " << r.status;
+        if (!r.killedBy.empty())
+            cout << " by #" << r.killedBy.front();
+        cout << " after " << r.results.size() << " sequence(s), " << r.ms / 1000.0 << "s";
+        if (!r.error.empty())
+            cout << " (" << r.error << ")";
+        cout << endl;
+    }
+};
+
+int runCampaign(const MutateOptions &options)
+{
+    auto t0 = chrono::steady_clock::now();
+    map<string, LaunchSpec> launch = readLaunchSpecs(options.launchPath);
+
+    KillMatrix matrix;
+    matrix.fullMatrix = options.fullMatrix;
+    matrix.sequences = readBatchInputs(options.inputs);
+
+    KillRates rates;
+    if (!options.historyPath.empty()) {
+        KillMatrix history = readKillMatrix(options.historyPath);
+        for (const auto &m : history.mutants)
+            rates.add(history, m);
+        cout << "[Mutate] History: kill rates for " << rates.size() << " sequences from "
+             << options.historyPath << endl;
+    }
+
+    string workDir = options.outPath + ".work";
+    if (mkdir(workDir.c_str(), 0755) != 0 && errno != EEXIST)
+        throw runtime_error("Cannot create " + workDir + ": " + strerror(errno));
+
+    set<string> apps;
+    for (const auto &input : options.inputs)
+        apps.insert(input.first);
+    for (const auto &app : apps)
+        if (!launch.count(app))
+            throw runtime_error(options.launchPath + " has no launch command for " + app);
+
+    Campaign campaign(options, matrix, launch, rates, workDir);
+
+    if (options.baseline) {
+        vector<Job> originals;
+        for (const auto &app : apps) {
+            Job job;
+            job.mutant.id = "ORIGINAL";
+            job.mutant.app = app;
+            job.order = testOrder(matrix, app, rates);
+            job.fullMatrix = true;
+            originals.push_back(move(job));
+        }
+        for (const auto &original : campaign.run(move(originals), "baseline")) {
+            if (original.status == "error")
+                throw runtime_error("baseline for " + original.app + " failed: " + original.error);
+            for (const auto &cell : original.results)
+                if (cell.second == "fail" || cell.second == "error")
+                    matrix.excluded.push_back(cell.first);
+        }
+        sort(matrix.excluded.begin(), matrix.excluded.end());
+        cout << "[Mutate] Baseline: " << matrix.excluded.size()
+             << " sequence(s) fail on the original backend and are excluded" << endl;
+    }
+
+    vector<Job> jobs;
+    for (const auto &app : apps) {
+        vector<Job> found = discoverMutants(options, app);
+        if (found.empty())
+            cout << "[Mutate] No mutants for " << app << " under " << options.root << endl;
+        for (auto &job : found) {
+            job.fullMatrix = options.fullMatrix;
+            jobs.push_back(move(job));
+        }
+    }
+    cout << "[Mutate] " << jobs.size() << " mutants, " << matrix.sequences.size() << " sequences, "
+         << options.jobs << " workers" << endl;
+
+    matrix.mutants = campaign.run(move(jobs), "mutant");
+    sort(matrix.mutants.begin(), matrix.mutants.end(), [](const MutantResult &a, const MutantResult &b) {
+        return a.app != b.app ? a.app < b.app : a.id < b.id;
+    });
+    writeKillMatrix(matrix, options.outPath);
+
+    size_t killed = 0, survived = 0, errors = 0;
+    for (const auto &m : matrix.mutants) {
+        killed += m.status == "killed";
+        survived += m.status == "survived";
+        errors += m.status == "error";
+    }
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << "[Mutate] Wrote " << options.outPath << " | killed " << killed << " | survived "
+         << survived << " | errors " << errors << " | score "
+         << (killed + survived ? 100.0 * killed / (killed + survived) : 0.0) << "% | "
+         << wall << "s" << endl;
+    return errors == 0 ? 0 : 1;
+}
+
+/* ============================================================
+ * minimize
+ * ============================================================ */
+
+json planEntries(const KillMatrix &matrix, const vector<size_t> &columns)
+{
+    json entries = json::array();
+    for (size_t column : columns) {
+        const BatchItem &item = matrix.sequences[column];
+        size_t kills = 0;
+        for (const auto &mutant : matrix.mutants)
+            kills += mutant.app == item.app && matrix.killed(mutant, column);
+        json entry = {{"index", column}, {"sequence", item.sequence}, {"kills", kills}};
+        if (!item.name.empty())
+            entry["name"] = item.name;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+int runMinimize(int argc, char *argv[], int first)
+{
+    string matrixPath, outPath = "suite-selection.json";
+    bool exact = false;
+    for (int i = first; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--exact")
+            exact = true;
+        else if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (matrixPath.empty() && arg.compare(0, 1, "-") != 0)
+            matrixPath = arg;
+        else
+            throw runtime_error("Unknown minimize argument: " + arg);
+    }
+    if (matrixPath.empty())
+        throw runtime_error("usage: mutate minimize MATRIX.json [--exact] [--out SELECTION.json]");
+
+    KillMatrix matrix = readKillMatrix(matrixPath);
+    if (!matrix.fullMatrix)
+        cout << "[Mutate] " << matrixPath << " stopped each mutant at its first kill; "
+             << "a --full-matrix campaign allows a smaller cover" << endl;
+
+    json apps = json::object();
+    for (const auto &plan : planSuites(matrix, exact)) {
+        apps[plan.app] = {{"sequences", plan.sequences},
+                          {"killable", plan.killable},
+                          {"exact", plan.exact},
+                          {"apfd", plan.apfd},
+                          {"apfd_suite_order", plan.apfdSuiteOrder},
+                          {"minimized", planEntries(matrix, plan.minimized)},
+                          {"prioritized", planEntries(matrix, plan.prioritized)}};
+        cout << "[Mutate] " << plan.app << ": " << plan.minimized.size() << " of " << plan.sequences
+             << " sequences kill all " << plan.killable << " killable mutants ("
+             << (plan.exact ? "optimal" : "greedy") << ") | APFD " << plan.apfdSuiteOrder
+             << " in suite order, " << plan.apfd << " prioritized" << endl;
+    }
+
+    ofstream out(outPath);
+    if (!out)
+        throw runtime_error("Cannot write selection: " + outPath);
+    out << json{{"matrix", matrixPath}, {"full_matrix", matrix.fullMatrix}, {"apps", apps}}.dump(1) << "\n";
+    cout << "[Mutate] Wrote " << outPath << endl;
+    return 0;
+}
+
+} // namespace
+
+int runMutate(int argc, char *argv[], int first)
+{
+    try {
+        if (first < argc && string(argv[first]) == "minimize")
+            return runMinimize(argc, argv, first + 1);
+        return runCampaign(parseMutateArgs(argc, argv, first));
+    } catch (const exception &e) {
+        cerr << "[Mutate] " << e.what() << endl;
+        return 1;
+    }
+}
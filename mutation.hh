@@ -0,0 +1,96 @@
+#ifndef MUTATION_HH
+#define MUTATION_HH
+
+#include "batch.hh"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Mutation campaigns over mutation_testing/<app>/mutants/<ID>_<OP>_<what>/
+ *
+ *   mutate --launch LAUNCH.json [-j N] [--root DIR] [--out MATRIX.json]
+ *          [--history MATRIX.json] [--only ID,ID...] [--port-base P]
+ *          [--ready-timeout S] [--mode full|rewrite] [--checkpoints]
+ *          [--full-matrix] [--baseline] [--verbose] app=SEQUENCES.jsonl...
+ *
+ * Every mutant gets a worker process and a backend of its own on a local
+ * port, up to N at a time. LAUNCH.json says how to start an app's backend:
+ *
+ *   {"library": {"command": "scripts/library-mutant.sh {mutant_file} {port}",
+ *                "ready_timeout": 120}}
+ *
+ * with {port}, {mutant_id}, {mutant_dir}, {mutant_file} ("" when the mutant
+ * ships no source) and {work_dir} substituted. The command runs under
+ * /bin/sh in its own process group, which is torn down after the run; its
+ * output goes to WORK/<ID>.backend.log. The backend is ready once its port
+ * accepts connections.
+ *
+ * A sequence kills a mutant when it fails against it. Sequences run most
+ * likely killer first - kill rates come from --history plus the mutants
+ * already finished in this campaign - and a mutant stops at its first kill
+ * unless --full-matrix asks for every cell. --baseline first runs each app's
+ * suite against the original backend ({mutant_id} = ORIGINAL) and drops the
+ * sequences that fail there, since they would "kill" every mutant.
+ */
+
+struct MutantResult {
+    string id;                      // "LI_M01"
+    string app;
+    string op;                      // "CDL", "SDL", ...
+    string dir;
+    string status;                  // "killed" | "survived" | "error"
+    string error;
+    vector<size_t> killedBy;        // sequence indexes
+    map<size_t, string> results;    // sequence index -> pass | fail | unsat | error
+    double ms = 0;
+};
+
+// Columns are sequences, rows are mutants; unrun cells are absent
+struct KillMatrix {
+    vector<BatchItem> sequences;
+    vector<MutantResult> mutants;
+    bool fullMatrix = false;
+    vector<size_t> excluded;        // failed against the original backend
+
+    bool killed(const MutantResult &mutant, size_t sequence) const;
+};
+
+KillMatrix readKillMatrix(const string &path);
+void writeKillMatrix(const KillMatrix &matrix, const string &path);
+
+/*
+ * Suite reduction from a kill matrix (`mutate minimize MATRIX.json
+ * [--exact] [--out SELECTION.json]`), per app:
+ *
+ *   minimized   - a smallest set of sequences that still kills every killed
+ *                 mutant: greedy set cover with redundant picks dropped, or
+ *                 Z3's optimizer with --exact
+ *   prioritized - every sequence, most additional kills first (shorter
+ *                 first on ties), to maximize APFD
+ *
+ * Only observed kills count, so an early-stopped matrix gives a weaker
+ * minimization than one from --full-matrix.
+ */
+struct SuitePlan {
+    string app;
+    size_t sequences = 0;
+    size_t killable = 0;
+    vector<size_t> minimized;       // sequence indexes
+    vector<size_t> prioritized;
+    double apfd = 0;                // of prioritized
+    double apfdSuiteOrder = 0;      // of the sequences in file order
+    bool exact = false;
+};
+
+vector<SuitePlan> planSuites(const KillMatrix &matrix, bool exact);
+
+// Average percentage of faults detected by `order` over the app's killed mutants
+double apfd(const KillMatrix &matrix, const string &app, const vector<size_t> &order);
+
+int runMutate(int argc, char *argv[], int first);
+
+#endif
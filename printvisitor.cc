@@ -274,7 +274,7 @@ void PrintVisitor::printStmt(const Stmt* stmt) {
     
     // Check if it's an Assert (not in base visitor yet)
     // Assert uses ASSUME type but is a different class
-    const Assert* assertStmt = dynamic_cast<const Assert*>(stmt);
+    const Assert* assertStmt = stmt->as<Assert>();
     if (assertStmt) {
         cout << "assert(";
         if (assertStmt->expr) {
@@ -1,5 +1,4 @@
 #include "rewrite_globals_visitor.hh"
-#include "clonevisitor.hh"
 #include <iostream>
 
 using namespace std;
@@ -10,13 +9,52 @@ using namespace std;
 
 RewriteGlobalsVisitor::RewriteGlobalsVisitor() {}
 
+void RewriteGlobalsVisitor::setRestorePoint(
+    const string& id,
+    const vector<Ref<Stmt>>* prefix) {
+    restoreId = id;
+    restorePrefix = prefix;
+}
+
+int RewriteGlobalsVisitor::findCheckpoint(const vector<Ref<Stmt>>& stmts,
+                                          const string& id) {
+    for (size_t i = 0; i < stmts.size(); i++) {
+        const Assign* as = stmts[i]->as<Assign>();
+        if (!as) continue;
+        const FuncCall* fc = as->right->as<FuncCall>();
+        if (!fc || fc->name != "checkpoint" || fc->args.size() != 1) continue;
+        const String* arg = fc->args[0]->as<String>();
+        if (arg && arg->value == id) return (int)i;
+    }
+    return -1;
+}
+
+void RewriteGlobalsVisitor::spliceRestorePrefix(
+    vector<Ref<Stmt>>& stmts,
+    const string& id,
+    const vector<Ref<Stmt>>& prefix) {
+    int cp = findCheckpoint(stmts, id);
+    if (cp < 0) {
+        throw runtime_error("Restore point has no checkpoint: " + id);
+    }
+    vector<Ref<Stmt>> spliced;
+    spliced.push_back(move(stmts[0]));
+    for (const auto& stmt : prefix) {
+        spliced.push_back(stmt);
+    }
+    for (size_t i = cp + 1; i < stmts.size(); i++) {
+        spliced.push_back(move(stmts[i]));
+    }
+    stmts = move(spliced);
+}
+
 /* ============================================================
  * HELPER: Fresh Temporary Variable
  * ============================================================ */
 
 string RewriteGlobalsVisitor::freshTemp(const string& globalName) {
     int& counter = tmpCounters[globalName];
-    string result = "tmp_" + globalName + "_" + to_string(counter);
+    string result = "tmp_" + globalName + "_" + tempMarker + to_string(counter);
     counter++;
     return result;
 }
@@ -26,11 +64,11 @@ string RewriteGlobalsVisitor::freshTemp(const string& globalName) {
  * ============================================================ */
 
 bool RewriteGlobalsVisitor::isInitAssign(const Stmt* stmt) {
-    const Assign* as = dynamic_cast<const Assign*>(stmt);
+    const Assign* as = stmt->as<Assign>();
     if (!as) return false;
 
-    const Var* lhs = dynamic_cast<const Var*>(as->left.get());
-    const Map* rhs = dynamic_cast<const Map*>(as->right.get());
+    const Var* lhs = as->left->as<Var>();
+    const Map* rhs = as->right->as<Map>();
 
     if (!lhs || !rhs) return false;
 
@@ -45,7 +83,7 @@ bool RewriteGlobalsVisitor::isInitAssign(const Stmt* stmt) {
 bool RewriteGlobalsVisitor::isGlobalVar(const Expr* expr) {
     if (!expr) return false;
     
-    const Var* v = dynamic_cast<const Var*>(expr);
+    const Var* v = expr->as<Var>();
     if (!v) return false;
     
     return globals.count(v->name) > 0;
@@ -62,28 +100,28 @@ bool RewriteGlobalsVisitor::containsGlobals(const Expr* expr) {
     if (isGlobalVar(expr)) return true;
     
     // Recursively check function call arguments
-    if (const FuncCall* fc = dynamic_cast<const FuncCall*>(expr)) {
+    if (const FuncCall* fc = expr->as<FuncCall>()) {
         for (const auto& arg : fc->args) {
             if (containsGlobals(arg.get())) return true;
         }
     }
     
     // Check tuple elements
-    if (const Tuple* t = dynamic_cast<const Tuple*>(expr)) {
+    if (const Tuple* t = expr->as<Tuple>()) {
         for (const auto& e : t->exprs) {
             if (containsGlobals(e.get())) return true;
         }
     }
     
     // Check set elements
-    if (const Set* s = dynamic_cast<const Set*>(expr)) {
+    if (const Set* s = expr->as<Set>()) {
         for (const auto& e : s->elements) {
             if (containsGlobals(e.get())) return true;
         }
     }
     
     // Check map values
-    if (const Map* m = dynamic_cast<const Map*>(expr)) {
+    if (const Map* m = expr->as<Map>()) {
         for (const auto& kv : m->value) {
             if (containsGlobals(kv.first.get())) return true;
             if (containsGlobals(kv.second.get())) return true;
@@ -117,8 +155,8 @@ void RewriteGlobalsVisitor::visitProgram(const Program& p) {
     
     for (const auto& stmt : p.statements) {
         if (isInitAssign(stmt.get())) {
-            const Assign* as = dynamic_cast<const Assign*>(stmt.get());
-            const Var* lhs = dynamic_cast<const Var*>(as->left.get());
+            const Assign* as = stmt->as<Assign>();
+            const Var* lhs = as->left->as<Var>();
             globals.insert(lhs->name);
             tmpCounters[lhs->name] = 0;  // Initialize counter
         }
@@ -128,10 +166,15 @@ void RewriteGlobalsVisitor::visitProgram(const Program& p) {
     for (const auto& g : globals) cout << g << " ";
     cout << endl;
     
-    // STEP 2: Insert reset() call
+    // STEP 2: Insert reset() call (or restore(id) when resuming a checkpoint)
     {
-        vector<unique_ptr<Expr>> noArgs;
-        auto resetCall = make_unique<FuncCall>("reset", move(noArgs));
+        vector<Ref<Expr>> args;
+        string fname = "reset";
+        if (!restoreId.empty()) {
+            fname = "restore";
+            args.push_back(make_unique<String>(restoreId));
+        }
+        auto resetCall = make_unique<FuncCall>(fname, move(args));
         newStmts.push_back(
             make_unique<Assign>(
                 make_unique<Var>("_"),
@@ -151,6 +194,13 @@ void RewriteGlobalsVisitor::visitProgram(const Program& p) {
         this->visit(stmt.get());
     }
     
+    // STEP 3a: Swap the rewritten prefix for the concrete one the checkpoint
+    // was taken with. The prefix is still rewritten above so temp counters
+    // for the remaining statements match the original numbering.
+    if (!restoreId.empty() && restorePrefix) {
+        spliceRestorePrefix(newStmts, restoreId, *restorePrefix);
+    }
+    
     // STEP 4: Create final program
     rewrittenProgram = make_unique<Program>(move(newStmts));
     
@@ -176,9 +226,11 @@ void RewriteGlobalsVisitor::visitAssume(const Assume& s) {
     }
     
     // Then add the assume with rewritten condition
-    newStmts.push_back(
-        make_unique<Assume>(move(result.expr))
-    );
+    if (result.expr.get() == s.expr.get()) {
+        newStmts.push_back(shareNode(&s));
+    } else {
+        newStmts.push_back(make_unique<Assume>(move(result.expr)));
+    }
 }
 
 void RewriteGlobalsVisitor::visitAssert(const Assert& s) {
@@ -191,9 +243,11 @@ void RewriteGlobalsVisitor::visitAssert(const Assert& s) {
     }
     
     // Then add the assert with rewritten condition
-    newStmts.push_back(
-        make_unique<Assert>(move(result.expr))
-    );
+    if (result.expr.get() == s.expr.get()) {
+        newStmts.push_back(shareNode(&s));
+    } else {
+        newStmts.push_back(make_unique<Assert>(move(result.expr)));
+    }
 }
 
 /* ============================================================
@@ -227,17 +281,12 @@ void RewriteGlobalsVisitor::rewriteAssignStmt(const Assign& s) {
             newStmts.push_back(move(stmt));
         }
         
-        // Clone LHS
-        CloneVisitor cloner;
-        auto lhsClone = cloner.cloneExpr(s.left.get());
-        
-        // Add assignment
-        newStmts.push_back(
-            make_unique<Assign>(
-                move(lhsClone),
-                move(rhsResult.expr)
-            )
-        );
+        // Add assignment, reusing the original when the RHS is unchanged
+        if (rhsResult.expr.get() == s.right.get()) {
+            newStmts.push_back(shareNode(&s));
+        } else {
+            newStmts.push_back(make_unique<Assign>(s.left, move(rhsResult.expr)));
+        }
     }
 }
 
@@ -252,7 +301,7 @@ RewriteGlobalsVisitor::detectMapUpdate(const Expr* lhs, const Expr* rhs) {
     info.isMapUpdate = false;
     
     // Case 1: Direct global assignment (G = expr)
-    if (const Var* v = dynamic_cast<const Var*>(lhs)) {
+    if (const Var* v = lhs->as<Var>()) {
         if (globals.count(v->name)) {
             info.globalName = v->name;
             info.isMapUpdate = false;
@@ -271,21 +320,20 @@ RewriteGlobalsVisitor::detectMapUpdate(const Expr* lhs, const Expr* rhs) {
     
     // Case 2: Map index assignment (G[k] = v)
     // This comes as: [] (G, k) on LHS
-    if (const FuncCall* fc = dynamic_cast<const FuncCall*>(lhs)) {
+    if (const FuncCall* fc = lhs->as<FuncCall>()) {
         if (fc->name == "[]" && fc->args.size() == 2) {
             const Expr* base = fc->args[0].get();
             const Expr* keyExpr = fc->args[1].get();
             
             // Check if base is a global
-            if (const Var* baseVar = dynamic_cast<const Var*>(base)) {
+            if (const Var* baseVar = base->as<Var>()) {
                 if (globals.count(baseVar->name)) {
                     info.globalName = baseVar->name;
                     info.isMapUpdate = true;
                     
-                    // Clone key and value
-                    CloneVisitor cloner;
-                    info.key = cloner.cloneExpr(keyExpr);
-                    info.value = cloner.cloneExpr(rhs);
+                    // Share key and value
+                    info.key = shareNode(keyExpr);
+                    info.value = shareNode(rhs);
                     
                     return info;
                 }
@@ -302,14 +350,14 @@ RewriteGlobalsVisitor::detectMapUpdate(const Expr* lhs, const Expr* rhs) {
 
 void RewriteGlobalsVisitor::emitMapUpdate(
     const string& globalName,
-    unique_ptr<Expr> key,
-    unique_ptr<Expr> value
+    Ref<Expr> key,
+    Ref<Expr> value
 ) {
     string tmpName = freshTemp(globalName);
     
     // STEP 1: tmp := get_G()
     {
-        vector<unique_ptr<Expr>> noArgs;
+        vector<Ref<Expr>> noArgs;
         auto getCall = make_unique<FuncCall>("get_" + globalName, move(noArgs));
         
         newStmts.push_back(
@@ -322,7 +370,7 @@ void RewriteGlobalsVisitor::emitMapUpdate(
     
     // STEP 2: tmp[k] := v
     {
-        vector<unique_ptr<Expr>> indexArgs;
+        vector<Ref<Expr>> indexArgs;
         indexArgs.push_back(make_unique<Var>(tmpName));
         indexArgs.push_back(move(key));
         
@@ -338,7 +386,7 @@ void RewriteGlobalsVisitor::emitMapUpdate(
     
     // STEP 3: _ := set_G(tmp)
     {
-        vector<unique_ptr<Expr>> setArgs;
+        vector<Ref<Expr>> setArgs;
         setArgs.push_back(make_unique<Var>(tmpName));
         
         auto setCall = make_unique<FuncCall>("set_" + globalName, move(setArgs));
@@ -360,7 +408,7 @@ void RewriteGlobalsVisitor::emitMapUpdate(
 
 void RewriteGlobalsVisitor::emitMapReplace(
     const string& globalName,
-    unique_ptr<Expr> expr
+    Ref<Expr> expr
 ) {
     // Rewrite the expression first
     auto exprResult = rewriteExpr(expr.get());
@@ -371,7 +419,7 @@ void RewriteGlobalsVisitor::emitMapReplace(
     }
     
     // _ := set_G(expr')
-    vector<unique_ptr<Expr>> setArgs;
+    vector<Ref<Expr>> setArgs;
     setArgs.push_back(move(exprResult.expr));
     
     auto setCall = make_unique<FuncCall>("set_" + globalName, move(setArgs));
@@ -399,45 +447,61 @@ RewriteGlobalsVisitor::rewriteExpr(const Expr* e) {
     }
     
     // Dispatch based on expression type
-    if (auto v = dynamic_cast<const Var*>(e)) {
+    if (auto v = e->as<Var>()) {
         return rewriteVar(v);
     }
-    if (auto f = dynamic_cast<const FuncCall*>(e)) {
+    if (auto f = e->as<FuncCall>()) {
         return rewriteFuncCall(f);
     }
-    if (auto n = dynamic_cast<const Num*>(e)) {
+    if (auto n = e->as<Num>()) {
         return rewriteNum(n);
     }
-    if (auto s = dynamic_cast<const String*>(e)) {
+    if (auto s = e->as<String>()) {
         return rewriteString(s);
     }
-    if (auto t = dynamic_cast<const Tuple*>(e)) {
+    if (auto t = e->as<Tuple>()) {
         return rewriteTuple(t);
     }
-    if (auto s = dynamic_cast<const Set*>(e)) {
+    if (auto s = e->as<Set>()) {
         return rewriteSet(s);
     }
-    if (auto m = dynamic_cast<const Map*>(e)) {
+    if (auto m = e->as<Map>()) {
         return rewriteMap(m);
     }
-    if (auto bc = dynamic_cast<const BoolConst*>(e)) {
+    if (auto bc = e->as<BoolConst>()) {
         return rewriteBoolConst(bc);
     }
-    if (auto binop = dynamic_cast<const BinaryOpExpr*>(e)) {
+    if (auto binop = e->as<BinaryOpExpr>()) {
         return rewriteBinaryOpExpr(binop);
     }
-    if (auto unop = dynamic_cast<const UnaryOpExpr*>(e)) {
+    if (auto unop = e->as<UnaryOpExpr>()) {
         return rewriteUnaryOpExpr(unop);
     }
     
     
-    // Default: clone as-is
-    CloneVisitor cloner;
+    // Default: nothing to rewrite
     RewriteResult result;
-    result.expr = cloner.cloneExpr(e);
+    result.expr = shareNode(e);
     return result;
 }
 
+bool RewriteGlobalsVisitor::rewriteOperands(const vector<Ref<Expr>>& operands,
+                                            vector<Ref<Expr>>& out,
+                                            RewriteResult& result) {
+    bool changed = false;
+    for (const auto& operand : operands) {
+        auto operandResult = rewriteExpr(operand.get());
+        
+        for (auto& stmt : operandResult.hoistedStmts) {
+            result.hoistedStmts.push_back(move(stmt));
+        }
+        
+        changed |= operandResult.expr.get() != operand.get();
+        out.push_back(move(operandResult.expr));
+    }
+    return changed;
+}
+
 /* ============================================================
  * REWRITE VAR
  * ============================================================ */
@@ -451,7 +515,7 @@ RewriteGlobalsVisitor::rewriteVar(const Var* v) {
         string tmpName = freshTemp(v->name);
         
         // Hoist: tmp := get_G()
-        vector<unique_ptr<Expr>> noArgs;
+        vector<Ref<Expr>> noArgs;
         auto getCall = make_unique<FuncCall>("get_" + v->name, move(noArgs));
         
         result.hoistedStmts.push_back(
@@ -464,8 +528,8 @@ RewriteGlobalsVisitor::rewriteVar(const Var* v) {
         // Return tmp
         result.expr = make_unique<Var>(tmpName);
     } else {
-        // Not a global, clone as-is
-        result.expr = make_unique<Var>(v->name);
+        // Not a global, keep as-is
+        result.expr = shareNode(v);
     }
     
     return result;
@@ -487,23 +551,14 @@ RewriteGlobalsVisitor::rewriteFuncCall(const FuncCall* f) {
     
     // General function call: rewrite all arguments
     RewriteResult result;
-    vector<unique_ptr<Expr>> newArgs;
+    vector<Ref<Expr>> newArgs;
     
-    for (const auto& arg : f->args) {
-        auto argResult = rewriteExpr(arg.get());
-        
-        // Collect hoisted statements
-        for (auto& stmt : argResult.hoistedStmts) {
-            result.hoistedStmts.push_back(move(stmt));
-        }
-        
-        // Collect rewritten argument
-        newArgs.push_back(move(argResult.expr));
+    if (rewriteOperands(f->args, newArgs, result)) {
+        result.expr = make_unique<FuncCall>(f->name, move(newArgs));
+    } else {
+        result.expr = shareNode(f);
     }
     
-    // Create new function call with rewritten args
-    result.expr = make_unique<FuncCall>(f->name, move(newArgs));
-    
     return result;
 }
 
@@ -517,8 +572,7 @@ RewriteGlobalsVisitor::rewriteMapAccess(const FuncCall* f) {
     
     if (f->args.size() != 2) {
         // Malformed [], shouldn't happen
-        CloneVisitor cloner;
-        result.expr = cloner.cloneExpr(f);
+        result.expr = shareNode(f);
         return result;
     }
     
@@ -526,12 +580,12 @@ RewriteGlobalsVisitor::rewriteMapAccess(const FuncCall* f) {
     const Expr* key = f->args[1].get();
     
     // Check if base is a global
-    if (const Var* baseVar = dynamic_cast<const Var*>(base)) {
+    if (const Var* baseVar = base->as<Var>()) {
         if (globals.count(baseVar->name)) {
             // Hoist: tmp := get_G()
             string tmpName = freshTemp(baseVar->name);
             
-            vector<unique_ptr<Expr>> noArgs;
+            vector<Ref<Expr>> noArgs;
             auto getCall = make_unique<FuncCall>("get_" + baseVar->name, move(noArgs));
             
             result.hoistedStmts.push_back(
@@ -548,7 +602,7 @@ RewriteGlobalsVisitor::rewriteMapAccess(const FuncCall* f) {
             }
             
             // Return: tmp[key']
-            vector<unique_ptr<Expr>> indexArgs;
+            vector<Ref<Expr>> indexArgs;
             indexArgs.push_back(make_unique<Var>(tmpName));
             indexArgs.push_back(move(keyResult.expr));
             
@@ -568,7 +622,12 @@ RewriteGlobalsVisitor::rewriteMapAccess(const FuncCall* f) {
         result.hoistedStmts.push_back(move(stmt));
     }
     
-    vector<unique_ptr<Expr>> indexArgs;
+    if (baseResult.expr.get() == base && keyResult.expr.get() == key) {
+        result.expr = shareNode(f);
+        return result;
+    }
+    
+    vector<Ref<Expr>> indexArgs;
     indexArgs.push_back(move(baseResult.expr));
     indexArgs.push_back(move(keyResult.expr));
     
@@ -585,20 +644,19 @@ RewriteGlobalsVisitor::rewriteDom(const FuncCall* f) {
     RewriteResult result;
     
     if (f->args.size() != 1) {
-        CloneVisitor cloner;
-        result.expr = cloner.cloneExpr(f);
+        result.expr = shareNode(f);
         return result;
     }
     
     const Expr* base = f->args[0].get();
     
     // Check if base is a global
-    if (const Var* baseVar = dynamic_cast<const Var*>(base)) {
+    if (const Var* baseVar = base->as<Var>()) {
         if (globals.count(baseVar->name)) {
             // Hoist: tmp := get_G()
             string tmpName = freshTemp(baseVar->name);
             
-            vector<unique_ptr<Expr>> noArgs;
+            vector<Ref<Expr>> noArgs;
             auto getCall = make_unique<FuncCall>("get_" + baseVar->name, move(noArgs));
             
             result.hoistedStmts.push_back(
@@ -609,7 +667,7 @@ RewriteGlobalsVisitor::rewriteDom(const FuncCall* f) {
             );
             
             // Return: dom(tmp)
-            vector<unique_ptr<Expr>> domArgs;
+            vector<Ref<Expr>> domArgs;
             domArgs.push_back(make_unique<Var>(tmpName));
             
             result.expr = make_unique<FuncCall>("dom", move(domArgs));
@@ -624,7 +682,12 @@ RewriteGlobalsVisitor::rewriteDom(const FuncCall* f) {
         result.hoistedStmts.push_back(move(stmt));
     }
     
-    vector<unique_ptr<Expr>> domArgs;
+    if (argResult.expr.get() == base) {
+        result.expr = shareNode(f);
+        return result;
+    }
+    
+    vector<Ref<Expr>> domArgs;
     domArgs.push_back(move(argResult.expr));
     
     result.expr = make_unique<FuncCall>("dom", move(domArgs));
@@ -638,14 +701,14 @@ RewriteGlobalsVisitor::rewriteDom(const FuncCall* f) {
 RewriteGlobalsVisitor::RewriteResult
 RewriteGlobalsVisitor::rewriteNum(const Num* n) {
     RewriteResult result;
-    result.expr = make_unique<Num>(n->value);
+    result.expr = shareNode(n);
     return result;
 }
 
 RewriteGlobalsVisitor::RewriteResult
 RewriteGlobalsVisitor::rewriteString(const String* s) {
     RewriteResult result;
-    result.expr = make_unique<String>(s->value);
+    result.expr = shareNode(s);
     return result;
 }
 
@@ -656,19 +719,13 @@ RewriteGlobalsVisitor::rewriteString(const String* s) {
 RewriteGlobalsVisitor::RewriteResult
 RewriteGlobalsVisitor::rewriteTuple(const Tuple* t) {
     RewriteResult result;
-    vector<unique_ptr<Expr>> newElements;
+    vector<Ref<Expr>> newElements;
     
-    for (const auto& elem : t->exprs) {
-        auto elemResult = rewriteExpr(elem.get());
-        
-        for (auto& stmt : elemResult.hoistedStmts) {
-            result.hoistedStmts.push_back(move(stmt));
-        }
-        
-        newElements.push_back(move(elemResult.expr));
+    if (rewriteOperands(t->exprs, newElements, result)) {
+        result.expr = make_unique<Tuple>(move(newElements));
+    } else {
+        result.expr = shareNode(t);
     }
-    
-    result.expr = make_unique<Tuple>(move(newElements));
     return result;
 }
 
@@ -679,25 +736,19 @@ RewriteGlobalsVisitor::rewriteTuple(const Tuple* t) {
 RewriteGlobalsVisitor::RewriteResult
 RewriteGlobalsVisitor::rewriteSet(const Set* s) {
     RewriteResult result;
-    vector<unique_ptr<Expr>> newElements;
+    vector<Ref<Expr>> newElements;
     
-    for (const auto& elem : s->elements) {
-        auto elemResult = rewriteExpr(elem.get());
-        
-        for (auto& stmt : elemResult.hoistedStmts) {
-            result.hoistedStmts.push_back(move(stmt));
-        }
-        
-        newElements.push_back(move(elemResult.expr));
+    if (rewriteOperands(s->elements, newElements, result)) {
+        result.expr = make_unique<Set>(move(newElements));
+    } else {
+        result.expr = shareNode(s);
     }
-    
-    result.expr = make_unique<Set>(move(newElements));
     return result;
 }
 
 RewriteGlobalsVisitor::RewriteResult RewriteGlobalsVisitor::rewriteBoolConst(const BoolConst* bc) {
     RewriteResult result;
-    result.expr = make_unique<BoolConst>(bc->value);
+    result.expr = shareNode(bc);
     return result;
 }
 
@@ -713,6 +764,12 @@ RewriteGlobalsVisitor::RewriteResult RewriteGlobalsVisitor::rewriteBinaryOpExpr(
         result.hoistedStmts.push_back(std::move(stmt));
     }
     
+    if (leftResult.expr.get() == binop->left.get() &&
+        rightResult.expr.get() == binop->right.get()) {
+        result.expr = shareNode(binop);
+        return result;
+    }
+    
     result.expr = make_unique<BinaryOpExpr>(
         binop->op,
         std::move(leftResult.expr),
@@ -730,6 +787,11 @@ RewriteGlobalsVisitor::RewriteResult RewriteGlobalsVisitor::rewriteUnaryOpExpr(c
         result.hoistedStmts.push_back(std::move(stmt));
     }
     
+    if (operandResult.expr.get() == unop->operand.get()) {
+        result.expr = shareNode(unop);
+        return result;
+    }
+    
     result.expr = make_unique<UnaryOpExpr>(
         unop->op,
         std::move(operandResult.expr)
@@ -745,7 +807,8 @@ RewriteGlobalsVisitor::RewriteResult RewriteGlobalsVisitor::rewriteUnaryOpExpr(c
 RewriteGlobalsVisitor::RewriteResult
 RewriteGlobalsVisitor::rewriteMap(const Map* m) {
     RewriteResult result;
-    vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> newPairs;
+    vector<pair<Ref<Var>, Ref<Expr>>> newPairs;
+    bool changed = false;
     
     for (const auto& kv : m->value) {
         // Rewrite key (should be Var, but rewrite anyway)
@@ -761,19 +824,22 @@ RewriteGlobalsVisitor::rewriteMap(const Map* m) {
         }
         
         // Key must be Var for Map AST
-        Var* keyVar = dynamic_cast<Var*>(keyResult.expr.get());
+        Var* keyVar = keyResult.expr->as<Var>();
         if (!keyVar) {
             throw runtime_error("Map key must be Var after rewrite");
         }
         
-        unique_ptr<Var> keyOwned(static_cast<Var*>(keyResult.expr.release()));
-        
+        changed |= keyVar != kv.first.get() || valResult.expr.get() != kv.second.get();
         newPairs.push_back({
-            move(keyOwned),
+            shareNode(keyVar),
             move(valResult.expr)
         });
     }
     
-    result.expr = make_unique<Map>(move(newPairs));
+    if (changed) {
+        result.expr = make_unique<Map>(move(newPairs));
+    } else {
+        result.expr = shareNode(m);
+    }
     return result;
 }
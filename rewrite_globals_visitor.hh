@@ -23,9 +23,11 @@
  * 3. Prepend: _ := reset()
  * 4. Rewrite reads:  U[k]  →  tmp_U_i := get_U(); ... tmp_U_i[k]
  * 5. Rewrite writes: U[k] = v  →  tmp := get_U(); tmp[k] := v; set_U(tmp)
+ * 6. Optional restore point: reset() becomes restore(id) and everything up
+ *    to `_ := checkpoint(id)` is replaced by the stored concrete prefix
  * 
  * KEY IMPROVEMENTS:
- * - Uses CloneVisitor for all AST copying
+ * - Shares every subtree the rewrite leaves alone instead of copying it
  * - Proper temp variable counters per global
  * - Hoists all get_G() to statement level
  * - Handles nested expressions correctly
@@ -42,6 +44,20 @@ public:
     // Main entry point
     void visitProgram(const Program& p) override;
 
+    // Start from checkpoint `id` instead of reset(). `prefix` is the concrete
+    // prefix recorded with the checkpoint, ending in `_ := checkpoint(id)`.
+    void setRestorePoint(const std::string& id,
+                         const std::vector<Ref<Stmt>>* prefix);
+
+    // Temps are named tmp_G_<marker><n>; a non-empty marker lets ATC
+    // templates find and renumber them (tmp_U_0 by default)
+    void setTempMarker(const std::string& marker) { tempMarker = marker; }
+
+    // Replace stmts[1 .. `_ := checkpoint(id)`] with the statements of `prefix`
+    static void spliceRestorePrefix(std::vector<Ref<Stmt>>& stmts,
+                                    const std::string& id,
+                                    const std::vector<Ref<Stmt>>& prefix);
+
 private:
     // === STATE ===
     
@@ -52,7 +68,17 @@ private:
     std::map<std::string, int> tmpCounters;
     
     // Output statements buffer
-    std::vector<std::unique_ptr<Stmt>> newStmts;
+    std::vector<Ref<Stmt>> newStmts;
+
+    // Restore point (empty id → plain reset)
+    std::string restoreId;
+    const std::vector<Ref<Stmt>>* restorePrefix = nullptr;
+    
+    std::string tempMarker;
+    
+    // Index of `_ := checkpoint(id)` in stmts, or -1
+    static int findCheckpoint(const std::vector<Ref<Stmt>>& stmts,
+                              const std::string& id);
     
     // === HELPERS ===
     
@@ -85,14 +111,21 @@ private:
      * Returns: (rewritten_expr, hoisted_stmts)
      * 
      * hoisted_stmts must be inserted BEFORE the statement using rewritten_expr.
+     * A subtree without globals comes back as the very node passed in.
      */
     struct RewriteResult {
-        std::unique_ptr<Expr> expr;
-        std::vector<std::unique_ptr<Stmt>> hoistedStmts;
+        Ref<Expr> expr;
+        std::vector<Ref<Stmt>> hoistedStmts;
     };
     
     RewriteResult rewriteExpr(const Expr* e);
     
+    // Rewrite operands left to right into `out`, hoisting into `result`;
+    // false when every operand came back unchanged
+    bool rewriteOperands(const std::vector<Ref<Expr>>& operands,
+                         std::vector<Ref<Expr>>& out,
+                         RewriteResult& result);
+    
     // Specific expression rewriters
     RewriteResult rewriteVar(const Var* v);
     RewriteResult rewriteFuncCall(const FuncCall* f);
@@ -119,8 +152,8 @@ private:
      */
     struct MapUpdateInfo {
         std::string globalName;  // "U", "T", etc.
-        std::unique_ptr<Expr> key;    // email (for U[email] = pass)
-        std::unique_ptr<Expr> value;  // password
+        Ref<Expr> key;           // email (for U[email] = pass)
+        Ref<Expr> value;         // password
         bool isMapUpdate;        // true if G[k]=v, false if G=expr
     };
     
@@ -130,12 +163,12 @@ private:
     
     // Rewrite: G[k] = v  →  tmp := get_G(); tmp[k] := v; set_G(tmp)
     void emitMapUpdate(const std::string& globalName,
-                      std::unique_ptr<Expr> key,
-                      std::unique_ptr<Expr> value);
+                      Ref<Expr> key,
+                      Ref<Expr> value);
     
     // Rewrite: G := expr  →  set_G(expr')
     void emitMapReplace(const std::string& globalName,
-                       std::unique_ptr<Expr> expr);
+                       Ref<Expr> expr);
     
     // === REQUIRED VISITOR OVERRIDES (No-ops) ===
     
@@ -1,5 +1,6 @@
 #include "ecommercefunctionfactory.hh"
 #include <iostream>
+#include <set>
 #include <stdexcept>
 
 using namespace std;
@@ -17,12 +18,12 @@ string EcommerceAPIFunction::extractString(Expr* expr) {
         throw runtime_error("Null expression in extractString");
 
     if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
+        String* str = expr->as<String>();
         return str->value;
     }
 
     if (expr->exprType == ExprType::VAR) {
-        Var* var = dynamic_cast<Var*>(expr);
+        Var* var = expr->as<Var>();
         return var->name;
     }
 
@@ -34,50 +35,13 @@ int EcommerceAPIFunction::extractInt(Expr* expr) {
         throw runtime_error("Null expression in extractInt");
 
     if (expr->exprType == ExprType::NUM) {
-        Num* num = dynamic_cast<Num*>(expr);
+        Num* num = expr->as<Num>();
         return num->value;
     }
 
     throw runtime_error("Expected NUM expression");
 }
 
-json EcommerceAPIFunction::extractJson(Expr* expr) {
-    if (!expr)
-        return json::object();
-
-    if (expr->exprType == ExprType::MAP) {
-        Map* map = dynamic_cast<Map*>(expr);
-        json obj = json::object();
-
-        for (const auto& kv : map->value) {
-            string key = kv.first->name;
-
-            if (kv.second->exprType == ExprType::STRING) {
-                String* val = dynamic_cast<String*>(kv.second.get());
-                obj[key] = val->value;
-            } else if (kv.second->exprType == ExprType::NUM) {
-                Num* val = dynamic_cast<Num*>(kv.second.get());
-                obj[key] = val->value;
-            } else {
-                obj[key] = "unsupported_type";
-            }
-        }
-
-        return obj;
-    }
-
-    if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
-        try {
-            return json::parse(str->value);
-        } catch (...) {
-            return str->value;
-        }
-    }
-
-    return json::object();
-}
-
 string EcommerceAPIFunction::getCurrentToken(const string& email) {
     // First check local cache
     auto it = factory->getT().find(email);
@@ -108,6 +72,19 @@ string EcommerceAPIFunction::getCurrentToken(const string& email) {
  * ============================================================ */
 
 // ========== RESET ==========
+void EcommerceFunctionFactory::clearCaches() {
+    getU().clear();
+    getT().clear();
+    getRoles().clear();
+    getP().clear();
+    getStock().clear();
+    getSellers().clear();
+    getC().clear();
+    getO().clear();
+    getOrderStatus().clear();
+    getRev().clear();
+}
+
 ResetFunc::ResetFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
     : EcommerceAPIFunction(factory, args) {}
 
@@ -119,16 +96,7 @@ unique_ptr<Expr> ResetFunc::execute() {
         HttpResponse resp = factory->getHttpClient()->post("/api/test/reset", body);
 
         if (resp.statusCode >= 200 && resp.statusCode < 300) {
-            factory->getU().clear();
-            factory->getT().clear();
-            factory->getRoles().clear();
-            factory->getP().clear();
-            factory->getStock().clear();
-            factory->getSellers().clear();
-            factory->getC().clear();
-            factory->getO().clear();
-            factory->getOrderStatus().clear();
-            factory->getRev().clear();
+            factory->clearCaches();
             return make_unique<Num>(200);
         }
         return make_unique<Num>(resp.statusCode);
@@ -178,13 +146,9 @@ SetUFunc::SetUFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetUFunc::execute() {
     cout << "[SetUFunc] Setting U..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getU().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getU()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_U", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getU());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_U", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetUFunc] Error: " << e.what() << endl;
@@ -232,13 +196,9 @@ SetTFunc::SetTFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetTFunc::execute() {
     cout << "[SetTFunc] Setting T..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getT().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getT()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_T", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getT());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_T", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetTFunc] Error: " << e.what() << endl;
@@ -286,13 +246,9 @@ SetRolesFunc::SetRolesFunc(EcommerceFunctionFactory* factory, vector<Expr*> args
 unique_ptr<Expr> SetRolesFunc::execute() {
     cout << "[SetRolesFunc] Setting Roles..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getRoles().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getRoles()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Roles", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getRoles());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Roles", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetRolesFunc] Error: " << e.what() << endl;
@@ -340,13 +296,9 @@ SetPFunc::SetPFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetPFunc::execute() {
     cout << "[SetPFunc] Setting P..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getP().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getP()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_P", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getP());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_P", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetPFunc] Error: " << e.what() << endl;
@@ -394,13 +346,9 @@ SetStockFunc::SetStockFunc(EcommerceFunctionFactory* factory, vector<Expr*> args
 unique_ptr<Expr> SetStockFunc::execute() {
     cout << "[SetStockFunc] Setting Stock..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getStock().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getStock()[k] = v.get<int>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Stock", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getStock());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Stock", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetStockFunc] Error: " << e.what() << endl;
@@ -448,13 +396,9 @@ SetSellersFunc::SetSellersFunc(EcommerceFunctionFactory* factory, vector<Expr*>
 unique_ptr<Expr> SetSellersFunc::execute() {
     cout << "[SetSellersFunc] Setting Sellers..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getSellers().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getSellers()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Sellers", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getSellers());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Sellers", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetSellersFunc] Error: " << e.what() << endl;
@@ -502,13 +446,9 @@ SetCFunc::SetCFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetCFunc::execute() {
     cout << "[SetCFunc] Setting C..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getC().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getC()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_C", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getC());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_C", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetCFunc] Error: " << e.what() << endl;
@@ -556,13 +496,9 @@ SetOFunc::SetOFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetOFunc::execute() {
     cout << "[SetOFunc] Setting O..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getO().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getO()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_O", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getO());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_O", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetOFunc] Error: " << e.what() << endl;
@@ -610,13 +546,9 @@ SetOrderStatusFunc::SetOrderStatusFunc(EcommerceFunctionFactory* factory, vector
 unique_ptr<Expr> SetOrderStatusFunc::execute() {
     cout << "[SetOrderStatusFunc] Setting OrderStatus..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getOrderStatus().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getOrderStatus()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_OrderStatus", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getOrderStatus());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_OrderStatus", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetOrderStatusFunc] Error: " << e.what() << endl;
@@ -664,13 +596,9 @@ SetRevFunc::SetRevFunc(EcommerceFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetRevFunc::execute() {
     cout << "[SetRevFunc] Setting Rev..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getRev().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getRev()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Rev", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getRev());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Rev", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     } catch (const exception& e) {
         cerr << "[SetRevFunc] Error: " << e.what() << endl;
@@ -1525,56 +1453,71 @@ EcommerceFunctionFactory::EcommerceFunctionFactory(const string& baseUrl)
     cout << "[EcommerceFunctionFactory] Initialized with baseUrl: " << baseUrl << endl;
 }
 
+bool EcommerceFunctionFactory::isReadOnly(const string& fname) const {
+    static const set<string> reads = {
+        "getAllProducts", "getProductById", "getSellerProducts", "getCart",
+        "getBuyerOrders", "getSellerOrders", "getProductReviews"};
+    return reads.count(fname) > 0;
+}
+
 unique_ptr<Function> EcommerceFunctionFactory::getFunction(string fname, vector<Expr*> args) {
     cout << "[Factory] Creating function: " << fname << endl;
 
-    // Test API functions
-    if (fname == "reset") return make_unique<ResetFunc>(this, args);
-    if (fname == "get_U") return make_unique<GetUFunc>(this, args);
-    if (fname == "set_U") return make_unique<SetUFunc>(this, args);
-    if (fname == "get_T") return make_unique<GetTFunc>(this, args);
-    if (fname == "set_T") return make_unique<SetTFunc>(this, args);
-    if (fname == "get_Roles") return make_unique<GetRolesFunc>(this, args);
-    if (fname == "set_Roles") return make_unique<SetRolesFunc>(this, args);
-    if (fname == "get_P") return make_unique<GetPFunc>(this, args);
-    if (fname == "set_P") return make_unique<SetPFunc>(this, args);
-    if (fname == "get_Stock") return make_unique<GetStockFunc>(this, args);
-    if (fname == "set_Stock") return make_unique<SetStockFunc>(this, args);
-    if (fname == "get_Sellers") return make_unique<GetSellersFunc>(this, args);
-    if (fname == "set_Sellers") return make_unique<SetSellersFunc>(this, args);
-    if (fname == "get_C") return make_unique<GetCFunc>(this, args);
-    if (fname == "set_C") return make_unique<SetCFunc>(this, args);
-    if (fname == "get_O") return make_unique<GetOFunc>(this, args);
-    if (fname == "set_O") return make_unique<SetOFunc>(this, args);
-    if (fname == "get_OrderStatus") return make_unique<GetOrderStatusFunc>(this, args);
-    if (fname == "set_OrderStatus") return make_unique<SetOrderStatusFunc>(this, args);
-    if (fname == "get_Rev") return make_unique<GetRevFunc>(this, args);
-    if (fname == "set_Rev") return make_unique<SetRevFunc>(this, args);
-
-    // Business API functions
-    if (fname == "registerBuyer") return make_unique<RegisterBuyerFunc>(this, args);
-    if (fname == "registerSeller") return make_unique<RegisterSellerFunc>(this, args);
-    if (fname == "login") return make_unique<LoginFunc>(this, args);
-    if (fname == "getAllProducts") return make_unique<GetAllProductsFunc>(this, args);
-    if (fname == "getProductById") return make_unique<GetProductByIdFunc>(this, args);
-    if (fname == "createProduct") return make_unique<CreateProductFunc>(this, args);
-    if (fname == "updateProduct") return make_unique<UpdateProductFunc>(this, args);
-    if (fname == "deleteProduct") return make_unique<DeleteProductFunc>(this, args);
-    if (fname == "getSellerProducts") return make_unique<GetSellerProductsFunc>(this, args);
-    if (fname == "addToCart") return make_unique<AddToCartFunc>(this, args);
-    if (fname == "getCart") return make_unique<GetCartFunc>(this, args);
-    if (fname == "updateCart") return make_unique<UpdateCartFunc>(this, args);
-    if (fname == "createOrder") return make_unique<CreateOrderFunc>(this, args);
-    if (fname == "getBuyerOrders") return make_unique<GetBuyerOrdersFunc>(this, args);
-    if (fname == "getSellerOrders") return make_unique<GetSellerOrdersFunc>(this, args);
-    if (fname == "updateOrderStatus") return make_unique<UpdateOrderStatusFunc>(this, args);
-    if (fname == "createReview") return make_unique<CreateReviewFunc>(this, args);
-    if (fname == "getProductReviews") return make_unique<GetProductReviewsFunc>(this, args);
-
-    // Bug detection functions
-    if (fname == "checkOrderTotal") return make_unique<CheckOrderTotalFunc>(this, args);
-    if (fname == "addToCartMaxStock") return make_unique<AddToCartMaxStockFunc>(this, args);
-    if (fname == "deleteProductByBuyer") return make_unique<DeleteProductByBuyerFunc>(this, args);
+    static const FunctionTable<EcommerceFunctionFactory> functions = {
+        // Test API functions
+        {"reset", &makeFunction<ResetFunc>},
+        {"checkpoint", &makeCheckpoint<EcommerceFunctionFactory>},
+        {"restore", &makeRestore<EcommerceFunctionFactory>},
+        {"get_U", &makeFunction<GetUFunc>},
+        {"set_U", &makeFunction<SetUFunc>},
+        {"get_T", &makeFunction<GetTFunc>},
+        {"set_T", &makeFunction<SetTFunc>},
+        {"get_Roles", &makeFunction<GetRolesFunc>},
+        {"set_Roles", &makeFunction<SetRolesFunc>},
+        {"get_P", &makeFunction<GetPFunc>},
+        {"set_P", &makeFunction<SetPFunc>},
+        {"get_Stock", &makeFunction<GetStockFunc>},
+        {"set_Stock", &makeFunction<SetStockFunc>},
+        {"get_Sellers", &makeFunction<GetSellersFunc>},
+        {"set_Sellers", &makeFunction<SetSellersFunc>},
+        {"get_C", &makeFunction<GetCFunc>},
+        {"set_C", &makeFunction<SetCFunc>},
+        {"get_O", &makeFunction<GetOFunc>},
+        {"set_O", &makeFunction<SetOFunc>},
+        {"get_OrderStatus", &makeFunction<GetOrderStatusFunc>},
+        {"set_OrderStatus", &makeFunction<SetOrderStatusFunc>},
+        {"get_Rev", &makeFunction<GetRevFunc>},
+        {"set_Rev", &makeFunction<SetRevFunc>},
+
+        // Business API functions
+        {"registerBuyer", &makeFunction<RegisterBuyerFunc>},
+        {"registerSeller", &makeFunction<RegisterSellerFunc>},
+        {"login", &makeFunction<LoginFunc>},
+        {"getAllProducts", &makeFunction<GetAllProductsFunc>},
+        {"getProductById", &makeFunction<GetProductByIdFunc>},
+        {"createProduct", &makeFunction<CreateProductFunc>},
+        {"updateProduct", &makeFunction<UpdateProductFunc>},
+        {"deleteProduct", &makeFunction<DeleteProductFunc>},
+        {"getSellerProducts", &makeFunction<GetSellerProductsFunc>},
+        {"addToCart", &makeFunction<AddToCartFunc>},
+        {"getCart", &makeFunction<GetCartFunc>},
+        {"updateCart", &makeFunction<UpdateCartFunc>},
+        {"createOrder", &makeFunction<CreateOrderFunc>},
+        {"getBuyerOrders", &makeFunction<GetBuyerOrdersFunc>},
+        {"getSellerOrders", &makeFunction<GetSellerOrdersFunc>},
+        {"updateOrderStatus", &makeFunction<UpdateOrderStatusFunc>},
+        {"createReview", &makeFunction<CreateReviewFunc>},
+        {"getProductReviews", &makeFunction<GetProductReviewsFunc>},
+
+        // Bug detection functions
+        {"checkOrderTotal", &makeFunction<CheckOrderTotalFunc>},
+        {"addToCartMaxStock", &makeFunction<AddToCartMaxStockFunc>},
+        {"deleteProductByBuyer", &makeFunction<DeleteProductByBuyerFunc>},
+    };
+
+    auto it = functions.find(fname);
+    if (it != functions.end())
+        return it->second(this, args);
 
     throw runtime_error("Unknown function: " + fname);
 }
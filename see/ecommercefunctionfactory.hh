@@ -4,6 +4,7 @@
 #include "functionfactory.hh"
 #include "../ast.hh"
 #include "httpclient.hh"
+#include "exprjsonwriter.hh"
 #include <nlohmann/json.hpp>
 #include <memory>
 #include <string>
@@ -31,7 +32,6 @@ public:
     
     string extractString(Expr* expr);
     int extractInt(Expr* expr);
-    json extractJson(Expr* expr);
     string getCurrentToken(const string& email);
 };
 
@@ -305,6 +305,7 @@ class EcommerceFunctionFactory : public FunctionFactory {
 private:
     unique_ptr<HttpClient> httpClient;
     string baseUrl;
+    ExprJsonWriter jsonWriter;  // reused for every set_G payload
     
     map<string, string> U_cache;
     map<string, string> T_cache;
@@ -322,8 +323,12 @@ public:
     ~EcommerceFunctionFactory() = default;
     
     unique_ptr<Function> getFunction(string fname, vector<Expr*> args) override;
+    bool isReadOnly(const string& fname) const override;
     
     HttpClient* getHttpClient() { return httpClient.get(); }
+    // Drops the local copies of the globals; get_G refills them
+    void clearCaches();
+    ExprJsonWriter& getJsonWriter() { return jsonWriter; }
     
     map<string, string>& getU() { return U_cache; }
     map<string, string>& getT() { return T_cache; }
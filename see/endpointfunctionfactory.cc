@@ -0,0 +1,292 @@
+#include "endpointfunctionfactory.hh"
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+/* ============================================================
+ * StringTemplate
+ * ============================================================ */
+
+EndpointFunctionFactory::StringTemplate EndpointFunctionFactory::StringTemplate::compile(const string& source) {
+    StringTemplate t;
+    string current;
+    size_t i = 0;
+    while (i < source.size()) {
+        size_t close = source.find('}', i);
+        if (source[i] == '{' && close != string::npos && close > i + 1 &&
+            source.find_first_not_of("0123456789", i + 1) == close) {
+            t.text.push_back(current);
+            t.slots.push_back(stoi(source.substr(i + 1, close - i - 1)));
+            current.clear();
+            i = close + 1;
+            continue;
+        }
+        current += source[i++];
+    }
+    t.text.push_back(current);
+    if (t.slots.size() == 1 && t.text[0].empty() && t.text[1].empty())
+        t.wholeArg = t.slots[0];
+    return t;
+}
+
+string EndpointFunctionFactory::StringTemplate::expand(const vector<string>& args) const {
+    string out = text[0];
+    for (size_t i = 0; i < slots.size(); i++)
+        out += args[slots[i]] + text[i + 1];
+    return out;
+}
+
+int EndpointFunctionFactory::StringTemplate::maxArg() const {
+    int m = -1;
+    for (int s : slots)
+        m = max(m, s);
+    return m;
+}
+
+/* ============================================================
+ * Functions
+ * ============================================================ */
+
+class EndpointResetFunc : public Function {
+    EndpointFunctionFactory* factory;
+
+public:
+    EndpointResetFunc(EndpointFunctionFactory* f) : factory(f) {}
+
+    unique_ptr<Expr> execute() override {
+        const string& tag = factory->getApp().tag;
+        cout << "[" << tag << ":reset] POST /api/test/reset" << endl;
+        try {
+            HttpResponse resp = factory->getHttpClient()->post("/api/test/reset", json::object());
+            if (resp.statusCode >= 200 && resp.statusCode < 300) {
+                factory->clearCaches();
+                return make_unique<Num>(200);
+            }
+            return make_unique<Num>(resp.statusCode);
+        } catch (const exception& e) {
+            cerr << "[" << tag << ":reset] Error: " << e.what() << endl;
+            return make_unique<Num>(500);
+        }
+    }
+};
+
+class EndpointGlobalFunc : public Function {
+    EndpointFunctionFactory* factory;
+    const string& global;
+    bool isSet;
+    vector<Expr*> arguments;
+
+public:
+    EndpointGlobalFunc(EndpointFunctionFactory* f, const string& g, bool set, vector<Expr*> a)
+        : factory(f), global(g), isSet(set), arguments(a) {}
+
+    unique_ptr<Expr> execute() override {
+        map<string, string>& cache = factory->getCache(global);
+        if (isSet) {
+            if (arguments.size() < 1)
+                throw runtime_error("set_" + global + " requires 1 argument");
+            factory->getJsonWriter().fillCache(arguments[0], cache);
+            return make_unique<Num>(200);
+        }
+        cout << "[" << factory->getApp().tag << ":get_" << global << "] Fetching " << global << "..." << endl;
+        vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> pairs;
+        for (auto& [k, v] : cache)
+            pairs.push_back(make_pair(make_unique<Var>(k), make_unique<String>(v)));
+        return make_unique<Map>(std::move(pairs));
+    }
+};
+
+class EndpointCallFunc : public Function {
+    EndpointFunctionFactory* factory;
+    const EndpointFunctionFactory::PreparedEndpoint& ep;
+    vector<Expr*> arguments;
+
+    unique_ptr<Expr> fail(int status, const string& message) {
+        if (ep.binding->onFailure == OnFailure::THROW)
+            throw runtime_error("[" + factory->getApp().tag + ":" + ep.binding->name + "] " + message);
+        return make_unique<Num>(status);
+    }
+
+public:
+    EndpointCallFunc(EndpointFunctionFactory* f, const EndpointFunctionFactory::PreparedEndpoint& p, vector<Expr*> a)
+        : factory(f), ep(p), arguments(a) {}
+
+    unique_ptr<Expr> execute() override {
+        const EndpointBinding& b = *ep.binding;
+        const string& tag = factory->getApp().tag;
+        if (arguments.size() < ep.arity)
+            throw runtime_error(b.name + " requires " + to_string(ep.arity) +
+                                (ep.arity == 1 ? " argument" : " arguments"));
+
+        vector<string> args;
+        args.reserve(arguments.size());
+        for (Expr* a : arguments)
+            args.push_back(EndpointFunctionFactory::argString(a));
+
+        string path = ep.path.expand(args);
+        try {
+            map<string, string> headers;
+            if (b.authArg >= 0) {
+                string token = factory->getToken(args[b.authArg]);
+                if (token.empty())
+                    return fail(401, "No token for " + args[b.authArg] + " — user not registered or login failed");
+                headers["Authorization"] = "Bearer " + token;
+            }
+
+            json body = ep.bodyBase;
+            for (const auto& [key, field] : ep.bodyFields)
+                body[key] = field.wholeArg >= 0 ? json(args[field.wholeArg]) : json(field.expand(args));
+
+            HttpClient* http = factory->getHttpClient();
+            HttpResponse resp;
+            switch (b.method) {
+            case HttpMethod::GET:  resp = http->get(path, headers); break;
+            case HttpMethod::POST: resp = http->post(path, body, headers); break;
+            case HttpMethod::PUT:  resp = http->put(path, body, headers); break;
+            case HttpMethod::DEL:  resp = http->del(path, headers); break;
+            }
+            cout << "[" << tag << ":" << b.name << "] " << path << " -> " << resp.statusCode << endl;
+
+            if (resp.statusCode != 200)
+                return fail(resp.statusCode, "API call failed: " + to_string(resp.statusCode) + " " + resp.body);
+
+            if (b.resultArg < 0 && b.resultField.empty() && b.tokenField.empty())
+                return make_unique<Num>(200);
+
+            json data = resp.getJson();
+            if (!b.tokenField.empty())
+                factory->getCache(factory->getApp().tokenCache)[args[0]] = data[b.tokenField].get<string>();
+
+            string result = b.resultArg >= 0 ? args[b.resultArg]
+                          : !b.resultField.empty() ? data[b.resultField].get<string>() : "";
+            for (const string& g : b.record)
+                factory->getCache(g)[result] = result;
+            if (result.empty())
+                return make_unique<Num>(200);
+            return make_unique<String>(result);
+        } catch (const exception& e) {
+            if (b.onFailure == OnFailure::THROW) {
+                if (dynamic_cast<const runtime_error*>(&e))
+                    throw;
+                throw runtime_error("[" + tag + ":" + b.name + "] Error: " + e.what());
+            }
+            cerr << "[" << tag << ":" << b.name << "] Error: " << e.what() << endl;
+            return make_unique<Num>(500);
+        }
+    }
+};
+
+/* ============================================================
+ * EndpointFunctionFactory
+ * ============================================================ */
+
+EndpointFunctionFactory::EndpointFunctionFactory(const EndpointApp& a, const string& url)
+    : app(a), baseUrl(url) {
+    httpClient = make_unique<HttpClient>(url);
+
+    handlers["reset"] = {Kind::RESET, 0};
+    handlers["checkpoint"] = {Kind::CHECKPOINT, 0};
+    handlers["restore"] = {Kind::RESTORE, 0};
+    for (size_t i = 0; i < app.globals.size(); i++) {
+        handlers["get_" + app.globals[i]] = {Kind::GET_GLOBAL, i};
+        handlers["set_" + app.globals[i]] = {Kind::SET_GLOBAL, i};
+        caches[app.globals[i]];
+    }
+    if (!app.tokenCache.empty())
+        caches[app.tokenCache];
+
+    prepared.reserve(app.endpoints.size());
+    for (const EndpointBinding& b : app.endpoints) {
+        PreparedEndpoint p;
+        p.binding = &b;
+        p.path = StringTemplate::compile(b.path);
+        int maxArg = max(p.path.maxArg(), max(b.authArg, b.resultArg));
+        if (!b.tokenField.empty())
+            maxArg = max(maxArg, 0);
+        p.bodyBase = json::object();
+        for (auto& [key, value] : b.body.items()) {
+            if (value.is_string()) {
+                StringTemplate t = StringTemplate::compile(value.get<string>());
+                if (!t.slots.empty()) {
+                    maxArg = max(maxArg, t.maxArg());
+                    p.bodyFields.push_back({key, t});
+                    continue;
+                }
+            }
+            p.bodyBase[key] = value;
+        }
+        p.arity = maxArg + 1;
+
+        if (handlers.count(b.name))
+            throw runtime_error("EndpointFunctionFactory: duplicate function: " + b.name);
+        handlers[b.name] = {Kind::ENDPOINT, prepared.size()};
+        prepared.push_back(std::move(p));
+    }
+}
+
+unique_ptr<Function> EndpointFunctionFactory::getFunction(string fname, vector<Expr*> args) {
+    auto it = handlers.find(fname);
+    if (it == handlers.end())
+        throw runtime_error("EndpointFunctionFactory(" + app.tag + "): unknown function: " + fname);
+
+    const Handler& h = it->second;
+    switch (h.kind) {
+    case Kind::RESET:
+        return make_unique<EndpointResetFunc>(this);
+    case Kind::CHECKPOINT:
+        return makeCheckpoint(this, args);
+    case Kind::RESTORE:
+        return makeRestore(this, args);
+    case Kind::GET_GLOBAL:
+    case Kind::SET_GLOBAL:
+        return make_unique<EndpointGlobalFunc>(this, app.globals[h.index], h.kind == Kind::SET_GLOBAL, args);
+    case Kind::ENDPOINT:
+        return make_unique<EndpointCallFunc>(this, prepared[h.index], args);
+    }
+    return nullptr;
+}
+
+bool EndpointFunctionFactory::isReadOnly(const string& fname) const {
+    auto it = handlers.find(fname);
+    return it != handlers.end() && it->second.kind == Kind::ENDPOINT &&
+           prepared[it->second.index].binding->method == HttpMethod::GET;
+}
+
+void EndpointFunctionFactory::clearCaches() {
+    for (auto& entry : caches)
+        entry.second.clear();
+}
+
+string EndpointFunctionFactory::getToken(const string& principal) {
+    map<string, string>& tokens = caches[app.tokenCache];
+    // 1. Local token cache
+    auto it = tokens.find(principal);
+    if (it != tokens.end() && !it->second.empty())
+        return it->second;
+    if (app.tokenRefreshPath.empty())
+        return "";
+    // 2. Fetch every token from the server
+    HttpResponse resp = httpClient->get(app.tokenRefreshPath);
+    if (resp.statusCode == 200) {
+        json data = resp.getJson();
+        for (auto& [k, v] : data.items())
+            if (v.is_string())
+                tokens[k] = v.get<string>();
+        it = tokens.find(principal);
+        if (it != tokens.end())
+            return it->second;
+    }
+    return "";
+}
+
+string EndpointFunctionFactory::argString(Expr* expr) {
+    if (!expr) throw runtime_error("Null expression in argString");
+    if (expr->exprType == ExprType::STRING)
+        return expr->as<String>()->value;
+    if (expr->exprType == ExprType::VAR)
+        return expr->as<Var>()->name;
+    if (expr->exprType == ExprType::NUM)
+        return to_string(expr->as<Num>()->value);
+    throw runtime_error("Expected STRING, NUM or VAR expression");
+}
@@ -0,0 +1,123 @@
+#ifndef ENDPOINTFUNCTIONFACTORY_HH
+#define ENDPOINTFUNCTIONFACTORY_HH
+
+#include "functionfactory.hh"
+#include "../ast.hh"
+#include "httpclient.hh"
+#include "exprjsonwriter.hh"
+#include <nlohmann/json.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * Endpoint bindings
+ *
+ * A whole app described as data: the globals mirrored by get_G/set_G,
+ * the token cache, and one row per business call. Strings in `path` and
+ * `body` are templates where "{i}" is the i-th call argument, e.g.
+ *   {"confirmBooking", HttpMethod::POST, "/api/bookings/{1}/confirm"}
+ * A body value that is exactly "{i}" is replaced by the argument itself.
+ * ============================================================ */
+
+enum class HttpMethod { GET, POST, PUT, DEL };
+
+enum class OnFailure {
+    STATUS,  // return the status code (401 when there is no token), 500 on error
+    THROW    // no token or non-200 is a runtime_error
+};
+
+struct EndpointBinding {
+    string name;                  // function name used by the spec
+    HttpMethod method = HttpMethod::GET;
+    string path;                  // path template
+    json body = json::object();   // body template (ignored for GET/DEL)
+    int authArg = -1;             // args[i] is the principal whose bearer token is sent
+    OnFailure onFailure = OnFailure::STATUS;
+
+    // On 200: result is args[resultArg], else response[resultField], else
+    // the status code. tokenField stores response[tokenField] as the token
+    // of args[0]; `record` adds result -> result to each listed global.
+    int resultArg = -1;
+    string resultField;
+    string tokenField;
+    vector<string> record;
+};
+
+struct EndpointApp {
+    string tag;                   // log prefix ("SV")
+    vector<string> globals;       // caches exposed as get_G/set_G
+    string tokenCache;            // principal -> JWT cache (cleared on reset)
+    string tokenRefreshPath;      // GET endpoint returning every token, "" = none
+    vector<EndpointBinding> endpoints;
+};
+
+/* ============================================================
+ * EndpointFunctionFactory
+ *
+ * Generic FunctionFactory driven by an EndpointApp. Templates are compiled
+ * once at construction and getFunction is a single hash lookup.
+ * ============================================================ */
+class EndpointFunctionFactory : public FunctionFactory {
+public:
+    // "{i}" template, pre-split into literal text and argument slots
+    struct StringTemplate {
+        vector<string> text;      // text.size() == slots.size() + 1
+        vector<int> slots;
+        int wholeArg = -1;        // template is exactly "{i}"
+
+        static StringTemplate compile(const string& source);
+        string expand(const vector<string>& args) const;
+        int maxArg() const;
+    };
+
+    struct PreparedEndpoint {
+        const EndpointBinding* binding;
+        StringTemplate path;
+        json bodyBase;            // literal fields, copied per call
+        vector<pair<string, StringTemplate>> bodyFields;
+        size_t arity = 0;         // arguments the call needs
+    };
+
+    enum class Kind { RESET, CHECKPOINT, RESTORE, GET_GLOBAL, SET_GLOBAL, ENDPOINT };
+
+    struct Handler {
+        Kind kind;
+        size_t index;             // into `prepared` or the global name list
+    };
+
+private:
+    EndpointApp app;
+    unique_ptr<HttpClient> httpClient;
+    string baseUrl;
+    ExprJsonWriter jsonWriter;    // fills the set_G caches
+
+    vector<PreparedEndpoint> prepared;
+    unordered_map<string, Handler> handlers;
+    unordered_map<string, map<string, string>> caches;
+
+public:
+    EndpointFunctionFactory(const EndpointApp& app, const string& baseUrl);
+    virtual ~EndpointFunctionFactory() = default;
+
+    unique_ptr<Function> getFunction(string fname, vector<Expr*> args) override;
+    bool isReadOnly(const string& fname) const override;
+
+    const EndpointApp& getApp() const { return app; }
+    HttpClient* getHttpClient() { return httpClient.get(); }
+    const vector<PreparedEndpoint>& getPrepared() const { return prepared; }
+    map<string, string>& getCache(const string& global) { return caches[global]; }
+    ExprJsonWriter& getJsonWriter() { return jsonWriter; }
+
+    void clearCaches();
+    string getToken(const string& principal);
+
+    static string argString(Expr* expr);
+};
+
+#endif // ENDPOINTFUNCTIONFACTORY_HH
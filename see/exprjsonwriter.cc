@@ -0,0 +1,172 @@
+#include "exprjsonwriter.hh"
+
+using namespace std;
+
+void ExprJsonWriter::writeString(const string& s) {
+    static const char* hex = "0123456789abcdef";
+    buffer += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"':  buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\b': buffer += "\\b"; break;
+        case '\f': buffer += "\\f"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                buffer += "\\u00";
+                buffer += hex[c >> 4];
+                buffer += hex[c & 0xf];
+            } else {
+                buffer += (char)c;
+            }
+        }
+    }
+    buffer += '"';
+}
+
+void ExprJsonWriter::writeValue(const Expr* expr) {
+    if (!expr) {
+        buffer += "null";
+        return;
+    }
+    switch (expr->exprType) {
+    case ExprType::MAP: {
+        const Map* m = static_cast<const Map*>(expr);
+        buffer += '{';
+        for (size_t i = 0; i < m->value.size(); i++) {
+            if (i) buffer += ',';
+            writeString(m->value[i].first->name);
+            buffer += ':';
+            writeValue(m->value[i].second.get());
+        }
+        buffer += '}';
+        return;
+    }
+    case ExprType::SET:
+    case ExprType::TUPLE: {
+        const auto& elements = expr->exprType == ExprType::SET
+            ? static_cast<const Set*>(expr)->elements
+            : static_cast<const Tuple*>(expr)->exprs;
+        buffer += '[';
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (i) buffer += ',';
+            writeValue(elements[i].get());
+        }
+        buffer += ']';
+        return;
+    }
+    case ExprType::STRING:
+        writeString(static_cast<const String*>(expr)->value);
+        return;
+    case ExprType::NUM:
+        buffer += to_string(static_cast<const Num*>(expr)->value);
+        return;
+    case ExprType::BOOL_CONST:
+        buffer += static_cast<const BoolConst*>(expr)->value ? "true" : "false";
+        return;
+    case ExprType::VAR:
+        writeString(static_cast<const Var*>(expr)->name);
+        return;
+    default:
+        buffer += "null";
+    }
+}
+
+const string& ExprJsonWriter::write(const Expr* expr) {
+    buffer.clear();
+    writeValue(expr);
+    return buffer;
+}
+
+const string& ExprJsonWriter::wrap(const string& key, const Expr* expr) {
+    buffer.clear();
+    buffer += '{';
+    writeString(key);
+    buffer += ':';
+    if (expr && expr->exprType == ExprType::STRING &&
+        json::accept(static_cast<const String*>(expr)->value))
+        buffer += static_cast<const String*>(expr)->value;
+    else if (expr && expr->exprType != ExprType::MAP && expr->exprType != ExprType::STRING)
+        buffer += "{}";
+    else
+        writeValue(expr);
+    buffer += '}';
+    return buffer;
+}
+
+void ExprJsonWriter::fillCache(const Expr* expr, map<string, string>& cache) {
+    cache.clear();
+    if (expr && expr->exprType == ExprType::STRING) {
+        json data = json::parse(static_cast<const String*>(expr)->value, nullptr, false);
+        if (data.is_object())
+            for (auto& [k, v] : data.items())
+                cache[k] = v.is_string() ? v.get<string>() : v.dump();
+        return;
+    }
+    if (!expr || expr->exprType != ExprType::MAP)
+        return;
+    for (const auto& kv : static_cast<const Map*>(expr)->value) {
+        const Expr* value = kv.second.get();
+        if (value && value->exprType == ExprType::STRING)
+            cache[kv.first->name] = static_cast<const String*>(value)->value;
+        else if (value && value->exprType == ExprType::VAR)
+            cache[kv.first->name] = static_cast<const Var*>(value)->name;
+        else
+            cache[kv.first->name] = write(value);
+    }
+}
+
+void ExprJsonWriter::fillCache(const Expr* expr, map<string, int>& cache) {
+    cache.clear();
+    if (expr && expr->exprType == ExprType::STRING) {
+        json data = json::parse(static_cast<const String*>(expr)->value, nullptr, false);
+        if (data.is_object())
+            for (auto& [k, v] : data.items())
+                cache[k] = v.get<int>();
+        return;
+    }
+    if (!expr || expr->exprType != ExprType::MAP)
+        return;
+    for (const auto& kv : static_cast<const Map*>(expr)->value) {
+        const Expr* value = kv.second.get();
+        if (!value || value->exprType != ExprType::NUM)
+            throw runtime_error("value of " + kv.first->name + " is not a number");
+        cache[kv.first->name] = static_cast<const Num*>(value)->value;
+    }
+}
+
+json exprToJson(const Expr* expr) {
+    if (!expr)
+        return nullptr;
+    switch (expr->exprType) {
+    case ExprType::MAP: {
+        json obj = json::object();
+        for (const auto& kv : static_cast<const Map*>(expr)->value)
+            obj[kv.first->name] = exprToJson(kv.second.get());
+        return obj;
+    }
+    case ExprType::SET:
+    case ExprType::TUPLE: {
+        const auto& elements = expr->exprType == ExprType::SET
+            ? static_cast<const Set*>(expr)->elements
+            : static_cast<const Tuple*>(expr)->exprs;
+        json arr = json::array();
+        for (const auto& e : elements)
+            arr.push_back(exprToJson(e.get()));
+        return arr;
+    }
+    case ExprType::STRING:
+        return static_cast<const String*>(expr)->value;
+    case ExprType::NUM:
+        return static_cast<const Num*>(expr)->value;
+    case ExprType::BOOL_CONST:
+        return static_cast<const BoolConst*>(expr)->value;
+    case ExprType::VAR:
+        return static_cast<const Var*>(expr)->name;
+    default:
+        return nullptr;
+    }
+}
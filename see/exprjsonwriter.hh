@@ -0,0 +1,51 @@
+#ifndef EXPRJSONWRITER_HH
+#define EXPRJSONWRITER_HH
+
+#include "../ast.hh"
+#include <nlohmann/json.hpp>
+#include <map>
+#include <string>
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * Serializes concrete Exprs straight to JSON text, without building a
+ * json DOM first:
+ *   Map -> object (keys are the Var names), Set/Tuple -> array,
+ *   String -> string, Num -> number, BoolConst -> bool, Var -> string.
+ * Anything else (unevaluated calls, SymVars) is written as null.
+ *
+ * The writer owns its buffer and reuses it across calls, so a factory
+ * that keeps one writer posts every set_G payload without reallocating.
+ */
+class ExprJsonWriter {
+private:
+    string buffer;
+
+    void writeValue(const Expr* expr);
+    void writeString(const string& s);
+
+public:
+    // JSON text of `expr`; valid until the next call on this writer
+    const string& write(const Expr* expr);
+
+    // {"<key>": <expr>} - the test API set_G payload. A String that
+    // already holds JSON text is embedded as-is.
+    const string& wrap(const string& key, const Expr* expr);
+
+    // Replaces `cache` with the entries of a set_G argument, the way the
+    // factories keep them: String values as-is, anything else as JSON
+    // text. A String argument is read as JSON text, as wrap() sends it.
+    // Clobbers the buffer, so call it before wrap().
+    void fillCache(const Expr* expr, map<string, string>& cache);
+    // Same for integer-valued globals; a value that is not a Num throws
+    void fillCache(const Expr* expr, map<string, int>& cache);
+
+    void reserve(size_t n) { buffer.reserve(n); }
+};
+
+// DOM form of the same mapping, for callers that need to inspect values
+json exprToJson(const Expr* expr);
+
+#endif // EXPRJSONWRITER_HH
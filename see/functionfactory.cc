@@ -1,5 +1,6 @@
 #include "../ast.hh" // fixed the include path 
 #include "functionfactory.hh"
+#include "httpclient.hh"
 
 template <typename DerivedType, typename BaseType>
 unique_ptr<DerivedType> dynamic_pointer_cast(std::unique_ptr<BaseType>& basePtr) {
@@ -8,3 +9,23 @@ unique_ptr<DerivedType> dynamic_pointer_cast(std::unique_ptr<BaseType>& basePtr)
     }
     return nullptr;
 }
+
+unique_ptr<Expr> TestApiSnapshotFunc::execute() {
+    string name = op == Op::CHECKPOINT ? "checkpoint" : "restore";
+    if (args.size() < 1 || !args[0] || args[0]->exprType != ExprType::STRING)
+        throw runtime_error(name + " requires 1 string argument (id)");
+    string id = args[0]->cast<String>().value;
+    cout << "[" << name << "] " << client->getBaseUrl() << " id=" << id << endl;
+
+    try {
+        HttpResponse resp = client->post("/api/test/" + name, json{{"id", id}});
+        if (resp.statusCode < 200 || resp.statusCode >= 300)
+            return make_unique<Num>(resp.statusCode);
+        if (op == Op::RESTORE && clearCaches)
+            clearCaches();
+        return make_unique<Num>(200);
+    } catch (const exception& e) {
+        cerr << "[" << name << "] Error: " << e.what() << endl;
+        return make_unique<Num>(500);
+    }
+}
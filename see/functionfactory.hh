@@ -1,12 +1,15 @@
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
 class Expr;
+class HttpClient;
 
 using namespace std;
 class Function {
@@ -21,8 +24,55 @@ class FunctionFactory {
     public:
         virtual unique_ptr<Function> getFunction(string fname, vector<Expr*> args) = 0;
 
+        // Business calls that only read backend state (plain GETs), so the
+        // same call answers the same until something is written
+        virtual bool isReadOnly(const string& fname) const { return false; }
+
     protected:
 };
 
+// Name -> constructor table: O(1) dispatch for factories that implement
+// one Function subclass per API call
+template <typename Factory>
+using FunctionTable = unordered_map<string, unique_ptr<Function> (*)(Factory*, const vector<Expr*>&)>;
+
+template <typename F, typename Factory>
+unique_ptr<Function> makeFunction(Factory* factory, const vector<Expr*>& args) {
+    return make_unique<F>(factory, args);
+}
+
+// checkpoint(id) / restore(id) on an app's test API, POSTing {"id": id} to
+// /api/test/checkpoint or /api/test/restore under the client's base URL.
+// A 404 means the backend lacks the protocol and SEE replays instead.
+// After a successful restore, clearCaches drops the factory's copies of
+// the globals.
+class TestApiSnapshotFunc : public Function {
+    public:
+        enum class Op { CHECKPOINT, RESTORE };
+
+        TestApiSnapshotFunc(Op op, HttpClient* client, function<void()> clearCaches, vector<Expr*> args)
+            : op(op), client(client), clearCaches(std::move(clearCaches)), args(std::move(args)) {}
+        unique_ptr<Expr> execute() override;
+
+    private:
+        Op op;
+        HttpClient* client;
+        function<void()> clearCaches;
+        vector<Expr*> args;
+};
+
+// Table entries for factories with getHttpClient() and clearCaches()
+template <typename Factory>
+unique_ptr<Function> makeCheckpoint(Factory* factory, const vector<Expr*>& args) {
+    return make_unique<TestApiSnapshotFunc>(TestApiSnapshotFunc::Op::CHECKPOINT, factory->getHttpClient(),
+                                            nullptr, args);
+}
+
+template <typename Factory>
+unique_ptr<Function> makeRestore(Factory* factory, const vector<Expr*>& args) {
+    return make_unique<TestApiSnapshotFunc>(TestApiSnapshotFunc::Op::RESTORE, factory->getHttpClient(),
+                                            [factory] { factory->clearCaches(); }, args);
+}
+
 template <typename DerivedType, typename BaseType>
 unique_ptr<DerivedType> dynamic_pointer_cast(std::unique_ptr<BaseType>&);
@@ -1,4 +1,5 @@
 #include "ghostsocketfunctionfactory.hh"
+#include "exprjsonwriter.hh"
 #include <iostream>
 #include <stdexcept>
 
@@ -17,47 +18,18 @@ string GhostSocketAPIFunction::extractString(Expr* expr) {
         throw runtime_error("Null expression in extractString");
 
     if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
+        String* str = expr->as<String>();
         return str->value;
     }
 
     if (expr->exprType == ExprType::VAR) {
-        Var* var = dynamic_cast<Var*>(expr);
+        Var* var = expr->as<Var>();
         return var->name;
     }
 
     throw runtime_error("Expected STRING or VAR expression");
 }
 
-json GhostSocketAPIFunction::extractJson(Expr* expr) {
-    if (!expr) return json::object();
-
-    if (expr->exprType == ExprType::MAP) {
-        Map* map = dynamic_cast<Map*>(expr);
-        json obj = json::object();
-        for (const auto& kv : map->value) {
-            string key = kv.first->name;
-            if (kv.second->exprType == ExprType::STRING) {
-                String* val = dynamic_cast<String*>(kv.second.get());
-                obj[key] = val->value;
-            } else if (kv.second->exprType == ExprType::NUM) {
-                Num* val = dynamic_cast<Num*>(kv.second.get());
-                obj[key] = val->value;
-            } else {
-                obj[key] = "unsupported_type";
-            }
-        }
-        return obj;
-    }
-
-    if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
-        try { return json::parse(str->value); } catch (...) { return str->value; }
-    }
-
-    return json::object();
-}
-
 string GhostSocketAPIFunction::getCurrentToken(const string& email) {
     auto it = factory->getU().find(email);
     if (it != factory->getU().end() && !it->second.empty()) {
@@ -83,6 +55,12 @@ string GhostSocketAPIFunction::getCurrentToken(const string& email) {
  * ============================================================ */
 
 // ========== RESET ==========
+void GhostSocketFunctionFactory::clearCaches() {
+    getU().clear();
+    getD().clear();
+    getS().clear();
+}
+
 ResetFunc::ResetFunc(GhostSocketFunctionFactory* factory, vector<Expr*> args)
     : GhostSocketAPIFunction(factory, args) {}
 
@@ -91,9 +69,7 @@ unique_ptr<Expr> ResetFunc::execute() {
     try {
         HttpResponse resp = factory->getHttpClient()->post("/api/test/reset", json::object());
         if (resp.statusCode >= 200 && resp.statusCode < 300) {
-            factory->getU().clear();
-            factory->getD().clear();
-            factory->getS().clear();
+            factory->clearCaches();
             return make_unique<Num>(200);
         }
         return make_unique<Num>(resp.statusCode);
@@ -135,11 +111,7 @@ SetUFunc::SetUFunc(GhostSocketFunctionFactory* factory, vector<Expr*> args)
 
 unique_ptr<Expr> SetUFunc::execute() {
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getU().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getU()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getU());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[GS:SetUFunc] Error: " << e.what() << endl;
@@ -179,11 +151,7 @@ SetDFunc::SetDFunc(GhostSocketFunctionFactory* factory, vector<Expr*> args)
 
 unique_ptr<Expr> SetDFunc::execute() {
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getD().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getD()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getD());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[GS:SetDFunc] Error: " << e.what() << endl;
@@ -223,11 +191,7 @@ SetSFunc::SetSFunc(GhostSocketFunctionFactory* factory, vector<Expr*> args)
 
 unique_ptr<Expr> SetSFunc::execute() {
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getS().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getS()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getS());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[GS:SetSFunc] Error: " << e.what() << endl;
@@ -584,25 +548,38 @@ GhostSocketFunctionFactory::GhostSocketFunctionFactory(const string& baseUrl)
     httpClient = make_unique<HttpClient>(baseUrl);
 }
 
+bool GhostSocketFunctionFactory::isReadOnly(const string& fname) const {
+    return fname == "getMyDevices" || fname == "getOtherDevices" || fname == "getDeviceInfo" ||
+           fname == "getSessions";
+}
+
 unique_ptr<Function> GhostSocketFunctionFactory::getFunction(string fname, vector<Expr*> args) {
-    if (fname == "reset")               return make_unique<ResetFunc>(this, args);
-    if (fname == "get_U")               return make_unique<GetUFunc>(this, args);
-    if (fname == "set_U")               return make_unique<SetUFunc>(this, args);
-    if (fname == "get_D")               return make_unique<GetDFunc>(this, args);
-    if (fname == "set_D")               return make_unique<SetDFunc>(this, args);
-    if (fname == "get_S")               return make_unique<GetSFunc>(this, args);
-    if (fname == "set_S")               return make_unique<SetSFunc>(this, args);
-    if (fname == "registerUser")        return make_unique<RegisterUserFunc>(this, args);
-    if (fname == "registerDevice")      return make_unique<RegisterDeviceFunc>(this, args);
-    if (fname == "getMyDevices")        return make_unique<GetMyDevicesFunc>(this, args);
-    if (fname == "getOtherDevices")     return make_unique<GetOtherDevicesFunc>(this, args);
-    if (fname == "getDeviceInfo")       return make_unique<GetDeviceInfoFunc>(this, args);
-    if (fname == "deleteDevice")        return make_unique<DeleteDeviceFunc>(this, args);
-    if (fname == "createSession")       return make_unique<CreateSessionFunc>(this, args);
-    if (fname == "joinSession")         return make_unique<JoinSessionFunc>(this, args);
-    if (fname == "getSessions")         return make_unique<GetSessionsFunc>(this, args);
-    if (fname == "terminateSession")    return make_unique<TerminateSessionFunc>(this, args);
-    if (fname == "updatePermissions")   return make_unique<UpdatePermissionsFunc>(this, args);
+    static const FunctionTable<GhostSocketFunctionFactory> functions = {
+        {"reset", &makeFunction<ResetFunc>},
+        {"checkpoint", &makeCheckpoint<GhostSocketFunctionFactory>},
+        {"restore", &makeRestore<GhostSocketFunctionFactory>},
+        {"get_U", &makeFunction<GetUFunc>},
+        {"set_U", &makeFunction<SetUFunc>},
+        {"get_D", &makeFunction<GetDFunc>},
+        {"set_D", &makeFunction<SetDFunc>},
+        {"get_S", &makeFunction<GetSFunc>},
+        {"set_S", &makeFunction<SetSFunc>},
+        {"registerUser", &makeFunction<RegisterUserFunc>},
+        {"registerDevice", &makeFunction<RegisterDeviceFunc>},
+        {"getMyDevices", &makeFunction<GetMyDevicesFunc>},
+        {"getOtherDevices", &makeFunction<GetOtherDevicesFunc>},
+        {"getDeviceInfo", &makeFunction<GetDeviceInfoFunc>},
+        {"deleteDevice", &makeFunction<DeleteDeviceFunc>},
+        {"createSession", &makeFunction<CreateSessionFunc>},
+        {"joinSession", &makeFunction<JoinSessionFunc>},
+        {"getSessions", &makeFunction<GetSessionsFunc>},
+        {"terminateSession", &makeFunction<TerminateSessionFunc>},
+        {"updatePermissions", &makeFunction<UpdatePermissionsFunc>},
+    };
+
+    auto it = functions.find(fname);
+    if (it != functions.end())
+        return it->second(this, args);
 
     throw runtime_error("GhostSocketFunctionFactory: unknown function: " + fname);
 }
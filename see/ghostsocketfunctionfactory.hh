@@ -4,6 +4,7 @@
 #include "functionfactory.hh"
 #include "../ast.hh"
 #include "httpclient.hh"
+#include "exprjsonwriter.hh"
 #include <nlohmann/json.hpp>
 #include <memory>
 #include <string>
@@ -30,7 +31,6 @@ public:
     virtual ~GhostSocketAPIFunction() = default;
 
     string extractString(Expr* expr);
-    json extractJson(Expr* expr);
     string getCurrentToken(const string& email);
 };
 
@@ -157,6 +157,7 @@ class GhostSocketFunctionFactory : public FunctionFactory {
 private:
     unique_ptr<HttpClient> httpClient;
     string baseUrl;
+    ExprJsonWriter jsonWriter;  // fills the set_G caches
 
     map<string, string> U_cache;   // email → token
     map<string, string> D_cache;   // deviceId → deviceId
@@ -167,8 +168,12 @@ public:
     ~GhostSocketFunctionFactory() = default;
 
     unique_ptr<Function> getFunction(string fname, vector<Expr*> args) override;
+    bool isReadOnly(const string& fname) const override;
 
     HttpClient* getHttpClient() { return httpClient.get(); }
+    // Drops the local copies of the globals; get_G refills them
+    void clearCaches();
+    ExprJsonWriter& getJsonWriter() { return jsonWriter; }
 
     map<string, string>& getU() { return U_cache; }
     map<string, string>& getD() { return D_cache; }
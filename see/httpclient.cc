@@ -1,4 +1,6 @@
 #include "httpclient.hh"
+#include "../trace.hh"
+#include "../metrics.hh"
 #include <iostream>
 #include <sstream>
 
@@ -24,6 +26,9 @@ HttpClient::~HttpClient() {
 }
 
 HttpResponse HttpClient::get(const string& endpoint, const map<string, string>& headers) {
+    TRACE_SPAN(span, "HTTP GET", "http");
+    MetricsStopwatch watch;
+    span.arg("endpoint", endpoint);
     HttpResponse response;
     string fullUrl = baseUrl + endpoint;
     string responseBody;
@@ -58,16 +63,26 @@ HttpResponse HttpClient::get(const string& endpoint, const map<string, string>&
     
     response.statusCode = static_cast<int>(statusCode);
     response.body = responseBody;
+    span.arg("status", (long long)response.statusCode);
+    watch.http("GET", endpoint, response.statusCode);
     
     return response;
 }
 
 HttpResponse HttpClient::post(const string& endpoint, const json& body, const map<string, string>& headers) {
+    return postRaw(endpoint, body.dump(), headers);
+}
+
+HttpResponse HttpClient::postRaw(const string& endpoint, const string& requestBody, const map<string, string>& headers) {
+    TRACE_SPAN(span, "HTTP POST", "http");
+    MetricsStopwatch watch;
+    span.arg("endpoint", endpoint);
     HttpResponse response;
     string fullUrl = baseUrl + endpoint;
     string responseBody;
-    string requestBody = body.dump();
-    
+    // Reset CURL state: the last POST/PUT left POSTFIELDS pointing at its
+    // freed body, which a reused handle would send again
+    curl_easy_reset(curl);
     curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
     curl_easy_setopt(curl, CURLOPT_POST, 1L);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestBody.c_str());
@@ -96,6 +111,8 @@ HttpResponse HttpClient::post(const string& endpoint, const json& body, const ma
     
     response.statusCode = static_cast<int>(statusCode);
     response.body = responseBody;
+    span.arg("status", (long long)response.statusCode);
+    watch.http("POST", endpoint, response.statusCode);
     
     cout << "[HttpClient] POST " << endpoint << " -> " << statusCode << endl;
     
@@ -103,11 +120,15 @@ HttpResponse HttpClient::post(const string& endpoint, const json& body, const ma
 }
 
 HttpResponse HttpClient::put(const string& endpoint, const json& body, const map<string, string>& headers) {
+    TRACE_SPAN(span, "HTTP PUT", "http");
+    MetricsStopwatch watch;
+    span.arg("endpoint", endpoint);
     HttpResponse response;
     string fullUrl = baseUrl + endpoint;
     string responseBody;
     string requestBody = body.dump();
-    
+    // Reset CURL state
+    curl_easy_reset(curl);
     curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestBody.c_str());
@@ -135,15 +156,21 @@ HttpResponse HttpClient::put(const string& endpoint, const json& body, const map
     
     response.statusCode = static_cast<int>(statusCode);
     response.body = responseBody;
+    span.arg("status", (long long)response.statusCode);
+    watch.http("PUT", endpoint, response.statusCode);
     
     return response;
 }
 
 HttpResponse HttpClient::del(const string& endpoint, const map<string, string>& headers) {
+    TRACE_SPAN(span, "HTTP DELETE", "http");
+    MetricsStopwatch watch;
+    span.arg("endpoint", endpoint);
     HttpResponse response;
     string fullUrl = baseUrl + endpoint;
     string responseBody;
-    
+    // Reset CURL state
+    curl_easy_reset(curl);
     curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
@@ -173,6 +200,8 @@ HttpResponse HttpClient::del(const string& endpoint, const map<string, string>&
     
     response.statusCode = static_cast<int>(statusCode);
     response.body = responseBody;
+    span.arg("status", (long long)response.statusCode);
+    watch.http("DELETE", endpoint, response.statusCode);
     
     return response;
 }
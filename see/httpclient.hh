@@ -60,6 +60,8 @@ public:
     // HTTP Methods
     HttpResponse get(const string& endpoint, const map<string, string>& headers = {});
     HttpResponse post(const string& endpoint, const json& body, const map<string, string>& headers = {});
+    // POST an already serialized JSON body (see ExprJsonWriter)
+    HttpResponse postRaw(const string& endpoint, const string& body, const map<string, string>& headers = {});
     HttpResponse put(const string& endpoint, const json& body, const map<string, string>& headers = {});
     HttpResponse del(const string& endpoint, const map<string, string>& headers = {});
     
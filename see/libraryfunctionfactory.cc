@@ -1,5 +1,7 @@
 #include "libraryfunctionfactory.hh"
+#include "exprjsonwriter.hh"
 #include <iostream>
+#include <set>
 #include <stdexcept>
 
 using namespace std;
@@ -21,19 +23,19 @@ namespace Library
 
         if (expr->exprType == ExprType::STRING)
         {
-            String *str = dynamic_cast<String *>(expr);
+            String *str = expr->as<String>();
             return str->value;
         }
 
         if (expr->exprType == ExprType::VAR)
         {
-            Var *var = dynamic_cast<Var *>(expr);
+            Var *var = expr->as<Var>();
             return var->name;
         }
 
         if (expr->exprType == ExprType::NUM)
         {
-            Num *num = dynamic_cast<Num *>(expr);
+            Num *num = expr->as<Num>();
             return to_string(num->value);
         }
 
@@ -47,72 +49,31 @@ namespace Library
 
         if (expr->exprType == ExprType::NUM)
         {
-            Num *num = dynamic_cast<Num *>(expr);
+            Num *num = expr->as<Num>();
             return num->value;
         }
 
         if (expr->exprType == ExprType::STRING)
         {
-            String *str = dynamic_cast<String *>(expr);
+            String *str = expr->as<String>();
             return stoi(str->value);
         }
 
         throw runtime_error("Expected NUM expression");
     }
 
-    json LibraryAPIFunction::extractJson(Expr *expr)
-    {
-        if (!expr)
-            return json::object();
-
-        if (expr->exprType == ExprType::MAP)
-        {
-            Map *map = dynamic_cast<Map *>(expr);
-            json obj = json::object();
-
-            for (const auto &kv : map->value)
-            {
-                string key = kv.first->name;
-
-                if (kv.second->exprType == ExprType::STRING)
-                {
-                    String *val = dynamic_cast<String *>(kv.second.get());
-                    obj[key] = val->value;
-                }
-                else if (kv.second->exprType == ExprType::NUM)
-                {
-                    Num *val = dynamic_cast<Num *>(kv.second.get());
-                    obj[key] = val->value;
-                }
-                else
-                {
-                    obj[key] = "unsupported_type";
-                }
-            }
-
-            return obj;
-        }
-
-        if (expr->exprType == ExprType::STRING)
-        {
-            String *str = dynamic_cast<String *>(expr);
-            try
-            {
-                return json::parse(str->value);
-            }
-            catch (...)
-            {
-                return str->value;
-            }
-        }
-
-        return json::object();
-    }
-
     /* ============================================================
      * Test API Functions
      * ============================================================ */
 
+    void LibraryFunctionFactory::clearCaches()
+    {
+        getB().clear();
+        getS().clear();
+        getReq().clear();
+        getLoans().clear();
+    }
+
     ResetFunc::ResetFunc(LibraryFunctionFactory *factory, vector<Expr *> args)
         : LibraryAPIFunction(factory, args) {}
 
@@ -126,10 +87,7 @@ namespace Library
 
             if (resp.statusCode >= 200 && resp.statusCode < 300)
             {
-                factory->getB().clear();
-                factory->getS().clear();
-                factory->getReq().clear();
-                factory->getLoans().clear();
+                factory->clearCaches();
                 return make_unique<Num>(200);
             }
             return make_unique<Num>(resp.statusCode);
@@ -1001,75 +959,64 @@ namespace Library
         cout << "[LibraryFunctionFactory] Initialized with baseUrl: " << baseUrl << endl;
     }
 
+    // acceptRequest is a GET too, but it creates the loan
+    bool LibraryFunctionFactory::isReadOnly(const string &fname) const
+    {
+        static const set<string> reads = {
+            "getAllBooks", "getBookByCode", "getAllStudents", "getStudentById",
+            "getAllRequests", "getRequestById", "getAllLoans", "getLoanById"};
+        return reads.count(fname) > 0;
+    }
+
     unique_ptr<Function> LibraryFunctionFactory::getFunction(string fname, vector<Expr *> args)
     {
         cout << "[LibraryFactory] Creating function: " << fname << endl;
 
-        // Test API functions
-        if (fname == "reset")
-            return make_unique<ResetFunc>(this, args);
-        if (fname == "get_B")
-            return make_unique<GetBFunc>(this, args);
-        if (fname == "set_B")
-            return make_unique<SetBFunc>(this, args);
-        if (fname == "get_S")
-            return make_unique<GetSFunc>(this, args);
-        if (fname == "set_S")
-            return make_unique<SetSFunc>(this, args);
-        if (fname == "get_Req")
-            return make_unique<GetReqFunc>(this, args);
-        if (fname == "set_Req")
-            return make_unique<SetReqFunc>(this, args);
-        if (fname == "get_Loans")
-            return make_unique<GetLoansFunc>(this, args);
-        if (fname == "set_Loans")
-            return make_unique<SetLoansFunc>(this, args);
-
-        // Book API functions
-        if (fname == "getAllBooks")
-            return make_unique<GetAllBooksFunc>(this, args);
-        if (fname == "getBookByCode")
-            return make_unique<GetBookByCodeFunc>(this, args);
-        if (fname == "saveBook")
-            return make_unique<SaveBookFunc>(this, args);
-        if (fname == "updateBook")
-            return make_unique<UpdateBookFunc>(this, args);
-        if (fname == "deleteBook")
-            return make_unique<DeleteBookFunc>(this, args);
-
-        // Student API functions
-        if (fname == "getAllStudents")
-            return make_unique<GetAllStudentsFunc>(this, args);
-        if (fname == "getStudentById")
-            return make_unique<GetStudentByIdFunc>(this, args);
-        if (fname == "saveStudent")
-            return make_unique<SaveStudentFunc>(this, args);
-        if (fname == "updateStudent")
-            return make_unique<UpdateStudentFunc>(this, args);
-        if (fname == "deleteStudent")
-            return make_unique<DeleteStudentFunc>(this, args);
-
-        // Request API functions
-        if (fname == "getAllRequests")
-            return make_unique<GetAllRequestsFunc>(this, args);
-        if (fname == "getRequestById")
-            return make_unique<GetRequestByIdFunc>(this, args);
-        if (fname == "saveRequest")
-            return make_unique<SaveRequestFunc>(this, args);
-        if (fname == "deleteRequest")
-            return make_unique<DeleteRequestFunc>(this, args);
-
-        // Loan API functions
-        if (fname == "getAllLoans")
-            return make_unique<GetAllLoansFunc>(this, args);
-        if (fname == "getLoanById")
-            return make_unique<GetLoanByIdFunc>(this, args);
-        if (fname == "acceptRequest")
-            return make_unique<AcceptRequestFunc>(this, args);
-        if (fname == "returnBook")
-            return make_unique<ReturnBookFunc>(this, args);
-        if (fname == "saveLoan")
-            return make_unique<SaveLoanFunc>(this, args);
+        static const FunctionTable<LibraryFunctionFactory> functions = {
+            // Test API functions
+            {"reset", &makeFunction<ResetFunc>},
+            {"checkpoint", &makeCheckpoint<LibraryFunctionFactory>},
+            {"restore", &makeRestore<LibraryFunctionFactory>},
+            {"get_B", &makeFunction<GetBFunc>},
+            {"set_B", &makeFunction<SetBFunc>},
+            {"get_S", &makeFunction<GetSFunc>},
+            {"set_S", &makeFunction<SetSFunc>},
+            {"get_Req", &makeFunction<GetReqFunc>},
+            {"set_Req", &makeFunction<SetReqFunc>},
+            {"get_Loans", &makeFunction<GetLoansFunc>},
+            {"set_Loans", &makeFunction<SetLoansFunc>},
+
+            // Book API functions
+            {"getAllBooks", &makeFunction<GetAllBooksFunc>},
+            {"getBookByCode", &makeFunction<GetBookByCodeFunc>},
+            {"saveBook", &makeFunction<SaveBookFunc>},
+            {"updateBook", &makeFunction<UpdateBookFunc>},
+            {"deleteBook", &makeFunction<DeleteBookFunc>},
+
+            // Student API functions
+            {"getAllStudents", &makeFunction<GetAllStudentsFunc>},
+            {"getStudentById", &makeFunction<GetStudentByIdFunc>},
+            {"saveStudent", &makeFunction<SaveStudentFunc>},
+            {"updateStudent", &makeFunction<UpdateStudentFunc>},
+            {"deleteStudent", &makeFunction<DeleteStudentFunc>},
+
+            // Request API functions
+            {"getAllRequests", &makeFunction<GetAllRequestsFunc>},
+            {"getRequestById", &makeFunction<GetRequestByIdFunc>},
+            {"saveRequest", &makeFunction<SaveRequestFunc>},
+            {"deleteRequest", &makeFunction<DeleteRequestFunc>},
+
+            // Loan API functions
+            {"getAllLoans", &makeFunction<GetAllLoansFunc>},
+            {"getLoanById", &makeFunction<GetLoanByIdFunc>},
+            {"acceptRequest", &makeFunction<AcceptRequestFunc>},
+            {"returnBook", &makeFunction<ReturnBookFunc>},
+            {"saveLoan", &makeFunction<SaveLoanFunc>},
+        };
+
+        auto it = functions.find(fname);
+        if (it != functions.end())
+            return it->second(this, args);
 
         throw runtime_error("Unknown function: " + fname);
     }
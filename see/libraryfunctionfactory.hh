@@ -33,7 +33,6 @@ namespace Library
 
         string extractString(Expr *expr);
         int extractInt(Expr *expr);
-        json extractJson(Expr *expr);
     };
 
     /* ============================================================
@@ -272,8 +271,11 @@ namespace Library
         ~LibraryFunctionFactory() = default;
 
         unique_ptr<Function> getFunction(string fname, vector<Expr *> args) override;
+        bool isReadOnly(const string &fname) const override;
 
         HttpClient *getHttpClient() { return httpClient.get(); }
+        // Drops the local copies of the globals; get_G refills them
+        void clearCaches();
 
         map<string, string> &getB() { return B_cache; }
         map<string, string> &getS() { return S_cache; }
@@ -0,0 +1,175 @@
+#include "mirroredfunctionfactory.hh"
+#include "exprjsonwriter.hh"
+#include "../clonevisitor.hh"
+
+#include <algorithm>
+
+namespace {
+
+bool startsWith(const string &s, const char *prefix)
+{
+    return s.rfind(prefix, 0) == 0;
+}
+
+bool succeeded(const Expr *result)
+{
+    if (!result || result->exprType != ExprType::NUM)
+        return false;
+    int status = result->cast<Num>().value;
+    return status >= 200 && status < 300;
+}
+
+unique_ptr<Expr> copyOf(const Expr *e)
+{
+    CloneVisitor cloner;
+    return cloner.cloneExpr(e);
+}
+
+// set_G's argument as get_G would answer it: map entries in key order
+unique_ptr<Expr> asRead(const Expr &value)
+{
+    if (value.exprType != ExprType::MAP)
+        return copyOf(&value);
+    unique_ptr<Expr> copy = copyOf(&value);
+    vector<pair<Ref<Var>, Ref<Expr>>> entries = copy->cast<Map>().value;
+    stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+        return a.first->name < b.first->name;
+    });
+    return make_unique<Map>(std::move(entries));
+}
+
+} // namespace
+
+unique_ptr<Function> MirroredFunctionFactory::getFunction(string fname, vector<Expr *> args)
+{
+    unique_ptr<Function> call = backend->getFunction(fname, args);
+    if (!call)
+        return nullptr;
+    return make_unique<MirroredFunction>(this, std::move(fname), std::move(args), std::move(call));
+}
+
+void MirroredFunctionFactory::setWriteSets(const map<string, set<string>> *writeSets)
+{
+    if (writeSets == writes)
+        return;
+    writes = writeSets;
+    invalidateAll();
+
+    string readOnlyCalls;
+    for (const auto &kv : *writes)
+    {
+        if (kv.second.empty() && backend->isReadOnly(kv.first))
+            readOnlyCalls += (readOnlyCalls.empty() ? "" : ", ") + kv.first;
+    }
+    cout << "[Mirror] Read-only calls: " << (readOnlyCalls.empty() ? "none" : readOnlyCalls) << endl;
+}
+
+unique_ptr<Expr> MirroredFunctionFactory::run(const string &fname, const vector<Expr *> &args,
+                                              Function &call)
+{
+    if (fname == "checkpoint")
+        return call.execute();
+
+    if (fname == "reset" || fname == "restore")
+    {
+        unique_ptr<Expr> result = call.execute();
+        invalidateAll();
+        return result;
+    }
+
+    if (startsWith(fname, "get_") && args.empty())
+    {
+        unique_ptr<Expr> &mirrored = globals[fname.substr(4)];
+        if (mirrored)
+            return serve(fname, *mirrored, call, mirrored);
+        stats.forwarded++;
+        unique_ptr<Expr> result = call.execute();
+        mirrored = copyOf(result.get());
+        return result;
+    }
+
+    if (startsWith(fname, "set_") && args.size() == 1)
+    {
+        unique_ptr<Expr> result = call.execute();
+        readOnly.clear();
+        // A failed write leaves the backend's value unknown
+        unique_ptr<Expr> &mirrored = globals[fname.substr(4)];
+        mirrored = succeeded(result.get()) ? asRead(*args[0]) : nullptr;
+        return result;
+    }
+
+    const set<string> *changes = nullptr;
+    if (writes)
+    {
+        auto it = writes->find(fname);
+        if (it != writes->end())
+            changes = &it->second;
+    }
+
+    // The factory knows which calls are plain GETs; the spec must agree
+    if (backend->isReadOnly(fname) && (!changes || changes->empty()))
+    {
+        string key = fname;
+        for (Expr *arg : args)
+            key += "\x1f" + exprToJson(arg).dump();
+        unique_ptr<Expr> &answer = readOnly[key];
+        if (answer)
+            return serve(fname, *answer, call, answer);
+        stats.forwarded++;
+        unique_ptr<Expr> result = call.execute();
+        answer = copyOf(result.get());
+        return result;
+    }
+
+    unique_ptr<Expr> result = call.execute();
+    if (!changes)
+    {
+        invalidateAll();
+        return result;
+    }
+    readOnly.clear();
+    for (const string &global : *changes)
+        globals.erase(global);
+    return result;
+}
+
+bool MirroredFunctionFactory::shouldVerify()
+{
+    if (verifyRate <= 0.0)
+        return false;
+    verifyCredit += verifyRate;
+    if (verifyCredit < 1.0)
+        return false;
+    verifyCredit -= 1.0;
+    return true;
+}
+
+unique_ptr<Expr> MirroredFunctionFactory::serve(const string &fname, const Expr &mirrored,
+                                                Function &call, unique_ptr<Expr> &slot)
+{
+    if (!shouldVerify())
+    {
+        stats.served++;
+        cout << "[Mirror] " << fname << " served from mirror" << endl;
+        return copyOf(&mirrored);
+    }
+
+    stats.verified++;
+    unique_ptr<Expr> result = call.execute();
+    json expected = exprToJson(&mirrored);
+    json actual = exprToJson(result.get());
+    if (expected != actual)
+    {
+        stats.drifted++;
+        cout << "[Mirror] Drift on " << fname << ": mirror " << expected.dump()
+             << ", backend " << actual.dump() << endl;
+        slot = copyOf(result.get());
+    }
+    return result;
+}
+
+void MirroredFunctionFactory::invalidateAll()
+{
+    globals.clear();
+    readOnly.clear();
+}
@@ -0,0 +1,90 @@
+#ifndef MIRROREDFUNCTIONFACTORY_HH
+#define MIRROREDFUNCTIONFACTORY_HH
+
+#include "functionfactory.hh"
+#include "../ast.hh"
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+using namespace std;
+
+/* ============================================================
+ * MirroredFunctionFactory - write-through client-side state mirror
+ *
+ * Wraps an app's factory and answers reads without HTTP while the
+ * mirror is known to match the backend:
+ *   - set_G(v) goes to the backend and, when it succeeds, the mirror
+ *     holds v as the value of G
+ *   - get_G() is served from the mirror when G is current, otherwise it
+ *     goes to the backend and its answer becomes the mirror of G
+ *   - a business call invalidates the globals in its write set (the
+ *     spec's effect sets, see specWriteSets); G is refreshed by the next
+ *     get_G. Calls the factory reports as read-only (and the spec does not
+ *     say write) are answered again for the same arguments until anything
+ *     is written.
+ *   - reset, restore and calls the write sets do not know invalidate
+ *     everything; checkpoint changes nothing.
+ *
+ * verifyRate of the served reads still go to the backend (evenly spread,
+ * not random, so runs repeat). A mismatch is logged as drift and the
+ * backend's answer replaces the mirror.
+ * ============================================================ */
+class MirroredFunctionFactory : public FunctionFactory
+{
+public:
+    struct Stats {
+        size_t served = 0;      // reads answered from the mirror
+        size_t forwarded = 0;   // reads that went to the backend
+        size_t verified = 0;
+        size_t drifted = 0;
+    };
+
+    MirroredFunctionFactory(FunctionFactory *backend, double verifyRate = 0.0)
+        : backend(backend), verifyRate(verifyRate) {}
+
+    unique_ptr<Function> getFunction(string fname, vector<Expr *> args) override;
+    bool isReadOnly(const string &fname) const override { return backend->isReadOnly(fname); }
+
+    // API function -> globals it may change; without write sets every
+    // business call invalidates the whole mirror
+    void setWriteSets(const map<string, set<string>> *writes);
+
+    const Stats &getStats() const { return stats; }
+
+    // Runs one call of `fname` through the mirror; `call` is the backend's
+    unique_ptr<Expr> run(const string &fname, const vector<Expr *> &args, Function &call);
+
+private:
+    FunctionFactory *backend;
+    double verifyRate;
+    double verifyCredit = 0.0;
+    const map<string, set<string>> *writes = nullptr;
+    map<string, unique_ptr<Expr>> globals;   // G -> current value
+    map<string, unique_ptr<Expr>> readOnly;  // call + arguments -> answer
+    Stats stats;
+
+    bool shouldVerify();
+    unique_ptr<Expr> serve(const string &fname, const Expr &mirrored, Function &call,
+                           unique_ptr<Expr> &slot);
+    void invalidateAll();
+};
+
+class MirroredFunction : public Function
+{
+private:
+    MirroredFunctionFactory *mirror;
+    string fname;
+    vector<Expr *> args;
+    unique_ptr<Function> call;
+
+public:
+    MirroredFunction(MirroredFunctionFactory *mirror, string fname, vector<Expr *> args,
+                     unique_ptr<Function> call)
+        : mirror(mirror), fname(std::move(fname)), args(std::move(args)), call(std::move(call)) {}
+
+    unique_ptr<Expr> execute() override { return mirror->run(fname, args, *call); }
+};
+
+#endif // MIRROREDFUNCTIONFACTORY_HH
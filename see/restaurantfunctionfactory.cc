@@ -18,13 +18,13 @@ string APIFunction::extractString(Expr *expr)
 
     if (expr->exprType == ExprType::STRING)
     {
-        String *str = dynamic_cast<String *>(expr);
+        String *str = expr->as<String>();
         return str->value;
     }
 
     if (expr->exprType == ExprType::VAR)
     {
-        Var *var = dynamic_cast<Var *>(expr);
+        Var *var = expr->as<Var>();
         return var->name;
     }
 
@@ -38,62 +38,13 @@ int APIFunction::extractInt(Expr *expr)
 
     if (expr->exprType == ExprType::NUM)
     {
-        Num *num = dynamic_cast<Num *>(expr);
+        Num *num = expr->as<Num>();
         return num->value;
     }
 
     throw runtime_error("Expected NUM expression");
 }
 
-json APIFunction::extractJson(Expr *expr)
-{
-    if (!expr)
-        return json::object();
-
-    if (expr->exprType == ExprType::MAP)
-    {
-        Map *map = dynamic_cast<Map *>(expr);
-        json obj = json::object();
-
-        for (const auto &kv : map->value)
-        {
-            string key = kv.first->name;
-
-            if (kv.second->exprType == ExprType::STRING)
-            {
-                String *val = dynamic_cast<String *>(kv.second.get());
-                obj[key] = val->value;
-            }
-            else if (kv.second->exprType == ExprType::NUM)
-            {
-                Num *val = dynamic_cast<Num *>(kv.second.get());
-                obj[key] = val->value;
-            }
-            else
-            {
-                obj[key] = "unsupported_type";
-            }
-        }
-
-        return obj;
-    }
-
-    if (expr->exprType == ExprType::STRING)
-    {
-        String *str = dynamic_cast<String *>(expr);
-        try
-        {
-            return json::parse(str->value);
-        }
-        catch (...)
-        {
-            return str->value;
-        }
-    }
-
-    return json::object();
-}
-
 string APIFunction::getCurrentToken(const string &email)
 {
     // First check local cache
@@ -128,6 +79,20 @@ string APIFunction::getCurrentToken(const string &email)
  * Test API Functions
  * ============================================================ */
 
+void RestaurantFunctionFactory::clearCaches()
+{
+    getU().clear();
+    getT().clear();
+    getRoles().clear();
+    getC().clear();
+    getR().clear();
+    getM().clear();
+    getO().clear();
+    getRev().clear();
+    getOwners().clear();
+    getAssignments().clear();
+}
+
 ResetFunc::ResetFunc(RestaurantFunctionFactory *factory, vector<Expr *> args)
     : APIFunction(factory, args) {}
 
@@ -142,16 +107,7 @@ unique_ptr<Expr> ResetFunc::execute()
 
         if (resp.statusCode >= 200 && resp.statusCode < 300)
         {
-            factory->getU().clear();
-            factory->getT().clear();
-            factory->getRoles().clear();
-            factory->getC().clear();
-            factory->getR().clear();
-            factory->getM().clear();
-            factory->getO().clear();
-            factory->getRev().clear();
-            factory->getOwners().clear();
-            factory->getAssignments().clear();
+            factory->clearCaches();
             return make_unique<Num>(200);
         }
         return make_unique<Num>(resp.statusCode);
@@ -211,14 +167,9 @@ unique_ptr<Expr> SetUFunc::execute()
     cout << "[SetUFunc] Setting U..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getU().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getU()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_U", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getU());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_U", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -274,14 +225,9 @@ unique_ptr<Expr> SetTFunc::execute()
     cout << "[SetTFunc] Setting T..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getT().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getT()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_T", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getT());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_T", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -339,14 +285,9 @@ unique_ptr<Expr> SetCFunc::execute()
     cout << "[SetCFunc] Setting C..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getC().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getC()[k] = v.dump();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_C", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getC());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_C", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -405,14 +346,9 @@ unique_ptr<Expr> SetRFunc::execute()
     cout << "[SetRFunc] Setting R..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getR().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getR()[k] = v.dump();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_R", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getR());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_R", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -445,7 +381,7 @@ unique_ptr<Expr> GetMFunc::execute()
 
             // data format: { restaurantId: [{id, name, price, category}, ...], ... }
             // We need to return: { menuItemId: restaurantId, ... }
-            // This allows findKeyFromMapInSigma("tmp_M_") to return menuItemId
+            // This lets SEE index menuItemId as the latest key of global M
 
             for (auto &[restaurantId, menuItems] : data.items())
             {
@@ -489,14 +425,9 @@ unique_ptr<Expr> SetMFunc::execute()
     cout << "[SetMFunc] Setting M..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getM().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getM()[k] = v.dump();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_M", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getM());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_M", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -555,14 +486,9 @@ unique_ptr<Expr> SetOFunc::execute()
     cout << "[SetOFunc] Setting O..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getO().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getO()[k] = v.dump();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_O", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getO());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_O", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -621,14 +547,9 @@ unique_ptr<Expr> SetRevFunc::execute()
     cout << "[SetRevFunc] Setting Rev..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getRev().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getRev()[k] = v.dump();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Rev", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getRev());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Rev", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -691,14 +612,9 @@ unique_ptr<Expr> SetRolesFunc::execute()
     cout << "[SetRolesFunc] Setting Roles..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getRoles().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getRoles()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Roles", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getRoles());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Roles", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -757,14 +673,9 @@ unique_ptr<Expr> SetOwnersFunc::execute()
     cout << "[SetOwnersFunc] Setting Owners..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getOwners().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getOwners()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Owners", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getOwners());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Owners", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -822,14 +733,9 @@ unique_ptr<Expr> SetAssignmentsFunc::execute()
     cout << "[SetAssignmentsFunc] Setting Assignments..." << endl;
     try
     {
-        json mapData = extractJson(arguments[0]);
-        factory->getAssignments().clear();
-        for (auto &[k, v] : mapData.items())
-        {
-            factory->getAssignments()[k] = v.get<string>();
-        }
-        json body = {{"data", mapData}};
-        HttpResponse resp = factory->getHttpClient()->post("/api/test/set_Assignments", body);
+        factory->getJsonWriter().fillCache(arguments[0], factory->getAssignments());
+        HttpResponse resp = factory->getHttpClient()->postRaw(
+            "/api/test/set_Assignments", factory->getJsonWriter().wrap("data", arguments[0]));
         return make_unique<Num>(resp.statusCode);
     }
     catch (const exception &e)
@@ -1556,89 +1462,64 @@ RestaurantFunctionFactory::RestaurantFunctionFactory(const string &baseUrl)
     cout << "[RestaurantFunctionFactory] Initialized with baseUrl: " << baseUrl << endl;
 }
 
+bool RestaurantFunctionFactory::isReadOnly(const string &fname) const
+{
+    return fname == "browseRestaurants" || fname == "viewMenu";
+}
+
 unique_ptr<Function> RestaurantFunctionFactory::getFunction(string fname, vector<Expr *> args)
 {
     cout << "[Factory] Creating function: " << fname << endl;
 
-    // Test API functions
-    if (fname == "reset")
-        return make_unique<ResetFunc>(this, args);
-    if (fname == "get_U")
-        return make_unique<GetUFunc>(this, args);
-    if (fname == "set_U")
-        return make_unique<SetUFunc>(this, args);
-    if (fname == "get_T")
-        return make_unique<GetTFunc>(this, args);
-    if (fname == "set_T")
-        return make_unique<SetTFunc>(this, args);
-    if (fname == "get_Roles")
-        return make_unique<GetRolesFunc>(this, args);
-    if (fname == "set_Roles")
-        return make_unique<SetRolesFunc>(this, args);
-    if (fname == "get_Owners")
-        return make_unique<GetOwnersFunc>(this, args);
-    if (fname == "set_Owners")
-        return make_unique<SetOwnersFunc>(this, args);
-    if (fname == "get_Assignments")
-        return make_unique<GetAssignmentsFunc>(this, args);
-    if (fname == "set_Assignments")
-        return make_unique<SetAssignmentsFunc>(this, args);
-    if (fname == "get_C")
-        return make_unique<GetCFunc>(this, args);
-    if (fname == "set_C")
-        return make_unique<SetCFunc>(this, args);
-    if (fname == "get_R")
-        return make_unique<GetRFunc>(this, args);
-    if (fname == "set_R")
-        return make_unique<SetRFunc>(this, args);
-    if (fname == "get_M")
-        return make_unique<GetMFunc>(this, args);
-    if (fname == "set_M")
-        return make_unique<SetMFunc>(this, args);
-    if (fname == "get_O")
-        return make_unique<GetOFunc>(this, args);
-    if (fname == "set_O")
-        return make_unique<SetOFunc>(this, args);
-    if (fname == "get_Rev")
-        return make_unique<GetRevFunc>(this, args);
-    if (fname == "set_Rev")
-        return make_unique<SetRevFunc>(this, args);
-    // Business API functions - 3 separate register functions
-    if (fname == "registerCustomer")
-        return make_unique<RegisterCustomerFunc>(this, args);
-    if (fname == "registerOwner")
-        return make_unique<RegisterOwnerFunc>(this, args);
-    if (fname == "registerAgent")
-        return make_unique<RegisterAgentFunc>(this, args);
-
-    if (fname == "login")
-        return make_unique<LoginFunc>(this, args);
-    if (fname == "browseRestaurants")
-        return make_unique<BrowseRestaurantsFunc>(this, args);
-    if (fname == "viewMenu")
-        return make_unique<ViewMenuFunc>(this, args);
-    if (fname == "addToCart")
-        return make_unique<AddToCartFunc>(this, args);
-    if (fname == "placeOrder")
-        return make_unique<PlaceOrderFunc>(this, args);
-    if (fname == "leaveReview")
-        return make_unique<LeaveReviewFunc>(this, args);
-    if (fname == "createRestaurant")
-        return make_unique<CreateRestaurantFunc>(this, args);
-    if (fname == "addMenuItem")
-        return make_unique<AddMenuItemFunc>(this, args);
-    if (fname == "assignOrder")
-        return make_unique<AssignOrderFunc>(this, args);
-    if (fname == "updateOrderStatusOwner")
-        return make_unique<UpdateOrderStatusOwnerFunc>(this, args);
-    if (fname == "updateOrderStatusAgent")
-        return make_unique<UpdateOrderStatusAgentFunc>(this, args);
-    if (fname == "checkOrderAmount")
-        return make_unique<CheckOrderAmountFunc>(this, args);
-    if (fname == "checkCartTotal")
-        return make_unique<CheckCartTotalFunc>(this, args);
-    if (fname == "addToCartQuantityZero")
-        return make_unique<AddToCartQuantityZeroFunc>(this, args);
+    static const FunctionTable<RestaurantFunctionFactory> functions = {
+        // Test API functions
+        {"reset", &makeFunction<ResetFunc>},
+        {"checkpoint", &makeCheckpoint<RestaurantFunctionFactory>},
+        {"restore", &makeRestore<RestaurantFunctionFactory>},
+        {"get_U", &makeFunction<GetUFunc>},
+        {"set_U", &makeFunction<SetUFunc>},
+        {"get_T", &makeFunction<GetTFunc>},
+        {"set_T", &makeFunction<SetTFunc>},
+        {"get_Roles", &makeFunction<GetRolesFunc>},
+        {"set_Roles", &makeFunction<SetRolesFunc>},
+        {"get_Owners", &makeFunction<GetOwnersFunc>},
+        {"set_Owners", &makeFunction<SetOwnersFunc>},
+        {"get_Assignments", &makeFunction<GetAssignmentsFunc>},
+        {"set_Assignments", &makeFunction<SetAssignmentsFunc>},
+        {"get_C", &makeFunction<GetCFunc>},
+        {"set_C", &makeFunction<SetCFunc>},
+        {"get_R", &makeFunction<GetRFunc>},
+        {"set_R", &makeFunction<SetRFunc>},
+        {"get_M", &makeFunction<GetMFunc>},
+        {"set_M", &makeFunction<SetMFunc>},
+        {"get_O", &makeFunction<GetOFunc>},
+        {"set_O", &makeFunction<SetOFunc>},
+        {"get_Rev", &makeFunction<GetRevFunc>},
+        {"set_Rev", &makeFunction<SetRevFunc>},
+
+        // Business API functions - 3 separate register functions
+        {"registerCustomer", &makeFunction<RegisterCustomerFunc>},
+        {"registerOwner", &makeFunction<RegisterOwnerFunc>},
+        {"registerAgent", &makeFunction<RegisterAgentFunc>},
+        {"login", &makeFunction<LoginFunc>},
+        {"browseRestaurants", &makeFunction<BrowseRestaurantsFunc>},
+        {"viewMenu", &makeFunction<ViewMenuFunc>},
+        {"addToCart", &makeFunction<AddToCartFunc>},
+        {"placeOrder", &makeFunction<PlaceOrderFunc>},
+        {"leaveReview", &makeFunction<LeaveReviewFunc>},
+        {"createRestaurant", &makeFunction<CreateRestaurantFunc>},
+        {"addMenuItem", &makeFunction<AddMenuItemFunc>},
+        {"assignOrder", &makeFunction<AssignOrderFunc>},
+        {"updateOrderStatusOwner", &makeFunction<UpdateOrderStatusOwnerFunc>},
+        {"updateOrderStatusAgent", &makeFunction<UpdateOrderStatusAgentFunc>},
+        {"checkOrderAmount", &makeFunction<CheckOrderAmountFunc>},
+        {"checkCartTotal", &makeFunction<CheckCartTotalFunc>},
+        {"addToCartQuantityZero", &makeFunction<AddToCartQuantityZeroFunc>},
+    };
+
+    auto it = functions.find(fname);
+    if (it != functions.end())
+        return it->second(this, args);
 
     throw runtime_error("Unknown function: " + fname);
 }
@@ -4,6 +4,7 @@
 #include "functionfactory.hh"
 #include "../ast.hh"
 #include "httpclient.hh"
+#include "exprjsonwriter.hh"
 #include <nlohmann/json.hpp>
 #include <memory>
 #include <string>
@@ -30,7 +31,6 @@ public:
     // Helpers to extract concrete values from Expr*
     string extractString(Expr* expr);
     int extractInt(Expr* expr);
-    json extractJson(Expr* expr);
     string getCurrentToken(const string& email);
 };
 
@@ -280,6 +280,7 @@ class RestaurantFunctionFactory : public FunctionFactory {
 private:
     unique_ptr<HttpClient> httpClient;
     string baseUrl;
+    ExprJsonWriter jsonWriter;  // reused for every set_G payload
     
     // In-memory cache of global maps
     map<string, string> U_cache;
@@ -298,8 +299,12 @@ public:
     ~RestaurantFunctionFactory() = default;
     
     unique_ptr<Function> getFunction(string fname, vector<Expr*> args) override;
+    bool isReadOnly(const string& fname) const override;
     
     HttpClient* getHttpClient() { return httpClient.get(); }
+    // Drops the local copies of the globals; get_G refills them
+    void clearCaches();
+    ExprJsonWriter& getJsonWriter() { return jsonWriter; }
     
     map<string, string>& getU() { return U_cache; }
     map<string, string>& getT() { return T_cache; }
@@ -2,6 +2,8 @@
 #include "./see.hh"
 #include "../clonevisitor.hh"
 #include "functionfactory.hh"
+#include "../trace.hh"
+#include "../metrics.hh"
 #include <iostream>
 #include <set>
 using namespace std;
@@ -24,7 +26,7 @@ static bool isNumBool(Expr *expr)
 {
     if (expr && expr->exprType == ExprType::NUM)
     {
-        Num *n = dynamic_cast<Num *>(expr);
+        Num *n = expr->as<Num>();
         return (n->value == 0 || n->value == 1);
     }
     return false;
@@ -38,22 +40,22 @@ static string exprToString(Expr *expr)
 
     if (expr->exprType == ExprType::SYMVAR)
     {
-        SymVar *sv = dynamic_cast<SymVar *>(expr);
+        SymVar *sv = expr->as<SymVar>();
         return "X" + ::to_string(sv->getNum());
     }
     else if (expr->exprType == ExprType::NUM)
     {
-        Num *num = dynamic_cast<Num *>(expr);
+        Num *num = expr->as<Num>();
         return ::to_string(num->value);
     }
     else if (expr->exprType == ExprType::VAR)
     {
-        Var *var = dynamic_cast<Var *>(expr);
+        Var *var = expr->as<Var>();
         return var->name;
     }
     else if (expr->exprType == ExprType::FUNCCALL)
     {
-        FuncCall *fc = dynamic_cast<FuncCall *>(expr);
+        FuncCall *fc = expr->as<FuncCall>();
         string result = fc->name + "(";
         for (size_t i = 0; i < fc->args.size(); i++)
         {
@@ -66,12 +68,12 @@ static string exprToString(Expr *expr)
     }
     else if (expr->exprType == ExprType::STRING)
     {
-        String *str = dynamic_cast<String *>(expr);
+        String *str = expr->as<String>();
         return "\"" + str->value + "\"";
     }
     else if (expr->exprType == ExprType::SET)
     {
-        Set *set = dynamic_cast<Set *>(expr);
+        Set *set = expr->as<Set>();
         string result = "{";
         for (size_t i = 0; i < set->elements.size(); i++)
         {
@@ -84,7 +86,7 @@ static string exprToString(Expr *expr)
     }
     else if (expr->exprType == ExprType::MAP)
     {
-        Map *map = dynamic_cast<Map *>(expr);
+        Map *map = expr->as<Map>();
         string result = "{";
         for (size_t i = 0; i < map->value.size(); i++)
         {
@@ -99,7 +101,7 @@ static string exprToString(Expr *expr)
     }
     else if (expr->exprType == ExprType::TUPLE)
     {
-        Tuple *tuple = dynamic_cast<Tuple *>(expr);
+        Tuple *tuple = expr->as<Tuple>();
         string result = "(";
         for (size_t i = 0; i < tuple->exprs.size(); i++)
         {
@@ -113,12 +115,12 @@ static string exprToString(Expr *expr)
     // NEW: Handle Boolean nodes
     else if (expr->exprType == ExprType::BOOL_CONST)
     {
-        BoolConst *bc = dynamic_cast<BoolConst *>(expr);
+        BoolConst *bc = expr->as<BoolConst>();
         return bc->value ? "true" : "false";
     }
     else if (expr->exprType == ExprType::BINARY_OP)
     {
-        BinaryOpExpr *binop = dynamic_cast<BinaryOpExpr *>(expr);
+        BinaryOpExpr *binop = expr->as<BinaryOpExpr>();
         string opStr;
         switch (binop->op)
         {
@@ -160,7 +162,7 @@ static string exprToString(Expr *expr)
     }
     else if (expr->exprType == ExprType::UNARY_OP)
     {
-        UnaryOpExpr *unop = dynamic_cast<UnaryOpExpr *>(expr);
+        UnaryOpExpr *unop = expr->as<UnaryOpExpr>();
         string opStr;
         switch (unop->op)
         {
@@ -180,7 +182,12 @@ static string exprToString(const unique_ptr<Expr> &expr)
     return exprToString(expr.get());
 }
 
-unique_ptr<Expr> SEE::computePathConstraint(vector<Expr *> C)
+static string exprToString(const Ref<Expr> &expr)
+{
+    return exprToString(expr.get());
+}
+
+unique_ptr<Expr> SEE::computePathConstraint(const vector<Ref<Expr>> &C)
 {
     if (C.empty())
     {
@@ -191,26 +198,44 @@ unique_ptr<Expr> SEE::computePathConstraint(vector<Expr *> C)
         return make_unique<FuncCall>("Eq", std::move(args));
     }
 
-    CloneVisitor cloner;
     if (C.size() == 1)
     {
         // Single constraint, return it
-        return cloner.cloneExpr(C[0]);
+        CloneVisitor cloner;
+        return cloner.cloneExpr(C[0].get());
     }
 
     // Multiple constraints, conjoin them with AND
     // For now, we'll create a nested structure: C1 AND (C2 AND (C3 AND ...))
-    unique_ptr<Expr> result = cloner.cloneExpr(C.back());
+    // The conjuncts are the recorded constraints themselves
+    Ref<Expr> rest = C.back();
 
-    for (int i = C.size() - 2; i >= 0; i--)
+    for (int i = C.size() - 2; i >= 1; i--)
     {
-        vector<unique_ptr<Expr>> args;
-        args.push_back(cloner.cloneExpr(C[i]));
-        args.push_back(std::move(result));
-        result = make_unique<FuncCall>("And", std::move(args));
+        vector<Ref<Expr>> args;
+        args.push_back(C[i]);
+        args.push_back(std::move(rest));
+        rest = makeRef<FuncCall>("And", std::move(args));
     }
 
-    return result;
+    vector<Ref<Expr>> args;
+    args.push_back(C[0]);
+    args.push_back(std::move(rest));
+    return make_unique<FuncCall>("And", std::move(args));
+}
+
+void SEE::addConstraint(Expr *constraint)
+{
+    // A concrete true adds nothing to the conjunction
+    if (constraint->exprType == ExprType::BOOL_CONST && constraint->as<BoolConst>()->value)
+        return;
+    // Evaluation results have no owner and sigma may alias them, so only a
+    // node already held through Refs (a program node) is shared; any other
+    // is copied into one the path constraint owns
+    if (constraint->useCount() > 0)
+        pathConstraint.push_back(Ref<Expr>(constraint));
+    else
+        pathConstraint.push_back(Ref<Expr>(CloneVisitor().cloneExpr(constraint)));
 }
 
 unique_ptr<Expr> SEE::computePathConstraint()
@@ -222,12 +247,12 @@ bool SEE::isReady(Stmt &s, SymbolTable &st)
 {
     if (s.statementType == StmtType::ASSIGN)
     {
-        Assign &assign = dynamic_cast<Assign &>(s);
+        Assign &assign = s.cast<Assign>();
 
         // Check if this is an API call assignment (e.g., r1 := f(x1))
         if (assign.right->exprType == ExprType::FUNCCALL)
         {
-            FuncCall &fc = dynamic_cast<FuncCall &>(*assign.right);
+            FuncCall &fc = assign.right->cast<FuncCall>();
 
             if (isAPI(fc))
             {
@@ -258,13 +283,13 @@ bool SEE::isReady(Stmt &s, SymbolTable &st)
     }
     else if (s.statementType == StmtType::ASSUME)
     {
-        Assume &assume = dynamic_cast<Assume &>(s);
+        Assume &assume = s.cast<Assume>();
         return isReady(*assume.expr, st);
     }
     // Add ASSERT handling
     else if (s.statementType == StmtType::ASSERT)
     {
-        Assert &assertStmt = dynamic_cast<Assert &>(s);
+        Assert &assertStmt = s.cast<Assert>();
         // Handle null or trivial assertions
         if (!assertStmt.expr)
         {
@@ -272,7 +297,7 @@ bool SEE::isReady(Stmt &s, SymbolTable &st)
         }
         if (assertStmt.expr->exprType == ExprType::NUM)
         {
-            Num *num = dynamic_cast<Num *>(assertStmt.expr.get());
+            Num *num = assertStmt.expr->as<Num>();
             if (num && num->value == 1)
             {
                 return true; // Trivial assertion is always ready
@@ -295,7 +320,7 @@ bool SEE::isReady(Expr &e, SymbolTable &st)
 {
     if (e.exprType == ExprType::FUNCCALL)
     {
-        FuncCall &fc = dynamic_cast<FuncCall &>(e);
+        FuncCall &fc = e.cast<FuncCall>();
 
         // Special case: input() with no arguments IS ready for symbolic execution
         // It will create a new symbolic variable
@@ -325,7 +350,7 @@ bool SEE::isReady(Expr &e, SymbolTable &st)
     }
     if (e.exprType == ExprType::MAP)
     {
-        Map &map = dynamic_cast<Map &>(e);
+        Map &map = e.cast<Map>();
         for (unsigned int i = 0; i < map.value.size(); i++)
         {
             if (isReady(*map.value[i].second, st) == false)
@@ -341,7 +366,7 @@ bool SEE::isReady(Expr &e, SymbolTable &st)
     }
     if (e.exprType == ExprType::SET)
     {
-        Set &set = dynamic_cast<Set &>(e);
+        Set &set = e.cast<Set>();
         for (unsigned int i = 0; i < set.elements.size(); i++)
         {
             if (isReady(*set.elements[i], st) == false)
@@ -368,17 +393,17 @@ bool SEE::isReady(Expr &e, SymbolTable &st)
     }
     if (e.exprType == ExprType::BINARY_OP)
     {
-        BinaryOpExpr &binop = dynamic_cast<BinaryOpExpr &>(e);
+        BinaryOpExpr &binop = e.cast<BinaryOpExpr>();
         return isReady(*binop.left, st) && isReady(*binop.right, st);
     }
     if (e.exprType == ExprType::UNARY_OP)
     {
-        UnaryOpExpr &unop = dynamic_cast<UnaryOpExpr &>(e);
+        UnaryOpExpr &unop = e.cast<UnaryOpExpr>();
         return isReady(*unop.operand, st);
     }
     if (e.exprType == ExprType::TUPLE)
     {
-        Tuple &tuple = dynamic_cast<Tuple &>(e);
+        Tuple &tuple = e.cast<Tuple>();
         for (unsigned int i = 0; i < tuple.exprs.size(); i++)
         {
             if (isReady(*tuple.exprs[i], st) == false)
@@ -391,7 +416,7 @@ bool SEE::isReady(Expr &e, SymbolTable &st)
     if (e.exprType == ExprType::VAR)
     {
         // Variables are ready if they're bound in sigma AND their value is concrete
-        Var &var = dynamic_cast<Var &>(e);
+        Var &var = e.cast<Var>();
 
         // First, try direct lookup
         if (sigma.hasValue(var.name))
@@ -472,17 +497,17 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
     else if (e.exprType == ExprType::BINARY_OP)
     {
-        BinaryOpExpr &binop = dynamic_cast<BinaryOpExpr &>(e);
+        BinaryOpExpr &binop = e.cast<BinaryOpExpr>();
         return isSymbolic(*binop.left, st) || isSymbolic(*binop.right, st);
     }
     else if (e.exprType == ExprType::UNARY_OP)
     {
-        UnaryOpExpr &unop = dynamic_cast<UnaryOpExpr &>(e);
+        UnaryOpExpr &unop = e.cast<UnaryOpExpr>();
         return isSymbolic(*unop.operand, st);
     }
     else if (e.exprType == ExprType::FUNCCALL)
     {
-        FuncCall &fc = dynamic_cast<FuncCall &>(e);
+        FuncCall &fc = e.cast<FuncCall>();
         for (unsigned int i = 0; i < fc.args.size(); i++)
         {
             if (isSymbolic(*fc.args[i], st) == true)
@@ -494,7 +519,7 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
     else if (e.exprType == ExprType::MAP)
     {
-        Map &map = dynamic_cast<Map &>(e);
+        Map &map = e.cast<Map>();
         for (unsigned int i = 0; i < map.value.size(); i++)
         {
             if (isSymbolic(*map.value[i].second, st) == true)
@@ -510,7 +535,7 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
     else if (e.exprType == ExprType::SET)
     {
-        Set &set = dynamic_cast<Set &>(e);
+        Set &set = e.cast<Set>();
         for (unsigned int i = 0; i < set.elements.size(); i++)
         {
             if (isSymbolic(*set.elements[i], st) == true)
@@ -526,7 +551,7 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
     else if (e.exprType == ExprType::TUPLE)
     {
-        Tuple &tuple = dynamic_cast<Tuple &>(e);
+        Tuple &tuple = e.cast<Tuple>();
         for (unsigned int i = 0; i < tuple.exprs.size(); i++)
         {
             if (isSymbolic(*tuple.exprs[i], st) == true)
@@ -538,7 +563,7 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
     else if (e.exprType == ExprType::VAR)
     {
-        Var &var = dynamic_cast<Var &>(e);
+        Var &var = e.cast<Var>();
 
         // First, try direct lookup
         if (sigma.hasValue(var.name))
@@ -567,6 +592,132 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
     }
 }
 
+map<string, CheckpointSnapshot> SEE::checkpoints;
+mutex SEE::checkpointsMutex;
+atomic<bool> SEE::checkpointsUnsupported{false};
+
+bool SEE::checkpointPrefix(const string &id, vector<Ref<Stmt>> &prefix)
+{
+    lock_guard<mutex> lock(checkpointsMutex);
+    auto it = checkpoints.find(id);
+    if (it == checkpoints.end())
+        return false;
+    prefix = it->second.prefix;
+    return true;
+}
+
+void SEE::clearCheckpoints()
+{
+    lock_guard<mutex> lock(checkpointsMutex);
+    checkpoints.clear();
+    checkpointsUnsupported = false;
+}
+
+bool SEE::isCheckpointStmt(const Stmt &s, const string &fname, string &id)
+{
+    if (s.statementType != StmtType::ASSIGN)
+        return false;
+    const Assign &assign = s.cast<Assign>();
+    if (assign.right->exprType != ExprType::FUNCCALL)
+        return false;
+    const FuncCall &fc = assign.right->cast<FuncCall>();
+    if (fc.name != fname || fc.args.size() != 1 || fc.args[0]->exprType != ExprType::STRING)
+        return false;
+    id = fc.args[0]->cast<String>().value;
+    return true;
+}
+
+bool SEE::callTestApi(const string &fname, const string *id)
+{
+    String arg(id ? *id : "");
+    vector<Expr *> args;
+    if (id)
+        args.push_back(&arg);
+    try
+    {
+        TRACE_SPAN(span, fname, "api");
+        unique_ptr<Function> func = functionFactory->getFunction(fname, args);
+        if (Metrics::enabled)
+            Metrics::countFunctionCall(fname);
+        unique_ptr<Expr> result = func->execute();
+        return result && result->exprType == ExprType::NUM &&
+               result->as<Num>()->value == 200;
+    }
+    catch (const exception &e)
+    {
+        // Factories without the checkpoint protocol throw "Unknown function"
+        cout << "[CHECKPOINT] " << fname << " unavailable: " << e.what() << endl;
+        return false;
+    }
+}
+
+void SEE::takeCheckpoint(const Program &program, size_t index, const string &id)
+{
+    // Only a fully concrete prefix describes a real backend state
+    for (size_t i = 0; i < index; i++)
+    {
+        const Stmt &s = *program.statements[i];
+        if (s.statementType != StmtType::ASSIGN)
+            continue;
+        const Assign &assign = s.cast<Assign>();
+        if (assign.right->exprType == ExprType::FUNCCALL &&
+            assign.right->cast<FuncCall>().name == "input")
+        {
+            cout << "[CHECKPOINT] Prefix of '" << id << "' still abstract, not saved" << endl;
+            return;
+        }
+    }
+
+    if (checkpointsUnsupported)
+        return;
+    if (!callTestApi("checkpoint", &id))
+    {
+        cout << "[CHECKPOINT] Backend refused checkpoint '" << id
+             << "', using reset-and-replay from now on" << endl;
+        checkpointsUnsupported = true;
+        return;
+    }
+
+    CloneVisitor cloner;
+    CheckpointSnapshot snap;
+    snap.prefix.assign(program.statements.begin() + 1, program.statements.begin() + index + 1);
+    for (const auto &entry : sigma.getAllEntries())
+        snap.sigma[entry.first] = cloner.cloneExpr(entry.second);
+    snap.pathConstraint = pathConstraint;
+
+    {
+        lock_guard<mutex> lock(checkpointsMutex);
+        checkpoints[id] = std::move(snap);
+    }
+    cout << "[CHECKPOINT] Saved '" << id << "' (" << index << " prefix statements)" << endl;
+}
+
+bool SEE::restoreCheckpoint(const string &id)
+{
+    // Copy the snapshot out first: the HTTP call runs without the lock
+    CloneVisitor cloner;
+    map<string, unique_ptr<Expr>> savedSigma;
+    vector<Ref<Expr>> savedPathConstraint;
+    {
+        lock_guard<mutex> lock(checkpointsMutex);
+        auto it = checkpoints.find(id);
+        if (it == checkpoints.end())
+            return false;
+        for (const auto &entry : it->second.sigma)
+            savedSigma[entry.first] = cloner.cloneExpr(entry.second.get());
+        savedPathConstraint = it->second.pathConstraint;
+    }
+    if (!callTestApi("restore", &id))
+        return false;
+
+    for (auto &entry : savedSigma)
+        bindValue(entry.first, entry.second.release());
+    pathConstraint = std::move(savedPathConstraint);
+
+    cout << "[CHECKPOINT] Restored '" << id << "'" << endl;
+    return true;
+}
+
 // Symbolic Execution function following the algorithm:
 // function symex([s1, s2, ..., sn], σ)
 //   C ← []
@@ -579,15 +730,44 @@ bool SEE::isSymbolic(Expr &e, SymbolTable &st)
 //   return ⟨C, [], σ⟩  // All statements executed
 void SEE::execute(Program &program, SymbolTable &st)
 {
+    TRACE_SPAN(span, "SEE::execute", "see");
+    span.arg("statements", (long long)program.statements.size());
     pathConstraint.clear();
+    failedAssertions = 0;
 
-    // Add initial constraint: true (represented as Num(1))
-    pathConstraint.push_back(new BoolConst(true));
+    // Set while statements already covered by a restored checkpoint are skipped
+    string skipUntil;
 
     for (size_t i = 0; i < program.statements.size(); i++)
     {
         Stmt &s = *program.statements[i];
 
+        string id;
+        if (isCheckpointStmt(s, "restore", id))
+        {
+            if (restoreCheckpoint(id))
+            {
+                skipUntil = id;
+            }
+            else
+            {
+                // Backend lacks the endpoints or the snapshot is gone: replay
+                cout << "[CHECKPOINT] Restore of '" << id << "' failed, falling back to reset" << endl;
+                callTestApi("reset");
+            }
+            continue;
+        }
+        if (isCheckpointStmt(s, "checkpoint", id))
+        {
+            if (skipUntil == id)
+                skipUntil.clear();
+            else if (skipUntil.empty())
+                takeCheckpoint(program, i, id);
+            continue;
+        }
+        if (!skipUntil.empty())
+            continue;
+
         // Check if statement is ready for execution
         if (!isReady(s, st))
         {
@@ -605,17 +785,37 @@ void SEE::execute(Program &program, SymbolTable &st)
     cout << "\n[SEE] Path Constraint: " << exprToString(pc) << endl;
 }
 
+// Block position from a result variable: _result3 -> 3
+static bool blockIndexOf(const string &varName, size_t &index)
+{
+    size_t digits = varName.find_last_not_of("0123456789");
+    if (varName.compare(0, 7, "_result") != 0 || digits + 1 >= varName.size())
+        return false;
+    index = stoul(varName.substr(digits + 1));
+    return true;
+}
+
 void SEE::executeStmt(Stmt &s, SymbolTable &st)
 {
+    TRACE_SPAN(span, "executeStmt", "see");
+    if (Metrics::enabled)
+        Metrics::countStatement();
+    if (span.active())
+    {
+        static const char *kinds[] = {"assign", "assume", "assert", "decl"};
+        size_t kind = (size_t)s.statementType;
+        span.arg("kind", string(kind < 4 ? kinds[kind] : "other"));
+    }
+
     if (s.statementType == StmtType::ASSIGN)
     {
-        Assign &assign = dynamic_cast<Assign &>(s);
+        Assign &assign = s.cast<Assign>();
 
         // Get the variable name from left side
         string varName;
         if (assign.left->exprType == ExprType::VAR)
         {
-            varName = dynamic_cast<Var &>(*assign.left).name;
+            varName = assign.left->cast<Var>().name;
         }
         else
         {
@@ -636,7 +836,7 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
         // Check if right side is an API call
         if (assign.right->exprType == ExprType::FUNCCALL)
         {
-            FuncCall &fc = dynamic_cast<FuncCall &>(*assign.right);
+            FuncCall &fc = assign.right->cast<FuncCall>();
 
             if (isAPI(fc))
             {
@@ -667,7 +867,7 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
 
                     // Store a symbolic placeholder
                     // The actual execution will happen in a later pass with concrete values
-                    sigma.setValue(varName, new Num(-1)); // Placeholder
+                    bindValue(varName, new Num(-1)); // Placeholder
                     cout << "[ASSIGN] Result: " << varName << " := -1 (symbolic placeholder)" << endl;
                     return;
                 }
@@ -685,6 +885,13 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
 
                 if (func)
                 {
+                    if (Metrics::enabled)
+                        Metrics::countFunctionCall(fc.name);
+                    size_t blockIndex;
+                    if (Tracer::enabled && blockIndexOf(varName, blockIndex))
+                        Tracer::setBlockIndex(blockIndex);
+                    TRACE_SPAN(callSpan, fc.name, "api");
+
                     cout << "  [API_CALL] Executing function..." << endl;
                     unique_ptr<Expr> resultExpr = func->execute();
                     Expr *result = resultExpr.release();
@@ -692,14 +899,14 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
 
                     // Store result in sigma
                     cout << "  [API_CALL] Storing result in variable: " << varName << endl;
-                    sigma.setValue(varName, result);
+                    bindValue(varName, result);
                     cout << "[ASSIGN] Result: " << varName << " := " << exprToString(result) << endl;
                 }
                 else
                 {
                     cout << "  [API_CALL] Warning: No function found for " << fc.name << endl;
                     // Store a placeholder
-                    sigma.setValue(varName, new Num(-1));
+                    bindValue(varName, new Num(-1));
                 }
                 return;
             }
@@ -707,21 +914,21 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
 
         // Not an API call, evaluate normally
         Expr *result = evaluateExpr(*assign.right, st);
-        sigma.setValue(varName, result);
+        bindValue(varName, result);
         cout << "[ASSIGN] Result: " << varName << " := " << exprToString(result) << endl;
     }
     else if (s.statementType == StmtType::ASSUME)
     {
-        Assume &assume = dynamic_cast<Assume &>(s);
+        Assume &assume = s.cast<Assume>();
         cout << "\n[ASSUME] Evaluating: " << exprToString(assume.expr) << endl;
 
         Expr *result = evaluateExpr(*assume.expr, st);
         cout << "[ASSUME] Adding constraint: " << exprToString(result) << endl;
-        pathConstraint.push_back(result);
+        addConstraint(result);
     }
     else if (s.statementType == StmtType::ASSERT)
     {
-        Assert &assertStmt = dynamic_cast<Assert &>(s);
+        Assert &assertStmt = s.cast<Assert>();
 
         // Handle empty assertions
         if (!assertStmt.expr)
@@ -738,7 +945,7 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
         // Check if the assertion is concrete
         if (result->exprType == ExprType::BOOL_CONST)
         {
-            BoolConst *bc = dynamic_cast<BoolConst *>(result);
+            BoolConst *bc = result->as<BoolConst>();
             if (bc->value)
             {
                 cout << "[ASSERT] ✓ Assertion PASSED" << endl;
@@ -746,11 +953,12 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
             else
             {
                 cout << "[ASSERT] ✗ Assertion FAILED" << endl;
+                failedAssertions++;
             }
         }
         else if (result->exprType == ExprType::NUM)
         {
-            Num *num = dynamic_cast<Num *>(result);
+            Num *num = result->as<Num>();
             if (num->value == 1)
             {
                 cout << "[ASSERT] ✓ Assertion PASSED (numeric true)" << endl;
@@ -758,163 +966,122 @@ void SEE::executeStmt(Stmt &s, SymbolTable &st)
             else if (num->value == 0)
             {
                 cout << "[ASSERT] ✗ Assertion FAILED (numeric false)" << endl;
+                failedAssertions++;
             }
             else
             {
                 cout << "[ASSERT] Adding to path constraints (not fully concrete)" << endl;
-                pathConstraint.push_back(result);
+                addConstraint(result);
             }
         }
         else
         {
             // Symbolic assertion - add to path constraints
             cout << "[ASSERT] Adding to path constraints (not fully concrete)" << endl;
-            pathConstraint.push_back(result);
+            addConstraint(result);
         }
     }
 }
 
-// Helper to find a key from a map variable in sigma
-string SEE::findKeyFromMapInSigma(const string &prefix)
+// Split "tmp_<G>_<n>" into (G, n); false for any other variable name
+static bool parseMaterializedName(const string &varName, string &global, int &version)
 {
-    cout << "    [findKeyFromMapInSigma] Searching for prefix: " << prefix << endl;
+    if (varName.compare(0, 4, "tmp_") != 0)
+        return false;
+    size_t sep = varName.rfind('_');
+    if (sep <= 4 || sep + 1 >= varName.length())
+        return false;
+    for (size_t i = sep + 1; i < varName.length(); i++)
+        if (!isdigit((unsigned char)varName[i]))
+            return false;
+    global = varName.substr(4, sep - 4);
+    version = stoi(varName.substr(sep + 1));
+    return true;
+}
 
-    // Search through sigma for variables starting with prefix
-    // Look for the highest-numbered one (most recent)
-    int maxNum = -1;
-    string bestKey = "";
+void SEE::bindValue(const string &varName, Expr *value)
+{
+    sigma.setValue(varName, value);
 
-    for (auto &entry : sigma.getAllEntries())
-    {
-        const string &varName = entry.first;
+    string global;
+    int version;
+    if (!parseMaterializedName(varName, global, version))
+        return;
 
-        // Check if this variable starts with prefix
-        if (varName.compare(0, prefix.length(), prefix) == 0)
-        {
-            // Extract the number suffix
-            string numStr = varName.substr(prefix.length());
-            int num = -1;
-            try
-            {
-                num = stoi(numStr);
-            }
-            catch (...)
-            {
-                continue;
-            }
-
-            // Check if this is a Map
-            Expr *value = entry.second;
-            if (value && value->exprType == ExprType::MAP)
-            {
-                Map *mapExpr = dynamic_cast<Map *>(value);
-                if (mapExpr && !mapExpr->value.empty())
-                {
-                    // Found a non-empty map, update if it's the highest number
-                    if (num > maxNum)
-                    {
-                        maxNum = num;
-                        // Get the first key from this map
-                        bestKey = mapExpr->value[0].first->name;
-                        cout << "    [findKeyFromMapInSigma] Found " << varName
-                             << " with " << mapExpr->value.size() << " entries, key: " << bestKey << endl;
-                    }
-                }
-                else
-                {
-                    cout << "    [findKeyFromMapInSigma] " << varName << " is empty map" << endl;
-                }
-            }
-        }
+    MaterializedKeys &slot = latestKeys[global];
+    Map *mapExpr = value ? value->as<Map>() : nullptr;
+    if (mapExpr && !mapExpr->value.empty())
+    {
+        if (version < slot.version)
+            return;
+        slot.version = version;
+        slot.keys.clear();
+        for (const auto &kv : mapExpr->value)
+            slot.keys.push_back(kv.first->name);
+        cout << "    [KEYS] " << global << " -> " << varName << " (" << slot.keys.size()
+             << " entries, key: " << slot.keys[0] << ")" << endl;
+        return;
     }
+    if (version != slot.version)
+        return;
 
-    if (bestKey.empty())
+    // The newest snapshot was emptied: fall back to the next one down
+    slot = MaterializedKeys();
+    for (const auto &entry : sigma.getAllEntries())
     {
-        cout << "    [findKeyFromMapInSigma] No non-empty map found for " << prefix << endl;
+        string g;
+        int n;
+        Map *m = entry.second ? entry.second->as<Map>() : nullptr;
+        if (!m || m->value.empty() || !parseMaterializedName(entry.first, g, n) || g != global || n <= slot.version)
+            continue;
+        slot.version = n;
+        slot.keys.clear();
+        for (const auto &kv : m->value)
+            slot.keys.push_back(kv.first->name);
     }
-
-    return bestKey;
-}
-
-string SEE::findRestaurantIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_R_");
-}
-
-string SEE::findMenuItemIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_M_");
-}
-
-string SEE::findOrderIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_O_");
-}
-
-string SEE::findProductIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_P_");
-}
-
-string SEE::findCartIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_C_");
-}
-
-string SEE::findReviewIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_Rev_");
-}
-
-string SEE::findOrderStatusFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_OrderStatus_");
-}
-//restaurant webapp
-string SEE::findSellersFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_Sellers_");
-}
-
-string SEE::findStockFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_Stock_");
 }
-// ========================================
-// LIBRARY ID RESOLUTION HELPERS
-// ========================================
 
-string SEE::findBookCodeFromSigma()
+string SEE::latestKey(const string &global) const
 {
-    return findKeyFromMapInSigma("tmp_B_");
+    auto it = latestKeys.find(global);
+    if (it == latestKeys.end() || it->second.keys.empty())
+        return "";
+    return it->second.keys[0];
 }
 
-string SEE::findStudentIdFromSigma()
+String *SEE::resolvePlaceholder(const string &varName, Expr *value)
 {
-    return findKeyFromMapInSigma("tmp_S_");
-}
+    Placeholder *ph = value ? value->as<Placeholder>() : nullptr;
+    if (!ph)
+        return nullptr;
 
-string SEE::findRequestIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_Req_");
+    cout << "    [EVAL] Found placeholder " << ph->value << ", attempting runtime resolution" << endl;
+    string resolvedId = latestKey(ph->global);
+    if (resolvedId.empty())
+    {
+        cout << "    [EVAL] No materialized " << ph->global << " yet" << endl;
+        return nullptr;
+    }
+    cout << "    [EVAL] Resolved to: " << resolvedId << endl;
+    String *resolved = new String(resolvedId);
+    sigma.setValue(varName, resolved);
+    return resolved;
 }
 
-string SEE::findLoanIdFromSigma()
-{
-    return findKeyFromMapInSigma("tmp_Loans_");
-}
 Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 {
+    TRACE_SPAN_IF(span, Tracer::sampleEval(), "evaluateExpr", "see");
     CloneVisitor cloner;
 
     if (expr.exprType == ExprType::FUNCCALL)
     {
-        FuncCall &fc = dynamic_cast<FuncCall &>(expr);
+        FuncCall &fc = expr.cast<FuncCall>();
         cout << "  [EVAL] FuncCall: " << fc.name << " with " << fc.args.size() << " args" << endl;
 
         // Handle input() - creates a new symbolic variable
         if (fc.name == "input" && fc.args.size() == 0)
         {
+            // Process-wide numbering; symbolic execution runs on one thread
             static int symVarCounter = 0;
             SymVar *sv = new SymVar(symVarCounter++);
             cout << "    [EVAL] input() returns new symbolic variable: X" << sv->getNum() << endl;
@@ -929,7 +1096,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 
             if (mapExpr->exprType == ExprType::MAP)
             {
-                Map *map = dynamic_cast<Map *>(mapExpr);
+                Map *map = mapExpr->as<Map>();
                 cout << "    [EVAL] Map expr evaluated: " << exprToString(mapExpr) << endl;
                 cout << "    [EVAL] Domain has " << map->value.size() << " keys" << endl;
 
@@ -962,21 +1129,21 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 
             if (setExpr->exprType == ExprType::SET)
             {
-                Set *set = dynamic_cast<Set *>(setExpr);
+                Set *set = setExpr->as<Set>();
 
                 // Get element value as string for comparison
                 string elemStr;
                 if (element->exprType == ExprType::STRING)
                 {
-                    elemStr = dynamic_cast<String *>(element)->value;
+                    elemStr = element->as<String>()->value;
                 }
                 else if (element->exprType == ExprType::NUM)
                 {
-                    elemStr = to_string(dynamic_cast<Num *>(element)->value);
+                    elemStr = to_string(element->as<Num>()->value);
                 }
                 else if (element->exprType == ExprType::VAR)
                 {
-                    elemStr = dynamic_cast<Var *>(element)->name;
+                    elemStr = element->as<Var>()->name;
                 }
                 else
                 {
@@ -993,11 +1160,11 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
                     Expr *setElem = set->elements[i].get();
                     if (setElem->exprType == ExprType::STRING)
                     {
-                        setElemStr = dynamic_cast<String *>(setElem)->value;
+                        setElemStr = setElem->as<String>()->value;
                     }
                     else if (setElem->exprType == ExprType::NUM)
                     {
-                        setElemStr = to_string(dynamic_cast<Num *>(setElem)->value);
+                        setElemStr = to_string(setElem->as<Num>()->value);
                     }
                     else
                     {
@@ -1032,21 +1199,21 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 
             if (setExpr->exprType == ExprType::SET)
             {
-                Set *set = dynamic_cast<Set *>(setExpr);
+                Set *set = setExpr->as<Set>();
 
                 // Get element value as string for comparison
                 string elemStr;
                 if (element->exprType == ExprType::STRING)
                 {
-                    elemStr = dynamic_cast<String *>(element)->value;
+                    elemStr = element->as<String>()->value;
                 }
                 else if (element->exprType == ExprType::NUM)
                 {
-                    elemStr = to_string(dynamic_cast<Num *>(element)->value);
+                    elemStr = to_string(element->as<Num>()->value);
                 }
                 else if (element->exprType == ExprType::VAR)
                 {
-                    elemStr = dynamic_cast<Var *>(element)->name;
+                    elemStr = element->as<Var>()->name;
                 }
                 else
                 {
@@ -1060,11 +1227,11 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
                     Expr *setElem = set->elements[i].get();
                     if (setElem->exprType == ExprType::STRING)
                     {
-                        setElemStr = dynamic_cast<String *>(setElem)->value;
+                        setElemStr = setElem->as<String>()->value;
                     }
                     else if (setElem->exprType == ExprType::NUM)
                     {
-                        setElemStr = to_string(dynamic_cast<Num *>(setElem)->value);
+                        setElemStr = to_string(setElem->as<Num>()->value);
                     }
                     else
                     {
@@ -1098,22 +1265,22 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 
             if (mapExpr->exprType == ExprType::MAP)
             {
-                Map *map = dynamic_cast<Map *>(mapExpr);
+                Map *map = mapExpr->as<Map>();
                 cout << "    [EVAL] Map expr evaluated: " << exprToString(mapExpr) << endl;
 
                 // Get key as string for comparison
                 string keyStr;
                 if (keyExpr->exprType == ExprType::STRING)
                 {
-                    keyStr = dynamic_cast<String *>(keyExpr)->value;
+                    keyStr = keyExpr->as<String>()->value;
                 }
                 else if (keyExpr->exprType == ExprType::NUM)
                 {
-                    keyStr = to_string(dynamic_cast<Num *>(keyExpr)->value);
+                    keyStr = to_string(keyExpr->as<Num>()->value);
                 }
                 else if (keyExpr->exprType == ExprType::VAR)
                 {
-                    keyStr = dynamic_cast<Var *>(keyExpr)->name;
+                    keyStr = keyExpr->as<Var>()->name;
                 }
                 else
                 {
@@ -1151,19 +1318,19 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
             // Compare concrete values
             if (left->exprType == ExprType::STRING && right->exprType == ExprType::STRING)
             {
-                bool result = dynamic_cast<String *>(left)->value == dynamic_cast<String *>(right)->value;
+                bool result = left->as<String>()->value == right->as<String>()->value;
                 cout << "    [EVAL] Eq result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
             if (left->exprType == ExprType::NUM && right->exprType == ExprType::NUM)
             {
-                bool result = dynamic_cast<Num *>(left)->value == dynamic_cast<Num *>(right)->value;
+                bool result = left->as<Num>()->value == right->as<Num>()->value;
                 cout << "    [EVAL] Eq result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
             if (left->exprType == ExprType::BOOL_CONST && right->exprType == ExprType::BOOL_CONST)
             {
-                bool result = dynamic_cast<BoolConst *>(left)->value == dynamic_cast<BoolConst *>(right)->value;
+                bool result = left->as<BoolConst>()->value == right->as<BoolConst>()->value;
                 cout << "    [EVAL] Eq result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
@@ -1191,7 +1358,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
 
                 if (argResult->exprType == ExprType::BOOL_CONST)
                 {
-                    BoolConst *bc = dynamic_cast<BoolConst *>(argResult);
+                    BoolConst *bc = argResult->as<BoolConst>();
                     if (!bc->value)
                     {
                         anyFalse = true;
@@ -1215,7 +1382,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
                 bool reallyAllTrue = true;
                 for (auto &arg : evaluatedArgs)
                 {
-                    if (arg->exprType != ExprType::BOOL_CONST || !dynamic_cast<BoolConst *>(arg)->value)
+                    if (arg->exprType != ExprType::BOOL_CONST || !arg->as<BoolConst>()->value)
                     {
                         reallyAllTrue = false;
                         break;
@@ -1257,7 +1424,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
             // If both are BoolConst, evaluate
             if (left->exprType == ExprType::BOOL_CONST && right->exprType == ExprType::BOOL_CONST)
             {
-                bool result = dynamic_cast<BoolConst *>(left)->value && dynamic_cast<BoolConst *>(right)->value;
+                bool result = left->as<BoolConst>()->value && right->as<BoolConst>()->value;
                 cout << "    [EVAL] And result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
@@ -1276,7 +1443,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
             // If both are BoolConst, evaluate
             if (left->exprType == ExprType::BOOL_CONST && right->exprType == ExprType::BOOL_CONST)
             {
-                bool result = dynamic_cast<BoolConst *>(left)->value || dynamic_cast<BoolConst *>(right)->value;
+                bool result = left->as<BoolConst>()->value || right->as<BoolConst>()->value;
                 cout << "    [EVAL] Or result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
@@ -1294,7 +1461,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
             // If BoolConst, evaluate
             if (operand->exprType == ExprType::BOOL_CONST)
             {
-                bool result = !dynamic_cast<BoolConst *>(operand)->value;
+                bool result = !operand->as<BoolConst>()->value;
                 cout << "    [EVAL] Not result: " << (result ? "true" : "false") << endl;
                 return new BoolConst(result);
             }
@@ -1323,13 +1490,15 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     }
     else if (expr.exprType == ExprType::NUM)
     {
-        Num *result = new Num(dynamic_cast<Num &>(expr).value);
+        Num *result = new Num(expr.cast<Num>().value);
         cout << "  [EVAL] Num: " << exprToString(result) << endl;
         return result;
     }
     else if (expr.exprType == ExprType::STRING)
     {
-        String *result = new String(dynamic_cast<String &>(expr).value);
+        String &str = expr.cast<String>();
+        Placeholder *ph = str.as<Placeholder>();
+        String *result = ph ? new Placeholder(ph->global, ph->value) : new String(str.value);
         cout << "  [EVAL] String: " << exprToString(result) << endl;
         return result;
     }
@@ -1341,7 +1510,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     }
     else if (expr.exprType == ExprType::VAR)
     {
-        Var &v = dynamic_cast<Var &>(expr);
+        Var &v = expr.cast<Var>();
         cout << "  [EVAL] Var lookup: " << v.name << endl;
 
         // First, try direct lookup
@@ -1349,135 +1518,9 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
         {
             Expr *value = sigma.getValue(v.name);
 
-            // Check if the value is a placeholder that needs runtime resolution
-            if (value->exprType == ExprType::STRING)
-            {
-                String *strVal = dynamic_cast<String *>(value);
-                if (strVal->value == "__NEEDS_RESTAURANT_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_RESTAURANT_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findRestaurantIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_MENUITEM_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_MENUITEM_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findMenuItemIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_ORDER_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_ORDER_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findOrderIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-
-                else if (strVal->value == "__NEEDS_PRODUCT_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_PRODUCT_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findProductIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_CART_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_CART_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findCartIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_REVIEW_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_REVIEW_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findReviewIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                // ========================================
-                // LIBRARY PLACEHOLDER RESOLUTION
-                // ========================================
-                else if (strVal->value == "__NEEDS_BOOK_CODE__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_BOOK_CODE__, attempting runtime resolution" << endl;
-                    string resolvedId = findBookCodeFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_STUDENT_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_STUDENT_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findStudentIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_REQUEST_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_REQUEST_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findRequestIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-                else if (strVal->value == "__NEEDS_LOAN_ID__")
-                {
-                    cout << "    [EVAL] Found placeholder __NEEDS_LOAN_ID__, attempting runtime resolution" << endl;
-                    string resolvedId = findLoanIdFromSigma();
-                    if (!resolvedId.empty())
-                    {
-                        cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                        String *resolved = new String(resolvedId);
-                        sigma.setValue(v.name, resolved);
-                        return resolved;
-                    }
-                }
-            }
+            // Placeholders resolve against the latest materialized key set
+            if (String *resolved = resolvePlaceholder(v.name, value))
+                return resolved;
 
             cout << "    [EVAL] Found in sigma: " << exprToString(value) << endl;
             return value;
@@ -1494,95 +1537,8 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
             {
                 Expr *value = sigma.getValue(suffixedName);
 
-                // NEW: Check for placeholder in suffixed name too
-                if (value->exprType == ExprType::STRING)
-                {
-                    String *strVal = dynamic_cast<String *>(value);
-                    if (strVal->value == "__NEEDS_RESTAURANT_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_RESTAURANT_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findRestaurantIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_MENUITEM_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_MENUITEM_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findMenuItemIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_ORDER_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_ORDER_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findOrderIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_BOOK_CODE__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_BOOK_CODE__, attempting runtime resolution" << endl;
-                        string resolvedId = findBookCodeFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_STUDENT_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_STUDENT_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findStudentIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_REQUEST_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_REQUEST_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findRequestIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                    else if (strVal->value == "__NEEDS_LOAN_ID__")
-                    {
-                        cout << "    [EVAL] Found placeholder __NEEDS_LOAN_ID__, attempting runtime resolution" << endl;
-                        string resolvedId = findLoanIdFromSigma();
-                        if (!resolvedId.empty())
-                        {
-                            cout << "    [EVAL] Resolved to: " << resolvedId << endl;
-                            String *resolved = new String(resolvedId);
-                            sigma.setValue(suffixedName, resolved);
-                            return resolved;
-                        }
-                    }
-                }
+                if (String *resolved = resolvePlaceholder(suffixedName, value))
+                    return resolved;
 
                 cout << "    [EVAL] Found in sigma: " << exprToString(value) << endl;
                 return value;
@@ -1595,7 +1551,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     else if (expr.exprType == ExprType::SET)
     {
         // Evaluate each element in the set
-        Set &set = dynamic_cast<Set &>(expr);
+        Set &set = expr.cast<Set>();
         cout << "  [EVAL] Set with " << set.elements.size() << " elements" << endl;
 
         vector<unique_ptr<Expr>> evaluatedElements;
@@ -1612,7 +1568,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     else if (expr.exprType == ExprType::MAP)
     {
         // Evaluate each key-value pair in the map
-        Map &map = dynamic_cast<Map &>(expr);
+        Map &map = expr.cast<Map>();
         cout << "  [EVAL] Map with " << map.value.size() << " entries" << endl;
 
         vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> evaluatedPairs;
@@ -1632,7 +1588,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     else if (expr.exprType == ExprType::TUPLE)
     {
         // Evaluate each element in the tuple
-        Tuple &tuple = dynamic_cast<Tuple &>(expr);
+        Tuple &tuple = expr.cast<Tuple>();
         cout << "  [EVAL] Tuple with " << tuple.exprs.size() << " elements" << endl;
 
         vector<unique_ptr<Expr>> evaluatedExprs;
@@ -1650,13 +1606,13 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     // Add Boolean expression types
     else if (expr.exprType == ExprType::BOOL_CONST)
     {
-        BoolConst *result = new BoolConst(dynamic_cast<BoolConst &>(expr).value);
+        BoolConst *result = new BoolConst(expr.cast<BoolConst>().value);
         cout << "  [EVAL] BoolConst: " << exprToString(result) << endl;
         return result;
     }
     else if (expr.exprType == ExprType::BINARY_OP)
     {
-        BinaryOpExpr &binop = dynamic_cast<BinaryOpExpr &>(expr);
+        BinaryOpExpr &binop = expr.cast<BinaryOpExpr>();
         cout << "  [EVAL] BinaryOpExpr" << endl;
 
         // Evaluate operands
@@ -1671,7 +1627,7 @@ Expr *SEE::evaluateExpr(Expr &expr, SymbolTable &st)
     }
     else if (expr.exprType == ExprType::UNARY_OP)
     {
-        UnaryOpExpr &unop = dynamic_cast<UnaryOpExpr &>(expr);
+        UnaryOpExpr &unop = expr.cast<UnaryOpExpr>();
         cout << "  [EVAL] UnaryOpExpr" << endl;
 
         // Evaluate operand
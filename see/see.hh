@@ -1,7 +1,10 @@
 #ifndef SEE_HH
 #define SEE_HH
 
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,6 +20,15 @@ using namespace std;
 // see = symbolic execution engine 
 
 
+// Saved state behind a named backend checkpoint: the concrete prefix that
+// produced it (reset/restore statement excluded, checkpoint statement
+// included) plus sigma and the path constraint at that point.
+struct CheckpointSnapshot {
+    vector<Ref<Stmt>> prefix;               // shared with the program
+    map<string, unique_ptr<Expr>> sigma;
+    vector<Ref<Expr>> pathConstraint;       // shared with the SEE that took it
+};
+
 // Two variables to be added 
 // one corresponding to sigma (value environment - string to expr mapping) 
 //and one corresponding to the path constraint (vector of exprs)
@@ -26,7 +38,7 @@ class SEE {
         SymVar *symVar=nullptr;
 
         ValueEnvironment sigma;  // Value environment: maps variable names to their values
-        vector<Expr*> pathConstraint;
+        vector<Ref<Expr>> pathConstraint;
         FunctionFactory* functionFactory; // Factory for creating API functions
 
         // Maps base variable names to their current suffixed names
@@ -37,25 +49,27 @@ class SEE {
         // "email0" -> "email", "password1" -> "password"
         string extractBaseName(const string& suffixedName);
 
-        // Helper methods for runtime placeholder resolution, restaurant ID, menu item ID, order ID
-        string findKeyFromMapInSigma(const string& prefix);
-        string findRestaurantIdFromSigma();
-        string findMenuItemIdFromSigma();
-        string findOrderIdFromSigma();
-        // E-commerce ID resolution helpers
-        string findProductIdFromSigma();
-        string findCartIdFromSigma();
-        string findReviewIdFromSigma();
-        string findOrderStatusFromSigma();
-        string findSellersFromSigma();
-        string findStockFromSigma();
-        // Library ID resolution helpers
-        string findBookCodeFromSigma();
-        string findStudentIdFromSigma();
-        string findRequestIdFromSigma();
-        string findLoanIdFromSigma();
-        
-        unique_ptr<Expr> computePathConstraint(vector<Expr*>);
+        // Index from each global ("R", "B", ...) to its latest materialized
+        // key set: the keys of the highest-numbered non-empty tmp_G_i map.
+        // Maintained by bindValue, so placeholder lookups are O(1).
+        struct MaterializedKeys {
+            int version = -1;
+            vector<string> keys;
+        };
+        unordered_map<string, MaterializedKeys> latestKeys;
+
+        // Concrete assertions that evaluated to false in the last execute()
+        size_t failedAssertions = 0;
+
+        // sigma[varName] := value, updating latestKeys for tmp_G_i maps
+        void bindValue(const string& varName, Expr* value);
+        // Resolve a placeholder through latestKeys (nullptr if still pending)
+        String* resolvePlaceholder(const string& varName, Expr* value);
+
+        unique_ptr<Expr> computePathConstraint(const vector<Ref<Expr>>&);
+        // Record a constraint (a concrete true is skipped). Snapshots and the
+        // conjunction share the recorded nodes instead of copying them.
+        void addConstraint(Expr* constraint);
         // If the statement is a call to an API function, then none of its parameters
         // should be variables whose values are symbolic expression.
         bool isReady(Stmt&, SymbolTable&);
@@ -73,6 +87,23 @@ class SEE {
         // Built-in functions: Add, Sub, Mul, Eq, Lt, Gt, And, Or, Not, input
         bool isAPI(const FuncCall& fc);
 
+        // Process-wide: checkpoints outlive the SEE instance of the test
+        // that took them so later sequences sharing the prefix can restore.
+        // Testers and daemon sessions share it, hence the lock; entries are
+        // copied out under it, never referenced.
+        static map<string, CheckpointSnapshot> checkpoints;
+        static mutex checkpointsMutex;
+        // Set once the backend refuses a checkpoint; stops further attempts
+        static atomic<bool> checkpointsUnsupported;
+
+        // Recognise `_ := checkpoint(id)` / `_ := restore(id)`; returns the id
+        static bool isCheckpointStmt(const Stmt&, const string& fname, string& id);
+        void takeCheckpoint(const Program&, size_t index, const string& id);
+        // True when the backend and sigma were rolled forward to `id`
+        bool restoreCheckpoint(const string& id);
+        // reset() with no id, checkpoint(id) / restore(id) with one
+        bool callTestApi(const string& fname, const string* id = nullptr);
+
 	void executeStmt(Stmt&, SymbolTable&);
 	Expr* evaluateExpr(Expr&, SymbolTable&);
     public:
@@ -86,8 +117,18 @@ class SEE {
         // Solve path constraints and return a result
         unique_ptr<Expr> computePathConstraint();
         
+        // Checkpoint registry (see CheckpointSnapshot)
+        // Copies the prefix saved under `id`; false when there is none
+        static bool checkpointPrefix(const string& id, vector<Ref<Stmt>>& prefix);
+        // Forget every checkpoint (another app or spec takes over the backend)
+        static void clearCheckpoints();
+
+        // First key of the latest materialized map of `global`, "" if none
+        string latestKey(const string& global) const;
+
         // Getters for testing
         ValueEnvironment& getSigma() { return sigma; }
-        vector<Expr*>& getPathConstraint() { return pathConstraint; }
+        const vector<Ref<Expr>>& getPathConstraint() const { return pathConstraint; }
+        size_t getFailedAssertions() const { return failedAssertions; }
 };
 #endif
@@ -0,0 +1,49 @@
+#ifndef STUBFUNCTIONFACTORY_HH
+#define STUBFUNCTIONFACTORY_HH
+
+#include "functionfactory.hh"
+#include "../ast.hh"
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+/* ============================================================
+ * StubFunctionFactory - in-process backend for benchmarks
+ *
+ * Every API call succeeds immediately, so SEE and the tester can be
+ * timed without a server or network in the way. Calls that create a
+ * resource (create*, save*, register*) return a fresh id string, like the
+ * real backends; all others return the status code. Calls are counted
+ * per function name.
+ * ============================================================ */
+class StubFunctionFactory : public FunctionFactory
+{
+private:
+    int status;
+    map<string, size_t> calls;
+    size_t nextId = 0;
+
+public:
+    explicit StubFunctionFactory(int status = 200) : status(status) {}
+
+    unique_ptr<Function> getFunction(string fname, vector<Expr *> args) override;
+
+    const map<string, size_t> &getCalls() const { return calls; }
+    size_t totalCalls() const;
+    void resetCalls() { calls.clear(); }
+};
+
+class StubFunction : public Function
+{
+private:
+    int status;
+    string id;   // non-empty: returned instead of the status
+
+public:
+    StubFunction(int status, string id) : status(status), id(std::move(id)) {}
+    unique_ptr<Expr> execute() override;
+};
+
+#endif // STUBFUNCTIONFACTORY_HH
@@ -1,4 +1,5 @@
 #include "tripvaultfunctionfactory.hh"
+#include "exprjsonwriter.hh"
 #include <iostream>
 #include <stdexcept>
 #include <set>
@@ -18,12 +19,12 @@ string TripVaultAPIFunction::extractString(Expr* expr) {
         throw runtime_error("Null expression in extractString");
 
     if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
+        String* str = expr->as<String>();
         return str->value;
     }
 
     if (expr->exprType == ExprType::VAR) {
-        Var* var = dynamic_cast<Var*>(expr);
+        Var* var = expr->as<Var>();
         return var->name;
     }
 
@@ -35,61 +36,24 @@ int TripVaultAPIFunction::extractInt(Expr* expr) {
         throw runtime_error("Null expression in extractInt");
 
     if (expr->exprType == ExprType::NUM) {
-        Num* num = dynamic_cast<Num*>(expr);
+        Num* num = expr->as<Num>();
         return num->value;
     }
 
     // Handle String/Var that may contain a numeric value from Z3
     if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
+        String* str = expr->as<String>();
         try { return std::stoi(str->value); } catch (...) { return 500; }
     }
 
     if (expr->exprType == ExprType::VAR) {
-        Var* var = dynamic_cast<Var*>(expr);
+        Var* var = expr->as<Var>();
         try { return std::stoi(var->name); } catch (...) { return 500; }
     }
 
     return 500; // fallback default amount
 }
 
-json TripVaultAPIFunction::extractJson(Expr* expr) {
-    if (!expr)
-        return json::object();
-
-    if (expr->exprType == ExprType::MAP) {
-        Map* map = dynamic_cast<Map*>(expr);
-        json obj = json::object();
-
-        for (const auto& kv : map->value) {
-            string key = kv.first->name;
-
-            if (kv.second->exprType == ExprType::STRING) {
-                String* val = dynamic_cast<String*>(kv.second.get());
-                obj[key] = val->value;
-            } else if (kv.second->exprType == ExprType::NUM) {
-                Num* val = dynamic_cast<Num*>(kv.second.get());
-                obj[key] = val->value;
-            } else {
-                obj[key] = "unsupported_type";
-            }
-        }
-
-        return obj;
-    }
-
-    if (expr->exprType == ExprType::STRING) {
-        String* str = dynamic_cast<String*>(expr);
-        try {
-            return json::parse(str->value);
-        } catch (...) {
-            return str->value;
-        }
-    }
-
-    return json::object();
-}
-
 string TripVaultAPIFunction::getCurrentToken(const string& email) {
     // First check local cache
     auto it = factory->getT().find(email);
@@ -120,6 +84,15 @@ string TripVaultAPIFunction::getCurrentToken(const string& email) {
  * ============================================================ */
 
 // ========== RESET ==========
+void TripVaultFunctionFactory::clearCaches() {
+    getU().clear();
+    getT().clear();
+    getTrips().clear();
+    getMembers().clear();
+    getE().clear();
+    getProposals().clear();
+}
+
 ResetFunc::ResetFunc(TripVaultFunctionFactory* factory, vector<Expr*> args)
     : TripVaultAPIFunction(factory, args) {}
 
@@ -131,12 +104,7 @@ unique_ptr<Expr> ResetFunc::execute() {
         HttpResponse resp = factory->getHttpClient()->post("/api/test/reset", body);
 
         if (resp.statusCode >= 200 && resp.statusCode < 300) {
-            factory->getU().clear();
-            factory->getT().clear();
-            factory->getTrips().clear();
-            factory->getMembers().clear();
-            factory->getE().clear();
-            factory->getProposals().clear();
+            factory->clearCaches();
             return make_unique<Num>(200);
         }
         return make_unique<Num>(resp.statusCode);
@@ -186,11 +154,7 @@ SetUFunc::SetUFunc(TripVaultFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetUFunc::execute() {
     cout << "[SetUFunc] Setting U..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getU().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getU()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getU());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetUFunc] Error: " << e.what() << endl;
@@ -238,11 +202,7 @@ SetTFunc::SetTFunc(TripVaultFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetTFunc::execute() {
     cout << "[SetTFunc] Setting T..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getT().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getT()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getT());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetTFunc] Error: " << e.what() << endl;
@@ -290,11 +250,7 @@ SetTripsFunc::SetTripsFunc(TripVaultFunctionFactory* factory, vector<Expr*> args
 unique_ptr<Expr> SetTripsFunc::execute() {
     cout << "[SetTripsFunc] Setting Trips..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getTrips().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getTrips()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getTrips());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetTripsFunc] Error: " << e.what() << endl;
@@ -342,11 +298,7 @@ SetMembersFunc::SetMembersFunc(TripVaultFunctionFactory* factory, vector<Expr*>
 unique_ptr<Expr> SetMembersFunc::execute() {
     cout << "[SetMembersFunc] Setting Members..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getMembers().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getMembers()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getMembers());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetMembersFunc] Error: " << e.what() << endl;
@@ -394,11 +346,7 @@ SetEFunc::SetEFunc(TripVaultFunctionFactory* factory, vector<Expr*> args)
 unique_ptr<Expr> SetEFunc::execute() {
     cout << "[SetEFunc] Setting E..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getE().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getE()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getE());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetEFunc] Error: " << e.what() << endl;
@@ -446,11 +394,7 @@ SetProposalsFunc::SetProposalsFunc(TripVaultFunctionFactory* factory, vector<Exp
 unique_ptr<Expr> SetProposalsFunc::execute() {
     cout << "[SetProposalsFunc] Setting Proposals..." << endl;
     try {
-        json mapData = extractJson(arguments[0]);
-        factory->getProposals().clear();
-        for (auto& [k, v] : mapData.items()) {
-            factory->getProposals()[k] = v.get<string>();
-        }
+        factory->getJsonWriter().fillCache(arguments[0], factory->getProposals());
         return make_unique<Num>(200);
     } catch (const exception& e) {
         cerr << "[SetProposalsFunc] Error: " << e.what() << endl;
@@ -1009,35 +953,47 @@ TripVaultFunctionFactory::TripVaultFunctionFactory(const string& baseUrl)
     httpClient = make_unique<HttpClient>(baseUrl);
 }
 
+bool TripVaultFunctionFactory::isReadOnly(const string& fname) const {
+    return fname == "getUserTrips" || fname == "getExpenses" || fname == "getProposals";
+}
+
 unique_ptr<Function> TripVaultFunctionFactory::getFunction(string fname, vector<Expr*> args) {
-    if (fname == "reset")             return make_unique<ResetFunc>(this, args);
-    if (fname == "get_U")             return make_unique<GetUFunc>(this, args);
-    if (fname == "set_U")             return make_unique<SetUFunc>(this, args);
-    if (fname == "get_T")             return make_unique<GetTFunc>(this, args);
-    if (fname == "set_T")             return make_unique<SetTFunc>(this, args);
-    if (fname == "get_Trips")         return make_unique<GetTripsFunc>(this, args);
-    if (fname == "set_Trips")         return make_unique<SetTripsFunc>(this, args);
-    if (fname == "get_Members")       return make_unique<GetMembersFunc>(this, args);
-    if (fname == "set_Members")       return make_unique<SetMembersFunc>(this, args);
-    if (fname == "get_E")             return make_unique<GetEFunc>(this, args);
-    if (fname == "set_E")             return make_unique<SetEFunc>(this, args);
-    if (fname == "get_Proposals")     return make_unique<GetProposalsFunc>(this, args);
-    if (fname == "set_Proposals")     return make_unique<SetProposalsFunc>(this, args);
-    if (fname == "registerUser")      return make_unique<RegisterUserFunc>(this, args);
-    if (fname == "loginUser")         return make_unique<LoginUserFunc>(this, args);
-    if (fname == "createTrip")        return make_unique<CreateTripFunc>(this, args);
-    if (fname == "getUserTrips")      return make_unique<GetUserTripsFunc>(this, args);
-    if (fname == "updateTrip")        return make_unique<UpdateTripFunc>(this, args);
-    if (fname == "deleteTrip")        return make_unique<DeleteTripFunc>(this, args);
-    if (fname == "addMember")         return make_unique<AddMemberFunc>(this, args);
-    if (fname == "joinByInvite")      return make_unique<JoinByInviteFunc>(this, args);
-    if (fname == "removeMember")      return make_unique<RemoveMemberFunc>(this, args);
-    if (fname == "createExpense")     return make_unique<CreateExpenseFunc>(this, args);
-    if (fname == "getExpenses")       return make_unique<GetExpensesFunc>(this, args);
-    if (fname == "deleteExpense")     return make_unique<DeleteExpenseFunc>(this, args);
-    if (fname == "createProposal")    return make_unique<CreateProposalFunc>(this, args);
-    if (fname == "getProposals")      return make_unique<GetProposalsListFunc>(this, args);
-    if (fname == "deleteProposal")    return make_unique<DeleteProposalFunc>(this, args);
+    static const FunctionTable<TripVaultFunctionFactory> functions = {
+        {"reset", &makeFunction<ResetFunc>},
+        {"checkpoint", &makeCheckpoint<TripVaultFunctionFactory>},
+        {"restore", &makeRestore<TripVaultFunctionFactory>},
+        {"get_U", &makeFunction<GetUFunc>},
+        {"set_U", &makeFunction<SetUFunc>},
+        {"get_T", &makeFunction<GetTFunc>},
+        {"set_T", &makeFunction<SetTFunc>},
+        {"get_Trips", &makeFunction<GetTripsFunc>},
+        {"set_Trips", &makeFunction<SetTripsFunc>},
+        {"get_Members", &makeFunction<GetMembersFunc>},
+        {"set_Members", &makeFunction<SetMembersFunc>},
+        {"get_E", &makeFunction<GetEFunc>},
+        {"set_E", &makeFunction<SetEFunc>},
+        {"get_Proposals", &makeFunction<GetProposalsFunc>},
+        {"set_Proposals", &makeFunction<SetProposalsFunc>},
+        {"registerUser", &makeFunction<RegisterUserFunc>},
+        {"loginUser", &makeFunction<LoginUserFunc>},
+        {"createTrip", &makeFunction<CreateTripFunc>},
+        {"getUserTrips", &makeFunction<GetUserTripsFunc>},
+        {"updateTrip", &makeFunction<UpdateTripFunc>},
+        {"deleteTrip", &makeFunction<DeleteTripFunc>},
+        {"addMember", &makeFunction<AddMemberFunc>},
+        {"joinByInvite", &makeFunction<JoinByInviteFunc>},
+        {"removeMember", &makeFunction<RemoveMemberFunc>},
+        {"createExpense", &makeFunction<CreateExpenseFunc>},
+        {"getExpenses", &makeFunction<GetExpensesFunc>},
+        {"deleteExpense", &makeFunction<DeleteExpenseFunc>},
+        {"createProposal", &makeFunction<CreateProposalFunc>},
+        {"getProposals", &makeFunction<GetProposalsListFunc>},
+        {"deleteProposal", &makeFunction<DeleteProposalFunc>},
+    };
+
+    auto it = functions.find(fname);
+    if (it != functions.end())
+        return it->second(this, args);
 
     throw runtime_error("TripVaultFunctionFactory: unknown function: " + fname);
 }
@@ -1,12 +1,18 @@
 #include "z3solver.hh"
 #include "../symvar.hh"
+#include "../trace.hh"
+#include "../metrics.hh"
+#include <algorithm>
 #include <iostream>
 
 // ============================================================================
 // Z3InputMaker Implementation
 // ============================================================================
 
-Z3InputMaker::Z3InputMaker(TypeMap* tm) : typeMap(tm) {}
+Z3InputMaker::Z3InputMaker(TypeMap* tm)
+    : ownedCtx(make_unique<z3::context>()), ctx(*ownedCtx), typeMap(tm) {}
+
+Z3InputMaker::Z3InputMaker(z3::context& shared, TypeMap* tm) : ctx(shared), typeMap(tm) {}
 
 Z3InputMaker::~Z3InputMaker() {
     // Clean up allocated z3::expr pointers
@@ -24,9 +30,9 @@ Z3InputMaker::~Z3InputMaker() {
 // ============================================================================
 // Z3 Sort Helpers
 // ============================================================================
- z3::expr Z3InputMaker::convertArg(const unique_ptr<Expr>& arg){
+ z3::expr Z3InputMaker::convertArg(const Ref<Expr>& arg){
         if (arg->exprType == ExprType::SYMVAR) {
-            SymVar* sv = dynamic_cast<SymVar*>(arg.get());
+            SymVar* sv = arg->as<SymVar>();
             unsigned int num = sv->getNum();
             
             if (symVarMap.find(num) == symVarMap.end()) {
@@ -45,6 +51,8 @@ Z3InputMaker::~Z3InputMaker() {
         }
 }
 z3::sort Z3InputMaker::getStringSort() {
+    if (abstractStrings)
+        return ctx.uninterpreted_sort("Str");
     return ctx.string_sort();
 }
 
@@ -74,7 +82,7 @@ z3::sort Z3InputMaker::typeExprToSort(TypeExpr* type) {
     
     switch (type->typeExprType) {
         case TypeExprType::TYPE_CONST: {
-            TypeConst* tc = dynamic_cast<TypeConst*>(type);
+            TypeConst* tc = type->as<TypeConst>();
             if (tc->name == "string") {
                 return getStringSort();
             } else if (tc->name == "int" || tc->name == "integer") {
@@ -85,12 +93,12 @@ z3::sort Z3InputMaker::typeExprToSort(TypeExpr* type) {
             return ctx.int_sort(); // Default
         }
         case TypeExprType::SET_TYPE: {
-            SetType* st = dynamic_cast<SetType*>(type);
+            SetType* st = type->as<SetType>();
             z3::sort elemSort = typeExprToSort(st->elementType.get());
             return getSetSort(elemSort);
         }
         case TypeExprType::MAP_TYPE: {
-            MapType* mt = dynamic_cast<MapType*>(type);
+            MapType* mt = type->as<MapType>();
             z3::sort keySort = typeExprToSort(mt->domain.get());
             z3::sort valSort = typeExprToSort(mt->range.get());
             return getMapSort(keySort, valSort);
@@ -123,6 +131,15 @@ pair<z3::expr, z3::expr> Z3InputMaker::makeEmptyMapWithDomain(z3::sort keySort,
     return make_pair(valueArray, domainArray);
 }
 
+// Creates a variable's Z3 constants (both arrays for a map) on first use,
+// so dom(M) finds M's domain array even before M itself was converted
+void Z3InputMaker::declareVar(const Var& var) {
+    if (namedVarMap.find(var.name) != namedVarMap.end())
+        return;
+    visitVar(var);
+    theStack.pop();
+}
+
 bool Z3InputMaker::isMapVariable(const string& varName) {
     if (!typeMap || !typeMap->hasValue(varName)) {
         return false;
@@ -132,6 +149,310 @@ bool Z3InputMaker::isMapVariable(const string& varName) {
     return type->typeExprType == TypeExprType::MAP_TYPE;
 }
 
+// ============================================================================
+// Finite-Domain Maps
+// ============================================================================
+
+namespace {
+
+bool isTypeConst(const TypeExpr* type, const char* a, const char* b) {
+    const TypeConst* tc = type ? type->as<TypeConst>() : nullptr;
+    return tc && (tc->name == a || tc->name == b);
+}
+
+bool isIntType(const TypeExpr* type) { return isTypeConst(type, "int", "integer"); }
+bool isStringType(const TypeExpr* type) { return isTypeConst(type, "string", "string"); }
+
+bool isMembership(const string& name) {
+    return name == "in" || name == "member" || name == "contains" ||
+           name == "not_in" || name == "not_member" || name == "not_contains";
+}
+
+// dom(M) for a variable M, else null
+const Var* domainOf(const Expr* e) {
+    const FuncCall* fc = e->as<FuncCall>();
+    if (!fc || fc->name != "dom" || fc->args.size() != 1)
+        return nullptr;
+    return fc->args[0]->as<Var>();
+}
+
+// Records the key terms each map variable is looked up with. A map that
+// shows up anywhere else (stored into, compared, passed whole) escapes.
+void scanKeyTerms(const Expr* e, map<string, vector<const Expr*>>& uses, set<string>& escaped) {
+    if (!e)
+        return;
+    switch (e->exprType) {
+    case ExprType::VAR:
+        escaped.insert(e->cast<Var>().name);
+        return;
+    case ExprType::FUNCCALL: {
+        const FuncCall& fc = e->cast<FuncCall>();
+        if (fc.args.size() == 2) {
+            const Var* lookedUp = nullptr;
+            const Expr* key = nullptr;
+            if (fc.name == "[]" || fc.name == "get" || fc.name == "lookup" || fc.name == "select" ||
+                fc.name == "contains_key" || fc.name == "has_key") {
+                lookedUp = fc.args[0]->as<Var>();
+                key = fc.args[1].get();
+            } else if (isMembership(fc.name)) {
+                lookedUp = domainOf(fc.args[1].get());
+                key = fc.args[0].get();
+            }
+            if (lookedUp) {
+                uses[lookedUp->name].push_back(key);
+                scanKeyTerms(key, uses, escaped);
+                return;
+            }
+        }
+        for (const auto& arg : fc.args)
+            scanKeyTerms(arg.get(), uses, escaped);
+        return;
+    }
+    case ExprType::BINARY_OP: {
+        const BinaryOpExpr& b = e->cast<BinaryOpExpr>();
+        const Var* lookedUp = (b.op == BinOp::IN || b.op == BinOp::NOT_IN) ? domainOf(b.right.get()) : nullptr;
+        if (lookedUp) {
+            uses[lookedUp->name].push_back(b.left.get());
+            scanKeyTerms(b.left.get(), uses, escaped);
+            return;
+        }
+        scanKeyTerms(b.left.get(), uses, escaped);
+        scanKeyTerms(b.right.get(), uses, escaped);
+        return;
+    }
+    case ExprType::UNARY_OP:
+        scanKeyTerms(e->cast<UnaryOpExpr>().operand.get(), uses, escaped);
+        return;
+    case ExprType::SET:
+        for (const auto& el : e->cast<Set>().elements)
+            scanKeyTerms(el.get(), uses, escaped);
+        return;
+    case ExprType::TUPLE:
+        for (const auto& el : e->cast<Tuple>().exprs)
+            scanKeyTerms(el.get(), uses, escaped);
+        return;
+    case ExprType::MAP:
+        for (const auto& kv : e->cast<Map>().value)
+            scanKeyTerms(kv.second.get(), uses, escaped);
+        return;
+    default:
+        return;
+    }
+}
+
+// The key a literal stands for in a map with int or string keys; false for
+// anything else (symbolic terms, a string used as an int key, ...)
+bool literalKey(const Expr* key, bool intKeys, string& out) {
+    if (intKeys && key->exprType == ExprType::NUM) {
+        out = to_string(key->cast<Num>().value);
+        return true;
+    }
+    if (!intKeys && key->exprType == ExprType::STRING) {
+        out = key->cast<String>().value;
+        return true;
+    }
+    return false;
+}
+
+bool isIntKey(const string& key) {
+    size_t digits = key.compare(0, 1, "-") == 0 ? 1 : 0;
+    return key.size() > digits && key.find_first_not_of("0123456789", digits) == string::npos;
+}
+
+} // namespace
+
+void Z3InputMaker::planFiniteMaps(const Expr* formula) {
+    if (finiteMapLimit == 0 || !typeMap)
+        return;
+
+    map<string, vector<const Expr*>> uses;
+    set<string> escaped;
+    scanKeyTerms(formula, uses, escaped);
+
+    for (const auto& entry : uses) {
+        const string& name = entry.first;
+        if (escaped.count(name) || finiteKeys.count(name) || namedVarMap.count(name) ||
+            !isMapVariable(name))
+            continue;
+        MapType* mapType = typeMap->getValue(name)->as<MapType>();
+        bool intKeys = isIntType(mapType->domain.get());
+
+        set<string> keys;
+        bool literal = true;
+        for (const Expr* key : entry.second) {
+            string value;
+            literal = literal && literalKey(key, intKeys, value);
+            keys.insert(value);
+        }
+        if (!literal)
+            continue;
+        auto known = keyUniverse.find(name);
+        if (known != keyUniverse.end()) {
+            for (const string& key : known->second) {
+                if (!intKeys || isIntKey(key))
+                    keys.insert(key);
+            }
+        }
+        if (keys.size() > finiteMapLimit) {
+            cout << "[Z3] " << name << " keeps the array encoding (" << keys.size() << " keys)" << endl;
+            continue;
+        }
+        finiteKeys[name] = keys;
+    }
+}
+
+Z3InputMaker::FiniteMap* Z3InputMaker::finiteMapOf(const Expr* mapArg) {
+    const Var* var = mapArg ? mapArg->as<Var>() : nullptr;
+    if (!var)
+        return nullptr;
+    auto built = finiteMaps.find(var->name);
+    if (built != finiteMaps.end())
+        return &built->second;
+    auto planned = finiteKeys.find(var->name);
+    if (planned == finiteKeys.end())
+        return nullptr;
+
+    const string& name = var->name;
+    MapType* mapType = typeMap->getValue(name)->as<MapType>();
+    z3::sort valueSort = typeExprToSort(mapType->range.get());
+
+    FiniteMap& fm = finiteMaps[name];
+    for (const string& key : planned->second) {
+        z3::expr present = ctx.bool_const((name + "_domain[" + key + "]").c_str());
+        z3::expr value = ctx.constant((name + "[" + key + "]").c_str(), valueSort);
+        if (abstractStrings && isStringType(mapType->range.get()))
+            stringVars.insert(name + "[" + key + "]");
+        fm.present.emplace(key, present);
+        fm.values.emplace(key, value);
+        variables.push_back(present);
+        variables.push_back(value);
+    }
+    cout << "[Z3] Finite map encoding for " << name << ": " << planned->second.size() << " keys" << endl;
+    return &fm;
+}
+
+// ============================================================================
+// Equality-Only Strings
+// ============================================================================
+
+namespace {
+
+// Operations that need the sequence theory or an order on strings
+bool isSequenceOp(const string& name) {
+    return name == "concat" || name == "append_list" || name == "length" || name == "prefix" ||
+           name == "suffix" || name == "contains_seq" || name == "at" || name == "nth";
+}
+
+bool isOrderOrArith(const string& name) {
+    return name == "<" || name == "<=" || name == ">" || name == ">=" || name == "Lt" ||
+           name == "Le" || name == "Gt" || name == "Ge" || name == "Add" || name == "Sub" ||
+           name == "Mul";
+}
+
+struct StringUses {
+    TypeMap* typeMap;
+    bool strings = false;   // the formula mentions a string at all
+    string blocker;         // first operation that needs real strings
+
+    bool isString(const Expr* e) const {
+        if (e->exprType == ExprType::STRING)
+            return true;
+        if (!typeMap)
+            return false;
+        if (const Var* var = e->as<Var>())
+            return typeMap->hasValue(var->name) && isStringType(typeMap->getValue(var->name));
+        const FuncCall* fc = e->as<FuncCall>();
+        if (fc && (fc->name == "[]" || fc->name == "get") && fc->args.size() == 2) {
+            const Var* mapVar = fc->args[0]->as<Var>();
+            if (mapVar && typeMap->hasValue(mapVar->name)) {
+                const MapType* mt = typeMap->getValue(mapVar->name)->as<MapType>();
+                return mt && isStringType(mt->range.get());
+            }
+        }
+        return false;
+    }
+
+    void orderedOperands(const string& op, const Expr* a, const Expr* b) {
+        if (blocker.empty() && (isString(a) || isString(b)))
+            blocker = op + " on strings";
+    }
+
+    void scan(const Expr* e) {
+        if (!e || !blocker.empty())
+            return;
+        if (isString(e))
+            strings = true;
+        switch (e->exprType) {
+        case ExprType::FUNCCALL: {
+            const FuncCall& fc = e->cast<FuncCall>();
+            if (isSequenceOp(fc.name)) {
+                blocker = fc.name;
+                return;
+            }
+            if (isOrderOrArith(fc.name) && fc.args.size() == 2)
+                orderedOperands(fc.name, fc.args[0].get(), fc.args[1].get());
+            for (const auto& arg : fc.args)
+                scan(arg.get());
+            return;
+        }
+        case ExprType::BINARY_OP: {
+            const BinaryOpExpr& b = e->cast<BinaryOpExpr>();
+            if (b.op == BinOp::LT || b.op == BinOp::LE || b.op == BinOp::GT || b.op == BinOp::GE)
+                orderedOperands("comparison", b.left.get(), b.right.get());
+            scan(b.left.get());
+            scan(b.right.get());
+            return;
+        }
+        case ExprType::UNARY_OP:
+            scan(e->cast<UnaryOpExpr>().operand.get());
+            return;
+        case ExprType::SET:
+            for (const auto& el : e->cast<Set>().elements)
+                scan(el.get());
+            return;
+        case ExprType::TUPLE:
+            for (const auto& el : e->cast<Tuple>().exprs)
+                scan(el.get());
+            return;
+        case ExprType::MAP:
+            for (const auto& kv : e->cast<Map>().value)
+                scan(kv.second.get());
+            return;
+        default:
+            return;
+        }
+    }
+};
+
+} // namespace
+
+void Z3InputMaker::planStringAbstraction(const Expr* formula) {
+    // Sorts are fixed once the first constant exists
+    if (!stringAbstractionEnabled || !variables.empty() || !symVarMap.empty())
+        return;
+
+    StringUses uses{typeMap};
+    uses.scan(formula);
+    if (!uses.blocker.empty()) {
+        cout << "[Z3] Keeping the string theory: " << uses.blocker << endl;
+        return;
+    }
+    if (uses.strings) {
+        abstractStrings = true;
+        cout << "[Z3] Strings are compared for equality only; solving them uninterpreted" << endl;
+    }
+}
+
+// Distinct literals are distinct strings
+z3::expr Z3InputMaker::withStringLiterals(const z3::expr& formula) {
+    if (stringConstants.size() < 2)
+        return formula;
+    z3::expr_vector literals(ctx);
+    for (const z3::expr& c : stringConstants)
+        literals.push_back(c);
+    return formula && z3::distinct(literals);
+}
+
 // ============================================================================
 // Main Z3 Input Conversion
 // ============================================================================
@@ -140,10 +461,12 @@ z3::expr Z3InputMaker::makeZ3Input(unique_ptr<Expr>& expr) {
     if (!expr) {
         throw runtime_error("Null expression in Z3 conversion");
     }
+    planStringAbstraction(expr.get());
+    planFiniteMaps(expr.get());
     
     // Handle SymVar specially since it's not part of the ExprVisitor interface
     if (expr->exprType == ExprType::SYMVAR) {
-        SymVar* sv = dynamic_cast<SymVar*>(expr.get());
+        SymVar* sv = expr->as<SymVar>();
         unsigned int num = sv->getNum();
         
         // Check if we've already created a Z3 variable for this SymVar
@@ -163,17 +486,19 @@ z3::expr Z3InputMaker::makeZ3Input(unique_ptr<Expr>& expr) {
     }
     z3::expr result = theStack.top();
     theStack.pop();
-    return result;
+    return withStringLiterals(result);
 }
 
 z3::expr Z3InputMaker::makeZ3Input(Expr* expr) {
     if (!expr) {
         throw runtime_error("Null expression in Z3 conversion");
     }
+    planStringAbstraction(expr);
+    planFiniteMaps(expr);
     
     // Handle SymVar specially
     if (expr->exprType == ExprType::SYMVAR) {
-        SymVar* sv = dynamic_cast<SymVar*>(expr);
+        SymVar* sv = expr->as<SymVar>();
         unsigned int num = sv->getNum();
         
         if (symVarMap.find(num) == symVarMap.end()) {
@@ -192,13 +517,24 @@ z3::expr Z3InputMaker::makeZ3Input(Expr* expr) {
     }
     z3::expr result = theStack.top();
     theStack.pop();
-    return result;
+    return withStringLiterals(result);
 }
 
 vector<z3::expr> Z3InputMaker::getVariables() {
     return variables;
 }
 
+vector<z3::expr> Z3InputMaker::getInputs() {
+    vector<z3::expr> inputs;
+    for (const auto& entry : symVarMap)
+        inputs.push_back(*entry.second);
+    for (const auto& entry : namedVarMap) {
+        if (!entry.second->get_sort().is_array())
+            inputs.push_back(*entry.second);
+    }
+    return inputs;
+}
+
 // ============================================================================
 // Expression Visitors
 // ============================================================================
@@ -218,7 +554,7 @@ void Z3InputMaker::visitVar(const Var &node) {
         // Special handling for MAP types (Approach 2)
         // ======================================================
         if (type->typeExprType == TypeExprType::MAP_TYPE) {
-            MapType* mapType = dynamic_cast<MapType*>(type);
+            MapType* mapType = type->as<MapType>();
             
             z3::sort keySort = typeExprToSort(mapType->domain.get());
             z3::sort valueSort = typeExprToSort(mapType->range.get());
@@ -256,6 +592,8 @@ void Z3InputMaker::visitVar(const Var &node) {
         // ======================================================
         z3::sort varSort = typeExprToSort(type);
         z3::expr* z3Var = new z3::expr(ctx.constant(node.name.c_str(), varSort));
+        if (abstractStrings && isStringType(type))
+            stringVars.insert(node.name);
         namedVarMap[node.name] = z3Var;
         variables.push_back(*z3Var);
         theStack.push(*z3Var);
@@ -277,6 +615,16 @@ void Z3InputMaker::visitNum(const Num &node) {
 }
 
 void Z3InputMaker::visitString(const String &node) {
+    if (abstractStrings) {
+        auto id = stringIds.emplace(node.value, stringLiterals.size());
+        if (id.second) {
+            string name = "str!" + to_string(stringLiterals.size());
+            stringLiterals.push_back(node.value);
+            stringConstants.push_back(ctx.constant(name.c_str(), getStringSort()));
+        }
+        theStack.push(stringConstants[id.first->second]);
+        return;
+    }
     theStack.push(ctx.string_val(node.value));
 }
 
@@ -288,6 +636,32 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
     // ========================================================================
     
     // MAP ACCESS: [] (alias for "get")
+    // Finite maps first: the key is a literal the map has a slot for
+    if (node.args.size() == 2) {
+        const Expr* mapArg = nullptr;
+        const Expr* key = nullptr;
+        bool lookup = node.name == "[]" || node.name == "get" || node.name == "lookup" || node.name == "select";
+        if (lookup || node.name == "contains_key" || node.name == "has_key") {
+            mapArg = node.args[0].get();
+            key = node.args[1].get();
+        } else if (isMembership(node.name)) {
+            mapArg = domainOf(node.args[1].get());
+            key = node.args[0].get();
+        }
+        if (FiniteMap* fm = finiteMapOf(mapArg)) {
+            string k;
+            MapType* mapType = typeMap->getValue(mapArg->cast<Var>().name)->as<MapType>();
+            literalKey(key, isIntType(mapType->domain.get()), k);
+            if (lookup)
+                theStack.push(fm->values.at(k));
+            else if (node.name.compare(0, 4, "not_") == 0)
+                theStack.push(!fm->present.at(k));
+            else
+                theStack.push(fm->present.at(k));
+            return;
+        }
+    }
+
     if (node.name == "[]" && node.args.size() == 2) {
         cout << "[Z3] Map access: []" << endl;
         z3::expr mapExpr = convertArg(node.args[0]);
@@ -302,9 +676,10 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
         
         // Check if argument is a Var (map variable)
         if (node.args[0]->exprType == ExprType::VAR) {
-            Var* mapVar = dynamic_cast<Var*>(node.args[0].get());
+            Var* mapVar = node.args[0]->as<Var>();
             
             // Look up domain array
+            declareVar(*mapVar);
             if (domainVarMap.find(mapVar->name) != domainVarMap.end()) {
                 z3::expr domainArray = *domainVarMap[mapVar->name];
                 cout << "[Z3]   Found domain array for: " << mapVar->name << endl;
@@ -330,7 +705,7 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
     if ((node.name == "in" || node.name == "member" || node.name == "contains") && node.args.size() == 2) {
         // Check if second arg is dom(map) - SPECIAL CASE for Approach 2
         if (node.args[1]->exprType == ExprType::FUNCCALL) {
-            FuncCall* fc = dynamic_cast<FuncCall*>(node.args[1].get());
+            FuncCall* fc = node.args[1]->as<FuncCall>();
             if (fc && fc->name == "dom") {
                 cout << "[Z3] Domain membership: in(key, dom(map))" << endl;
                 
@@ -339,9 +714,10 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
                 
                 // Get map variable
                 if (fc->args[0]->exprType == ExprType::VAR) {
-                    Var* mapVar = dynamic_cast<Var*>(fc->args[0].get());
+                    Var* mapVar = fc->args[0]->as<Var>();
                     
                     // Look up domain array
+                    declareVar(*mapVar);
                     if (domainVarMap.find(mapVar->name) != domainVarMap.end()) {
                         z3::expr domainArray = *domainVarMap[mapVar->name];
                         
@@ -371,7 +747,7 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
     if ((node.name == "not_in" || node.name == "not_member" || node.name == "not_contains") && node.args.size() == 2) {
         // Check if second arg is dom(map) - SPECIAL CASE for Approach 2
         if (node.args[1]->exprType == ExprType::FUNCCALL) {
-            FuncCall* fc = dynamic_cast<FuncCall*>(node.args[1].get());
+            FuncCall* fc = node.args[1]->as<FuncCall>();
             if (fc && fc->name == "dom") {
                 cout << "[Z3] Domain non-membership: not_in(key, dom(map))" << endl;
                 
@@ -380,9 +756,10 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
                 
                 // Get map variable
                 if (fc->args[0]->exprType == ExprType::VAR) {
-                    Var* mapVar = dynamic_cast<Var*>(fc->args[0].get());
+                    Var* mapVar = fc->args[0]->as<Var>();
                     
                     // Look up domain array
+                    declareVar(*mapVar);
                     if (domainVarMap.find(mapVar->name) != domainVarMap.end()) {
                         z3::expr domainArray = *domainVarMap[mapVar->name];
                         
@@ -544,9 +921,10 @@ void Z3InputMaker::visitFuncCall(const FuncCall &node) {
     
     // Check if first arg is a variable (map variable)
     if (node.args[0]->exprType == ExprType::VAR) {
-        Var* mapVar = dynamic_cast<Var*>(node.args[0].get());
+        Var* mapVar = node.args[0]->as<Var>();
         
         // Look up domain array
+        declareVar(*mapVar);
         if (domainVarMap.find(mapVar->name) != domainVarMap.end()) {
             z3::expr domainArray = *domainVarMap[mapVar->name];
             
@@ -650,7 +1028,7 @@ void Z3InputMaker::visitMap(const Map &node) {
     // Create a map from key-value pairs
     if (node.value.empty()) {
         // Empty map - default to string->string
-        theStack.push(makeEmptyMap(ctx.string_sort(), ctx.string_sort()));
+        theStack.push(makeEmptyMap(getStringSort(), getStringSort()));
         return;
     }
     
@@ -761,6 +1139,19 @@ void Z3InputMaker::visitBoolConst(const BoolConst &node) {
 
 void Z3InputMaker::visitBinaryOpExpr(const BinaryOpExpr &node) {
     cout << "[Z3] BinaryOpExpr: ";
+
+    if (node.op == BinOp::IN || node.op == BinOp::NOT_IN) {
+        const Var* mapVar = domainOf(node.right.get());
+        if (FiniteMap* fm = finiteMapOf(mapVar)) {
+            cout << (node.op == BinOp::IN ? "IN" : "NOT_IN") << " (finite map)" << endl;
+            string k;
+            MapType* mapType = typeMap->getValue(mapVar->name)->as<MapType>();
+            literalKey(node.left.get(), isIntType(mapType->domain.get()), k);
+            z3::expr present = fm->present.at(k);
+            theStack.push(node.op == BinOp::IN ? present : !present);
+            return;
+        }
+    }
     
     // Convert left and right operands
     z3::expr left = convertArg(node.left);
@@ -862,8 +1253,115 @@ void Z3InputMaker::visitProgram(const Program &node) {
 
 Z3Solver::Z3Solver(TypeMap* tm) : typeMap(tm) {}
 
+// Reused so the context setup is paid once, not on every solve
+z3::context& Z3Solver::solverContext() const {
+    if (!context)
+        context = make_shared<z3::context>();
+    return *context;
+}
+
+void Z3Solver::useKeysFrom(const ValueEnvironment& sigma) {
+    keyUniverse.clear();
+    for (const auto& entry : sigma.getAllEntries()) {
+        const Map* value = entry.second ? entry.second->as<Map>() : nullptr;
+        if (!value)
+            continue;
+        set<string>& keys = keyUniverse[entry.first];
+        for (const auto& kv : value->value)
+            keys.insert(kv.first->name);
+
+        // tmp_U_0 holds a snapshot of U
+        const string& name = entry.first;
+        size_t last = name.rfind('_');
+        if (name.compare(0, 4, "tmp_") == 0 && last > 4) {
+            set<string>& global = keyUniverse[name.substr(4, last - 4)];
+            global.insert(keys.begin(), keys.end());
+        }
+    }
+}
+
+string Z3Solver::inventString(const string& var, int variant) const {
+    string value = stringNamer ? stringNamer(var, variant) : "";
+    if (value.empty())
+        value = var + "_" + to_string(variant);
+    return value;
+}
+
+map<string, unique_ptr<ResultValue>> Z3Solver::readModel(Z3InputMaker& inputMaker, const z3::model& m) const {
+    // Extract variable values from the model
+    map<string, unique_ptr<ResultValue>> var_values;
+    
+    // Uninterpreted strings back to strings: a literal's element names
+    // the literal, every other element a fresh string nothing else uses
+    const vector<string>& literals = inputMaker.getStringLiterals();
+    vector<z3::expr> literalValues;
+    for (const z3::expr& c : inputMaker.getStringConstants())
+        literalValues.push_back(m.eval(c, true));
+    set<string> taken(literals.begin(), literals.end());
+    map<string, string> invented;
+    int variant = 0;
+
+    // Get all variables that were used
+    vector<z3::expr> vars = inputMaker.getVariables();
+    for (const auto& var : vars) {
+        z3::expr val = m.eval(var, true);
+        string varName = var.to_string();
+        
+        // Handle different types of values
+        if (inputMaker.abstractsStrings() && inputMaker.isStringVar(var.decl().name().str())) {
+            string element = val.to_string();
+            string strVal;
+            size_t literal = 0;
+            while (literal < literalValues.size() && !z3::eq(literalValues[literal], val))
+                literal++;
+            if (literal < literals.size()) {
+                strVal = literals[literal];
+            } else if (invented.count(element)) {
+                strVal = invented[element];
+            } else {
+                string name = var.decl().name().str();
+                strVal = inventString(name, variant);
+                while (taken.count(strVal))
+                    strVal = name + "_" + to_string(variant++);
+                variant++;
+                invented[element] = strVal;
+                taken.insert(strVal);
+            }
+            cout << "[Z3Solver] " << varName << " = \"" << strVal << "\" (" << element << ")" << endl;
+            var_values[varName] = make_unique<StringResultValue>(strVal);
+        } else if (val.is_numeral()) {
+            int intVal;
+            if (val.is_int() && Z3_get_numeral_int(inputMaker.getContext(), val, &intVal)) {
+                cout << "[Z3Solver] " << varName << " = " << intVal << endl;
+                var_values[varName] = make_unique<IntResultValue>(intVal);
+            }
+        } else if (val.is_string_value()) {
+            string strVal = val.get_string();
+            cout << "[Z3Solver] " << varName << " = \"" << strVal << "\"" << endl;
+            var_values[varName] = make_unique<StringResultValue>(strVal);
+        } else if (val.is_bool()) {
+            bool boolVal = val.is_true();
+            cout << "[Z3Solver] " << varName << " = " << (boolVal ? "true" : "false") << endl;
+            var_values[varName] = make_unique<BoolResultValue>(boolVal);
+        } else if (val.is_array()) {
+            // For arrays (sets/maps), store as string representation
+            cout << "[Z3Solver] " << varName << " = " << val << " (array)" << endl;
+            var_values[varName] = make_unique<StringResultValue>(val.to_string());
+        } else {
+            cout << "[Z3Solver] " << varName << " = " << val << " (unknown type)" << endl;
+            var_values[varName] = make_unique<StringResultValue>(val.to_string());
+        }
+    }
+
+    return var_values;
+}
+
 Result Z3Solver::solve(unique_ptr<Expr> formula) const {
-    Z3InputMaker inputMaker(typeMap);
+    TRACE_SPAN(span, "Z3Solver::solve", "solver");
+    MetricsSolveTimer solveTimer;
+    Z3InputMaker inputMaker(solverContext(), typeMap);
+    inputMaker.setFiniteMaps(keyUniverse, finiteMapLimit);
+    inputMaker.setStringAbstraction(stringAbstraction);
     
     // Convert the formula to Z3 format
     z3::expr z3Formula = inputMaker.makeZ3Input(formula);
@@ -877,46 +1375,107 @@ Result Z3Solver::solve(unique_ptr<Expr> formula) const {
     
     if(s.check() == z3::sat) {
         cout << "[Z3Solver] SAT - Model found!" << endl;
-        z3::model m = s.get_model();
-        
-        // Extract variable values from the model
-        map<string, unique_ptr<ResultValue>> var_values;
-        
-        // Get all variables that were used
-        vector<z3::expr> vars = inputMaker.getVariables();
-        for (const auto& var : vars) {
-            z3::expr val = m.eval(var, true);
-            string varName = var.to_string();
-            
-            // Handle different types of values
-            if (val.is_numeral()) {
-                int intVal;
-                if (val.is_int() && Z3_get_numeral_int(inputMaker.getContext(), val, &intVal)) {
-                    cout << "[Z3Solver] " << varName << " = " << intVal << endl;
-                    var_values[varName] = make_unique<IntResultValue>(intVal);
-                }
-            } else if (val.is_string_value()) {
-                string strVal = val.get_string();
-                cout << "[Z3Solver] " << varName << " = \"" << strVal << "\"" << endl;
-                var_values[varName] = make_unique<StringResultValue>(strVal);
-            } else if (val.is_bool()) {
-                bool boolVal = val.is_true();
-                cout << "[Z3Solver] " << varName << " = " << (boolVal ? "true" : "false") << endl;
-                var_values[varName] = make_unique<BoolResultValue>(boolVal);
-            } else if (val.is_array()) {
-                // For arrays (sets/maps), store as string representation
-                cout << "[Z3Solver] " << varName << " = " << val << " (array)" << endl;
-                var_values[varName] = make_unique<StringResultValue>(val.to_string());
-            } else {
-                cout << "[Z3Solver] " << varName << " = " << val << " (unknown type)" << endl;
-                var_values[varName] = make_unique<StringResultValue>(val.to_string());
-            }
-        }
-        
-        return Result(true, std::move(var_values));
+        return Result(true, readModel(inputMaker, s.get_model()));
     }
     else {
         cout << "[Z3Solver] UNSAT - No solution exists" << endl;
         return Result(false, map<string, unique_ptr<ResultValue>>());
     }
 }
+
+// One session for every model: each model adds a clause blocking its input
+// tuple, and the diversity goals ride along as assumptions the solver may
+// drop (through the unsat core) when they cannot be met
+size_t Z3Solver::enumerate(unique_ptr<Expr> formula, size_t n,
+                           const function<bool(const Result&)>& onModel,
+                           const ModelDiversity& diversity) const {
+    TRACE_SPAN(span, "Z3Solver::enumerate", "solver");
+    MetricsSolveTimer solveTimer;
+    Z3InputMaker inputMaker(solverContext(), typeMap);
+    inputMaker.setFiniteMaps(keyUniverse, finiteMapLimit);
+    // Blocking clauses need the model's values as terms; elements of the
+    // uninterpreted string sort are not
+    inputMaker.setStringAbstraction(false);
+
+    z3::expr z3Formula = inputMaker.makeZ3Input(formula);
+    z3::context& ctx = inputMaker.getContext();
+    z3::solver s(ctx);
+    s.add(z3Formula);
+
+    vector<z3::expr> inputs = inputMaker.getInputs();
+    cout << "[Z3Solver] Enumerating up to " << n << " models over " << inputs.size() << " inputs" << endl;
+
+    // distinct -> every input avoids the values it had in earlier models
+    z3::expr distinct = ctx.bool_const("diversity!distinct");
+    bool distinctOpen = diversity.distinctValues;
+
+    size_t found = 0;
+    while (found < n) {
+        vector<z3::expr> assumptions;
+        if (distinctOpen)
+            assumptions.push_back(distinct);
+        vector<z3::expr> boundaries;
+        if (!diversity.boundaries.empty()) {
+            int bound = diversity.boundaries[found % diversity.boundaries.size()];
+            for (const z3::expr& input : inputs) {
+                if (!input.is_int())
+                    continue;
+                z3::expr pin = ctx.bool_const(("diversity!" + to_string(found) + "!" + input.to_string()).c_str());
+                s.add(z3::implies(pin, input == ctx.int_val(bound)));
+                boundaries.push_back(pin);
+                assumptions.push_back(pin);
+            }
+        }
+
+        z3::check_result r = z3::unknown;
+        while (true) {
+            z3::expr_vector assumed(ctx);
+            for (const z3::expr& a : assumptions)
+                assumed.push_back(a);
+            r = s.check(assumed);
+            if (r != z3::unsat || assumptions.empty())
+                break;
+
+            // Drop the boundary pins in the core first, then distinctness
+            z3::expr_vector core = s.unsat_core();
+            auto inCore = [&](const z3::expr& a) {
+                for (unsigned i = 0; i < core.size(); i++) {
+                    if (z3::eq(core[i], a))
+                        return true;
+                }
+                return false;
+            };
+            size_t before = assumptions.size();
+            assumptions.erase(remove_if(assumptions.begin(), assumptions.end(), [&](const z3::expr& a) {
+                return !z3::eq(a, distinct) && inCore(a);
+            }), assumptions.end());
+            if (assumptions.size() == before) {
+                if (distinctOpen)
+                    cout << "[Z3Solver] No model with all-new values left; only requiring a new tuple" << endl;
+                distinctOpen = false;
+                assumptions.clear();
+            }
+        }
+        if (r != z3::sat)
+            break;
+
+        z3::model m = s.get_model();
+        found++;
+        cout << "[Z3Solver] Model " << found << "/" << n << endl;
+        Result result(true, readModel(inputMaker, m));
+        if (!onModel(result) || inputs.empty())
+            break;
+
+        // Never the same tuple again
+        z3::expr_vector differs(ctx);
+        for (const z3::expr& input : inputs) {
+            z3::expr value = m.eval(input, true);
+            differs.push_back(input != value);
+            s.add(z3::implies(distinct, input != value));
+        }
+        s.add(z3::mk_or(differs));
+    }
+
+    cout << "[Z3Solver] Enumerated " << found << " models" << endl;
+    return found;
+}
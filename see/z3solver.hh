@@ -1,7 +1,9 @@
 #ifndef Z3SOLVER_HH
 #define Z3SOLVER_HH
 
+#include <functional>
 #include<memory>
+#include <set>
 #include <stack>
 #include<string>
 
@@ -14,13 +16,47 @@ using namespace std;
 
 class Z3InputMaker : public ASTVisitor {
     private:
-        z3::context ctx;
+        unique_ptr<z3::context> ownedCtx;        // when no context is passed in
+        z3::context& ctx;
         stack<z3::expr> theStack;
         vector<z3::expr> variables;
         map<unsigned int, z3::expr*> symVarMap; // Map SymVar numbers to Z3 variables
         map<string, z3::expr*> namedVarMap;     // Map named variables to Z3 expressions/value arrays
         map<string, z3::expr*> domainVarMap;     //  Map named variables to Z3 domain arrays
         TypeMap* typeMap;                        // Type information for variables
+
+        // Finite-domain maps: a map looked up only with literal keys, which
+        // together with its keys in sigma number at most finiteMapLimit, is
+        // one Bool (in domain) and one value constant per key, so dom/in/[]
+        // need no array theory. A symbolic key keeps the arrays: matching it
+        // against every known key costs more than the arrays save.
+        struct FiniteMap {
+            map<string, z3::expr> present;
+            map<string, z3::expr> values;
+        };
+        map<string, set<string>> keyUniverse;    // map name -> keys known from sigma
+        size_t finiteMapLimit = 0;
+        map<string, set<string>> finiteKeys;     // maps chosen for the finite encoding
+        map<string, FiniteMap> finiteMaps;
+
+        void planFiniteMaps(const Expr* formula);
+        FiniteMap* finiteMapOf(const Expr* mapArg);
+
+        // Equality-only strings: when strings are only compared with =, !=
+        // and membership, they live in an uninterpreted sort whose literals
+        // are pairwise distinct constants, so the solve needs no sequence
+        // theory. Any sequence operation (concat, length, prefix, ...) or
+        // ordering on a string keeps the String sort.
+        bool stringAbstractionEnabled = false;
+        bool abstractStrings = false;
+        map<string, size_t> stringIds;
+        vector<string> stringLiterals;
+        vector<z3::expr> stringConstants;        // stands for stringLiterals[i]
+        set<string> stringVars;                  // Z3 constants standing for strings
+
+        z3::expr withStringLiterals(const z3::expr& formula);
+
+        void planStringAbstraction(const Expr* formula);
         
         // Z3 sorts for custom types
         z3::sort getStringSort();
@@ -39,15 +75,33 @@ class Z3InputMaker : public ASTVisitor {
         pair<z3::expr, z3::expr> makeEmptyMapWithDomain(z3::sort keySort, z3::sort valueSort);
         // Helper to check if variable is a map
         bool isMapVariable(const string& varName);
+        void declareVar(const Var& var);
 
         
 
     public:
         Z3InputMaker(TypeMap* typeMap = nullptr);
+        // Builds into `ctx`, which must outlive the maker
+        Z3InputMaker(z3::context& ctx, TypeMap* typeMap = nullptr);
         ~Z3InputMaker();
+        // Enables the finite map encoding for maps of at most `limit` keys
+        void setFiniteMaps(const map<string, set<string>>& keys, size_t limit) {
+            keyUniverse = keys;
+            finiteMapLimit = limit;
+        }
+        void setStringAbstraction(bool enabled) { stringAbstractionEnabled = enabled; }
+        // After makeZ3Input: were strings solved in the uninterpreted sort?
+        bool abstractsStrings() const { return abstractStrings; }
+        bool isStringVar(const string& name) const { return stringVars.count(name) > 0; }
+        // After makeZ3Input: did the map get the finite encoding?
+        bool isFiniteMap(const string& name) const { return finiteKeys.count(name) > 0; }
+        const vector<string>& getStringLiterals() const { return stringLiterals; }
+        const vector<z3::expr>& getStringConstants() const { return stringConstants; }
         z3::expr makeZ3Input(unique_ptr<Expr>& expr);
         z3::expr makeZ3Input(Expr* expr);
 	    vector<z3::expr> getVariables();
+        // Scalar unknowns (SymVars and non-collection variables)
+        vector<z3::expr> getInputs();
         z3::context& getContext() { return ctx; }
 
     protected:
@@ -79,7 +133,7 @@ class Z3InputMaker : public ASTVisitor {
 
 
         // Declaration/High-level visitor methods
-        z3::expr convertArg(const unique_ptr<Expr>& arg);
+        z3::expr convertArg(const Ref<Expr>& arg);
 
     public:
         // High-level visitor methods
@@ -92,11 +146,55 @@ class Z3InputMaker : public ASTVisitor {
         void visitProgram(const Program &node) override;
 };
 
+// What makes a set of models diverse (see Z3Solver::enumerate)
+struct ModelDiversity {
+    // Every input takes a value it had in no earlier model, for as long as
+    // the formula allows; after that any new tuple will do
+    bool distinctValues = false;
+    // Model i tries to pin each int input to boundaries[i % size]
+    vector<int> boundaries;
+};
+
 class Z3Solver : public Solver {
     private:
         TypeMap* typeMap;
+        // Every solve builds into this one context, created on first use
+        mutable shared_ptr<z3::context> context;
+        map<string, set<string>> keyUniverse;
+        size_t finiteMapLimit = 16;
+        bool stringAbstraction = true;
+        function<string(const string&, int)> stringNamer;
+
+        z3::context& solverContext() const;
+        string inventString(const string& var, int variant) const;
+        map<string, unique_ptr<ResultValue>> readModel(Z3InputMaker& inputMaker, const z3::model& m) const;
     public:
         Z3Solver(TypeMap* typeMap = nullptr);
         Result solve(unique_ptr<Expr>) const;
+
+        // Solve in `ctx` from now on, so a long-lived caller (the daemon)
+        // keeps one context across short-lived solvers
+        void shareContext(shared_ptr<z3::context> ctx) { context = std::move(ctx); }
+        // Up to n models of one formula from a single incremental session,
+        // no two alike on the inputs. Each goes to onModel as soon as it is
+        // found (return false to stop); returns how many were found.
+        size_t enumerate(unique_ptr<Expr> formula, size_t n,
+                         const function<bool(const Result&)>& onModel,
+                         const ModelDiversity& diversity = ModelDiversity()) const;
+
+        // Keys of every concrete map in sigma, under the variable's name and,
+        // for tmp_G_i, under G as well
+        void useKeysFrom(const ValueEnvironment& sigma);
+        void setKeyUniverse(map<string, set<string>> keys) { keyUniverse = std::move(keys); }
+        const map<string, set<string>>& getKeyUniverse() const { return keyUniverse; }
+        // Largest map given the finite encoding; 0 keeps every map an array
+        void setFiniteMapLimit(size_t limit) { finiteMapLimit = limit; }
+        // Solve equality-only strings without the sequence theory (on by default)
+        void setStringAbstraction(bool enabled) { stringAbstraction = enabled; }
+        // Realistic value for the variant-th string a model invents for `var`
+        // (an empty answer falls back to "<var>_<variant>")
+        void setStringNamer(function<string(const string& var, int variant)> namer) {
+            stringNamer = std::move(namer);
+        }
 };
 #endif
@@ -0,0 +1,627 @@
+#include "specbinary.hh"
+#include "specparser.hh"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+// <sys/mman.h> defines MAP_TYPE, which clashes with TypeExprType::MAP_TYPE
+#undef MAP_TYPE
+
+namespace {
+
+const char SPEC_MAGIC[4] = {'T', 'G', 'S', 'B'};
+
+enum TypeTag : uint8_t {
+    T_NULL = 0, T_CONST, T_MAP, T_SET, T_TUPLE, T_FUNC
+};
+
+enum ExprTag : uint8_t {
+    E_NULL = 0, E_FUNCCALL, E_VAR, E_NUM, E_STRING, E_PLACEHOLDER,
+    E_BOOL, E_SET, E_TUPLE, E_MAP, E_BINARY, E_UNARY
+};
+
+enum CodeTag : uint8_t { C_200 = 0, C_201, C_400 };
+
+/* ============================================================
+ * Writer
+ * ============================================================ */
+
+class SpecEncoder {
+    string body;
+    vector<const string *> strings;
+    unordered_map<string, uint32_t> ids;
+
+public:
+    string encode(const Spec &spec)
+    {
+        u32(spec.globals.size());
+        for (const auto &d : spec.globals) {
+            str(d->name);
+            type(d->type.get());
+        }
+        u32(spec.init.size());
+        for (const auto &i : spec.init) {
+            str(i->varName);
+            expr(i->expr.get());
+        }
+        u32(spec.functions.size());
+        for (const auto &f : spec.functions) {
+            str(f->name);
+            types(f->params);
+            u8(code(f->returnType.first));
+            types(f->returnType.second);
+        }
+        u32(spec.blocks.size());
+        for (const auto &b : spec.blocks)
+            block(*b);
+        return finish(true);
+    }
+
+    // One spec element on its own: string table + tree, no header
+    string encode(const API &b)
+    {
+        block(b);
+        return finish(false);
+    }
+
+    string encode(const Decl &d)
+    {
+        str(d.name);
+        type(d.type.get());
+        return finish(false);
+    }
+
+    string encode(const Init &i)
+    {
+        str(i.varName);
+        expr(i.expr.get());
+        return finish(false);
+    }
+
+    string encode(const APIFuncDecl &f)
+    {
+        str(f.name);
+        types(f.params);
+        u8(code(f.returnType.first));
+        types(f.returnType.second);
+        return finish(false);
+    }
+
+private:
+    void block(const API &b)
+    {
+        str(b.name);
+        expr(b.pre.get());
+        expr(b.call ? b.call->call.get() : nullptr);
+        expr(b.call ? b.call->response.ResponseExpr.get() : nullptr);
+        expr(b.response.ResponseExpr.get());
+    }
+
+    // Header and string table go in front of the body
+    string finish(bool header)
+    {
+        string out;
+        string tree;
+        tree.swap(body);
+        if (header) {
+            body.append(SPEC_MAGIC, 4);
+            u32(SPEC_BINARY_VERSION);
+        }
+        u32(strings.size());
+        for (const string *s : strings) {
+            u32(s->size());
+            body += *s;
+        }
+        body += tree;
+        out.swap(body);
+        return out;
+    }
+
+    void u8(uint8_t v) { body.push_back((char)v); }
+
+    void u32(uint32_t v)
+    {
+        char b[4] = {(char)(v & 0xff), (char)((v >> 8) & 0xff),
+                     (char)((v >> 16) & 0xff), (char)((v >> 24) & 0xff)};
+        body.append(b, 4);
+    }
+
+    void str(const string &s)
+    {
+        auto it = ids.find(s);
+        if (it == ids.end()) {
+            it = ids.emplace(s, (uint32_t)strings.size()).first;
+            strings.push_back(&it->first);
+        }
+        u32(it->second);
+    }
+
+    static uint8_t code(HTTPResponseCode rc)
+    {
+        switch (rc) {
+        case HTTPResponseCode::OK_200: return C_200;
+        case HTTPResponseCode::CREATED_201: return C_201;
+        case HTTPResponseCode::BAD_REQUEST_400: return C_400;
+        }
+        return C_200;
+    }
+
+    void types(const vector<unique_ptr<TypeExpr>> &ts)
+    {
+        u32(ts.size());
+        for (const auto &t : ts)
+            type(t.get());
+    }
+
+    void type(const TypeExpr *t)
+    {
+        if (!t) {
+            u8(T_NULL);
+            return;
+        }
+        switch (t->typeExprType) {
+        case TypeExprType::TYPE_CONST:
+            u8(T_CONST);
+            str(static_cast<const TypeConst *>(t)->name);
+            return;
+        case TypeExprType::MAP_TYPE: {
+            auto m = static_cast<const MapType *>(t);
+            u8(T_MAP);
+            type(m->domain.get());
+            type(m->range.get());
+            return;
+        }
+        case TypeExprType::SET_TYPE:
+            u8(T_SET);
+            type(static_cast<const SetType *>(t)->elementType.get());
+            return;
+        case TypeExprType::TUPLE_TYPE:
+            u8(T_TUPLE);
+            types(static_cast<const TupleType *>(t)->elements);
+            return;
+        case TypeExprType::FUNC_TYPE: {
+            auto f = static_cast<const FuncType *>(t);
+            u8(T_FUNC);
+            types(f->params);
+            type(f->returnType.get());
+            return;
+        }
+        case TypeExprType::TYPE_VARIABLE:
+            break;
+        }
+        throw runtime_error("serializeSpec: unsupported type " + const_cast<TypeExpr *>(t)->toString());
+    }
+
+    void exprs(const vector<Ref<Expr>> &es)
+    {
+        u32(es.size());
+        for (const auto &e : es)
+            expr(e.get());
+    }
+
+    void expr(const Expr *e)
+    {
+        if (!e) {
+            u8(E_NULL);
+            return;
+        }
+        switch (e->exprType) {
+        case ExprType::FUNCCALL: {
+            auto fc = static_cast<const FuncCall *>(e);
+            u8(E_FUNCCALL);
+            str(fc->name);
+            exprs(fc->args);
+            return;
+        }
+        case ExprType::VAR:
+            u8(E_VAR);
+            str(static_cast<const Var *>(e)->name);
+            return;
+        case ExprType::NUM:
+            u8(E_NUM);
+            u32((uint32_t)static_cast<const Num *>(e)->value);
+            return;
+        case ExprType::STRING:
+            if (auto ph = e->as<Placeholder>()) {
+                u8(E_PLACEHOLDER);
+                str(ph->global);
+                str(ph->value);
+                return;
+            }
+            u8(E_STRING);
+            str(static_cast<const String *>(e)->value);
+            return;
+        case ExprType::BOOL_CONST:
+            u8(E_BOOL);
+            u8(static_cast<const BoolConst *>(e)->value ? 1 : 0);
+            return;
+        case ExprType::SET:
+            u8(E_SET);
+            exprs(static_cast<const Set *>(e)->elements);
+            return;
+        case ExprType::TUPLE:
+            u8(E_TUPLE);
+            exprs(static_cast<const Tuple *>(e)->exprs);
+            return;
+        case ExprType::MAP: {
+            const auto &entries = static_cast<const Map *>(e)->value;
+            u8(E_MAP);
+            u32(entries.size());
+            for (const auto &kv : entries) {
+                str(kv.first->name);
+                expr(kv.second.get());
+            }
+            return;
+        }
+        case ExprType::BINARY_OP: {
+            auto b = static_cast<const BinaryOpExpr *>(e);
+            u8(E_BINARY);
+            u8((uint8_t)b->op);
+            expr(b->left.get());
+            expr(b->right.get());
+            return;
+        }
+        case ExprType::UNARY_OP: {
+            auto u = static_cast<const UnaryOpExpr *>(e);
+            u8(E_UNARY);
+            u8((uint8_t)u->op);
+            expr(u->operand.get());
+            return;
+        }
+        default:
+            break;
+        }
+        throw runtime_error("serializeSpec: expression kind " +
+                            to_string((int)e->exprType) + " cannot be stored");
+    }
+};
+
+/* ============================================================
+ * Reader
+ * ============================================================ */
+
+class SpecDecoder {
+    const char *p;
+    const char *end;
+    vector<string> strings;
+
+public:
+    SpecDecoder(const char *data, size_t size) : p(data), end(data + size) {}
+
+    unique_ptr<Spec> decode()
+    {
+        if (!isSpecBinary(p, end - p))
+            throw runtime_error("spec binary: bad magic");
+        p += 4;
+        uint32_t version = u32();
+        if (version != SPEC_BINARY_VERSION)
+            throw runtime_error("spec binary: version " + to_string(version) +
+                                ", expected " + to_string(SPEC_BINARY_VERSION));
+
+        uint32_t n = count();
+        strings.reserve(n);
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t len = u32();
+            need(len);
+            strings.emplace_back(p, len);
+            p += len;
+        }
+
+        vector<unique_ptr<Decl>> globals;
+        n = count();
+        for (uint32_t i = 0; i < n; i++) {
+            string name = str();
+            globals.push_back(make_unique<Decl>(name, type()));
+        }
+
+        vector<unique_ptr<Init>> init;
+        n = count();
+        for (uint32_t i = 0; i < n; i++) {
+            string name = str();
+            init.push_back(make_unique<Init>(name, expr()));
+        }
+
+        vector<unique_ptr<APIFuncDecl>> functions;
+        n = count();
+        for (uint32_t i = 0; i < n; i++) {
+            string name = str();
+            auto params = types();
+            HTTPResponseCode rc = code(u8());
+            auto results = types();
+            functions.push_back(make_unique<APIFuncDecl>(name, std::move(params),
+                                                         make_pair(rc, std::move(results))));
+        }
+
+        vector<unique_ptr<API>> blocks;
+        n = count();
+        for (uint32_t i = 0; i < n; i++) {
+            string name = str();
+            auto pre = expr();
+            auto target = expr();
+            auto callResponse = expr();
+            auto post = expr();
+            unique_ptr<APIcall> call;
+            if (target) {
+                if (target->exprType != ExprType::FUNCCALL)
+                    throw runtime_error("spec binary: block call is not a function call");
+                unique_ptr<FuncCall> fc(static_cast<FuncCall *>(target.release()));
+                call = make_unique<APIcall>(std::move(fc), Response(std::move(callResponse)));
+            }
+            blocks.push_back(make_unique<API>(std::move(pre), std::move(call),
+                                              Response(std::move(post)), name));
+        }
+
+        if (p != end)
+            throw runtime_error("spec binary: trailing bytes");
+        return make_unique<Spec>(std::move(globals), std::move(init),
+                                 std::move(functions), std::move(blocks));
+    }
+
+private:
+    void need(size_t n)
+    {
+        if ((size_t)(end - p) < n)
+            throw runtime_error("spec binary: truncated");
+    }
+
+    uint8_t u8()
+    {
+        need(1);
+        return (uint8_t)*p++;
+    }
+
+    uint32_t u32()
+    {
+        need(4);
+        const unsigned char *b = (const unsigned char *)p;
+        p += 4;
+        return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    }
+
+    // Element count; every element takes at least one byte, so a count
+    // larger than the rest of the file is corruption, not a huge reserve
+    uint32_t count()
+    {
+        uint32_t n = u32();
+        if (n > (size_t)(end - p))
+            throw runtime_error("spec binary: bad count");
+        return n;
+    }
+
+    const string &str()
+    {
+        uint32_t id = u32();
+        if (id >= strings.size())
+            throw runtime_error("spec binary: bad string index");
+        return strings[id];
+    }
+
+    static HTTPResponseCode code(uint8_t c)
+    {
+        switch (c) {
+        case C_200: return HTTPResponseCode::OK_200;
+        case C_201: return HTTPResponseCode::CREATED_201;
+        case C_400: return HTTPResponseCode::BAD_REQUEST_400;
+        }
+        throw runtime_error("spec binary: bad response code");
+    }
+
+    vector<unique_ptr<TypeExpr>> types()
+    {
+        vector<unique_ptr<TypeExpr>> ts;
+        uint32_t n = count();
+        for (uint32_t i = 0; i < n; i++)
+            ts.push_back(type());
+        return ts;
+    }
+
+    unique_ptr<TypeExpr> type()
+    {
+        switch (u8()) {
+        case T_NULL:
+            return nullptr;
+        case T_CONST:
+            return make_unique<TypeConst>(str());
+        case T_MAP: {
+            auto domain = type();
+            auto range = type();
+            return make_unique<MapType>(std::move(domain), std::move(range));
+        }
+        case T_SET:
+            return make_unique<SetType>(type());
+        case T_TUPLE:
+            return make_unique<TupleType>(types());
+        case T_FUNC: {
+            auto params = types();
+            return make_unique<FuncType>(std::move(params), type());
+        }
+        }
+        throw runtime_error("spec binary: bad type tag");
+    }
+
+    vector<unique_ptr<Expr>> exprs()
+    {
+        vector<unique_ptr<Expr>> es;
+        uint32_t n = count();
+        es.reserve(n);
+        for (uint32_t i = 0; i < n; i++)
+            es.push_back(expr());
+        return es;
+    }
+
+    unique_ptr<Expr> expr()
+    {
+        switch (u8()) {
+        case E_NULL:
+            return nullptr;
+        case E_FUNCCALL: {
+            string name = str();
+            return make_unique<FuncCall>(name, exprs());
+        }
+        case E_VAR:
+            return make_unique<Var>(str());
+        case E_NUM:
+            return make_unique<Num>((int)u32());
+        case E_STRING:
+            return make_unique<String>(str());
+        case E_PLACEHOLDER: {
+            string global = str();
+            return make_unique<Placeholder>(global, str());
+        }
+        case E_BOOL:
+            return make_unique<BoolConst>(u8() != 0);
+        case E_SET:
+            return make_unique<Set>(exprs());
+        case E_TUPLE:
+            return make_unique<Tuple>(exprs());
+        case E_MAP: {
+            vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> entries;
+            uint32_t n = count();
+            for (uint32_t i = 0; i < n; i++) {
+                auto key = make_unique<Var>(str());
+                entries.emplace_back(std::move(key), expr());
+            }
+            return make_unique<Map>(std::move(entries));
+        }
+        case E_BINARY: {
+            uint8_t op = u8();
+            if (op > (uint8_t)BinOp::NOT_IN)
+                throw runtime_error("spec binary: bad binary operator");
+            auto l = expr();
+            auto r = expr();
+            return make_unique<BinaryOpExpr>((BinOp)op, std::move(l), std::move(r));
+        }
+        case E_UNARY: {
+            uint8_t op = u8();
+            if (op > (uint8_t)UnOp::NOT)
+                throw runtime_error("spec binary: bad unary operator");
+            return make_unique<UnaryOpExpr>((UnOp)op, expr());
+        }
+        }
+        throw runtime_error("spec binary: bad expression tag");
+    }
+};
+
+// Read-only mapping of a whole file, unmapped on scope exit
+class MappedFile {
+    int fd = -1;
+    void *addr = MAP_FAILED;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const string &path)
+    {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error("Cannot open spec file: " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw runtime_error("Cannot stat spec file: " + path);
+        }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("Cannot map spec file: " + path);
+            }
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (addr != MAP_FAILED)
+            munmap(addr, length);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return addr == MAP_FAILED ? "" : (const char *)addr; }
+    size_t size() const { return length; }
+};
+
+} // namespace
+
+/* ============================================================
+ * Entry points
+ * ============================================================ */
+
+string serializeSpec(const Spec &spec)
+{
+    return SpecEncoder().encode(spec);
+}
+
+string serializeSpecElement(const API &block)
+{
+    return SpecEncoder().encode(block);
+}
+
+string serializeSpecElement(const Decl &global)
+{
+    return SpecEncoder().encode(global);
+}
+
+string serializeSpecElement(const Init &init)
+{
+    return SpecEncoder().encode(init);
+}
+
+string serializeSpecElement(const APIFuncDecl &function)
+{
+    return SpecEncoder().encode(function);
+}
+
+unique_ptr<Spec> deserializeSpec(const char *data, size_t size)
+{
+    return SpecDecoder(data, size).decode();
+}
+
+bool isSpecBinary(const char *data, size_t size)
+{
+    return size >= 4 && memcmp(data, SPEC_MAGIC, 4) == 0;
+}
+
+void saveSpecBinary(const Spec &spec, const string &path)
+{
+    string bytes = serializeSpec(spec);
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out)
+        throw runtime_error("Cannot write spec file: " + path);
+    out.write(bytes.data(), bytes.size());
+    if (!out)
+        throw runtime_error("Failed writing spec file: " + path);
+}
+
+unique_ptr<Spec> loadSpecBinary(const string &path)
+{
+    MappedFile file(path);
+    try {
+        return deserializeSpec(file.data(), file.size());
+    } catch (const runtime_error &e) {
+        throw runtime_error(path + ": " + e.what());
+    }
+}
+
+unique_ptr<Spec> loadSpecFile(const string &path)
+{
+    {
+        MappedFile file(path);
+        if (isSpecBinary(file.data(), file.size())) {
+            try {
+                return deserializeSpec(file.data(), file.size());
+            } catch (const runtime_error &e) {
+                throw runtime_error(path + ": " + e.what());
+            }
+        }
+    }
+    return parseSpecFile(path);
+}
@@ -0,0 +1,47 @@
+#ifndef SPECBINARY_HH
+#define SPECBINARY_HH
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "ast.hh"
+
+using namespace std;
+
+/*
+ * Precompiled spec format (".specb"), little-endian:
+ *
+ *   "TGSB" u32 version
+ *   u32 nstrings, { u32 len, bytes }      every name and literal, interned once
+ *   u32 nglobals, { str name, type }
+ *   u32 ninit,    { str name, expr }
+ *   u32 nfuncs,   { str name, u32 n, type*, u8 code, u32 m, type* }
+ *   u32 nblocks,  { str name, expr pre, expr call, expr callResponse, expr post }
+ *
+ * where str is a u32 string-table index and type/expr are u8-tagged trees
+ * (tag 0 = null). The loader maps the file and builds the AST in a single
+ * pass with no tokenizing.
+ */
+
+const uint32_t SPEC_BINARY_VERSION = 1;
+
+string serializeSpec(const Spec &spec);
+unique_ptr<Spec> deserializeSpec(const char *data, size_t size);
+
+// Canonical bytes of a single block/global/init/function, in the same
+// encoding without the header: equal bytes mean structurally equal ASTs
+string serializeSpecElement(const API &block);
+string serializeSpecElement(const Decl &global);
+string serializeSpecElement(const Init &init);
+string serializeSpecElement(const APIFuncDecl &function);
+
+void saveSpecBinary(const Spec &spec, const string &path);
+unique_ptr<Spec> loadSpecBinary(const string &path);
+
+// True when the buffer starts with the binary magic
+bool isSpecBinary(const char *data, size_t size);
+
+// Loads a .specb or textual spec, picked by content
+unique_ptr<Spec> loadSpecFile(const string &path);
+
+#endif
@@ -0,0 +1,124 @@
+#include "specfingerprint.hh"
+#include "specbinary.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <set>
+
+using namespace std;
+
+namespace {
+
+string fnv1a(const string &bytes)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return hex;
+}
+
+// Names of every variable an expression mentions (B in dom(B'), ...)
+void collectVars(const Expr *e, set<string> &out)
+{
+    if (!e)
+        return;
+    switch (e->exprType) {
+    case ExprType::VAR:
+        out.insert(static_cast<const Var *>(e)->name);
+        return;
+    case ExprType::FUNCCALL:
+        for (const auto &arg : static_cast<const FuncCall *>(e)->args)
+            collectVars(arg.get(), out);
+        return;
+    case ExprType::SET:
+        for (const auto &el : static_cast<const Set *>(e)->elements)
+            collectVars(el.get(), out);
+        return;
+    case ExprType::TUPLE:
+        for (const auto &el : static_cast<const Tuple *>(e)->exprs)
+            collectVars(el.get(), out);
+        return;
+    case ExprType::MAP:
+        for (const auto &kv : static_cast<const Map *>(e)->value) {
+            out.insert(kv.first->name);
+            collectVars(kv.second.get(), out);
+        }
+        return;
+    case ExprType::BINARY_OP: {
+        auto b = static_cast<const BinaryOpExpr *>(e);
+        collectVars(b->left.get(), out);
+        collectVars(b->right.get(), out);
+        return;
+    }
+    case ExprType::UNARY_OP:
+        collectVars(static_cast<const UnaryOpExpr *>(e)->operand.get(), out);
+        return;
+    default:
+        return;
+    }
+}
+
+} // namespace
+
+map<string, string> fingerprintSpec(const Spec &spec)
+{
+    map<string, string> out;
+    // First block with a name wins, like genATC's search
+    for (const auto &block : spec.blocks)
+        out.emplace("block:" + block->name, fnv1a(serializeSpecElement(*block)));
+
+    // A global's fingerprint covers its type and its initial value
+    map<string, string> globals;
+    for (const auto &decl : spec.globals)
+        globals[decl->name] = serializeSpecElement(*decl);
+    for (const auto &init : spec.init)
+        globals[init->varName] += serializeSpecElement(*init);
+    for (const auto &kv : globals)
+        out["global:" + kv.first] = fnv1a(kv.second);
+
+    for (const auto &function : spec.functions)
+        out["function:" + function->name] = fnv1a(serializeSpecElement(*function));
+    return out;
+}
+
+map<string, string> sequenceDependencies(const Spec &spec, const map<string, string> &fingerprints,
+                                         const vector<string> &sequence)
+{
+    map<string, const API *> blocks;
+    for (const auto &block : spec.blocks)
+        blocks.emplace(block->name, block.get());
+
+    map<string, string> deps;
+    auto depend = [&](const string &key) {
+        auto it = fingerprints.find(key);
+        if (it != fingerprints.end())
+            deps[key] = it->second;
+    };
+
+    for (const auto &name : sequence) {
+        auto it = blocks.find(name);
+        if (it == blocks.end()) {
+            deps["block:" + name] = "missing";
+            continue;
+        }
+        const API &block = *it->second;
+        depend("block:" + name);
+
+        set<string> vars;
+        collectVars(block.pre.get(), vars);
+        collectVars(block.response.ResponseExpr.get(), vars);
+        if (block.call) {
+            collectVars(block.call->call.get(), vars);
+            collectVars(block.call->response.ResponseExpr.get(), vars);
+            depend("function:" + block.call->call->name);
+        }
+        // Only names that are globals have a fingerprint; locals drop out
+        for (const auto &var : vars)
+            depend("global:" + var);
+    }
+    return deps;
+}
@@ -0,0 +1,30 @@
+#ifndef SPECFINGERPRINT_HH
+#define SPECFINGERPRINT_HH
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ast.hh"
+
+using namespace std;
+
+/*
+ * Structural fingerprints of spec elements, for regression test selection.
+ *
+ * Each block, global (its declaration and init together) and API function
+ * declaration hashes to 64-bit FNV-1a over its canonical binary encoding
+ * (serializeSpecElement), so layout and the order of elements in the spec
+ * do not matter - only the ASTs do. Keys are "block:NAME", "global:NAME"
+ * and "function:NAME"; values are 16 hex digits.
+ *
+ * A sequence depends on its blocks, every global those blocks mention and
+ * the functions they call. It needs re-running when any of those changed.
+ */
+
+map<string, string> fingerprintSpec(const Spec &spec);
+
+// Dependency key -> fingerprint for one sequence; unknown blocks map to "missing"
+map<string, string> sequenceDependencies(const Spec &spec, const map<string, string> &fingerprints,
+                                         const vector<string> &sequence);
+
+#endif
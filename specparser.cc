@@ -0,0 +1,848 @@
+#include "specparser.hh"
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+/* ============================================================
+ * Lexer
+ * ============================================================ */
+
+namespace {
+
+enum class Tok { IDENT, NUM, STR, PUNCT, END };
+
+struct Token {
+    Tok kind;
+    string text;      // identifier name, punctuation, or unescaped string
+    bool quoted;      // `backquoted` identifier, never a keyword
+    long number;
+    int line;
+    int col;
+};
+
+const unordered_set<string> &reservedWords()
+{
+    static const unordered_set<string> words = {
+        "global", "init", "function", "block", "pre", "call", "post",
+    };
+    return words;
+}
+
+// Words that mean something inside an expression
+const unordered_set<string> &expressionWords()
+{
+    static const unordered_set<string> words = {
+        "in", "not_in", "AND", "and", "OR", "or", "true", "false", "set",
+    };
+    return words;
+}
+
+[[noreturn]] void syntaxError(int line, int col, const string &msg)
+{
+    throw runtime_error("spec:" + to_string(line) + ":" + to_string(col) + ": " + msg);
+}
+
+vector<Token> tokenize(const string &src)
+{
+    vector<Token> toks;
+    size_t i = 0;
+    int line = 1, col = 1;
+
+    auto advance = [&](size_t n) {
+        for (size_t k = 0; k < n && i < src.size(); k++, i++) {
+            if (src[i] == '\n') { line++; col = 1; }
+            else col++;
+        }
+    };
+    auto push = [&](Tok kind, string text, int l, int c, bool quoted = false, long number = 0) {
+        toks.push_back({kind, std::move(text), quoted, number, l, c});
+    };
+
+    while (i < src.size()) {
+        char ch = src[i];
+        int l = line, c = col;
+
+        if (isspace((unsigned char)ch)) { advance(1); continue; }
+        if (ch == '#' || (ch == '/' && i + 1 < src.size() && src[i + 1] == '/')) {
+            while (i < src.size() && src[i] != '\n') advance(1);
+            continue;
+        }
+
+        if (isalpha((unsigned char)ch) || ch == '_') {
+            size_t start = i;
+            while (i < src.size() && (isalnum((unsigned char)src[i]) || src[i] == '_')) advance(1);
+            push(Tok::IDENT, src.substr(start, i - start), l, c);
+            continue;
+        }
+
+        if (ch == '`') {
+            advance(1);
+            size_t start = i;
+            while (i < src.size() && src[i] != '`' && src[i] != '\n') advance(1);
+            if (i >= src.size() || src[i] != '`')
+                syntaxError(l, c, "unterminated `identifier`");
+            string name = src.substr(start, i - start);
+            if (name.empty())
+                syntaxError(l, c, "empty `identifier`");
+            advance(1);
+            push(Tok::IDENT, name, l, c, true);
+            continue;
+        }
+
+        bool negative = ch == '-' && i + 1 < src.size() && isdigit((unsigned char)src[i + 1]);
+        if (isdigit((unsigned char)ch) || negative) {
+            size_t start = i;
+            advance(1);
+            while (i < src.size() && isdigit((unsigned char)src[i])) advance(1);
+            string digits = src.substr(start, i - start);
+            long value;
+            try { value = stol(digits); }
+            catch (const exception &) { syntaxError(l, c, "number out of range: " + digits); }
+            if (value < INT_MIN || value > INT_MAX)
+                syntaxError(l, c, "number out of range: " + digits);
+            push(Tok::NUM, digits, l, c, false, value);
+            continue;
+        }
+
+        if (ch == '"') {
+            advance(1);
+            string value;
+            while (true) {
+                if (i >= src.size() || src[i] == '\n')
+                    syntaxError(l, c, "unterminated string");
+                char s = src[i];
+                if (s == '"') { advance(1); break; }
+                if (s == '\\') {
+                    if (i + 1 >= src.size())
+                        syntaxError(line, col, "unterminated escape");
+                    char e = src[i + 1];
+                    switch (e) {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    case '"': value += '"'; break;
+                    case '\\': value += '\\'; break;
+                    default: syntaxError(line, col, string("unknown escape \\") + e);
+                    }
+                    advance(2);
+                    continue;
+                }
+                value += s;
+                advance(1);
+            }
+            push(Tok::STR, value, l, c);
+            continue;
+        }
+
+        static const char *twoChar[] = {"->", "!=", "==", "<=", ">=", "&&", "||"};
+        bool matched = false;
+        for (const char *op : twoChar) {
+            if (src.compare(i, 2, op) == 0) {
+                push(Tok::PUNCT, op, l, c);
+                advance(2);
+                matched = true;
+                break;
+            }
+        }
+        if (matched) continue;
+
+        if (string("(){}[]<>,:='").find(ch) != string::npos) {
+            push(Tok::PUNCT, string(1, ch), l, c);
+            advance(1);
+            continue;
+        }
+
+        syntaxError(l, c, string("unexpected character '") + ch + "'");
+    }
+    toks.push_back({Tok::END, "", false, 0, line, col});
+    return toks;
+}
+
+/* ============================================================
+ * Parser
+ * ============================================================ */
+
+class SpecParser {
+    vector<Token> toks;
+    size_t pos = 0;
+
+public:
+    explicit SpecParser(const string &text) : toks(tokenize(text)) {}
+
+    unique_ptr<Spec> parse()
+    {
+        vector<unique_ptr<Decl>> globals;
+        vector<unique_ptr<Init>> init;
+        vector<unique_ptr<APIFuncDecl>> functions;
+        vector<unique_ptr<API>> blocks;
+
+        while (peek().kind != Tok::END) {
+            if (acceptKeyword("global")) {
+                string name = identifier("global name");
+                expect(":");
+                globals.push_back(make_unique<Decl>(name, type()));
+            } else if (acceptKeyword("init")) {
+                string name = identifier("init target");
+                expect("=");
+                init.push_back(make_unique<Init>(name, expr()));
+            } else if (acceptKeyword("function")) {
+                functions.push_back(function());
+            } else if (acceptKeyword("block")) {
+                blocks.push_back(block());
+            } else {
+                fail("expected 'global', 'init', 'function' or 'block'");
+            }
+        }
+        return make_unique<Spec>(std::move(globals), std::move(init),
+                                 std::move(functions), std::move(blocks));
+    }
+
+private:
+    const Token &peek(size_t ahead = 0) const
+    {
+        return toks[min(pos + ahead, toks.size() - 1)];
+    }
+
+    [[noreturn]] void fail(const string &msg) const
+    {
+        const Token &t = peek();
+        string found = t.kind == Tok::END ? "end of input" : "'" + t.text + "'";
+        syntaxError(t.line, t.col, msg + ", found " + found);
+    }
+
+    bool isPunct(const char *p) const
+    {
+        return peek().kind == Tok::PUNCT && peek().text == p;
+    }
+
+    bool accept(const char *p)
+    {
+        if (!isPunct(p)) return false;
+        pos++;
+        return true;
+    }
+
+    void expect(const char *p)
+    {
+        if (!accept(p))
+            fail(string("expected '") + p + "'");
+    }
+
+    bool isKeyword(const char *word) const
+    {
+        return peek().kind == Tok::IDENT && !peek().quoted && peek().text == word;
+    }
+
+    bool acceptKeyword(const char *word)
+    {
+        if (!isKeyword(word)) return false;
+        pos++;
+        return true;
+    }
+
+    string identifier(const char *what)
+    {
+        const Token &t = peek();
+        if (t.kind != Tok::IDENT)
+            fail(string("expected ") + what);
+        if (!t.quoted && (reservedWords().count(t.text) || expressionWords().count(t.text)))
+            fail(string("expected ") + what + " (use `" + t.text + "` for a reserved word)");
+        pos++;
+        return t.text;
+    }
+
+    /* ---------- declarations ---------- */
+
+    unique_ptr<APIFuncDecl> function()
+    {
+        string name = identifier("function name");
+        expect("(");
+        vector<unique_ptr<TypeExpr>> params = typeList(")");
+        expect("->");
+
+        const Token &code = peek();
+        if (code.kind != Tok::NUM)
+            fail("expected response code 200, 201 or 400");
+        HTTPResponseCode rc;
+        if (code.number == 200) rc = HTTPResponseCode::OK_200;
+        else if (code.number == 201) rc = HTTPResponseCode::CREATED_201;
+        else if (code.number == 400) rc = HTTPResponseCode::BAD_REQUEST_400;
+        else fail("unsupported response code");
+        pos++;
+
+        vector<unique_ptr<TypeExpr>> results;
+        if (accept("("))
+            results = typeList(")");
+        return make_unique<APIFuncDecl>(name, std::move(params),
+                                        make_pair(rc, std::move(results)));
+    }
+
+    unique_ptr<API> block()
+    {
+        string name;
+        if (!isPunct("{"))
+            name = identifier("block name");
+        expect("{");
+
+        unique_ptr<Expr> pre;
+        unique_ptr<APIcall> call;
+        unique_ptr<Expr> post;
+        if (acceptKeyword("pre"))
+            pre = expr();
+        if (acceptKeyword("call")) {
+            const Token &at = peek();
+            unique_ptr<Expr> target = postfix();
+            if (target->exprType != ExprType::FUNCCALL)
+                syntaxError(at.line, at.col, "'call' needs a function call");
+            unique_ptr<FuncCall> fc(static_cast<FuncCall *>(target.release()));
+            unique_ptr<Expr> callResponse;
+            if (accept("->"))
+                callResponse = expr();
+            call = make_unique<APIcall>(std::move(fc), Response(std::move(callResponse)));
+        }
+        if (acceptKeyword("post"))
+            post = expr();
+        expect("}");
+        return make_unique<API>(std::move(pre), std::move(call), Response(std::move(post)), name);
+    }
+
+    /* ---------- types ---------- */
+
+    vector<unique_ptr<TypeExpr>> typeList(const char *close)
+    {
+        vector<unique_ptr<TypeExpr>> types;
+        if (accept(close))
+            return types;
+        do {
+            types.push_back(type());
+        } while (accept(","));
+        expect(close);
+        return types;
+    }
+
+    unique_ptr<TypeExpr> type()
+    {
+        if (accept("("))
+            return make_unique<TupleType>(typeList(")"));
+        if (isKeyword("map") && peek(1).kind == Tok::PUNCT && peek(1).text == "<") {
+            pos += 2;
+            auto domain = type();
+            expect(",");
+            auto range = type();
+            expect(">");
+            return make_unique<MapType>(std::move(domain), std::move(range));
+        }
+        if (isKeyword("set") && peek(1).kind == Tok::PUNCT && peek(1).text == "<") {
+            pos += 2;
+            auto elem = type();
+            expect(">");
+            return make_unique<SetType>(std::move(elem));
+        }
+        if (isKeyword("fn") && peek(1).kind == Tok::PUNCT && peek(1).text == "(") {
+            pos += 2;
+            auto params = typeList(")");
+            expect("->");
+            return make_unique<FuncType>(std::move(params), type());
+        }
+        const Token &t = peek();
+        if (t.kind != Tok::IDENT)
+            fail("expected a type");
+        pos++;
+        return make_unique<TypeConst>(t.text);
+    }
+
+    /* ---------- expressions ---------- */
+
+    // Spelling of the infix operator at the cursor for a precedence level
+    bool peekInfix(int level, string &op) const
+    {
+        const Token &t = peek();
+        if (t.kind == Tok::IDENT && t.quoted)
+            return false;
+        static const unordered_set<string> orOps = {"OR", "or", "||"};
+        static const unordered_set<string> andOps = {"AND", "and", "&&"};
+        static const unordered_set<string> cmpOps = {"=", "==", "!=", "<", "<=", ">", ">=", "in", "not_in"};
+        const auto &ops = level == 0 ? orOps : level == 1 ? andOps : cmpOps;
+        if ((t.kind == Tok::IDENT || t.kind == Tok::PUNCT) && ops.count(t.text)) {
+            op = t.text;
+            return true;
+        }
+        return false;
+    }
+
+    static unique_ptr<Expr> binary(const string &op, unique_ptr<Expr> l, unique_ptr<Expr> r)
+    {
+        vector<unique_ptr<Expr>> args;
+        args.push_back(std::move(l));
+        args.push_back(std::move(r));
+        return make_unique<FuncCall>(op, std::move(args));
+    }
+
+    unique_ptr<Expr> expr() { return logical(0); }
+
+    // level 0: OR, level 1: AND (both left-associative)
+    unique_ptr<Expr> logical(int level)
+    {
+        auto lhs = level == 0 ? logical(1) : comparison();
+        string op;
+        while (peekInfix(level, op)) {
+            pos++;
+            auto rhs = level == 0 ? logical(1) : comparison();
+            lhs = binary(op, std::move(lhs), std::move(rhs));
+        }
+        return lhs;
+    }
+
+    // Comparisons do not chain: "a = b = c" is an error
+    unique_ptr<Expr> comparison()
+    {
+        auto lhs = postfix();
+        string op;
+        if (peekInfix(2, op)) {
+            pos++;
+            lhs = binary(op, std::move(lhs), postfix());
+            if (peekInfix(2, op))
+                fail("comparisons do not chain, add parentheses");
+        }
+        return lhs;
+    }
+
+    unique_ptr<Expr> postfix()
+    {
+        auto e = primary();
+        while (true) {
+            if (accept("'")) {
+                vector<unique_ptr<Expr>> args;
+                args.push_back(std::move(e));
+                e = make_unique<FuncCall>("'", std::move(args));
+            } else if (accept("[")) {
+                auto key = expr();
+                expect("]");
+                e = binary("[]", std::move(e), std::move(key));
+            } else {
+                return e;
+            }
+        }
+    }
+
+    vector<unique_ptr<Expr>> exprList(const char *close)
+    {
+        vector<unique_ptr<Expr>> items;
+        if (accept(close))
+            return items;
+        do {
+            items.push_back(expr());
+        } while (accept(","));
+        expect(close);
+        return items;
+    }
+
+    unique_ptr<Expr> primary()
+    {
+        const Token &t = peek();
+        switch (t.kind) {
+        case Tok::NUM:
+            pos++;
+            return make_unique<Num>((int)t.number);
+        case Tok::STR:
+            pos++;
+            return make_unique<String>(t.text);
+        case Tok::END:
+            fail("expected an expression");
+        case Tok::PUNCT:
+            if (accept("("))
+                return parenthesized();
+            if (accept("{"))
+                return mapLiteral();
+            fail("expected an expression");
+        case Tok::IDENT:
+            break;
+        }
+
+        if (!t.quoted) {
+            if (t.text == "true" || t.text == "false") {
+                pos++;
+                return make_unique<BoolConst>(t.text == "true");
+            }
+            if (t.text == "set" && peek(1).kind == Tok::PUNCT && peek(1).text == "{") {
+                pos += 2;
+                return make_unique<Set>(exprList("}"));
+            }
+            if (reservedWords().count(t.text) || expressionWords().count(t.text))
+                fail("expected an expression (use `" + t.text + "` for a name)");
+        }
+        string name = t.text;
+        pos++;
+        if (accept("("))
+            return make_unique<FuncCall>(name, exprList(")"));
+        return make_unique<Var>(name);
+    }
+
+    // "(e)" groups, "()" / "(e,)" / "(e, e, ...)" are tuples
+    unique_ptr<Expr> parenthesized()
+    {
+        vector<unique_ptr<Expr>> items;
+        if (accept(")"))
+            return make_unique<Tuple>(std::move(items));
+        items.push_back(expr());
+        if (accept(")"))
+            return std::move(items[0]);
+        expect(",");
+        while (!isPunct(")")) {
+            items.push_back(expr());
+            if (!accept(","))
+                break;
+        }
+        expect(")");
+        return make_unique<Tuple>(std::move(items));
+    }
+
+    unique_ptr<Expr> mapLiteral()
+    {
+        vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> entries;
+        if (accept("}"))
+            return make_unique<Map>(std::move(entries));
+        do {
+            string key = identifier("map key");
+            expect(":");
+            entries.emplace_back(make_unique<Var>(key), expr());
+        } while (accept(","));
+        expect("}");
+        return make_unique<Map>(std::move(entries));
+    }
+};
+
+/* ============================================================
+ * Writer
+ * ============================================================ */
+
+// Binding strength of an expression as written; higher binds tighter
+enum Prec { P_OR = 0, P_AND = 1, P_CMP = 2, P_POSTFIX = 3 };
+
+int infixLevel(const string &name)
+{
+    static const unordered_set<string> orOps = {"OR", "or", "||"};
+    static const unordered_set<string> andOps = {"AND", "and", "&&"};
+    static const unordered_set<string> cmpOps = {"=", "==", "!=", "<", "<=", ">", ">=", "in", "not_in"};
+    if (orOps.count(name)) return P_OR;
+    if (andOps.count(name)) return P_AND;
+    if (cmpOps.count(name)) return P_CMP;
+    return -1;
+}
+
+bool plainIdentifier(const string &name)
+{
+    if (name.empty() || !(isalpha((unsigned char)name[0]) || name[0] == '_'))
+        return false;
+    for (char c : name)
+        if (!(isalnum((unsigned char)c) || c == '_'))
+            return false;
+    return !reservedWords().count(name) && !expressionWords().count(name);
+}
+
+class SpecWriter {
+    ostream &out;
+
+public:
+    explicit SpecWriter(ostream &out) : out(out) {}
+
+    void spec(const Spec &s)
+    {
+        for (const auto &d : s.globals) {
+            out << "global " << ident(d->name) << " : ";
+            type(d->type.get());
+            out << "\n";
+        }
+        if (!s.globals.empty()) out << "\n";
+
+        for (const auto &i : s.init) {
+            out << "init " << ident(i->varName) << " = ";
+            expr(i->expr.get(), P_OR);
+            out << "\n";
+        }
+        if (!s.init.empty()) out << "\n";
+
+        for (const auto &f : s.functions) {
+            out << "function " << ident(f->name) << "(";
+            typeList(f->params);
+            out << ") -> " << code(f->returnType.first);
+            if (!f->returnType.second.empty()) {
+                out << " (";
+                typeList(f->returnType.second);
+                out << ")";
+            }
+            out << "\n";
+        }
+        if (!s.functions.empty()) out << "\n";
+
+        for (size_t b = 0; b < s.blocks.size(); b++) {
+            if (b) out << "\n";
+            block(*s.blocks[b]);
+        }
+    }
+
+private:
+    static string ident(const string &name)
+    {
+        if (plainIdentifier(name))
+            return name;
+        if (name.empty() || name.find_first_of("`\n") != string::npos)
+            throw runtime_error("writeSpecText: name cannot be written: \"" + name + "\"");
+        return "`" + name + "`";
+    }
+
+    static const char *code(HTTPResponseCode rc)
+    {
+        switch (rc) {
+        case HTTPResponseCode::OK_200: return "200";
+        case HTTPResponseCode::CREATED_201: return "201";
+        case HTTPResponseCode::BAD_REQUEST_400: return "400";
+        }
+        return "200";
+    }
+
+    void block(const API &api)
+    {
+        out << "block " << (api.name.empty() ? "" : ident(api.name) + " ") << "{\n";
+        if (api.pre) {
+            out << "    pre  ";
+            expr(api.pre.get(), P_OR);
+            out << "\n";
+        }
+        if (api.call) {
+            out << "    call ";
+            expr(api.call->call.get(), P_OR);
+            if (api.call->response.ResponseExpr) {
+                out << " -> ";
+                expr(api.call->response.ResponseExpr.get(), P_OR);
+            }
+            out << "\n";
+        }
+        if (api.response.ResponseExpr) {
+            out << "    post ";
+            expr(api.response.ResponseExpr.get(), P_OR);
+            out << "\n";
+        }
+        out << "}\n";
+    }
+
+    void typeList(const vector<unique_ptr<TypeExpr>> &types)
+    {
+        for (size_t i = 0; i < types.size(); i++) {
+            if (i) out << ", ";
+            type(types[i].get());
+        }
+    }
+
+    void type(const TypeExpr *t)
+    {
+        if (!t)
+            throw runtime_error("writeSpecText: missing type");
+        switch (t->typeExprType) {
+        case TypeExprType::TYPE_CONST: {
+            const string &name = static_cast<const TypeConst *>(t)->name;
+            // Any identifier-shaped name is a type name in type position
+            bool bare = !name.empty() && (isalpha((unsigned char)name[0]) || name[0] == '_') &&
+                        name.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_") == string::npos;
+            out << (bare ? name : ident(name));
+            return;
+        }
+        case TypeExprType::MAP_TYPE: {
+            auto m = static_cast<const MapType *>(t);
+            out << "map<";
+            type(m->domain.get());
+            out << ", ";
+            type(m->range.get());
+            out << ">";
+            return;
+        }
+        case TypeExprType::SET_TYPE:
+            out << "set<";
+            type(static_cast<const SetType *>(t)->elementType.get());
+            out << ">";
+            return;
+        case TypeExprType::TUPLE_TYPE:
+            out << "(";
+            typeList(static_cast<const TupleType *>(t)->elements);
+            out << ")";
+            return;
+        case TypeExprType::FUNC_TYPE: {
+            auto f = static_cast<const FuncType *>(t);
+            out << "fn(";
+            typeList(f->params);
+            out << ") -> ";
+            type(f->returnType.get());
+            return;
+        }
+        case TypeExprType::TYPE_VARIABLE:
+            break;
+        }
+        throw runtime_error("writeSpecText: unsupported type " + const_cast<TypeExpr *>(t)->toString());
+    }
+
+    static int precedence(const Expr *e)
+    {
+        if (e->exprType != ExprType::FUNCCALL)
+            return P_POSTFIX;
+        auto fc = static_cast<const FuncCall *>(e);
+        if (fc->args.size() == 2 && infixLevel(fc->name) >= 0)
+            return infixLevel(fc->name);
+        return P_POSTFIX;
+    }
+
+    // Write e so that it parses back at binding strength `min`
+    void expr(const Expr *e, int min)
+    {
+        if (!e)
+            throw runtime_error("writeSpecText: missing expression");
+        bool wrap = precedence(e) < min;
+        if (wrap) out << "(";
+        bare(e);
+        if (wrap) out << ")";
+    }
+
+    void exprList(const vector<Ref<Expr>> &items)
+    {
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i) out << ", ";
+            expr(items[i].get(), P_OR);
+        }
+    }
+
+    void bare(const Expr *e)
+    {
+        switch (e->exprType) {
+        case ExprType::FUNCCALL:
+            call(static_cast<const FuncCall *>(e));
+            return;
+        case ExprType::VAR:
+            out << ident(static_cast<const Var *>(e)->name);
+            return;
+        case ExprType::NUM:
+            out << static_cast<const Num *>(e)->value;
+            return;
+        case ExprType::STRING:
+            quote(static_cast<const String *>(e)->value);
+            return;
+        case ExprType::BOOL_CONST:
+            out << (static_cast<const BoolConst *>(e)->value ? "true" : "false");
+            return;
+        case ExprType::SET:
+            out << "set{";
+            exprList(static_cast<const Set *>(e)->elements);
+            out << "}";
+            return;
+        case ExprType::TUPLE: {
+            const auto &items = static_cast<const Tuple *>(e)->exprs;
+            out << "(";
+            exprList(items);
+            if (items.size() == 1) out << ",";
+            out << ")";
+            return;
+        }
+        case ExprType::MAP: {
+            const auto &entries = static_cast<const Map *>(e)->value;
+            out << "{";
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (i) out << ", ";
+                out << ident(entries[i].first->name) << ": ";
+                expr(entries[i].second.get(), P_OR);
+            }
+            out << "}";
+            return;
+        }
+        default:
+            break;
+        }
+        throw runtime_error("writeSpecText: expression kind " +
+                            to_string((int)e->exprType) + " has no text form");
+    }
+
+    void call(const FuncCall *fc)
+    {
+        int level = precedence(fc);
+        if (level < P_POSTFIX) {
+            // Left-associative logic ops keep a same-level left operand bare;
+            // comparisons do not chain, so both sides need a tighter operand
+            expr(fc->args[0].get(), level == P_CMP ? level + 1 : level);
+            out << " " << fc->name << " ";
+            expr(fc->args[1].get(), level + 1);
+            return;
+        }
+        if (fc->name == "'" && fc->args.size() == 1) {
+            expr(fc->args[0].get(), P_POSTFIX);
+            out << "'";
+            return;
+        }
+        if (fc->name == "[]" && fc->args.size() == 2) {
+            expr(fc->args[0].get(), P_POSTFIX);
+            out << "[";
+            expr(fc->args[1].get(), P_OR);
+            out << "]";
+            return;
+        }
+        out << ident(fc->name) << "(";
+        exprList(fc->args);
+        out << ")";
+    }
+
+    void quote(const string &s)
+    {
+        out << '"';
+        for (char c : s) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            case '\r': out << "\\r"; break;
+            default: out << c;
+            }
+        }
+        out << '"';
+    }
+};
+
+} // namespace
+
+/* ============================================================
+ * Entry points
+ * ============================================================ */
+
+unique_ptr<Spec> parseSpecText(const string &text)
+{
+    return SpecParser(text).parse();
+}
+
+unique_ptr<Spec> parseSpecFile(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot open spec file: " + path);
+    stringstream buffer;
+    buffer << in.rdbuf();
+    try {
+        return parseSpecText(buffer.str());
+    } catch (const runtime_error &e) {
+        // "spec:3:7: ..." -> "<path>:3:7: ..."
+        string msg = e.what();
+        if (msg.rfind("spec:", 0) == 0)
+            msg = path + msg.substr(4);
+        throw runtime_error(msg);
+    }
+}
+
+void writeSpecText(const Spec &spec, ostream &out)
+{
+    SpecWriter(out).spec(spec);
+}
+
+string writeSpecText(const Spec &spec)
+{
+    ostringstream out;
+    writeSpecText(spec, out);
+    return out.str();
+}
@@ -0,0 +1,44 @@
+#ifndef SPECPARSER_HH
+#define SPECPARSER_HH
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include "ast.hh"
+
+using namespace std;
+
+/*
+ * Textual spec format, parsed into the same Spec/API/Expr AST the
+ * make*Spec() builders produce:
+ *
+ *   # comment
+ *   global U : map<string, string>
+ *   init U = {}
+ *   function login(string, string) -> 200 (string)
+ *
+ *   block loginOk {
+ *       pre  email in dom(U) AND U[email] = password
+ *       call login(email, password)
+ *       post token in dom(T')
+ *   }
+ *
+ * Expressions:
+ *   e OR e, e AND e          logical ("and", "or", "&&", "||" also accepted)
+ *   e = e, e != e, e in e,   comparisons ("==", "<", "<=", ">", ">=", "not_in")
+ *   e', e[k]                 post-state and lookup ("'" and "[]" calls)
+ *   f(e, ...), x, 42, "s", true, {k: e}, set{e, ...}, (e, e)
+ * Every operator becomes a FuncCall named by its spelling, exactly as in
+ * the builders. Backquotes make any name an identifier: `!`(x).
+ * `call f(x) -> e` attaches a response expression to the call.
+ */
+
+// Parse spec text; throws runtime_error("spec:<line>:<col>: ...") on errors
+unique_ptr<Spec> parseSpecText(const string &text);
+unique_ptr<Spec> parseSpecFile(const string &path);
+
+// Write a Spec in the textual format (parseSpecText(writeSpecText(s)) == s)
+void writeSpecText(const Spec &spec, ostream &out);
+string writeSpecText(const Spec &spec);
+
+#endif
@@ -0,0 +1,49 @@
+#include "SharedSpecs.hpp"
+#include "RestaurantSpec.hpp"
+#include "EcommerceSpec.hpp"
+#include "LibrarySpec.hpp"
+#include "TripVaultSpec.hpp"
+#include "GhostSocketSpec.hpp"
+#include "ServeezSpec.hpp"
+
+using namespace std;
+
+shared_ptr<const Spec> restaurantSpec() {
+    static const shared_ptr<const Spec> spec = makeRestaurantSpec();
+    return spec;
+}
+
+shared_ptr<const Spec> ecommerceSpec() {
+    static const shared_ptr<const Spec> spec = makeEcommerceSpec();
+    return spec;
+}
+
+shared_ptr<const Spec> librarySpec() {
+    static const shared_ptr<const Spec> spec = makeLibrarySpec();
+    return spec;
+}
+
+shared_ptr<const Spec> tripVaultSpec() {
+    static const shared_ptr<const Spec> spec = makeTripVaultSpec();
+    return spec;
+}
+
+shared_ptr<const Spec> ghostSocketSpec() {
+    static const shared_ptr<const Spec> spec = makeGhostSocketSpec();
+    return spec;
+}
+
+shared_ptr<const Spec> serveezSpec() {
+    static const shared_ptr<const Spec> spec = makeServeezSpec();
+    return spec;
+}
+
+shared_ptr<const Spec> builtinSpec(const string& app) {
+    if (app == "restaurant") return restaurantSpec();
+    if (app == "ecommerce") return ecommerceSpec();
+    if (app == "library") return librarySpec();
+    if (app == "tripvault") return tripVaultSpec();
+    if (app == "ghostsocket") return ghostSocketSpec();
+    if (app == "serveez") return serveezSpec();
+    return nullptr;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "../ast.hh"
+#include <memory>
+#include <string>
+
+// Process-wide specs: each builder runs once, on first use, and every test
+// shares the same immutable AST. Only the specs are shareable: the pipeline
+// that consumes them (SEE's SymVar numbering, the value generator counters,
+// SuiteSelection) keeps unsynchronized process state and is single-threaded.
+std::shared_ptr<const Spec> restaurantSpec();
+std::shared_ptr<const Spec> ecommerceSpec();
+std::shared_ptr<const Spec> librarySpec();
+std::shared_ptr<const Spec> tripVaultSpec();
+std::shared_ptr<const Spec> ghostSocketSpec();
+std::shared_ptr<const Spec> serveezSpec();
+
+// By app name ("restaurant", "ecommerce", ...); nullptr when unknown
+std::shared_ptr<const Spec> builtinSpec(const std::string& app);
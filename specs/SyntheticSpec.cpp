@@ -0,0 +1,323 @@
+#include "SyntheticSpec.hpp"
+
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+/* =====================================================
+ * OPTIONS
+ * ===================================================== */
+
+SyntheticSpecOptions parseSyntheticSpecOptions(const string &text)
+{
+    SyntheticSpecOptions options;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ','))
+    {
+        if (item.empty())
+            continue;
+        size_t eq = item.find('=');
+        if (eq == string::npos)
+            throw runtime_error("Synthetic spec option needs key=value: '" + item + "'");
+        string key = item.substr(0, eq);
+        string value = item.substr(eq + 1);
+        try
+        {
+            if (key == "globals")
+                options.globals = stoul(value);
+            else if (key == "blocks")
+                options.blocks = stoul(value);
+            else if (key == "terms")
+                options.preconditionTerms = stoul(value);
+            else if (key == "mapsize")
+                options.initialMapSize = stoul(value);
+            else if (key == "deps")
+                options.dependencyRate = stod(value);
+            else if (key == "seed")
+                options.seed = (unsigned)stoul(value);
+            else
+                throw runtime_error("Unknown synthetic spec option: " + key);
+        }
+        catch (const logic_error &)
+        {
+            throw runtime_error("Bad value for synthetic spec option " + key + ": '" + value + "'");
+        }
+    }
+    if (options.globals == 0)
+        throw runtime_error("Synthetic spec needs at least one global");
+    if (options.blocks < options.globals)
+        throw runtime_error("Synthetic spec needs at least one block per global");
+    if (options.dependencyRate < 0 || options.dependencyRate > 1)
+        throw runtime_error("Synthetic spec deps must be within [0, 1]");
+    return options;
+}
+
+string describeSyntheticSpecOptions(const SyntheticSpecOptions &options)
+{
+    ostringstream out;
+    out << "globals=" << options.globals << ",blocks=" << options.blocks
+        << ",terms=" << options.preconditionTerms << ",mapsize=" << options.initialMapSize
+        << ",deps=" << options.dependencyRate << ",seed=" << options.seed;
+    return out.str();
+}
+
+/* =====================================================
+ * AST HELPERS
+ * ===================================================== */
+
+namespace
+{
+
+    // Same seed, same spec: only the raw mt19937 stream is used, never the
+    // implementation-defined std distributions
+    class Draw
+    {
+        mt19937 rng;
+
+    public:
+        explicit Draw(unsigned seed) : rng(seed) {}
+        size_t below(size_t n) { return n ? rng() % n : 0; }
+        bool chance(double p) { return rng() < p * 4294967296.0; }
+    };
+
+    unique_ptr<Expr> var(const string &name)
+    {
+        return make_unique<Var>(name);
+    }
+
+    unique_ptr<Expr> fn(const string &name, unique_ptr<Expr> a, unique_ptr<Expr> b = nullptr)
+    {
+        vector<unique_ptr<Expr>> args;
+        args.push_back(std::move(a));
+        if (b)
+            args.push_back(std::move(b));
+        return make_unique<FuncCall>(name, std::move(args));
+    }
+
+    unique_ptr<Expr> conj(vector<unique_ptr<Expr>> terms)
+    {
+        if (terms.empty())
+            return make_unique<Num>(1);
+        if (terms.size() == 1)
+            return std::move(terms[0]);
+        return make_unique<FuncCall>("AND", std::move(terms));
+    }
+
+    string global(size_t g) { return "G" + to_string(g); }
+    string key(size_t g) { return "key" + to_string(g); }
+    string value(size_t g) { return "val" + to_string(g); }
+
+    // key in dom(G)
+    unique_ptr<Expr> inDom(const string &k, unique_ptr<Expr> g)
+    {
+        return fn("in", var(k), fn("dom", std::move(g)));
+    }
+
+    // G'
+    unique_ptr<Expr> primed(size_t g)
+    {
+        return fn("'", var(global(g)));
+    }
+
+    unique_ptr<API> makeBlock(unique_ptr<Expr> pre, const string &fname,
+                              const vector<string> &argNames, unique_ptr<Expr> post,
+                              const string &name)
+    {
+        vector<unique_ptr<Expr>> args;
+        for (const auto &a : argNames)
+            args.push_back(var(a));
+        auto call = make_unique<APIcall>(
+            make_unique<FuncCall>(fname, std::move(args)),
+            Response(nullptr));
+        return make_unique<API>(std::move(pre), std::move(call), Response(std::move(post)), name);
+    }
+
+    // createG<g>(key, val): pre key not_in dom(G), post key in dom(G') and G'[key] = val
+    unique_ptr<API> creatingBlock(size_t g, const string &name)
+    {
+        auto pre = fn("not_in", var(key(g)), fn("dom", var(global(g))));
+
+        vector<unique_ptr<Expr>> post;
+        post.push_back(inDom(key(g), primed(g)));
+        post.push_back(fn("=", fn("[]", primed(g), var(key(g))), var(value(g))));
+
+        return makeBlock(std::move(pre), "create" + global(g), {key(g), value(g)},
+                         conj(std::move(post)), name);
+    }
+
+} // namespace
+
+/* =====================================================
+ * SPEC
+ * ===================================================== */
+
+std::unique_ptr<Spec> makeSyntheticSpec(const SyntheticSpecOptions &options)
+{
+    Draw draw(options.seed);
+
+    /* ---------- globals and initializations ---------- */
+
+    vector<unique_ptr<Decl>> globals;
+    vector<unique_ptr<Init>> init;
+    for (size_t g = 0; g < options.globals; g++)
+    {
+        globals.push_back(make_unique<Decl>(
+            global(g),
+            make_unique<MapType>(make_unique<TypeConst>("string"), make_unique<TypeConst>("string"))));
+
+        vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> entries;
+        for (size_t i = 0; i < options.initialMapSize; i++)
+        {
+            entries.emplace_back(
+                make_unique<Var>("seed" + to_string(g) + "_" + to_string(i)),
+                make_unique<String>("v" + to_string(i)));
+        }
+        init.push_back(make_unique<Init>(global(g), make_unique<Map>(std::move(entries))));
+    }
+
+    vector<unique_ptr<APIFuncDecl>> functions;
+
+    /* ---------- blocks ---------- */
+
+    vector<unique_ptr<API>> blocks;
+
+    // Every global gets a creating block, so every read can be satisfied
+    for (size_t g = 0; g < options.globals; g++)
+        blocks.push_back(creatingBlock(g, "create" + global(g) + "Ok"));
+
+    for (size_t b = options.globals; b < options.blocks; b++)
+    {
+        string suffix = to_string(b);
+        if (!draw.chance(options.dependencyRate))
+        {
+            size_t g = draw.below(options.globals);
+            blocks.push_back(creatingBlock(g, "create" + global(g) + "Ok" + suffix));
+            continue;
+        }
+
+        // Reads `terms` distinct globals, updates the first one
+        size_t terms = min(max<size_t>(options.preconditionTerms, 1), options.globals);
+        vector<size_t> reads;
+        while (reads.size() < terms)
+        {
+            size_t g = draw.below(options.globals);
+            bool seen = false;
+            for (size_t r : reads)
+                seen = seen || r == g;
+            if (!seen)
+                reads.push_back(g);
+        }
+
+        vector<unique_ptr<Expr>> pre;
+        vector<string> args;
+        for (size_t i = 0; i < reads.size(); i++)
+        {
+            size_t g = reads[i];
+            args.push_back(key(g));
+            // Alternate membership and value terms for variety
+            if (draw.below(2) == 0)
+                pre.push_back(inDom(key(g), var(global(g))));
+            else
+                pre.push_back(fn("=", fn("[]", var(global(g)), var(key(g))), var(value(g))));
+        }
+
+        size_t target = reads[0];
+        string newValue = "new" + value(target);
+        args.push_back(newValue);
+
+        vector<unique_ptr<Expr>> post;
+        post.push_back(fn("=", fn("[]", primed(target), var(key(target))), var(newValue)));
+        post.push_back(fn("=", var("_result"), make_unique<Num>(200)));
+
+        blocks.push_back(makeBlock(conj(std::move(pre)), "op" + suffix, args,
+                                   conj(std::move(post)),
+                                   "update" + global(target) + "Ok" + suffix));
+    }
+
+    return make_unique<Spec>(
+        std::move(globals),
+        std::move(init),
+        std::move(functions),
+        std::move(blocks));
+}
+
+/* =====================================================
+ * DEPENDENCIES AND SEQUENCES
+ * ===================================================== */
+
+static void collectEffects(const Expr *e, bool inPost, BlockEffects &effects)
+{
+    if (!e || e->exprType != ExprType::FUNCCALL)
+        return;
+    const FuncCall *fc = static_cast<const FuncCall *>(e);
+
+    // A "not in" precondition asks for absence, not for a prior write
+    if (fc->name == "not_in")
+        return;
+
+    if (fc->name == "'" && fc->args.size() == 1 && fc->args[0]->exprType == ExprType::VAR)
+    {
+        effects.writes.insert(static_cast<const Var *>(fc->args[0].get())->name);
+        return;
+    }
+    if (!inPost)
+    {
+        const Expr *map = nullptr;
+        if (fc->name == "dom" && fc->args.size() == 1)
+            map = fc->args[0].get();
+        else if (fc->name == "[]" && fc->args.size() == 2)
+            map = fc->args[0].get();
+        if (map && map->exprType == ExprType::VAR)
+            effects.reads.insert(static_cast<const Var *>(map)->name);
+    }
+    for (const auto &arg : fc->args)
+        collectEffects(arg.get(), inPost, effects);
+}
+
+BlockEffects blockEffects(const API &block)
+{
+    BlockEffects effects;
+    collectEffects(block.pre.get(), false, effects);
+    collectEffects(block.response.ResponseExpr.get(), true, effects);
+    return effects;
+}
+
+std::vector<std::vector<std::string>> makeSyntheticSequences(
+    const Spec &spec, size_t count, size_t depth, unsigned seed)
+{
+    if (spec.blocks.empty())
+        throw runtime_error("makeSyntheticSequences: spec has no blocks");
+
+    vector<BlockEffects> effects;
+    for (const auto &block : spec.blocks)
+        effects.push_back(blockEffects(*block));
+
+    Draw draw(seed);
+    vector<vector<string>> sequences;
+    for (size_t s = 0; s < count; s++)
+    {
+        set<string> populated;
+        vector<string> sequence;
+        for (size_t d = 0; d < depth; d++)
+        {
+            vector<size_t> ready;
+            for (size_t b = 0; b < spec.blocks.size(); b++)
+            {
+                bool ok = true;
+                for (const auto &g : effects[b].reads)
+                    ok = ok && populated.count(g);
+                if (ok)
+                    ready.push_back(b);
+            }
+            // Specs where nothing is ready up front still get a sequence
+            size_t b = ready.empty() ? draw.below(spec.blocks.size()) : ready[draw.below(ready.size())];
+            sequence.push_back(spec.blocks[b]->name);
+            populated.insert(effects[b].writes.begin(), effects[b].writes.end());
+        }
+        sequences.push_back(std::move(sequence));
+    }
+    return sequences;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "../ast.hh"
+
+// Random but well-formed specs for scaling experiments. The same options
+// (including the seed) always produce the same spec.
+//
+// Globals G0..Gn-1 are map<string, string>. The first n blocks create an
+// entry in one global each (pre: key not_in dom(G), post: _result in
+// dom(G')); the rest either create as well or, with probability
+// `dependencyRate`, read `preconditionTerms` globals (pre: AND of
+// key in dom(G) / G[key] = value terms) and update one of them.
+struct SyntheticSpecOptions
+{
+    size_t globals = 10;
+    size_t blocks = 20;
+    size_t preconditionTerms = 2;   // conjuncts in a reading block's precondition
+    size_t initialMapSize = 0;      // entries in each global's initial map
+    double dependencyRate = 0.5;    // share of non-creating blocks that read other globals
+    unsigned seed = 1;
+};
+
+// "globals=100,blocks=500,terms=3,mapsize=4,deps=0.7,seed=9"; unset keys keep their defaults
+SyntheticSpecOptions parseSyntheticSpecOptions(const std::string& text);
+std::string describeSyntheticSpecOptions(const SyntheticSpecOptions& options);
+
+std::unique_ptr<Spec> makeSyntheticSpec(const SyntheticSpecOptions& options);
+
+// Globals a block needs populated (key in dom(G) in its precondition) and
+// the globals it writes (G' in its postcondition). Works for any spec.
+struct BlockEffects
+{
+    std::set<std::string> reads;
+    std::set<std::string> writes;
+};
+BlockEffects blockEffects(const API& block);
+
+// `count` sequences of `depth` blocks in which every block's reads were
+// written by an earlier block, drawn deterministically from `seed`
+std::vector<std::vector<std::string>> makeSyntheticSequences(
+    const Spec& spec, size_t count, size_t depth, unsigned seed = 1);
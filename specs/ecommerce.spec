@@ -0,0 +1,156 @@
+# Ecommerce spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/EcommerceSpec.cpp: test_libapplication spec dump ecommerce specs/ecommerce.spec
+
+global U : map<string, string>
+global T : map<string, string>
+global Roles : map<string, Role>
+global P : map<string, string>
+global Stock : map<string, string>
+global Sellers : map<string, string>
+global C : map<string, string>
+global O : map<string, string>
+global OrderStatus : map<string, OrderStatus>
+global Rev : map<string, string>
+
+init U = {}
+init T = {}
+init Roles = {}
+init P = {}
+init Stock = {}
+init Sellers = {}
+init C = {}
+init O = {}
+init OrderStatus = {}
+init Rev = {}
+
+block registerBuyerOk {
+    pre  buyerEmail not_in dom(U)
+    call registerBuyer(buyerEmail, buyerPassword, buyerFullName)
+    post `AND`(U'[buyerEmail] = buyerPassword, Roles'[buyerEmail] = BUYER, _result = 201)
+}
+
+block loginBuyerOk {
+    pre  `AND`(buyerEmail in dom(U), U[buyerEmail] = buyerPassword, Roles[buyerEmail] = BUYER)
+    call login(buyerEmail, buyerPassword)
+    post T'[buyerEmail] = _result
+}
+
+block getAllProductsOk {
+    pre  1
+    call getAllProducts()
+    post 1
+}
+
+block getProductByIdOk {
+    pre  productId in dom(P)
+    call getProductById(productId)
+    post 1
+}
+
+block addToCartOk {
+    pre  `AND`(buyerEmail in dom(T), Roles[buyerEmail] = BUYER, productId in dom(P))
+    call addToCart(buyerEmail, productId, quantity)
+    post buyerEmail in dom(C')
+}
+
+block getCartOk {
+    pre  buyerEmail in dom(T) AND Roles[buyerEmail] = BUYER
+    call getCart(buyerEmail)
+    post 1
+}
+
+block updateCartOk {
+    pre  `AND`(buyerEmail in dom(T), Roles[buyerEmail] = BUYER, buyerEmail in dom(C))
+    call updateCart(buyerEmail, productId, quantity)
+    post 1
+}
+
+block createOrderOk {
+    pre  `AND`(buyerEmail in dom(T), Roles[buyerEmail] = BUYER, buyerEmail in dom(C))
+    call createOrder(buyerEmail, shippingAddress, paymentMethod)
+    post `AND`(_result in dom(O'), OrderStatus'[_result] = PENDING, buyerEmail not_in dom(C'))
+}
+
+block getBuyerOrdersOk {
+    pre  buyerEmail in dom(T) AND Roles[buyerEmail] = BUYER
+    call getBuyerOrders(buyerEmail)
+    post 1
+}
+
+block createReviewOk {
+    pre  `AND`(buyerEmail in dom(T), Roles[buyerEmail] = BUYER, orderId in dom(O), O[orderId] = buyerEmail)
+    call createReview(buyerEmail, productId, orderId, rating, comment)
+    post _result in dom(Rev')
+}
+
+block getProductReviewsOk {
+    pre  productId in dom(P)
+    call getProductReviews(productId)
+    post 1
+}
+
+block registerSellerOk {
+    pre  sellerEmail not_in dom(U)
+    call registerSeller(sellerEmail, sellerPassword, sellerFullName, storeName, storeDescription)
+    post U'[sellerEmail] = sellerPassword AND Roles'[sellerEmail] = SELLER
+}
+
+block loginSellerOk {
+    pre  `AND`(sellerEmail in dom(U), U[sellerEmail] = sellerPassword, Roles[sellerEmail] = SELLER)
+    call login(sellerEmail, sellerPassword)
+    post T'[sellerEmail] = _result
+}
+
+block createProductOk {
+    pre  sellerEmail in dom(T) AND Roles[sellerEmail] = SELLER
+    call createProduct(sellerEmail, title, description, category, price, quantity)
+    post _result in dom(P') AND Sellers'[_result] = sellerEmail
+}
+
+block updateProductOk {
+    pre  `AND`(sellerEmail in dom(T), Roles[sellerEmail] = SELLER, productId in dom(P), Sellers[productId] = sellerEmail)
+    call updateProduct(sellerEmail, productId, title, description, category, price, quantity)
+    post 1
+}
+
+block deleteProductOk {
+    pre  `AND`(sellerEmail in dom(T), Roles[sellerEmail] = SELLER, Sellers[productId] = sellerEmail)
+    call deleteProduct(sellerEmail, productId)
+    post productId not_in dom(P')
+}
+
+block getSellerProductsOk {
+    pre  sellerEmail in dom(T) AND Roles[sellerEmail] = SELLER
+    call getSellerProducts(sellerEmail)
+    post 1
+}
+
+block getSellerOrdersOk {
+    pre  sellerEmail in dom(T) AND Roles[sellerEmail] = SELLER
+    call getSellerOrders(sellerEmail)
+    post 1
+}
+
+block updateOrderStatusOk {
+    pre  `AND`(sellerEmail in dom(T), Roles[sellerEmail] = SELLER, orderId in dom(O))
+    call updateOrderStatus(sellerEmail, orderId, status)
+    post OrderStatus'[orderId] = status
+}
+
+block checkOrderTotalOk {
+    pre  orderId in dom(O)
+    call checkOrderTotal(orderId)
+    post _result = 1
+}
+
+block addToCartMaxStockOk {
+    pre  `AND`(buyerEmail in dom(T), productId in dom(P), Roles[buyerEmail] = BUYER)
+    call addToCartMaxStock(buyerEmail, productId)
+    post _result = 200
+}
+
+block deleteProductByBuyerErr {
+    pre  `AND`(buyerEmail in dom(T), productId in dom(P), Roles[buyerEmail] = BUYER)
+    call deleteProductByBuyer(buyerEmail, productId)
+    post _result = 404
+}
@@ -0,0 +1,106 @@
+# GhostSocket spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/GhostSocketSpec.cpp: test_libapplication spec dump ghostsocket specs/ghostsocket.spec
+
+global U : map<string, string>
+global D : map<string, string>
+global S : map<string, string>
+
+init U = {}
+init D = {}
+init S = {}
+
+block registerUserOk {
+    pre  userEmail not_in dom(U)
+    call registerUser(userEmail)
+    post userEmail in dom(U')
+}
+
+block registerUser2Ok {
+    pre  user2Email not_in dom(U)
+    call registerUser(user2Email)
+    post user2Email in dom(U')
+}
+
+block registerDeviceOk {
+    pre  userEmail in dom(U)
+    call registerDevice(userEmail, devId)
+    post devId in dom(D')
+}
+
+block getMyDevicesOk {
+    pre  userEmail in dom(U)
+    call getMyDevices(userEmail)
+    post 1
+}
+
+block getOtherDevicesOk {
+    pre  user2Email in dom(U)
+    call getOtherDevices(user2Email)
+    post 1
+}
+
+block getDeviceInfoOk {
+    pre  devId in dom(D)
+    call getDeviceInfo(userEmail, devId)
+    post 1
+}
+
+block getDeviceInfoForbiddenErr {
+    pre  devId not_in dom(D)
+    call getDeviceInfo(userEmail, devId)
+    post 1
+}
+
+block deleteDeviceOk {
+    pre  devId in dom(D)
+    call deleteDevice(userEmail, devId)
+    post 1
+}
+
+block createSessionOk {
+    pre  devId in dom(D)
+    call createSession(userEmail, devId)
+    post sessId in dom(S')
+}
+
+block createSessionForbiddenErr {
+    pre  devId not_in dom(D)
+    call createSession(userEmail, devId)
+    post 1
+}
+
+block joinSessionOk {
+    pre  sessId in dom(S)
+    call joinSession(user2Email, sessId)
+    post 1
+}
+
+block joinSessionNotFoundErr {
+    pre  sessId not_in dom(S)
+    call joinSession(userEmail, sessId)
+    post 1
+}
+
+block getSessionsOk {
+    pre  userEmail in dom(U)
+    call getSessions(userEmail)
+    post 1
+}
+
+block terminateSessionOk {
+    pre  sessId in dom(S)
+    call terminateSession(userEmail, sessId)
+    post 1
+}
+
+block terminateSessionForbiddenErr {
+    pre  sessId not_in dom(S)
+    call terminateSession(userEmail, sessId)
+    post 1
+}
+
+block updatePermissionsOk {
+    pre  sessId in dom(S)
+    call updatePermissions(userEmail, sessId)
+    post 1
+}
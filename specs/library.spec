@@ -0,0 +1,138 @@
+# Library spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/LibrarySpec.cpp: test_libapplication spec dump library specs/library.spec
+
+global B : map<string, string>
+global S : map<string, string>
+global Req : map<string, string>
+global Loans : map<string, string>
+
+init B = {}
+init S = {}
+init Req = {}
+init Loans = {}
+
+block getAllBooksOk {
+    pre  1
+    call getAllBooks()
+    post 1
+}
+
+block getBookByCodeOk {
+    pre  bookCode in dom(B)
+    call getBookByCode(bookCode)
+    post 1
+}
+
+block getBookByCodeErr {
+    pre  bookCode not_in dom(B)
+    call getBookByCode(bookCode)
+    post 1
+}
+
+block saveBookOk {
+    pre  1
+    call saveBook(bookTitle, bookAuthor, bookDesc)
+    post _result in dom(B')
+}
+
+block updateBookOk {
+    pre  bookCode in dom(B)
+    call updateBook(bookCode, bookTitle, bookAuthor, bookDesc)
+    post bookCode in dom(B')
+}
+
+block deleteBookOk {
+    pre  bookCode in dom(B)
+    call deleteBook(bookCode)
+    post bookCode not_in dom(B')
+}
+
+block getAllStudentsOk {
+    pre  1
+    call getAllStudents()
+    post 1
+}
+
+block getStudentByIdOk {
+    pre  studentId in dom(S)
+    call getStudentById(studentId)
+    post 1
+}
+
+block getStudentByIdErr {
+    pre  studentId not_in dom(S)
+    call getStudentById(studentId)
+    post 1
+}
+
+block saveStudentOk {
+    pre  1
+    call saveStudent(studentName, studentEmail, studentPhone)
+    post _result in dom(S')
+}
+
+block updateStudentOk {
+    pre  studentId in dom(S)
+    call updateStudent(studentId, studentName, studentEmail, studentPhone)
+    post studentId in dom(S')
+}
+
+block deleteStudentOk {
+    pre  studentId in dom(S)
+    call deleteStudent(studentId)
+    post studentId not_in dom(S')
+}
+
+block getAllRequestsOk {
+    pre  1
+    call getAllRequests()
+    post 1
+}
+
+block getRequestByIdOk {
+    pre  requestId in dom(Req)
+    call getRequestById(requestId)
+    post 1
+}
+
+block saveRequestOk {
+    pre  studentId in dom(S) AND bookCode in dom(B)
+    call saveRequest(studentId, bookCode, startDate, endDate)
+    post _result in dom(Req')
+}
+
+block deleteRequestOk {
+    pre  requestId in dom(Req)
+    call deleteRequest(requestId)
+    post requestId not_in dom(Req')
+}
+
+block getAllLoansOk {
+    pre  1
+    call getAllLoans()
+    post 1
+}
+
+block getLoanByIdOk {
+    pre  loanId in dom(Loans)
+    call getLoanById(loanId)
+    post 1
+}
+
+block acceptRequestOk {
+    pre  requestId in dom(Req)
+    call acceptRequest(requestId)
+    post _result in dom(Loans') AND requestId not_in dom(Req')
+}
+
+block returnBookOk {
+    pre  loanId in dom(Loans)
+    call returnBook(loanId)
+    post loanId not_in dom(Loans')
+}
+
+block saveLoanOk {
+    pre  studentId in dom(S) AND bookCode in dom(B)
+    call saveLoan(studentId, bookCode, startDate, endDate)
+    post _result in dom(Loans')
+}
@@ -0,0 +1,156 @@
+# Restaurant spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/RestaurantSpec.cpp: test_libapplication spec dump restaurant specs/restaurant.spec
+
+global U : map<string, string>
+global T : map<string, string>
+global Roles : map<string, Role>
+global C : map<string, string>
+global R : map<string, string>
+global M : map<string, string>
+global Owners : map<string, string>
+global O : map<string, string>
+global Assignments : map<string, string>
+global Rev : map<string, string>
+
+init U = {}
+init T = {}
+init Roles = {}
+init C = {}
+init R = {}
+init M = {}
+init Owners = {}
+init O = {}
+init Assignments = {}
+init Rev = {}
+
+block loginWrongPasswordErr {
+    pre  customerEmail in dom(U) AND U[customerEmail] != wrongPassword
+    call login(customerEmail, wrongPassword)
+    post 1
+}
+
+block loginCustomerErr {
+    pre  customerEmail not_in dom(U)
+    call login(customerEmail, customerPassword)
+    post 1
+}
+
+block registerCustomerOk {
+    pre  customerEmail not_in dom(U)
+    call registerCustomer(customerEmail, customerPassword, customerFullName, customerMobile)
+    post `AND`(U'[customerEmail] = customerPassword, Roles'[customerEmail] = CUSTOMER, _result = 201)
+}
+
+block loginCustomerOk {
+    pre  customerEmail in dom(U) AND U[customerEmail] = customerPassword
+    call login(customerEmail, customerPassword)
+    post T'[customerEmail] = _result
+}
+
+block browseRestaurantsOk {
+    pre  customerEmail in dom(T)
+    call browseRestaurants(customerEmail)
+    post 1
+}
+
+block viewMenuOk {
+    pre  customerEmail in dom(T) AND restaurantId in dom(R)
+    call viewMenu(customerEmail, restaurantId)
+    post 1
+}
+
+block addToCartRestaurantOk {
+    pre  customerEmail in dom(T) AND menuItemId in dom(M)
+    call addToCart(customerEmail, menuItemId, quantity)
+    post customerEmail in dom(C')
+}
+
+block placeOrderOk {
+    pre  customerEmail in dom(T) AND customerEmail in dom(C)
+    call placeOrder(customerEmail, deliveryAddress, paymentMethod)
+    post _result in dom(O') AND customerEmail not_in dom(C')
+}
+
+block leaveReviewOk {
+    pre  customerEmail in dom(T) AND orderId in dom(O)
+    call leaveReview(customerEmail, orderId, restaurantRating, deliveryRating, reviewComment)
+    post _result in dom(Rev')
+}
+
+block registerOwnerOk {
+    pre  ownerEmail not_in dom(U)
+    call registerOwner(ownerEmail, ownerPassword, ownerFullName, ownerMobile)
+    post `AND`(U'[ownerEmail] = ownerPassword, Roles'[ownerEmail] = OWNER, _result = 201)
+}
+
+block loginOwnerOk {
+    pre  ownerEmail in dom(U) AND U[ownerEmail] = ownerPassword
+    call login(ownerEmail, ownerPassword)
+    post T'[ownerEmail] = _result
+}
+
+block createRestaurantOk {
+    pre  ownerEmail in dom(T) AND Roles[ownerEmail] = OWNER
+    call createRestaurant(ownerEmail, restaurantName, restaurantAddress, restaurantContact)
+    post _result in dom(R') AND Owners'[_result] = ownerEmail
+}
+
+block createRestaurantCustomerErr {
+    pre  customerEmail in dom(T) AND Roles[customerEmail] = OWNER
+    call createRestaurant(customerEmail, restaurantName, restaurantAddress, restaurantContact)
+    post 1
+}
+
+block addMenuItemOk {
+    pre  `AND`(ownerEmail in dom(T), Roles[ownerEmail] = OWNER, restaurantId in dom(R))
+    call addMenuItem(ownerEmail, restaurantId, itemName, itemPrice)
+    post _result in dom(M')
+}
+
+block assignOrderOk {
+    pre  `AND`(ownerEmail in dom(T), Roles[ownerEmail] = OWNER, orderId in dom(O), agentEmail in dom(U), Roles[agentEmail] = AGENT)
+    call assignOrder(ownerEmail, orderId, agentEmail)
+    post Assignments'[orderId] = agentEmail
+}
+
+block updateOrderStatusOwnerOk {
+    pre  `AND`(ownerEmail in dom(T), Roles[ownerEmail] = OWNER, orderId in dom(O))
+    call updateOrderStatusOwner(ownerEmail, orderId, orderStatus)
+    post 1
+}
+
+block registerAgentOk {
+    pre  agentEmail not_in dom(U)
+    call registerAgent(agentEmail, agentPassword, agentFullName, agentMobile)
+    post U'[agentEmail] = agentPassword AND Roles'[agentEmail] = AGENT
+}
+
+block loginAgentOk {
+    pre  agentEmail in dom(U) AND U[agentEmail] = agentPassword
+    call login(agentEmail, agentPassword)
+    post T'[agentEmail] = _result
+}
+
+block updateOrderStatusAgentOk {
+    pre  `AND`(agentEmail in dom(T), Roles[agentEmail] = AGENT, orderId in dom(Assignments), Assignments[orderId] = agentEmail)
+    call updateOrderStatusAgent(agentEmail, orderId, orderStatus)
+    post 1
+}
+
+block checkOrderAmountOk {
+    pre  orderId in dom(O)
+    call checkOrderAmount(orderId)
+    post _result = 1
+}
+
+block checkCartTotalOk {
+    pre  customerEmail in dom(C)
+    call checkCartTotal(customerEmail)
+    post _result = 1
+}
+
+block addToCartQuantityZeroErr {
+    pre  customerEmail in dom(T) AND menuItemId in dom(M)
+    call addToCartQuantityZero(customerEmail, menuItemId)
+    post _result = 400
+}
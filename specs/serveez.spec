@@ -0,0 +1,112 @@
+# Serveez spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/ServeezSpec.cpp: test_libapplication spec dump serveez specs/serveez.spec
+
+global U : map<string, string>
+global P : map<string, string>
+global A : map<string, string>
+global C : map<string, string>
+global L : map<string, string>
+global B : map<string, string>
+
+init U = {}
+init P = {}
+init A = {}
+init C = {}
+init L = {}
+init B = {}
+
+block registerUserOk {
+    pre  userEmail not_in dom(U)
+    call registerUser(userEmail)
+    post userEmail in dom(U')
+}
+
+block registerProviderOk {
+    pre  provEmail not_in dom(P)
+    call registerProvider(provEmail)
+    post provEmail in dom(P')
+}
+
+block registerAdminOk {
+    pre  adminEmail not_in dom(A)
+    call registerAdmin(adminEmail)
+    post adminEmail in dom(A')
+}
+
+block createCategoryOk {
+    pre  adminEmail in dom(A)
+    call createCategory(adminEmail, catName)
+    post catId in dom(C')
+}
+
+block createListingOk {
+    pre  catId in dom(C)
+    call createListing(provEmail, catId, listingTitle)
+    post listingId in dom(L')
+}
+
+block getListingsOk {
+    pre  listingId in dom(L)
+    call getListings()
+    post 1
+}
+
+block getListingByIdOk {
+    pre  listingId in dom(L)
+    call getListingById(listingId)
+    post 1
+}
+
+block createBookingOk {
+    pre  listingId in dom(L)
+    call createBooking(userEmail, listingId)
+    post bookingId in dom(B')
+}
+
+block getMyBookingsOk {
+    pre  bookingId in dom(B)
+    call getMyBookings(userEmail)
+    post 1
+}
+
+block confirmBookingOk {
+    pre  bookingId in dom(B)
+    call confirmBooking(provEmail, bookingId)
+    post 1
+}
+
+block completeBookingOk {
+    pre  bookingId in dom(B)
+    call completeBooking(provEmail, bookingId)
+    post 1
+}
+
+block cancelBookingOk {
+    pre  bookingId in dom(B)
+    call cancelBooking(userEmail, bookingId)
+    post 1
+}
+
+block svzCreateReviewOk {
+    pre  bookingId in dom(B)
+    call createReview(userEmail, bookingId)
+    post 1
+}
+
+block getListingReviewsOk {
+    pre  listingId in dom(L)
+    call getListingReviews(listingId)
+    post 1
+}
+
+block createListingUnauthErr {
+    pre  catId in dom(C)
+    call createListingUnauth(catId, listingTitle)
+    post 1
+}
+
+block createBookingAsProviderErr {
+    pre  listingId in dom(L)
+    call createBookingAsProvider(provEmail, listingId)
+    post 1
+}
@@ -0,0 +1,160 @@
+# TripVault spec in the textual format (specparser.hh), for --spec and the spec tool.
+# Regenerate after changing specs/TripVaultSpec.cpp: test_libapplication spec dump tripvault specs/tripvault.spec
+
+global U : map<string, string>
+global T : map<string, string>
+global Trips : map<string, string>
+global Members : map<string, string>
+global E : map<string, string>
+global Proposals : map<string, string>
+
+init U = {}
+init T = {}
+init Trips = {}
+init Members = {}
+init E = {}
+init Proposals = {}
+
+block registerUserOk {
+    pre  userEmail not_in dom(U)
+    call registerUser(userEmail, userPassword)
+    post userEmail in dom(U')
+}
+
+block registerUserDuplicateErr {
+    pre  userEmail in dom(U)
+    call registerUser(userEmail, userPassword)
+    post 1
+}
+
+block loginUserOk {
+    pre  userEmail in dom(U)
+    call loginUser(userEmail)
+    post userEmail in dom(T')
+}
+
+block loginUserNotFoundErr {
+    pre  userEmail not_in dom(U)
+    call loginUser(userEmail)
+    post 1
+}
+
+block createTripOk {
+    pre  userEmail in dom(T)
+    call createTrip(userEmail, tripName, destination)
+    post tripId in dom(Trips')
+}
+
+block createTripUnauthErr {
+    pre  userEmail not_in dom(T)
+    call createTrip(userEmail, tripName, destination)
+    post 1
+}
+
+block getUserTripsOk {
+    pre  userEmail in dom(T)
+    call getUserTrips(userEmail)
+    post 1
+}
+
+block updateTripAdminOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call updateTrip(userEmail, tripId, tripName)
+    post 1
+}
+
+block deleteTripOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call deleteTrip(userEmail, tripId)
+    post tripId not_in dom(Trips')
+}
+
+block deleteTripForbiddenErr {
+    pre  tripId in dom(Trips) AND userEmail not_in dom(T)
+    call deleteTrip(userEmail, tripId)
+    post 1
+}
+
+block addMemberOk {
+    pre  `AND`(adminEmail in dom(T), tripId in dom(Trips), memberEmail in dom(U))
+    call addMember(adminEmail, tripId, memberEmail)
+    post 1
+}
+
+block addMemberForbiddenErr {
+    pre  tripId in dom(Trips) AND adminEmail not_in dom(T)
+    call addMember(adminEmail, tripId, memberEmail)
+    post 1
+}
+
+block joinByInviteOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call joinByInvite(userEmail, tripId)
+    post 1
+}
+
+block createExpenseOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call createExpense(userEmail, tripId, expenseTitle, amount, category)
+    post expenseId in dom(E')
+}
+
+block createExpenseForbiddenErr {
+    pre  userEmail not_in dom(T) AND tripId in dom(Trips)
+    call createExpense(userEmail, tripId, expenseTitle, amount, category)
+    post 1
+}
+
+block getExpensesOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call getExpenses(userEmail, tripId)
+    post 1
+}
+
+block deleteExpenseOk {
+    pre  userEmail in dom(T) AND expenseId in dom(E)
+    call deleteExpense(userEmail, expenseId)
+    post expenseId not_in dom(E')
+}
+
+block deleteExpenseForbiddenErr {
+    pre  userEmail not_in dom(T) AND expenseId in dom(E)
+    call deleteExpense(userEmail, expenseId)
+    post 1
+}
+
+block createProposalOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call createProposal(userEmail, tripId, proposalTitle, proposalType)
+    post proposalId in dom(Proposals')
+}
+
+block getProposalsOk {
+    pre  userEmail in dom(T) AND tripId in dom(Trips)
+    call getProposals(userEmail, tripId)
+    post 1
+}
+
+block deleteProposalOk {
+    pre  userEmail in dom(T) AND proposalId in dom(Proposals)
+    call deleteProposal(userEmail, proposalId)
+    post proposalId not_in dom(Proposals')
+}
+
+block deleteProposalForbiddenErr {
+    pre  userEmail not_in dom(T) AND proposalId in dom(Proposals)
+    call deleteProposal(userEmail, proposalId)
+    post 1
+}
+
+block registerUser2Ok {
+    pre  user2Email not_in dom(U)
+    call registerUser(user2Email, user2Password)
+    post user2Email in dom(U')
+}
+
+block loginUser2Ok {
+    pre  user2Email in dom(U)
+    call loginUser(user2Email)
+    post user2Email in dom(T')
+}
@@ -0,0 +1,104 @@
+#include "suiteselection.hh"
+#include "batch.hh"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+namespace {
+
+struct Deferred {
+    size_t rank;
+    size_t arrival;
+    string name;
+    function<void()> run;
+};
+
+// State of the process's one suite run; executors call in from a single thread
+ofstream recorder;
+bool filtering = false;         // --minimized: unranked tests are skipped
+bool reordering = false;
+bool replaying = false;
+string planName;
+map<string, size_t> ranks;      // sequence key -> position in the plan
+vector<Deferred> deferred;
+
+string keyOf(const vector<string> &sequence)
+{
+    return batchSequenceKey("", sequence);
+}
+
+} // namespace
+
+void SuiteSelection::record(const string &path)
+{
+    recorder.open(path);
+    if (!recorder)
+        throw runtime_error("Cannot write suite file: " + path);
+}
+
+void SuiteSelection::load(const string &path, const string &app, const string &plan)
+{
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Cannot read selection: " + path);
+    json doc = json::parse(in);
+    const json &apps = doc.value("apps", json::object());
+    if (!apps.contains(app) || !apps[app].contains(plan))
+        throw runtime_error(path + " has no " + plan + " plan for " + app);
+
+    ranks.clear();
+    for (const auto &entry : apps[app][plan])
+        ranks.emplace(keyOf(entry["sequence"].get<vector<string>>()), ranks.size());
+    filtering = plan == "minimized";
+    reordering = true;
+    planName = plan;
+    cout << "[Suite] " << app << ": " << plan << " plan of " << ranks.size()
+         << " sequences from " << path << endl;
+}
+
+bool SuiteSelection::intercept(const string &name, const vector<string> &sequence, function<void()> run)
+{
+    if (recorder.is_open()) {
+        recorder << "# " << name << "\n" << json(sequence).dump() << "\n";
+        return true;
+    }
+    if (!reordering || replaying)
+        return false;
+
+    auto it = ranks.find(keyOf(sequence));
+    if (it == ranks.end() && filtering) {
+        cout << "[Suite] Skipping " << name << " (not in the minimized suite)" << endl;
+        return true;
+    }
+    // Tests the plan does not rank keep their suite order, after the rest
+    size_t rank = it == ranks.end() ? ranks.size() : it->second;
+    deferred.push_back({rank, deferred.size(), name, move(run)});
+    return true;
+}
+
+void SuiteSelection::flush()
+{
+    if (recorder.is_open())
+        recorder.flush();
+    if (deferred.empty())
+        return;
+
+    vector<Deferred> queue;
+    queue.swap(deferred);
+    sort(queue.begin(), queue.end(), [](const Deferred &a, const Deferred &b) {
+        return a.rank != b.rank ? a.rank < b.rank : a.arrival < b.arrival;
+    });
+    cout << "[Suite] Running " << queue.size() << " tests in " << planName << " order" << endl;
+
+    replaying = true;
+    for (auto &test : queue)
+        test.run();
+    replaying = false;
+}
@@ -0,0 +1,33 @@
+#ifndef SUITESELECTION_HH
+#define SUITESELECTION_HH
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * SuiteSelection - record, reduce or reorder the built-in test suites
+ *
+ *   --record-suite FILE       write every test as a "# name" line plus its
+ *                             JSON sequence (the batch/mutate input format)
+ *                             instead of running it
+ *   --minimized SELECTION     run only the app's minimized sequences
+ *   --prioritized SELECTION   run the whole suite in prioritized order
+ *
+ * SELECTION is written by `mutate minimize`. Executors call intercept()
+ * first thing in runTest; tests held back for reordering run at flush().
+ */
+class SuiteSelection {
+public:
+    static void record(const string &path);
+    // plan: "minimized" or "prioritized"
+    static void load(const string &path, const string &app, const string &plan);
+
+    // True when the executor must not run the test now
+    static bool intercept(const string &name, const vector<string> &sequence, function<void()> run);
+    static void flush();
+};
+
+#endif
@@ -11,6 +11,7 @@ class SymVar : public Expr {
         static unsigned int count;
         unsigned int num;
     public:
+        static bool classof(const Expr &n) { return n.exprType == ExprType::SYMVAR; }
         SymVar(unsigned int);
         static unique_ptr<SymVar>getNewSymVar();
         virtual void accept(ASTVisitor&);
@@ -2,6 +2,10 @@
 #include <memory>
 #include <map>
 #include <functional>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
 #include "ast.hh"
 #include "printvisitor.hh"
 #include "algo.hpp"
@@ -16,12 +20,16 @@
 #include "see/see.hh"
 
 // Import webapp-specific specs
-#include "specs/RestaurantSpec.hpp"
-#include "specs/EcommerceSpec.hpp"
-#include "specs/LibrarySpec.hpp"
-#include "specs/TripVaultSpec.hpp"
-#include "specs/GhostSocketSpec.hpp"
-#include "specs/ServeezSpec.hpp"
+#include "specs/SharedSpecs.hpp"
+#include "specs/SyntheticSpec.hpp"
+#include "specparser.hh"
+#include "specbinary.hh"
+#include "daemon.hh"
+#include "batch.hh"
+#include "mutation.hh"
+#include "suiteselection.hh"
+#include "trace.hh"
+#include "metrics.hh"
 
 using namespace std;
 
@@ -36,6 +44,23 @@ enum class TestMode
     FULL_PIPELINE // Complete: genATC + Rewrite + SEE + Backend
 };
 
+// ============================================
+// SPEC OVERRIDE
+// ============================================
+
+// --spec FILE: run the suite against a textual or precompiled spec instead
+// of the built-in make*Spec() builder (sequences still name its blocks)
+static string specOverridePath;
+
+static shared_ptr<const Spec> applySpecOverride(shared_ptr<const Spec> builtin)
+{
+    if (specOverridePath.empty())
+        return builtin;
+    // Loaded once and shared, like the built-in specs
+    static const shared_ptr<const Spec> loaded = loadSpecFile(specOverridePath);
+    return loaded;
+}
+
 // ============================================
 // TEST EXECUTOR LIBRARY
 // ============================================
@@ -52,9 +77,13 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        // --record-suite / --minimized / --prioritized (see suiteselection.hh)
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
@@ -62,18 +91,20 @@ public:
         cout << "========================================\n"
              << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n"
@@ -115,29 +146,30 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<Library::LibraryFunctionFactory>(backendUrl);
         Tester tester(factory.get());
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<Library::LibraryFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("library"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -180,9 +212,12 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
@@ -190,18 +225,20 @@ public:
         cout << "========================================\n"
              << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n"
@@ -244,29 +281,30 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<RestaurantFunctionFactory>(backendUrl);
         Tester tester(factory.get());
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<RestaurantFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("restaurant"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -309,9 +347,12 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
@@ -319,18 +360,20 @@ public:
         cout << "========================================\n"
              << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n"
@@ -372,29 +415,30 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<Ecommerce::EcommerceFunctionFactory>(backendUrl);
         Tester tester(factory.get());
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<Ecommerce::EcommerceFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("ecommerce"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -437,27 +481,32 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
         cout << "DEPTH: " << testSequence.size() << " API calls" << endl;
         cout << "========================================\n" << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n" << endl;
@@ -492,28 +541,29 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<TripVault::TripVaultFunctionFactory>(backendUrl);
         Tester tester(factory.get());
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<TripVault::TripVaultFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("tripvault"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -551,7 +601,7 @@ namespace TripVaultTests
 void test01_registerLogin(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 01: Register → Login (Depth=2)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk"});
 }
 
@@ -559,7 +609,7 @@ void test01_registerLogin(TripVaultTestExecutor &executor)
 void test02_createTrip(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 02: Register → Login → Create Trip (Depth=3)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk"});
 }
 
@@ -567,7 +617,7 @@ void test02_createTrip(TripVaultTestExecutor &executor)
 void test03_getUserTrips(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 03: Register → Login → Create Trip → Get Trips (Depth=4)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "getUserTripsOk"});
 }
 
@@ -575,7 +625,7 @@ void test03_getUserTrips(TripVaultTestExecutor &executor)
 void test04_updateTrip(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 04: Register → Login → Create Trip → Update Trip (Depth=4)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "updateTripAdminOk"});
 }
 
@@ -583,7 +633,7 @@ void test04_updateTrip(TripVaultTestExecutor &executor)
 void test05_deleteTrip(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 05: Register → Login → Create Trip → Delete Trip (Depth=4)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "deleteTripOk"});
 }
 
@@ -591,7 +641,7 @@ void test05_deleteTrip(TripVaultTestExecutor &executor)
 void test06_addMember(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 06: Two Users → Create Trip → Add Member (Depth=6)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "registerUser2Ok", "loginUser2Ok", "addMemberOk"});
 }
@@ -600,7 +650,7 @@ void test06_addMember(TripVaultTestExecutor &executor)
 void test07_joinByInvite(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 07: Two Users → Create Trip → Join By Invite (Depth=6)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "registerUser2Ok", "loginUser2Ok", "joinByInviteOk"});
 }
@@ -609,7 +659,7 @@ void test07_joinByInvite(TripVaultTestExecutor &executor)
 void test08_createExpense(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 08: Register → Login → Create Trip → Create Expense (Depth=4)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createExpenseOk"});
 }
 
@@ -617,7 +667,7 @@ void test08_createExpense(TripVaultTestExecutor &executor)
 void test09_getExpenses(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 09: Create Trip → Create Expense → Get Expenses (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createExpenseOk", "getExpensesOk"});
 }
 
@@ -625,7 +675,7 @@ void test09_getExpenses(TripVaultTestExecutor &executor)
 void test10_deleteExpense(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 10: Create Trip → Create Expense → Delete Expense (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createExpenseOk", "deleteExpenseOk"});
 }
 
@@ -633,7 +683,7 @@ void test10_deleteExpense(TripVaultTestExecutor &executor)
 void test11_createProposal(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 11: Create Trip → Create Proposal (Depth=4)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createProposalOk"});
 }
 
@@ -641,7 +691,7 @@ void test11_createProposal(TripVaultTestExecutor &executor)
 void test12_getProposals(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 12: Create Trip → Create Proposal → Get Proposals (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createProposalOk", "getProposalsOk"});
 }
 
@@ -649,7 +699,7 @@ void test12_getProposals(TripVaultTestExecutor &executor)
 void test13_deleteProposal(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 13: Create Trip → Create Proposal → Delete Proposal (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createProposalOk", "deleteProposalOk"});
 }
 
@@ -657,7 +707,7 @@ void test13_deleteProposal(TripVaultTestExecutor &executor)
 void test14_multipleExpenses(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 14: Create Trip → Create 3 Expenses (Depth=6)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "createExpenseOk", "createExpenseOk", "createExpenseOk"});
 }
@@ -666,7 +716,7 @@ void test14_multipleExpenses(TripVaultTestExecutor &executor)
 void test15_multipleTrips(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 15: Register → Login → Create 2 Trips → Get Trips (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createTripOk", "getUserTripsOk"});
 }
 
@@ -674,7 +724,7 @@ void test15_multipleTrips(TripVaultTestExecutor &executor)
 void test16_expenseAndProposal(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 16: Create Trip → Create Expense → Create Proposal (Depth=5)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk", "createExpenseOk", "createProposalOk"});
 }
 
@@ -682,7 +732,7 @@ void test16_expenseAndProposal(TripVaultTestExecutor &executor)
 void test17_memberCreatesExpense(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 17: Two Users → Add Member → Create Expense (Depth=7)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "registerUser2Ok", "loginUser2Ok", "addMemberOk", "createExpenseOk"});
 }
@@ -691,7 +741,7 @@ void test17_memberCreatesExpense(TripVaultTestExecutor &executor)
 void test18_fullTripLifecycle(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 18: Full Lifecycle: Create→Expense→Proposal→Delete Both (Depth=7)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "createExpenseOk", "createProposalOk",
          "deleteExpenseOk", "deleteProposalOk"});
@@ -701,7 +751,7 @@ void test18_fullTripLifecycle(TripVaultTestExecutor &executor)
 void test19_joinAndCreateExpense(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 19: Multi-User Join → Create Expense (Depth=7)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "registerUser2Ok", "loginUser2Ok", "joinByInviteOk", "createExpenseOk"});
 }
@@ -710,7 +760,7 @@ void test19_joinAndCreateExpense(TripVaultTestExecutor &executor)
 void test20_deleteAndRecreateExpense(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 20: Create Expense → Delete → Re-create (Depth=6)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "createExpenseOk", "deleteExpenseOk", "createExpenseOk"});
 }
@@ -719,7 +769,7 @@ void test20_deleteAndRecreateExpense(TripVaultTestExecutor &executor)
 void test21_multipleProposals(TripVaultTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 21: Create Trip → Create 2 Proposals → Get All (Depth=6)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"registerUserOk", "loginUserOk", "createTripOk",
          "createProposalOk", "createProposalOk", "getProposalsOk"});
 }
@@ -728,7 +778,7 @@ void test21_multipleProposals(TripVaultTestExecutor &executor)
 void test22_loginWithoutRegister(TripVaultTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 22: Login Without Register (Depth=1)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"loginUserOk"});
 }
 
@@ -736,7 +786,7 @@ void test22_loginWithoutRegister(TripVaultTestExecutor &executor)
 void test23_createTripWithoutLogin(TripVaultTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 23: Create Trip Without Login (Depth=1)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"createTripOk"});
 }
 
@@ -744,7 +794,7 @@ void test23_createTripWithoutLogin(TripVaultTestExecutor &executor)
 void test24_deleteExpenseWithoutAuth(TripVaultTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 24: Delete Expense Without Auth (Depth=1)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"deleteExpenseOk"});
 }
 
@@ -752,7 +802,7 @@ void test24_deleteExpenseWithoutAuth(TripVaultTestExecutor &executor)
 void test25_deleteTripWithoutAuth(TripVaultTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 25: Delete Trip Without Login (Depth=1)",
-        makeTripVaultSpec(),
+        tripVaultSpec(),
         {"deleteTripOk"});
 }
 
@@ -774,27 +824,32 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
         cout << "DEPTH: " << testSequence.size() << " API calls" << endl;
         cout << "========================================\n" << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n" << endl;
@@ -829,28 +884,29 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<GhostSocket::GhostSocketFunctionFactory>(backendUrl);
         Tester tester(factory.get());
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<GhostSocket::GhostSocketFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("ghostsocket"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -888,7 +944,7 @@ namespace GhostSocketTests
 void test01_registerUser(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 01: Register User (Depth=1)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk"});
 }
 
@@ -896,7 +952,7 @@ void test01_registerUser(GhostSocketTestExecutor &executor)
 void test02_registerTwoUsers(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 02: Register Two Users (Depth=2)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerUser2Ok"});
 }
 
@@ -904,7 +960,7 @@ void test02_registerTwoUsers(GhostSocketTestExecutor &executor)
 void test03_registerDevice(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 03: Register User + Device (Depth=2)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk"});
 }
 
@@ -912,7 +968,7 @@ void test03_registerDevice(GhostSocketTestExecutor &executor)
 void test04_getMyDevices(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 04: Register → Device → GetMyDevices (Depth=3)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "getMyDevicesOk"});
 }
 
@@ -920,7 +976,7 @@ void test04_getMyDevices(GhostSocketTestExecutor &executor)
 void test05_getDeviceInfo(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 05: Register → Device → GetDeviceInfo (Depth=3)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "getDeviceInfoOk"});
 }
 
@@ -928,7 +984,7 @@ void test05_getDeviceInfo(GhostSocketTestExecutor &executor)
 void test06_createSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 06: Register → Device → CreateSession (Depth=3)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "createSessionOk"});
 }
 
@@ -936,7 +992,7 @@ void test06_createSession(GhostSocketTestExecutor &executor)
 void test07_joinSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 07: Two Users → Device → Session → Join (Depth=5)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerUser2Ok", "registerDeviceOk", "createSessionOk", "joinSessionOk"});
 }
 
@@ -944,7 +1000,7 @@ void test07_joinSession(GhostSocketTestExecutor &executor)
 void test08_getSessions(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 08: Register → Device → Session → GetSessions (Depth=4)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "createSessionOk", "getSessionsOk"});
 }
 
@@ -952,7 +1008,7 @@ void test08_getSessions(GhostSocketTestExecutor &executor)
 void test09_terminateSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 09: Register → Device → Session → Terminate (Depth=4)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "createSessionOk", "terminateSessionOk"});
 }
 
@@ -960,7 +1016,7 @@ void test09_terminateSession(GhostSocketTestExecutor &executor)
 void test10_deleteDevice(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 10: Register → Device → DeleteDevice (Depth=3)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "deleteDeviceOk"});
 }
 
@@ -968,7 +1024,7 @@ void test10_deleteDevice(GhostSocketTestExecutor &executor)
 void test11_getOtherDevices(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 11: Two Users → Device → Session → Join → GetOtherDevices (Depth=6)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerUser2Ok", "registerDeviceOk", "createSessionOk", "joinSessionOk", "getOtherDevicesOk"});
 }
 
@@ -976,7 +1032,7 @@ void test11_getOtherDevices(GhostSocketTestExecutor &executor)
 void test12_updatePermissions(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 12: Register → Device → Session → UpdatePermissions (Depth=4)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "createSessionOk", "updatePermissionsOk"});
 }
 
@@ -984,7 +1040,7 @@ void test12_updatePermissions(GhostSocketTestExecutor &executor)
 void test13_deviceInfoForbidden(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 13: GetDeviceInfo Forbidden (no device, Depth=1)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"getDeviceInfoForbiddenErr"});
 }
 
@@ -992,7 +1048,7 @@ void test13_deviceInfoForbidden(GhostSocketTestExecutor &executor)
 void test14_createSessionForbidden(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 14: CreateSession Forbidden (no device, Depth=1)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"createSessionForbiddenErr"});
 }
 
@@ -1000,7 +1056,7 @@ void test14_createSessionForbidden(GhostSocketTestExecutor &executor)
 void test15_joinSessionNotFound(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 15: JoinSession NotFound (no session, Depth=1)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"joinSessionNotFoundErr"});
 }
 
@@ -1008,7 +1064,7 @@ void test15_joinSessionNotFound(GhostSocketTestExecutor &executor)
 void test16_terminateSessionForbidden(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 16: TerminateSession Forbidden (no session, Depth=1)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"terminateSessionForbiddenErr"});
 }
 
@@ -1016,7 +1072,7 @@ void test16_terminateSessionForbidden(GhostSocketTestExecutor &executor)
 void test17_fullSessionLifecycle(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 17: Full Session Lifecycle (Depth=6)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerUser2Ok", "registerDeviceOk", "createSessionOk", "joinSessionOk", "terminateSessionOk"});
 }
 
@@ -1024,7 +1080,7 @@ void test17_fullSessionLifecycle(GhostSocketTestExecutor &executor)
 void test18_devicesAndSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 18: Register → Device → GetMyDevices → Session → GetSessions (Depth=5)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "getMyDevicesOk", "createSessionOk", "getSessionsOk"});
 }
 
@@ -1032,7 +1088,7 @@ void test18_devicesAndSession(GhostSocketTestExecutor &executor)
 void test19_deviceInfoAndSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 19: Register → Device → DeviceInfo → CreateSession (Depth=4)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "getDeviceInfoOk", "createSessionOk"});
 }
 
@@ -1040,7 +1096,7 @@ void test19_deviceInfoAndSession(GhostSocketTestExecutor &executor)
 void test20_joinAndUpdatePermissions(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 20: Two Users → Device → Session → Join → UpdatePermissions (Depth=6)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerUser2Ok", "registerDeviceOk", "createSessionOk", "joinSessionOk", "updatePermissionsOk"});
 }
 
@@ -1048,7 +1104,7 @@ void test20_joinAndUpdatePermissions(GhostSocketTestExecutor &executor)
 void test21_sessionListAndTerminate(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 21: Register → Device → Session → GetSessions → Terminate (Depth=5)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"registerUserOk", "registerDeviceOk", "createSessionOk", "getSessionsOk", "terminateSessionOk"});
 }
 
@@ -1056,7 +1112,7 @@ void test21_sessionListAndTerminate(GhostSocketTestExecutor &executor)
 void test22_createSessionNoDevice(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 22: CreateSession alone — no device (Expected UNSAT)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"createSessionOk"});
 }
 
@@ -1064,7 +1120,7 @@ void test22_createSessionNoDevice(GhostSocketTestExecutor &executor)
 void test23_joinSessionNoSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 23: JoinSession alone — no session (Expected UNSAT)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"joinSessionOk"});
 }
 
@@ -1072,7 +1128,7 @@ void test23_joinSessionNoSession(GhostSocketTestExecutor &executor)
 void test24_terminateNoSession(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 24: TerminateSession alone — no session (Expected UNSAT)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"terminateSessionOk"});
 }
 
@@ -1080,7 +1136,7 @@ void test24_terminateNoSession(GhostSocketTestExecutor &executor)
 void test25_deviceInfoNoDevice(GhostSocketTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 25: GetDeviceInfo alone — no device (Expected UNSAT)",
-        makeGhostSocketSpec(),
+        ghostSocketSpec(),
         {"getDeviceInfoOk"});
 }
 
@@ -1102,27 +1158,32 @@ public:
 
     void runTest(
         const string &testName,
-        unique_ptr<Spec> spec,
+        shared_ptr<const Spec> spec,
         const vector<string> &testSequence)
     {
+        if (SuiteSelection::intercept(testName, testSequence, [=] { runTest(testName, spec, testSequence); }))
+            return;
+
         cout << "\n========================================" << endl;
         cout << "TEST: " << testName << endl;
         cout << "MODE: " << getModeString() << endl;
         cout << "DEPTH: " << testSequence.size() << " API calls" << endl;
         cout << "========================================\n" << endl;
 
+        spec = applySpecOverride(std::move(spec));
+
         try
         {
             switch (mode)
             {
             case TestMode::ORIGINAL:
-                runOriginal(std::move(spec), testSequence);
+                runOriginal(*spec, testSequence);
                 break;
             case TestMode::REWRITE_ONLY:
-                runRewriteOnly(std::move(spec), testSequence);
+                runRewriteOnly(*spec, testSequence);
                 break;
             case TestMode::FULL_PIPELINE:
-                runFullPipeline(std::move(spec), testSequence);
+                runFullPipeline(*spec, testSequence);
                 break;
             }
             cout << "\n✓ " << testName << " COMPLETE!\n" << endl;
@@ -1157,28 +1218,29 @@ private:
         return "Unknown";
     }
 
-    void runOriginal(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runOriginal(const Spec &spec, const vector<string> &ts)
     {
-        Program atc = genATC(*spec, ts);
+        Program atc = genATC(spec, ts);
         PrintVisitor printer;
         printer.visitProgram(atc);
     }
 
-    void runRewriteOnly(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runRewriteOnly(const Spec &spec, const vector<string> &ts)
     {
         auto factory = make_unique<Serveez::ServeezFunctionFactory>(backendUrl);
         Tester tester(factory.get());
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
     }
 
-    void runFullPipeline(unique_ptr<Spec> spec, const vector<string> &ts)
+    void runFullPipeline(const Spec &spec, const vector<string> &ts)
     {
         SymbolTable *symbolTable = new SymbolTable(nullptr);
 
         auto factory = make_unique<Serveez::ServeezFunctionFactory>(backendUrl);
         Tester tester(factory.get());
+        tester.setValueGenerators(&ValueGeneratorRegistry::forApp("serveez"));
 
-        unique_ptr<Program> testApiATC = tester.generateATC(std::move(spec), ts);
+        unique_ptr<Program> testApiATC = tester.generateATC(spec, ts);
 
         vector<Expr *> inputVars;
         ValueEnvironment *valueEnv = new ValueEnvironment(nullptr);
@@ -1216,7 +1278,7 @@ namespace ServeezTests
 void test01_registerUser(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 01: Register USER (Depth=1)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerUserOk"});
 }
 
@@ -1224,7 +1286,7 @@ void test01_registerUser(ServeezTestExecutor &executor)
 void test02_registerProvider(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 02: Register PROVIDER (Depth=1)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerProviderOk"});
 }
 
@@ -1232,7 +1294,7 @@ void test02_registerProvider(ServeezTestExecutor &executor)
 void test03_registerAdmin(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 03: Register ADMIN (Depth=1)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk"});
 }
 
@@ -1240,7 +1302,7 @@ void test03_registerAdmin(ServeezTestExecutor &executor)
 void test04_createCategory(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 04: Admin → CreateCategory (Depth=2)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk"});
 }
 
@@ -1248,7 +1310,7 @@ void test04_createCategory(ServeezTestExecutor &executor)
 void test05_createListing(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 05: Admin → Category → Provider → Listing (Depth=4)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk"});
 }
 
@@ -1256,7 +1318,7 @@ void test05_createListing(ServeezTestExecutor &executor)
 void test06_getListings(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 06: Admin → Category → Provider → Listing → GetListings (Depth=5)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "getListingsOk"});
 }
 
@@ -1264,7 +1326,7 @@ void test06_getListings(ServeezTestExecutor &executor)
 void test07_getListingById(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 07: Admin → Category → Provider → Listing → GetListingById (Depth=5)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "getListingByIdOk"});
 }
 
@@ -1272,7 +1334,7 @@ void test07_getListingById(ServeezTestExecutor &executor)
 void test08_createBooking(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 08: Admin → Category → Provider → Listing → User → Booking (Depth=6)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk"});
 }
 
@@ -1280,7 +1342,7 @@ void test08_createBooking(ServeezTestExecutor &executor)
 void test09_getMyBookings(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 09: ... → Booking → GetMyBookings (Depth=7)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "getMyBookingsOk"});
 }
 
@@ -1288,7 +1350,7 @@ void test09_getMyBookings(ServeezTestExecutor &executor)
 void test10_confirmBooking(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 10: ... → Booking → ConfirmBooking (Depth=7)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "confirmBookingOk"});
 }
 
@@ -1296,7 +1358,7 @@ void test10_confirmBooking(ServeezTestExecutor &executor)
 void test11_completeBooking(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 11: ... → Booking → Confirm → Complete (Depth=8)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "confirmBookingOk", "completeBookingOk"});
 }
 
@@ -1304,7 +1366,7 @@ void test11_completeBooking(ServeezTestExecutor &executor)
 void test12_createReview(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 12: ... → Confirm → Complete → Review (Depth=9)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "confirmBookingOk", "completeBookingOk", "svzCreateReviewOk"});
 }
 
@@ -1312,7 +1374,7 @@ void test12_createReview(ServeezTestExecutor &executor)
 void test13_getListingReviews(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 13: ... → Review → GetListingReviews (Depth=10)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "confirmBookingOk", "completeBookingOk", "svzCreateReviewOk", "getListingReviewsOk"});
 }
 
@@ -1320,7 +1382,7 @@ void test13_getListingReviews(ServeezTestExecutor &executor)
 void test14_cancelBooking(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 14: ... → Booking → CancelBooking (Depth=7)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "cancelBookingOk"});
 }
 
@@ -1328,7 +1390,7 @@ void test14_cancelBooking(ServeezTestExecutor &executor)
 void test15_createListingUnauth(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 15: Admin → Category → CreateListingUnauth (Depth=3)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "createListingUnauthErr"});
 }
 
@@ -1336,7 +1398,7 @@ void test15_createListingUnauth(ServeezTestExecutor &executor)
 void test16_createBookingAsProvider(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 16: Admin → Category → Provider → Listing → CreateBookingAsProvider (Depth=5)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "createBookingAsProviderErr"});
 }
 
@@ -1344,7 +1406,7 @@ void test16_createBookingAsProvider(ServeezTestExecutor &executor)
 void test17_twoListings(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 17: Admin → Category → Provider → Listing1 → Listing2 (Depth=5)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "createListingOk"});
 }
 
@@ -1352,7 +1414,7 @@ void test17_twoListings(ServeezTestExecutor &executor)
 void test18_fullLifecycle(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 18: Full booking lifecycle (Depth=8)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "confirmBookingOk", "completeBookingOk"});
 }
 
@@ -1360,7 +1422,7 @@ void test18_fullLifecycle(ServeezTestExecutor &executor)
 void test19_multipleBookings(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 19: Two users book same listing (Depth=8)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "registerUserOk", "createBookingOk"});
 }
 
@@ -1368,7 +1430,7 @@ void test19_multipleBookings(ServeezTestExecutor &executor)
 void test20_bookAndCancel(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 20: Book → GetMyBookings → Cancel (Depth=8)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "registerUserOk", "createBookingOk", "getMyBookingsOk", "cancelBookingOk"});
 }
 
@@ -1376,7 +1438,7 @@ void test20_bookAndCancel(ServeezTestExecutor &executor)
 void test21_getListingThenBook(ServeezTestExecutor &executor)
 {
     executor.runTest("[SAT] Test 21: Listing → GetById → Book → Confirm (Depth=8)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"registerAdminOk", "createCategoryOk", "registerProviderOk", "createListingOk", "getListingByIdOk", "registerUserOk", "createBookingOk", "confirmBookingOk"});
 }
 
@@ -1384,7 +1446,7 @@ void test21_getListingThenBook(ServeezTestExecutor &executor)
 void test22_createCategoryNoAdmin(ServeezTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 22: createCategory alone — no admin (Expected UNSAT)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"createCategoryOk"});
 }
 
@@ -1392,7 +1454,7 @@ void test22_createCategoryNoAdmin(ServeezTestExecutor &executor)
 void test23_createListingNoProvider(ServeezTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 23: createListing alone — no provider/category (Expected UNSAT)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"createListingOk"});
 }
 
@@ -1400,7 +1462,7 @@ void test23_createListingNoProvider(ServeezTestExecutor &executor)
 void test24_createBookingNoUser(ServeezTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 24: createBooking alone — no user/listing (Expected UNSAT)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"createBookingOk"});
 }
 
@@ -1408,7 +1470,7 @@ void test24_createBookingNoUser(ServeezTestExecutor &executor)
 void test25_confirmBookingNone(ServeezTestExecutor &executor)
 {
     executor.runTest("[UNSAT] Test 25: confirmBooking alone — no booking (Expected UNSAT)",
-        makeServeezSpec(),
+        serveezSpec(),
         {"confirmBookingOk"});
 }
 
@@ -1429,7 +1491,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 01: Register Customer-->Login (Depth=2)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginCustomerOk"});
     }
 
@@ -1437,7 +1499,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 02: loginCustomerErr (Depth=1)",
-            makeRestaurantSpec(), {"loginCustomerErr"}
+            restaurantSpec(), {"loginCustomerErr"}
             // {"loginCustomerOk"} // Should fail: user not in U
         );
     }
@@ -1446,7 +1508,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 03: registerCustomerOk → loginWrongPasswordErr (Depth=2)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginWrongPasswordErr"}
             // {"browseRestaurantsOk"} // Public API, no auth needed
         );
@@ -1460,7 +1522,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 04: loginCustomerOk (Depth=1, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"loginCustomerOk"}
             // {"loginOk"} // should be UNSAT
         );
@@ -1470,7 +1532,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 05: registerCustomerOk → loginCustomerOk → addToCartRestaurantOk (Depth=3, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginCustomerOk", "addToCartRestaurantOk"} // unsat
             // {"registerOwnerOk", "loginOk"} // should be SAT
         );
@@ -1480,7 +1542,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 06: registerOwnerOk → loginOwnerOk → createRestaurantOk → placeOrderOk (Depth=4, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "placeOrderOk"}
             // {"registerAgentOk", "loginOk"} // should be SAT
         );
@@ -1494,7 +1556,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 07: registerOwnerOk → loginOwnerOk → createRestaurantOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk (Depth=7)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk",     // 1. Owner registers
              "loginOwnerOk",        // 2. Owner logs in
              "createRestaurantOk",  // 3. Owner creates restaurant
@@ -1509,7 +1571,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 08: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk (Depth=9)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk",       // 1. Owner registers
              "loginOwnerOk",          // 2. Owner logs in
              "createRestaurantOk",    // 3. Owner creates restaurant
@@ -1526,7 +1588,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 09: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk (Depth=10)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk",     // 1. Owner registers
              "loginOwnerOk",        // 2. Owner logs in
              "createRestaurantOk",  // 3. Owner creates restaurant
@@ -1543,7 +1605,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 10: Full Order Lifecycle with Review (Depth=19)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk",          // 1. Owner registers
              "loginOwnerOk",             // 2. Owner logs in
              "createRestaurantOk",       // 3. Owner creates restaurant
@@ -1569,7 +1631,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 11: registerOwnerOk → loginOwnerOk → createRestaurantOk (Depth=3)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk"}
             // {"registerCustomerOk", "loginOk", "addToCartOk", "placeOrderOk"} // should fail no browse restaurants
         );
@@ -1579,7 +1641,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 12: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → addMenuItemOk → addMenuItemOk (Depth=6)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk",
              "addMenuItemOk", "addMenuItemOk", "addMenuItemOk"}
             // {"registerOwnerOk", "loginOk", "createRestaurantOk", "addMenuItemOk"}
@@ -1590,7 +1652,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 13: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk (Depth=9)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk"}
@@ -1606,7 +1668,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 14: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk (Depth=10)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk"}
@@ -1618,7 +1680,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 15: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk → updateOrderStatusOwnerOk x3 (Depth=13)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk",
@@ -1633,7 +1695,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 16: registerCustomerOk → registerCustomerOk (Depth=2, Expected UNSAT - Duplicate Registration)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "registerOwnerOk"}
             //{"registerAgentOk", "loginOk", "placeOrderOk", "assignOrderOk", "updateOrderStatusAgentOk"} // delivery agent can't place order
         );
@@ -1647,7 +1709,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 17: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk → registerAgentOk → loginAgentOk → updateOrderStatusAgentOk (Depth=13, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk",
@@ -1661,7 +1723,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 18: loginCustomerOk → browseRestaurantsOk → addToCartRestaurantOk x3 → placeOrderOk (Depth=6, Expected UNSAT - No Registration)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"loginCustomerOk", "browseRestaurantsOk", "addToCartRestaurantOk", "addToCartRestaurantOk", "addToCartRestaurantOk", "placeOrderOk"} // should return unsat as no registration
         );
     }
@@ -1670,7 +1732,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 19: registerCustomerOk → loginCustomerOk → createRestaurantCustomerErr (Depth=3, Expected UNSAT - Customer Can't Create Restaurant)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginCustomerOk", "createRestaurantCustomerErr"});
     }
 
@@ -1682,7 +1744,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 20: registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk → leaveReviewOk (Depth=7, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk", "leaveReviewOk"});
     }
@@ -1691,7 +1753,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 21: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk x3 (Depth=6)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk",
              "addMenuItemOk", "addMenuItemOk", "addMenuItemOk"});
     }
@@ -1702,7 +1764,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 23: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk → registerCustomerOk → loginCustomerOk → browseRestaurantsOk → viewMenuOk → addToCartRestaurantOk → placeOrderOk (Depth=10)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk",       // 1. Owner registers
              "loginOwnerOk",          // 2. Owner logs in
              "createRestaurantOk",    // 3. Owner creates restaurant
@@ -1719,7 +1781,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 24: registerCustomerOk → loginCustomerOk → leaveReviewOk (Depth=3, Expected UNSAT - Review Before Order)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "loginCustomerOk", "leaveReviewOk"}
             // Should fail: can't review restaurant you haven't ordered from
         );
@@ -1729,7 +1791,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 25: registerOwnerOk → loginOwnerOk → createRestaurantOk → addMenuItemOk x5 → updateOrderStatusOwnerOk x2 (Depth=10, Expected UNSAT)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk",
              "addMenuItemOk", "addMenuItemOk", "addMenuItemOk",
              "addMenuItemOk", "addMenuItemOk", "updateOrderStatusOwnerOk", "updateOrderStatusOwnerOk"});
@@ -1739,7 +1801,7 @@ namespace RestaurantTests
     {
         executor.runTest(
             "Test 26: registerCustomerOk → registerCustomerOk (Depth=2, Expected UNSAT - Duplicate Email)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk", "registerCustomerOk"}); // edge case should return unsat
     }
     
@@ -1760,7 +1822,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 01: Get All Books (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"getAllBooksOk"});
     }
 
@@ -1768,7 +1830,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 02: Get All Students (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"getAllStudentsOk"});
     }
 
@@ -1776,7 +1838,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 03: Save Book (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk"});
     }
 
@@ -1784,7 +1846,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 04: Save Student (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk"});
     }
 
@@ -1796,7 +1858,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 05: Save Book → Get Book (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "getBookByCodeOk"});
     }
 
@@ -1804,7 +1866,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 06: Save Student → Get Student (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk", "getStudentByIdOk"});
     }
 
@@ -1812,7 +1874,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 07: Save Two Books (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveBookOk"});
     }
 
@@ -1820,7 +1882,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 08: Get Book Not Found (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"getBookByCodeErr"});
     }
 
@@ -1832,7 +1894,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 09: Book CRUD - Save → Update → Delete (Depth=3)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "updateBookOk", "deleteBookOk"});
     }
 
@@ -1840,7 +1902,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 10: Student CRUD - Save → Update → Delete (Depth=3)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk", "updateStudentOk", "deleteStudentOk"});
     }
 
@@ -1848,7 +1910,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 11: Create Book and Student (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk"});
     }
 
@@ -1860,7 +1922,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 12: Create Request Flow (Depth=3)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk"});
     }
 
@@ -1868,7 +1930,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 13: Accept Request Flow (Depth=4)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "acceptRequestOk"});
     }
 
@@ -1876,7 +1938,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 14: Full Borrow/Return Lifecycle (Depth=5)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "acceptRequestOk", "returnBookOk"});
     }
 
@@ -1884,7 +1946,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 15: Direct Loan Creation (Depth=3)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveLoanOk"});
     }
 
@@ -1892,7 +1954,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 16: Reject Request (Depth=4)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "deleteRequestOk"});
     }
 
@@ -1904,7 +1966,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 17: Request Without Book (Should be UNSAT)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk", "saveRequestOk"}); // No book - should fail
     }
 
@@ -1912,7 +1974,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 18: Request Without Student (Should be UNSAT)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveRequestOk"}); // No student - should fail
     }
 
@@ -1920,7 +1982,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 19: Accept Without Request (Should be UNSAT)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"acceptRequestOk"}); // No request - should fail
     }
 
@@ -1928,7 +1990,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 20: Return Without Loan (Should be UNSAT)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"returnBookOk"}); // No loan - should fail
     }
 
@@ -1940,7 +2002,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 21: Multiple Books (Depth=5)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveBookOk", "saveBookOk", "getAllBooksOk", "getBookByCodeOk"});
     }
 
@@ -1948,7 +2010,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 22: Multiple Students (Depth=5)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk", "saveStudentOk", "saveStudentOk", "getAllStudentsOk", "getStudentByIdOk"});
     }
 
@@ -1956,7 +2018,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 23: Multiple Borrowings (Depth=7)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveBookOk", "saveStudentOk",
              "saveRequestOk", "saveRequestOk",
              "acceptRequestOk", "acceptRequestOk"});
@@ -1966,7 +2028,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 24: Full Library Workflow (Depth=8)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveBookOk",
              "saveStudentOk", "saveStudentOk",
              "saveRequestOk", "acceptRequestOk",
@@ -1977,7 +2039,7 @@ namespace LibraryTests
     {
         executor.runTest(
             "Test 25: Complex Multi-User Scenario (Depth=10)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveBookOk", "saveBookOk",
              "saveStudentOk", "saveStudentOk",
              "saveRequestOk", "saveRequestOk",
@@ -2002,7 +2064,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 01: Register Buyer (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk"});
     }
 
@@ -2011,7 +2073,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 02: Register Seller (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk"});
     }
 
@@ -2020,7 +2082,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 03: Browse All Products - Public (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"getAllProductsOk"});
     }
 
@@ -2029,7 +2091,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 04: Register Buyer → Login (Depth=2)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk", "loginBuyerOk"});
     }
 
@@ -2038,7 +2100,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 05: Register Seller → Login (Depth=2)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk"});
     }
 
@@ -2047,7 +2109,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 06: Seller Creates Product (Depth=3)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk"});
     }
 
@@ -2056,7 +2118,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 07: Seller Creates 3 Products (Depth=5)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk",
              "createProductOk", "createProductOk", "createProductOk"});
     }
@@ -2066,7 +2128,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 08: Seller Creates → Updates Product (Depth=4)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk", "updateProductOk"});
     }
 
@@ -2075,7 +2137,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 09: Seller Creates → Deletes Product (Depth=4)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk", "deleteProductOk"});
     }
 
@@ -2084,7 +2146,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 10: Seller Creates → Views Inventory (Depth=4)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk", "getSellerProductsOk"});
     }
 
@@ -2093,7 +2155,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 11: Seller Setup → Buyer Browses (Depth=6)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk", "getAllProductsOk"});
     }
@@ -2103,7 +2165,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 12: Seller Setup → Buyer Adds to Cart (Depth=7)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk"});
@@ -2114,7 +2176,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 13: Seller Setup → Buyer Adds & Views Cart (Depth=8)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "getCartOk"});
@@ -2125,7 +2187,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 14: Seller Setup → Buyer Creates Order (Depth=8)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk"});
@@ -2136,7 +2198,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 15: Full Order Flow → Buyer Views Orders (Depth=9)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk", "getBuyerOrdersOk"});
@@ -2147,7 +2209,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 16: Full Order → Seller Views Orders (Depth=9)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk", "getSellerOrdersOk"});
@@ -2158,7 +2220,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 17: Full Order → Buyer Creates Review (Depth=9)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk", "createReviewOk"});
@@ -2169,7 +2231,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 18: Complete E-Commerce Flow (Depth=12)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "getAllProductsOk", "addToCartOk", "addToCartOk",
@@ -2181,7 +2243,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 19: Buyer Places Multiple Orders (Depth=12)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk",
              "createProductOk", "createProductOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
@@ -2195,7 +2257,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 20: Seller Full Product Management (Depth=10)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk",
              "createProductOk", "createProductOk", "createProductOk",
              "updateProductOk", "updateProductOk",
@@ -2208,7 +2270,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[SAT] Test 21: Deep E-Commerce Workflow (Depth=15)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk",
              "createProductOk", "createProductOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
@@ -2226,7 +2288,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 22: Buyer Login Without Registration (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"loginBuyerOk"});
     }
 
@@ -2235,7 +2297,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 23: Seller Login Without Registration (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"loginSellerOk"});
     }
 
@@ -2244,7 +2306,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 24: Duplicate Buyer Registration (Depth=2)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk", "registerBuyerOk"});
     }
 
@@ -2253,7 +2315,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 25: Buyer Cannot Create Product (Depth=3)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk", "loginBuyerOk", "createProductOk"});
     }
 
@@ -2262,7 +2324,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 26: Seller Cannot Add to Cart (Depth=3)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "addToCartOk"});
     }
 
@@ -2271,7 +2333,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 27: Seller Cannot Create Order (Depth=4)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk", "createOrderOk"});
     }
 
@@ -2280,7 +2342,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 28: Add to Cart - No Product Exists (Depth=3)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk", "loginBuyerOk", "addToCartOk"});
     }
 
@@ -2289,7 +2351,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 29: Create Order - Empty Cart (Depth=6)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "createOrderOk"});
@@ -2300,7 +2362,7 @@ namespace EcommerceTests
     {
         executor.runTest(
             "[UNSAT] Test 30: Create Review - No Order Placed (Depth=7)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createReviewOk"});
@@ -2322,7 +2384,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B1] POST /api/auth/register returns 200 instead of 201 (Depth=1)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerCustomerOk"});
     }
 
@@ -2333,7 +2395,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B2] POST /api/restaurants returns 200 instead of 201 (Depth=3)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk"});
     }
 
@@ -2344,7 +2406,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B3] POST /api/menu returns 200 instead of 201 (Depth=4, B2 cascade expected)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk"});
     }
 
@@ -2357,7 +2419,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B4] Order finalAmount missing deliveryFee — checkOrderAmountOk (Depth=11)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk",
@@ -2372,7 +2434,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B5] Cart not cleared after placing order (Depth=10, B2 cascade expected)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk"});
@@ -2386,7 +2448,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B6] Cart accepts quantity=0 — addToCartQuantityZeroErr (Depth=10)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk",
@@ -2402,7 +2464,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B7] Review rejected for delivered orders — full delivery flow (Depth=18, B2 cascade expected)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk", "placeOrderOk",
@@ -2423,7 +2485,7 @@ namespace BugTests
     {
         executor.runTest(
             "[BUG B8] Cart totalAmount ignores quantity — checkCartTotalOk (Depth=10)",
-            makeRestaurantSpec(),
+            restaurantSpec(),
             {"registerOwnerOk", "loginOwnerOk", "createRestaurantOk", "addMenuItemOk",
              "registerCustomerOk", "loginCustomerOk", "browseRestaurantsOk", "viewMenuOk",
              "addToCartRestaurantOk",
@@ -2445,7 +2507,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB1] POST /api/auth/register returns 200 instead of 201 (Depth=1)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerBuyerOk"});
     }
 
@@ -2455,7 +2517,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB2] POST /api/products returns 200 instead of 201 (Depth=3)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk"});
     }
 
@@ -2465,7 +2527,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB3] POST /api/orders returns 200 instead of 201 (Depth=7)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk"});
@@ -2480,7 +2542,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB4] Order totalAmount ignores quantity — checkOrderTotalOk (Depth=8)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk",
@@ -2494,7 +2556,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB5] Cart not cleared after order — createOrderOk (Depth=7)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk"});
@@ -2508,7 +2570,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB6] Cart rejects exact-stock quantity — addToCartMaxStockOk (Depth=6)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartMaxStockOk"});
@@ -2522,7 +2584,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB7] Review guard inverted — createReviewOk (Depth=8)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "addToCartOk", "createOrderOk", "createReviewOk"});
@@ -2536,7 +2598,7 @@ namespace EcomBugTests
     {
         executor.runTest(
             "[ECOM BUG EB8] Product delete missing seller auth — deleteProductByBuyerErr (Depth=6)",
-            makeEcommerceSpec(),
+            ecommerceSpec(),
             {"registerSellerOk", "loginSellerOk", "createProductOk",
              "registerBuyerOk", "loginBuyerOk",
              "deleteProductByBuyerErr"});
@@ -2558,7 +2620,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB1] Request not deleted after accept — acceptRequestOk (Depth=4)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "acceptRequestOk"});
     }
 
@@ -2570,7 +2632,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB2] Book not deleted — deleteBookOk (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "deleteBookOk"});
     }
 
@@ -2583,7 +2645,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB3] Overlap check inverted — accept rejects valid requests (Depth=4)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "acceptRequestOk"});
     }
 
@@ -2595,7 +2657,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB4] Loan not deleted on return — returnBookOk (Depth=5)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "saveStudentOk", "saveRequestOk", "acceptRequestOk", "returnBookOk"});
     }
 
@@ -2607,7 +2669,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB5] Student not deleted — deleteStudentOk (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk", "deleteStudentOk"});
     }
 
@@ -2619,7 +2681,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB6] Update deletes book instead of updating (Depth=2)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk", "updateBookOk"});
     }
 
@@ -2631,7 +2693,7 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB7] Student not saved to DB — saveStudentOk (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveStudentOk"});
     }
 
@@ -2643,11 +2705,121 @@ namespace LibraryBugTests
     {
         executor.runTest(
             "[LIB BUG LB8] Book not saved to DB — saveBookOk (Depth=1)",
-            makeLibrarySpec(),
+            librarySpec(),
             {"saveBookOk"});
     }
 }
 
+// ============================================
+// SPEC TOOL
+// ============================================
+
+// Builtin app name or a path to a .spec/.specb file
+// <app> | synthetic:<options> | <file>
+static shared_ptr<const Spec> loadSpecArg(const string &arg)
+{
+    if (auto spec = builtinSpec(arg))
+        return spec;
+    if (arg.compare(0, 10, "synthetic:") == 0)
+        return makeSyntheticSpec(parseSyntheticSpecOptions(arg.substr(10)));
+    return loadSpecFile(arg);
+}
+
+// spec dump <app|file> [out.spec]     write the textual form
+// spec compile <app|file> <out.specb> write the precompiled form
+// spec check [app...]                 builder -> text -> parse -> binary round trip
+// spec sequences <app|file> N DEPTH [SEED]  N dependency-respecting sequences as JSONL (batch input)
+static int runSpecTool(int argc, char *argv[])
+{
+    string cmd = argc > 2 ? argv[2] : "";
+    try
+    {
+        if (cmd == "dump" && (argc == 4 || argc == 5))
+        {
+            auto spec = loadSpecArg(argv[3]);
+            if (argc == 4)
+            {
+                writeSpecText(*spec, cout);
+                return 0;
+            }
+            ofstream out(argv[4]);
+            if (!out)
+                throw runtime_error(string("Cannot write spec file: ") + argv[4]);
+            writeSpecText(*spec, out);
+            cout << "[Spec] Wrote " << argv[4] << " (" << spec->blocks.size() << " blocks)" << endl;
+            return 0;
+        }
+        if (cmd == "compile" && argc == 5)
+        {
+            auto spec = loadSpecArg(argv[3]);
+            saveSpecBinary(*spec, argv[4]);
+            cout << "[Spec] Compiled " << argv[3] << " -> " << argv[4]
+                 << " (" << spec->blocks.size() << " blocks)" << endl;
+            return 0;
+        }
+        if (cmd == "sequences" && (argc == 6 || argc == 7))
+        {
+            auto spec = loadSpecArg(argv[3]);
+            unsigned seed = argc == 7 ? (unsigned)stoul(argv[6]) : 1;
+            for (const auto &seq : makeSyntheticSequences(*spec, stoul(argv[4]), stoul(argv[5]), seed))
+            {
+                cout << "[";
+                for (size_t i = 0; i < seq.size(); i++)
+                    cout << (i ? "," : "") << "\"" << seq[i] << "\"";
+                cout << "]\n";
+            }
+            return 0;
+        }
+        if (cmd == "check")
+        {
+            vector<string> apps;
+            for (int i = 3; i < argc; i++)
+                apps.push_back(argv[i]);
+            if (apps.empty())
+                apps = {"restaurant", "ecommerce", "library", "tripvault", "ghostsocket", "serveez"};
+
+            int failures = 0;
+            for (const auto &app : apps)
+            {
+                auto builtin = builtinSpec(app);
+                if (!builtin)
+                    throw runtime_error("Unknown spec: " + app);
+                string binary = serializeSpec(*builtin);
+                string text = writeSpecText(*builtin);
+
+                auto t0 = chrono::steady_clock::now();
+                auto parsed = parseSpecText(text);
+                auto t1 = chrono::steady_clock::now();
+                auto loaded = deserializeSpec(binary.data(), binary.size());
+                auto t2 = chrono::steady_clock::now();
+
+                bool textOk = serializeSpec(*parsed) == binary;
+                bool binaryOk = serializeSpec(*loaded) == binary;
+                if (!textOk || !binaryOk)
+                    failures++;
+                cout << "[Spec] " << app << ": " << builtin->blocks.size() << " blocks, "
+                     << text.size() << " B text, " << binary.size() << " B binary | parse "
+                     << chrono::duration<double, micro>(t1 - t0).count() << " us, load "
+                     << chrono::duration<double, micro>(t2 - t1).count() << " us | "
+                     << (textOk && binaryOk ? "OK" : "MISMATCH") << endl;
+            }
+            return failures == 0 ? 0 : 1;
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "[Spec] " << e.what() << endl;
+        return 1;
+    }
+
+    cerr << "usage: " << argv[0] << " spec dump <app|file> [out.spec]\n"
+         << "       " << argv[0] << " spec compile <app|file> <out.specb>\n"
+         << "       " << argv[0] << " spec check [app...]\n"
+         << "       " << argv[0] << " spec sequences <app|file> <count> <depth> [seed]\n"
+         << "  <app> may also be synthetic:globals=N,blocks=N,terms=N,mapsize=N,deps=P,seed=N" << endl;
+    return 2;
+}
+
 // ============================================
 // MAIN FUNCTION - TEST SELECTION
 // ============================================
@@ -2657,8 +2829,88 @@ int main(int argc, char* argv[])
     // backend = "restaurant" | "ecommerce" | "library"  (default: library)
     string backend = (argc > 1) ? string(argv[1]) : "library";
 
+    // TESTGEN_TRACE=FILE: Chrome trace of every mode, daemon and batch included
+    if (const char *tracePath = getenv("TESTGEN_TRACE"))
+        Tracer::start(tracePath);
+    // TESTGEN_METRICS=FILE: end-of-run counters and latency histograms
+    if (const char *metricsPath = getenv("TESTGEN_METRICS"))
+        Metrics::start(metricsPath);
+
+    if (backend == "spec")
+        return runSpecTool(argc, argv);
+
+    // daemon [--socket PATH]: serve JSONL test requests with everything kept warm
+    if (backend == "daemon")
+    {
+        try
+        {
+            return runDaemon(parseDaemonArgs(argc, argv, 2));
+        }
+        catch (const exception &e)
+        {
+            cerr << "[Daemon] " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    // batch [--shard i/n] app=FILE...: run sequence files, one shard of a split
+    if (backend == "batch")
+        return runBatch(argc, argv, 2);
+
+    // mutate --launch LAUNCH.json [-j N] app=FILE...: parallel mutation campaign
+    if (backend == "mutate")
+        return runMutate(argc, argv, 2);
+
+    string recordSuitePath, suitePlan, suitePlanPath;
+    // --checkpoints: restore shared prefixes from backend snapshots
+    // (needs /api/test/checkpoint + /api/test/restore, else reset-and-replay)
+    // --no-simplify: run test-API ATCs as rewritten, without partial evaluation
+    // --mirror-state [RATE]: serve get_G and read-only calls from a client-side
+    // mirror, checking RATE (0..1, default 0) of the served reads against the backend
+    // --spec FILE: load the suite's spec from a .spec/.specb file
+    // --trace FILE: write a Chrome trace-event file (open in Perfetto)
+    // --record-suite FILE | --minimized SEL | --prioritized SEL: see suiteselection.hh
+    // --metrics FILE: write run metrics (FILE.prom for Prometheus text, else JSON)
+    for (int i = 2; i < argc; i++)
+    {
+        if (string(argv[i]) == "--checkpoints")
+            Tester::setCheckpointsEnabled(true);
+        else if (string(argv[i]) == "--no-simplify")
+            Tester::setSimplifyEnabled(false);
+        else if (string(argv[i]) == "--mirror-state")
+        {
+            double rate = 0.0;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0]))
+                rate = stod(argv[++i]);
+            if (rate < 0.0 || rate > 1.0)
+            {
+                cerr << "--mirror-state rate must be between 0 and 1" << endl;
+                return 1;
+            }
+            Tester::setMirrorEnabled(true, rate);
+        }
+        else if (string(argv[i]) == "--spec" && i + 1 < argc)
+            specOverridePath = argv[++i];
+        else if (string(argv[i]) == "--trace" && i + 1 < argc)
+            Tracer::start(argv[++i]);
+        else if (string(argv[i]) == "--metrics" && i + 1 < argc)
+            Metrics::start(argv[++i]);
+        else if (string(argv[i]) == "--record-suite" && i + 1 < argc)
+            recordSuitePath = argv[++i];
+        else if ((string(argv[i]) == "--minimized" || string(argv[i]) == "--prioritized") && i + 1 < argc)
+        {
+            suitePlan = string(argv[i]).substr(2);
+            suitePlanPath = argv[++i];
+        }
+    }
+
     try
     {
+        if (!recordSuitePath.empty())
+            SuiteSelection::record(recordSuitePath);
+        if (!suitePlanPath.empty())
+            SuiteSelection::load(suitePlanPath, backend, suitePlan);
+
         // ========================================
         // CONFIGURATION
         // ========================================
@@ -2704,6 +2956,7 @@ int main(int argc, char* argv[])
             RestaurantTests::test23_invalidSequence(executor);
             RestaurantTests::test24_deepWorkflow(executor);
             RestaurantTests::test25_registerCustomerDuplicate(executor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL RESTAURANT TESTS COMPLETE         ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
@@ -2746,6 +2999,7 @@ int main(int argc, char* argv[])
             EcommerceTests::test28_addToCartNoProduct(ecomExecutor);
             EcommerceTests::test29_createOrderEmptyCart(ecomExecutor);
             EcommerceTests::test30_reviewWithoutOrder(ecomExecutor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL ECOMMERCE TESTS COMPLETE          ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
@@ -2783,6 +3037,7 @@ int main(int argc, char* argv[])
             GhostSocketTests::test23_joinSessionNoSession(gsExecutor);
             GhostSocketTests::test24_terminateNoSession(gsExecutor);
             GhostSocketTests::test25_deviceInfoNoDevice(gsExecutor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL GHOSTSOCKET TESTS COMPLETE        ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
@@ -2820,6 +3075,7 @@ int main(int argc, char* argv[])
             ServeezTests::test23_createListingNoProvider(svExecutor);
             ServeezTests::test24_createBookingNoUser(svExecutor);
             ServeezTests::test25_confirmBookingNone(svExecutor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL SERVEEZ TESTS COMPLETE            ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
@@ -2857,6 +3113,7 @@ int main(int argc, char* argv[])
             TripVaultTests::test23_createTripWithoutLogin(tvExecutor);
             TripVaultTests::test24_deleteExpenseWithoutAuth(tvExecutor);
             TripVaultTests::test25_deleteTripWithoutAuth(tvExecutor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL TRIPVAULT TESTS COMPLETE          ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
@@ -2894,6 +3151,7 @@ int main(int argc, char* argv[])
             LibraryTests::test23_multipleBorrowings(libExecutor);
             LibraryTests::test24_fullLibraryWorkflow(libExecutor);
             LibraryTests::test25_complexScenario(libExecutor);
+            SuiteSelection::flush();
             cout << "\n╔════════════════════════════════════════╗" << endl;
             cout << "║  ALL LIBRARY TESTS COMPLETE            ║" << endl;
             cout << "╚════════════════════════════════════════╝\n" << endl;
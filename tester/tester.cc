@@ -3,6 +3,10 @@
 #include "../algo.hpp"
 #include "../clonevisitor.hh"
 #include "../printvisitor.hh"
+#include "../atctemplate.hh"
+#include "../atcsimplifier.hh"
+#include "../trace.hh"
+#include "../metrics.hh"
 #include <iostream>
 #include <set>
 
@@ -380,150 +384,16 @@ bool isSequenceTrulyUnsat(const std::vector<std::string> &sequence)
     return false; // Not truly UNSAT - all dependencies can be met
 }
 
-// Generate realistic test values based on variable name hints
-Expr *generateRealisticValue(const string &varName, int index)
-{
-    string baseName = varName;
-    size_t i = varName.length();
-    while (i > 0 && isdigit(varName[i - 1]))
-    {
-        i--;
-    }
-    if (i < varName.length())
-    {
-        baseName = varName.substr(0, i);
-    }
-
-    string suffix = to_string(index);
-
-    if (baseName == "email")
-    {
-        return new String("testuser" + suffix + "@example.com");
-    }
-    else if (baseName == "password")
-    {
-        return new String("Password" + suffix + "!");
-    }
-    else if (baseName == "fullName")
-    {
-        return new String("Test User " + suffix);
-    }
-    else if (baseName == "mobile")
-    {
-        string paddedIndex = suffix;
-        while (paddedIndex.length() < 4)
-        {
-            paddedIndex = "0" + paddedIndex;
-        }
-        return new String("555000" + paddedIndex.substr(paddedIndex.length() - 4));
-    }
-    else if (baseName == "token")
-    {
-        return new String("token_" + suffix);
-    }
-    else if (baseName == "name")
-    {
-        return new String("TestName" + suffix);
-    }
-    else if (baseName == "address")
-    {
-        return new String("123 Test Street " + suffix);
-    }
-    else if (baseName == "contact")
-    {
-        return new String("contact" + suffix + "@test.com");
-    }
-
-    // ========================================
-    // LIBRARY WEBAPP MAPPINGS
-    // ========================================
-
-    // Book fields
-    else if (baseName == "bookTitle")
-    {
-        return new String("Test Book " + suffix);
-    }
-    else if (baseName == "bookAuthor")
-    {
-        return new String("Author " + suffix);
-    }
-    else if (baseName == "bookDesc")
-    {
-        return new String("Description for test book " + suffix);
-    }
-    else if (baseName == "bookCode")
-    {
-        // This should typically be resolved from sigma (existing book)
-        return new String("__BOOK_CODE_" + suffix + "__");
-    }
-
-    // Student fields
-    else if (baseName == "studentName")
-    {
-        return new String("Student " + suffix);
-    }
-    else if (baseName == "studentEmail")
-    {
-        return new String("student" + suffix + "@test.com");
-    }
-    else if (baseName == "studentPhone")
-    {
-        string paddedIndex = suffix;
-        while (paddedIndex.length() < 4)
-        {
-            paddedIndex = "0" + paddedIndex;
-        }
-        return new String("555100" + paddedIndex.substr(paddedIndex.length() - 4));
-    }
-    else if (baseName == "studentId")
-    {
-        // This should typically be resolved from sigma (existing student)
-        return new String("__STUDENT_ID_" + suffix + "__");
-    }
-
-    // Request/Loan date fields
-    else if (baseName == "startDate")
-    {
-        return new String("2025-01-01");
-    }
-    else if (baseName == "endDate")
-    {
-        return new String("2025-01-15");
-    }
-
-    // Request ID
-    else if (baseName == "requestId")
-    {
-        // This should typically be resolved from sigma (existing request)
-        return new String("__REQUEST_ID_" + suffix + "__");
-    }
-
-    // Loan ID
-    else if (baseName == "loanId")
-    {
-        // This should typically be resolved from sigma (existing loan)
-        return new String("__LOAN_ID_" + suffix + "__");
-    }
-
-    // ========================================
-    // DEFAULT FALLBACK
-    // ========================================
-    else
-    {
-        return new String("value_" + suffix);
-    }
-}
-
 void Tester::generateTest() {}
 
 bool isInputStmt(const Stmt &stmt)
 {
     if (stmt.statementType == StmtType::ASSIGN)
     {
-        const Assign *assign = dynamic_cast<const Assign *>(&stmt);
+        const Assign *assign = stmt.as<Assign>();
         if (assign && assign->right->exprType == ExprType::FUNCCALL)
         {
-            const FuncCall *fc = dynamic_cast<const FuncCall *>(assign->right.get());
+            const FuncCall *fc = assign->right->as<FuncCall>();
             if (fc)
             {
                 return (fc->name == "input" && fc->args.size() == 0);
@@ -556,72 +426,20 @@ string extractBaseName(const string &varName)
         baseName = varName.substr(0, idx);
     return baseName;
 }
-// Check if a variable needs to be resolved from sigma (constraint-aware IDs)
-bool needsSigmaLookup(const string &baseName)
-{
-
-    // Library app IDs
-    if (baseName == "bookCode" ||
-        baseName == "studentId" ||
-        baseName == "requestId" ||
-        baseName == "loanId")
-    {
-        return true;
-    }
 
-    // Restaurant app IDs
-    if (baseName == "restaurantId" ||
-        baseName == "menuItemId" ||
-        baseName == "orderId")
-    {
-        return true;
-    }
-    // E-commerce app IDs
-    if (baseName == "productId" ||
-        baseName == "cartId" ||
-        baseName == "reviewId")
-    {
-        return true;
-    }
-    return false;
+string Tester::solverString(const string &varName, int variant) const
+{
+    const ValueGenerator *gen = valueGenerators->find(extractBaseName(varName));
+    return gen ? gen->sample(variant) : "";
 }
 
-// Search sigma for the LATEST non-empty map with given prefix and return first key
-string Tester::findKeyFromMapInSigma(const string &prefix)
+// First key of the latest materialized map of `global` (SEE keeps the index)
+string Tester::findLatestKey(const string &global)
 {
-    cout << "    [findKeyFromMapInSigma] Searching for prefix: " << prefix << endl;
-
-    // Search from high to low to find the LATEST version
-    for (int i = 20; i >= 0; i--)
-    {
-        string varName = prefix + to_string(i);
-
-        if (see.getSigma().hasValue(varName))
-        {
-            Expr *value = see.getSigma().getValue(varName);
-
-            if (value && value->exprType == ExprType::MAP)
-            {
-                Map *map = dynamic_cast<Map *>(value);
-
-                if (map && !map->value.empty())
-                {
-                    Var *firstKey = map->value[0].first.get();
-                    cout << "    [findKeyFromMapInSigma] Found " << varName
-                         << " with " << map->value.size() << " entries, returning key: "
-                         << firstKey->name << endl;
-                    return firstKey->name;
-                }
-                else
-                {
-                    cout << "    [findKeyFromMapInSigma] " << varName << " is empty map" << endl;
-                }
-            }
-        }
-    }
-
-    cout << "    [findKeyFromMapInSigma] No non-empty map found for " << prefix << endl;
-    return "";
+    string key = see.latestKey(global);
+    if (key.empty())
+        cout << "    [findLatestKey] No non-empty " << global << " map in sigma" << endl;
+    return key;
 }
 
 // Generate value for a variable based on its base name
@@ -629,544 +447,43 @@ Expr *Tester::generateValueForBaseName(const string &baseName, const string &var
                                        int index, map<string, Expr *> &baseNameToValue,
                                        bool lookupFromSigma)
 {
+    const ValueGenerator *gen = valueGenerators->find(baseName);
     Expr *value = nullptr;
 
-    // OWNER ROLE VARIABLES
-    if (baseName == "ownerEmail")
-    {
-        value = new String("owner@example.com");
-    }
-    else if (baseName == "ownerPassword")
-    {
-        value = new String("OwnerPass1!");
-    }
-    else if (baseName == "ownerFullName")
-    {
-        value = new String("Test Owner");
-    }
-    else if (baseName == "ownerMobile")
-    {
-        value = new String("5550000001");
-    }
-    // CUSTOMER ROLE VARIABLES
-    else if (baseName == "customerEmail")
-    {
-        value = new String("customer@example.com");
-    }
-    else if (baseName == "customerPassword")
-    {
-        value = new String("CustomerPass1!");
-    }
-    else if (baseName == "customerFullName")
+    if (!gen)
     {
-        value = new String("Test Customer");
+        value = ValueGeneratorRegistry::fallback(index);
     }
-    else if (baseName == "customerMobile")
+    else if (gen->kind == GenKind::SIGMA_KEY)
     {
-        value = new String("5550000002");
-    }
-    // WRONG PASSWORD FOR ERROR TESTING
-    else if (baseName == "wrongPassword")
-    {
-        value = new String("WrongPass123!");
-    }
-    // AGENT ROLE VARIABLES
-    else if (baseName == "agentEmail")
-    {
-        value = new String("agent@example.com");
-    }
-    else if (baseName == "agentPassword")
-    {
-        value = new String("AgentPass1!");
-    }
-    else if (baseName == "agentFullName")
-    {
-        value = new String("Test Agent");
-    }
-    else if (baseName == "agentMobile")
-    {
-        value = new String("5550000003");
-    }
-    // ========================================
-    // E-COMMERCE: BUYER ROLE VARIABLES
-    // ========================================
-    else if (baseName == "buyerEmail")
-    {
-        value = new String("buyer@example.com");
-    }
-    else if (baseName == "buyerPassword")
-    {
-        value = new String("BuyerPass123!");
-    }
-    else if (baseName == "buyerFullName")
-    {
-        value = new String("Test Buyer");
-    }
-    // E-COMMERCE: SELLER ROLE VARIABLES
-    else if (baseName == "sellerEmail")
-    {
-        value = new String("seller@example.com");
-    }
-    else if (baseName == "sellerPassword")
-    {
-        value = new String("SellerPass123!");
-    }
-    else if (baseName == "sellerFullName")
-    {
-        value = new String("Test Seller");
-    }
-    else if (baseName == "storeName")
-    {
-        value = new String("Test Store");
-    }
-    else if (baseName == "storeDescription")
-    {
-        value = new String("A quality test store");
-    }
-    // E-COMMERCE: PRODUCT FIELDS
-    else if (baseName == "title")
-    {
-        value = new String("Test Product");
-    }
-    else if (baseName == "description")
-    {
-        value = new String("A great test product description");
-    }
-    else if (baseName == "category")
-    {
-        value = new String("Electronics");
-    }
-    else if (baseName == "price")
-    {
-        value = new Num(99);
-    }
-    // E-COMMERCE: CONSTRAINT-AWARE IDs
-    else if (baseName == "productId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_P_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] productId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_PRODUCT_ID__");
-                cout << "    [DEFERRED] productId - no product in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_PRODUCT_ID__");
-        }
-    }
-    else if (baseName == "cartId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_C_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] cartId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_CART_ID__");
-                cout << "    [DEFERRED] cartId - no cart in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_CART_ID__");
-        }
-    }
-    else if (baseName == "reviewId")
-    {
-        if (lookupFromSigma)
+        // CONSTRAINT-AWARE IDs - Look up from sigma if flag is set
+        string realId = lookupFromSigma ? findLatestKey(gen->text) : "";
+        if (!realId.empty())
         {
-            string realId = findKeyFromMapInSigma("tmp_Rev_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] reviewId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_REVIEW_ID__");
-                cout << "    [DEFERRED] reviewId - no review in sigma yet" << endl;
-            }
+            value = new String(realId);
+            cout << "    [RESOLVED from sigma] " << baseName << " = \"" << realId << "\"" << endl;
         }
         else
         {
-            value = new String("__NEEDS_REVIEW_ID__");
+            // Keep as placeholder - will be resolved in later iteration
+            value = new Placeholder(gen->text, gen->suffix);
+            if (lookupFromSigma)
+                cout << "    [DEFERRED] " << baseName << " - no " << gen->text << " map in sigma yet" << endl;
         }
     }
-    // E-COMMERCE: SHIPPING ADDRESS
-    else if (baseName == "shippingAddress")
-    {
-        value = new String("123 Test St,Test City,TS,12345,USA");
-    }
-    // E-COMMERCE: RATING
-    else if (baseName == "rating")
-    {
-        value = new Num(5);
-    }
-    else if (baseName == "comment")
-    {
-        value = new String("Great product, highly recommend!");
-    }
-    // E-COMMERCE: ORDER STATUS (for updateOrderStatus)
-    else if (baseName == "status")
-    {
-        // Use static counter to track order status progression
-        static int ecommerceStatusCounter = 0;
-        const char *statusSequence[] = {
-            "Processing", // 1st call
-            "Shipped",    // 2nd call
-            "Delivered"   // 3rd call
-        };
-        int seqIndex = ecommerceStatusCounter % 3;
-        value = new String(statusSequence[seqIndex]);
-        cout << "    [ORDER STATUS] Call #" << (ecommerceStatusCounter + 1)
-             << " -> status = \"" << statusSequence[seqIndex] << "\"" << endl;
-        ecommerceStatusCounter++;
-        return value; // Return early, don't cache
-    }
-    // CONSTRAINT-AWARE IDs - Look up from sigma if flag is set
-    else if (baseName == "restaurantId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_R_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] restaurantId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                // Keep as placeholder - will be resolved in later iteration
-                value = new String("__NEEDS_RESTAURANT_ID__");
-                cout << "    [DEFERRED] restaurantId - no restaurant in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_RESTAURANT_ID__");
-        }
-    }
-    else if (baseName == "menuItemId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_M_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] menuItemId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_MENUITEM_ID__");
-                cout << "    [DEFERRED] menuItemId - no menu item in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_MENUITEM_ID__");
-        }
-    }
-    else if (baseName == "orderId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_O_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] orderId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_ORDER_ID__");
-                cout << "    [DEFERRED] orderId - no order in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_ORDER_ID__");
-        }
-    }
-    // INTEGER TYPES
-    else if (baseName == "quantity")
-    {
-        value = new Num(2);
-    }
-    else if (baseName == "itemPrice")
-    {
-        value = new Num(150);
-    }
-    else if (baseName == "restaurantRating")
-    {
-        value = new Num(5);
-    }
-    else if (baseName == "deliveryRating")
-    {
-        value = new Num(4);
-    }
-    // RESTAURANT DETAILS
-    else if (baseName == "restaurantName")
-    {
-        value = new String("Test Restaurant");
-    }
-    else if (baseName == "restaurantAddress")
-    {
-        value = new String("123 Restaurant Street");
-    }
-    else if (baseName == "restaurantContact")
-    {
-        value = new String("restaurant@test.com");
-    }
-    // MENU ITEM DETAILS
-    else if (baseName == "itemName")
-    {
-        value = new String("Delicious Dish");
-    }
-    else if (baseName == "itemDescription")
-    {
-        value = new String("A very tasty menu item");
-    }
-    else if (baseName == "itemCategory")
-    {
-        value = new String("Main Course");
-    }
-    // ORDER & DELIVERY DETAILS
-    else if (baseName == "deliveryAddress")
-    {
-        value = new String("456 Customer Lane, Apt 7");
-    }
-    else if (baseName == "paymentMethod")
-    {
-        value = new String("card");
-    }
-
-    else if (baseName == "orderStatus")
-    {
-        // Use static counter to track order status progression
-        // This counter resets implicitly when the program restarts
-        static int orderStatusCounter = 0;
-
-        // Status sequence for complete order flow:
-        // Owner calls: accepted -> preparing -> ready
-        // Agent calls: picked_up -> delivered
-        const char *statusSequence[] = {
-            "accepted",  // 1st call (owner accepts)
-            "preparing", // 2nd call (owner starts preparing)
-            "ready",     // 3rd call (owner marks ready)
-            "picked_up", // 4th call (agent picks up)
-            "delivered"  // 5th call (agent delivers)
-        };
-
-        int seqIndex = orderStatusCounter % 5;
-        value = new String(statusSequence[seqIndex]);
-
-        cout << "    [ORDER STATUS] Call #" << (orderStatusCounter + 1)
-             << " (index=" << index << ") -> status = \"" << statusSequence[seqIndex] << "\"" << endl;
-
-        orderStatusCounter++;
-
-        // DON'T cache this value - each call needs a different status
-        // Return early to skip the caching at the end of the function
-        return value;
-    }
-    // REVIEW DETAILS
-    else if (baseName == "reviewComment")
-    {
-        value = new String("Great food and fast delivery!");
-    }
-
-    // ========================================
-    // LIBRARY: Book fields (MOVED BEFORE GENERIC FALLBACK)
-    // ========================================
-    else if (baseName == "bookTitle")
-    {
-        static int bookCounter = 0;
-        value = new String("Test Book " + to_string(++bookCounter));
-    }
-    else if (baseName == "bookAuthor")
-    {
-        value = new String("Test Author");
-    }
-    else if (baseName == "bookDesc")
-    {
-        value = new String("A comprehensive test book description");
-    }
-    else if (baseName == "bookCode")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_B_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] bookCode = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_BOOK_CODE__");
-                cout << "    [DEFERRED] bookCode - no book in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_BOOK_CODE__");
-        }
-    }
-
-    // ========================================
-    // LIBRARY: Student fields
-    // ========================================
-    else if (baseName == "studentName")
-    {
-        static int studentNameCounter = 0;
-        value = new String("Test Student " + to_string(++studentNameCounter));
-    }
-    else if (baseName == "studentEmail")
-    {
-        static int studentEmailCounter = 0;
-        value = new String("student" + to_string(++studentEmailCounter) + "@library.edu");
-    }
-    else if (baseName == "studentPhone")
-    {
-        static int phoneCounter = 0;
-        value = new String("555-000-" + to_string(1000 + phoneCounter++));
-    }
-    else if (baseName == "studentId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_S_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] studentId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_STUDENT_ID__");
-                cout << "    [DEFERRED] studentId - no student in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_STUDENT_ID__");
-        }
-    }
-
-    // ========================================
-    // LIBRARY: Request/Loan fields
-    // ========================================
-    else if (baseName == "requestId")
-    {
-        if (lookupFromSigma)
-        {
-            string realId = findKeyFromMapInSigma("tmp_Req_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] requestId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_REQUEST_ID__");
-                cout << "    [DEFERRED] requestId - no request in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_REQUEST_ID__");
-        }
-    }
-    else if (baseName == "loanId")
+    else
     {
-        if (lookupFromSigma)
+        value = gen->generate(index);
+        if (!gen->cache)
         {
-            string realId = findKeyFromMapInSigma("tmp_Loans_");
-            if (!realId.empty())
-            {
-                value = new String(realId);
-                cout << "    [RESOLVED from sigma] loanId = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                value = new String("__NEEDS_LOAN_ID__");
-                cout << "    [DEFERRED] loanId - no loan in sigma yet" << endl;
-            }
-        }
-        else
-        {
-            value = new String("__NEEDS_LOAN_ID__");
+            // Status progressions: DON'T cache, each call needs the next value
+            cout << "    [" << baseName << "] Call #" << gen->counter
+                 << " -> \"" << value->as<String>()->value << "\"" << endl;
+            return value;
         }
     }
-    else if (baseName == "startDate")
-    {
-        // Generate future date for loan start
-        static int dateOffset = 0;
-        value = new String("2025-02-" + to_string(10 + (dateOffset++ % 15)) + "T00:00:00.000Z");
-    }
-    else if (baseName == "endDate")
-    {
-        // Generate date 14 days after start date
-        static int endDateOffset = 0;
-        value = new String("2025-02-" + to_string(24 + (endDateOffset++ % 5)) + "T00:00:00.000Z");
-    }
-
-    // ========================================
-    // SERVEEZ APP VARIABLES (unique per test — cached so all occurrences in one test share same value)
-    // ========================================
-    else if (baseName == "userEmail")
-    {
-        static int svzUserCounter = 0;
-        value = new String("testuser" + to_string(++svzUserCounter) + "@serveez.com");
-    }
-    else if (baseName == "adminEmail")
-    {
-        static int svzAdminCounter = 0;
-        value = new String("admin" + to_string(++svzAdminCounter) + "@serveez.com");
-    }
-    else if (baseName == "provEmail")
-    {
-        static int svzProvCounter = 0;
-        value = new String("provider" + to_string(++svzProvCounter) + "@serveez.com");
-    }
-    else if (baseName == "catName")
-    {
-        static int svzCatCounter = 0;
-        value = new String("TestCategory" + to_string(++svzCatCounter));
-    }
-    else if (baseName == "listingTitle")
-    {
-        static int svzListingCounter = 0;
-        value = new String("TestListing" + to_string(++svzListingCounter));
-    }
-
-    // ========================================
-    // GENERIC FALLBACK (MUST BE LAST!)
-    // ========================================
-    else
-    {
-        value = generateRealisticValue(varName, index);
-    }
-
-    // Cache the value if generated
-    if (value != nullptr)
-    {
-        baseNameToValue[baseName] = value;
-    }
 
+    baseNameToValue[baseName] = value;
     return value;
 }
 
@@ -1177,14 +494,10 @@ bool hasUnresolvedPlaceholders(const Program &prog)
     {
         if (stmt->statementType == StmtType::ASSIGN)
         {
-            const Assign *assign = dynamic_cast<const Assign *>(stmt.get());
-            if (assign && assign->right->exprType == ExprType::STRING)
+            const Assign *assign = stmt->as<Assign>();
+            if (assign && assign->right->as<Placeholder>())
             {
-                const String *str = dynamic_cast<const String *>(assign->right.get());
-                if (str && (str->value.find("__NEEDS_") == 0))
-                {
-                    return true;
-                }
+                return true;
             }
         }
     }
@@ -1199,156 +512,21 @@ void resolvePlaceholdersInPlace(vector<Expr *> &concreteVals,
 {
     for (size_t i = 0; i < concreteVals.size(); i++)
     {
-        if (concreteVals[i]->exprType != ExprType::STRING)
-            continue;
-
-        String *strVal = dynamic_cast<String *>(concreteVals[i]);
-        if (!strVal)
+        Placeholder *ph = concreteVals[i] ? concreteVals[i]->as<Placeholder>() : nullptr;
+        if (!ph)
             continue;
 
-        if (strVal->value == "__NEEDS_RESTAURANT_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_R_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                // KEEP THE PLACEHOLDER - don't convert to fallback!
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_MENUITEM_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_M_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                // KEEP THE PLACEHOLDER
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_ORDER_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_O_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                // KEEP THE PLACEHOLDER
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_PRODUCT_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_P_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_CART_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_C_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_REVIEW_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_Rev_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        // LIBRARY CHECK
-        else if (strVal->value == "__NEEDS_BOOK_CODE__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_B_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_STUDENT_ID__")
+        string realId = tester->findLatestKey(ph->global);
+        if (!realId.empty())
         {
-            string realId = tester->findKeyFromMapInSigma("tmp_S_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
+            delete concreteVals[i];
+            concreteVals[i] = new String(realId);
+            cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
         }
-        else if (strVal->value == "__NEEDS_REQUEST_ID__")
-        {
-            string realId = tester->findKeyFromMapInSigma("tmp_Req_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
-        }
-        else if (strVal->value == "__NEEDS_LOAN_ID__")
+        else
         {
-            string realId = tester->findKeyFromMapInSigma("tmp_Loans_");
-            if (!realId.empty())
-            {
-                delete concreteVals[i];
-                concreteVals[i] = new String(realId);
-                cout << "    [RESOLVED] " << varNames[i] << " = \"" << realId << "\"" << endl;
-            }
-            else
-            {
-                cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
-            }
+            // KEEP THE PLACEHOLDER - don't convert to fallback!
+            cout << "    [STILL PENDING] " << varNames[i] << " - keeping placeholder for next iteration" << endl;
         }
     }
 }
@@ -1360,131 +538,46 @@ void resolvePlaceholdersInProgram(Program &prog, Tester *tester)
 
     // We need to modify the statements vector, but it's const
     // So we'll cast away const (this is safe since we own the Program)
-    auto &stmts = const_cast<vector<unique_ptr<Stmt>> &>(prog.statements);
+    auto &stmts = const_cast<vector<Ref<Stmt>> &>(prog.statements);
 
     for (size_t i = 0; i < stmts.size(); i++)
     {
-        if (stmts[i]->statementType == StmtType::ASSIGN)
-        {
-            Assign *assign = dynamic_cast<Assign *>(stmts[i].get());
-            if (assign && assign->right->exprType == ExprType::STRING)
-            {
-                const String *str = dynamic_cast<const String *>(assign->right.get());
-                if (str)
-                {
-                    string newValue = "";
+        if (stmts[i]->statementType != StmtType::ASSIGN)
+            continue;
 
-                    if (str->value == "__NEEDS_RESTAURANT_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_R_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_restaurant_available"; // Final fallback
-                        }
-                    }
-                    else if (str->value == "__NEEDS_MENUITEM_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_M_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_menuitem_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_ORDER_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_O_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_order_available";
-                        }
-                    }
-                    // ecommerce IDs
-                    else if (str->value == "__NEEDS_PRODUCT_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_P_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_product_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_CART_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_C_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_cart_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_REVIEW_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_Rev_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_review_available";
-                        }
-                    }
-                    // LIBRARY IDs
-                    else if (str->value == "__NEEDS_BOOK_CODE__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_B_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_book_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_STUDENT_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_S_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_student_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_REQUEST_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_Req_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_request_available";
-                        }
-                    }
-                    else if (str->value == "__NEEDS_LOAN_ID__")
-                    {
-                        newValue = tester->findKeyFromMapInSigma("tmp_Loans_");
-                        if (newValue.empty())
-                        {
-                            newValue = "no_loan_available";
-                        }
-                    }
+        const Assign *assign = stmts[i]->as<Assign>();
+        const Placeholder *ph = assign ? assign->right->as<Placeholder>() : nullptr;
+        if (!ph)
+            continue;
 
-                    if (!newValue.empty())
-                    {
-                        const Var *leftVar = dynamic_cast<const Var *>(assign->left.get());
-                        string varName = leftVar ? leftVar->name : "unknown";
-                        cout << "    [AST RESOLVED] " << varName << " = \"" << newValue << "\"" << endl;
-
-                        // Create a new statement with the resolved value
-                        auto newLeft = make_unique<Var>(varName);
-                        auto newRight = make_unique<String>(newValue);
-                        stmts[i] = make_unique<Assign>(std::move(newLeft), std::move(newRight));
-                    }
-                }
-            }
+        string newValue = tester->findLatestKey(ph->global);
+        if (newValue.empty())
+        {
+            newValue = ph->fallback(); // Final fallback
         }
+
+        const Var *leftVar = assign->left->as<Var>();
+        string varName = leftVar ? leftVar->name : "unknown";
+        cout << "    [AST RESOLVED] " << varName << " = \"" << newValue << "\"" << endl;
+
+        // Create a new statement with the resolved value
+        auto newLeft = make_unique<Var>(varName);
+        auto newRight = make_unique<String>(newValue);
+        stmts[i] = make_unique<Assign>(std::move(newLeft), std::move(newRight));
     }
 }
 bool isPathConstraintUnsat(SEE &see, const std::vector<std::string> &sequence)
 {
-    vector<Expr *> &pc = see.getPathConstraint();
+    const vector<Ref<Expr>> &pc = see.getPathConstraint();
 
     bool hasConcretelyFalse = false;
 
-    for (Expr *constraint : pc)
+    for (const Ref<Expr> &constraint : pc)
     {
         // Check for BoolConst(false)
         if (constraint->exprType == ExprType::BOOL_CONST)
         {
-            BoolConst *bc = dynamic_cast<BoolConst *>(constraint);
+            BoolConst *bc = constraint->as<BoolConst>();
             if (bc && !bc->value)
             {
                 hasConcretelyFalse = true;
@@ -1494,7 +587,7 @@ bool isPathConstraintUnsat(SEE &see, const std::vector<std::string> &sequence)
         // Check for Num(0) which also represents false
         else if (constraint->exprType == ExprType::NUM)
         {
-            Num *num = dynamic_cast<Num *>(constraint);
+            Num *num = constraint->as<Num>();
             if (num && num->value == 0)
             {
                 hasConcretelyFalse = true;
@@ -1513,8 +606,17 @@ bool isPathConstraintUnsat(SEE &see, const std::vector<std::string> &sequence)
     std::cout << "\n[UNSAT-CHECK] Path constraint contains FALSE - checking dependencies..." << std::endl;
     return isSequenceTrulyUnsat(sequence);
 }
+bool Tester::checkpointsEnabled = false;
+bool Tester::simplifyEnabled = true;
+bool Tester::mirrorEnabled = false;
+double Tester::mirrorVerifyRate = 0.0;
+
 unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *> ConcreteVals, ValueEnvironment *ve)
 {
+    TRACE_SPAN(span, "generateCTC", "tester");
+    span.arg("concreteValues", (long long)ConcreteVals.size());
+    if (Metrics::enabled)
+        Metrics::countCTCIteration();
     cout << "\n========================================" << endl;
     cout << ">>> generateCTC: Starting iteration" << endl;
     cout << "========================================" << endl;
@@ -1539,6 +641,8 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
     cout << "\n>>> generateCTC: STEP 2 - Running symbolic execution" << endl;
     SymbolTable st(nullptr);
     see.execute(*rewritten, st);
+    // Solves from here on encode maps over the keys sigma now holds
+    solver.useKeysFrom(see.getSigma());
 
     // NEW: STEP 2a - Check if path constraint is satisfiable
     if (isPathConstraintUnsat(see, currentApiSequence))
@@ -1594,29 +698,25 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
     {
         if (stmt->statementType == StmtType::ASSIGN)
         {
-            const Assign *assign = dynamic_cast<const Assign *>(stmt.get());
+            const Assign *assign = stmt->as<Assign>();
             if (!assign)
                 continue;
 
-            const Var *leftVar = dynamic_cast<const Var *>(assign->left.get());
+            const Var *leftVar = assign->left->as<Var>();
             if (!leftVar)
                 continue;
 
             // Skip input statements
             if (assign->right->exprType == ExprType::FUNCCALL)
             {
-                const FuncCall *fc = dynamic_cast<const FuncCall *>(assign->right.get());
+                const FuncCall *fc = assign->right->as<FuncCall>();
                 if (fc && fc->name == "input")
                     continue;
             }
 
             // Skip placeholder values - don't reuse them!
-            if (assign->right->exprType == ExprType::STRING)
-            {
-                const String *str = dynamic_cast<const String *>(assign->right.get());
-                if (str && str->value.find("__NEEDS_") == 0)
-                    continue;
-            }
+            if (assign->right->as<Placeholder>())
+                continue;
 
             string baseName = extractBaseName(leftVar->name);
 
@@ -1635,15 +735,15 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
         if (!isInputStmt(*stmt))
             continue;
 
-        const Assign *assign = dynamic_cast<const Assign *>(stmt.get());
-        const Var *leftVar = dynamic_cast<const Var *>(assign->left.get());
+        const Assign *assign = stmt->as<Assign>();
+        const Var *leftVar = assign->left->as<Var>();
         string varName = leftVar ? leftVar->name : "unknown";
         string baseName = extractBaseName(varName);
 
         Expr *value = nullptr;
 
         // For IDs that need sigma lookup, ALWAYS try sigma first
-        if (needsSigmaLookup(baseName))
+        if (valueGenerators->isSigmaKey(baseName))
         {
             value = generateValueForBaseName(baseName, varName, inputIndex, baseNameToValue, true);
             cout << "    " << varName << " = ";
@@ -1653,11 +753,11 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
             Expr *existing = baseNameToValue[baseName];
             if (existing->exprType == ExprType::STRING)
             {
-                value = new String(dynamic_cast<String *>(existing)->value);
+                value = new String(existing->as<String>()->value);
             }
             else if (existing->exprType == ExprType::NUM)
             {
-                value = new Num(dynamic_cast<Num *>(existing)->value);
+                value = new Num(existing->as<Num>()->value);
             }
             else
             {
@@ -1677,11 +777,11 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
 
         if (value->exprType == ExprType::STRING)
         {
-            cout << "\"" << dynamic_cast<String *>(value)->value << "\"" << endl;
+            cout << "\"" << value->as<String>()->value << "\"" << endl;
         }
         else if (value->exprType == ExprType::NUM)
         {
-            cout << dynamic_cast<Num *>(value)->value << endl;
+            cout << value->as<Num>()->value << endl;
         }
 
         inputIndex++;
@@ -1703,24 +803,44 @@ unique_ptr<Program> Tester::generateCTC(unique_ptr<Program> atc, vector<Expr *>
 }
 
 unique_ptr<Program> Tester::generateATC(
-    unique_ptr<Spec> spec,
-    vector<string> ts)
+    const Spec &spec,
+    const vector<string> &ts)
 {
+    Tracer::setSequence(ts);
+    TRACE_SPAN(span, "generateATC", "tester");
+
     // Store the API sequence for later use in UNSAT detection
     currentApiSequence = ts;
 
-    Program raw = genATC(*spec, ts);
+    // Resume from the longest prefix some earlier sequence checkpointed
+    string restoreId;
+    vector<Ref<Stmt>> savedPrefix;
+    const vector<Ref<Stmt>> *restorePrefix = nullptr;
+    if (checkpointsEnabled)
+    {
+        for (size_t n = ts.size(); n > 0; n--)
+        {
+            string id = checkpointId(ts, n);
+            if (SEE::checkpointPrefix(id, savedPrefix))
+            {
+                cout << "[Tester] Restoring checkpoint '" << id << "'" << endl;
+                restoreId = id;
+                restorePrefix = &savedPrefix;
+                break;
+            }
+        }
+    }
 
-    auto &mutable_stmts = const_cast<vector<unique_ptr<Stmt>> &>(raw.statements);
-    auto logicalATC = unique_ptr<Program>(new Program(std::move(mutable_stmts)));
+    // Blocks are rewritten once per spec; a sequence just stitches them
+    const ATCTemplates &templates = ATCTemplates::forSpec(spec);
+    unique_ptr<Program> testApiATC =
+        templates.instantiate(ts, checkpointsEnabled, restoreId, restorePrefix);
+    if (simplifyEnabled)
+        testApiATC = simplifyATC(*testApiATC, &templates.writeSets());
+    if (mirror)
+        mirror->setWriteSets(&templates.writeSets());
 
     PrintVisitor printer;
-
-    RewriteGlobalsVisitor rewriter;
-    rewriter.visitProgram(*logicalATC);
-
-    unique_ptr<Program> testApiATC = std::move(rewriter.rewrittenProgram);
-
     cout << "\n=== TEST-API ATC (After Rewrite) ===" << endl;
     printer.visitProgram(*testApiATC);
 
@@ -1734,7 +854,8 @@ unique_ptr<Program> Tester::rewriteATC(unique_ptr<Program> &atc, vector<Expr *>
         throw runtime_error("Empty test case but concrete values provided");
     }
 
-    vector<unique_ptr<Stmt>> newStmts;
+    // Only the input assignments change; every other statement is shared
+    vector<Ref<Stmt>> newStmts;
     int concreteValIndex = 0;
     CloneVisitor cloner;
 
@@ -1744,37 +865,35 @@ unique_ptr<Program> Tester::rewriteATC(unique_ptr<Program> &atc, vector<Expr *>
 
         if (stmt->statementType == StmtType::ASSIGN)
         {
-            Assign *assign = dynamic_cast<Assign *>(stmt.get());
+            const Assign *assign = stmt->as<Assign>();
 
             if (assign && assign->right->exprType == ExprType::FUNCCALL)
             {
-                FuncCall *fc = dynamic_cast<FuncCall *>(assign->right.get());
+                const FuncCall *fc = assign->right->as<FuncCall>();
 
                 if (fc && fc->name == "input" && fc->args.size() == 0)
                 {
                     if (concreteValIndex < ConcreteVals.size())
                     {
-                        Var *leftVarPtr = dynamic_cast<Var *>(assign->left.get());
-                        if (!leftVarPtr)
+                        if (!assign->left->is<Var>())
                         {
                             throw runtime_error("Expected Var on left side of input assignment");
                         }
-                        unique_ptr<Var> leftVar = make_unique<Var>(leftVarPtr->name);
                         unique_ptr<Expr> rightExpr = cloner.cloneExpr(ConcreteVals[concreteValIndex]);
 
-                        newStmts.push_back(make_unique<Assign>(move(leftVar), move(rightExpr)));
+                        newStmts.push_back(make_unique<Assign>(assign->left, move(rightExpr)));
                         concreteValIndex++;
                     }
                     else
                     {
-                        newStmts.push_back(cloner.cloneStmt(stmt.get()));
+                        newStmts.push_back(stmt);
                     }
                     continue;
                 }
             }
         }
 
-        newStmts.push_back(cloner.cloneStmt(stmt.get()));
+        newStmts.push_back(stmt);
     }
 
     return make_unique<Program>(move(newStmts));
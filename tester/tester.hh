@@ -8,35 +8,73 @@
 #include "../ast.hh"
 #include "../env.hh"
 #include "../see/see.hh"
+#include "../see/mirroredfunctionfactory.hh"
 #include "../see/z3solver.hh"
+#include "valuegenerators.hh"
 
 using namespace std;
 
 class Tester
 {
 private:
+    // Declared before see: SEE talks to the mirror when there is one
+    unique_ptr<MirroredFunctionFactory> mirror;
     SEE see;
     Z3Solver solver;
     vector<Expr *> pathConstraints;
     vector<string> currentApiSequence; 
+    ValueGeneratorRegistry *valueGenerators = &ValueGeneratorRegistry::forApp("");
+
+    // Off by default: backends need /api/test/checkpoint and /api/test/restore
+    static bool checkpointsEnabled;
+    // On by default: partial evaluation of test-API ATCs (atcsimplifier.hh)
+    static bool simplifyEnabled;
+    // Off by default: serve reads from a client-side mirror of the globals
+    static bool mirrorEnabled;
+    static double mirrorVerifyRate;
 public:
     // Constructor
-    Tester(FunctionFactory *functionFactory) : see(functionFactory), solver(), pathConstraints() {}
+    Tester(FunctionFactory *functionFactory)
+        : mirror(mirrorEnabled ? make_unique<MirroredFunctionFactory>(functionFactory, mirrorVerifyRate)
+                               : nullptr),
+          see(mirror ? mirror.get() : functionFactory), solver(), pathConstraints()
+    {
+        solver.setStringNamer([this](const string &var, int variant) { return solverString(var, variant); });
+    }
 
     // Main test generation methods
     void generateTest();
-    unique_ptr<Program> generateATC(unique_ptr<Spec>, vector<string>);
+    // The spec is only read; one instance can back many concurrent testers
+    unique_ptr<Program> generateATC(const Spec &spec, const vector<string> &ts);
     unique_ptr<Program> generateCTC(unique_ptr<Program>, vector<Expr *> ConcreteVals, ValueEnvironment *ve);
     unique_ptr<Program> rewriteATC(unique_ptr<Program> &, vector<Expr *> ConcreteVals);
 
+    // Checkpoint after every block and restore the longest saved prefix
+    // instead of reset-and-replay (falls back to reset when unavailable)
+    static void setCheckpointsEnabled(bool enabled) { checkpointsEnabled = enabled; }
+    static void setSimplifyEnabled(bool enabled) { simplifyEnabled = enabled; }
+    // verifyRate of mirror hits are still checked against the backend
+    static void setMirrorEnabled(bool enabled, double verifyRate = 0.0)
+    {
+        mirrorEnabled = enabled;
+        mirrorVerifyRate = verifyRate;
+    }
+
     // Helper methods for value generation
-    string findKeyFromMapInSigma(const string &prefix);
+    string findLatestKey(const string &global);
     Expr *generateValueForBaseName(const string &baseName, const string &varName,
                                    int index, map<string, Expr *> &baseNameToValue,
                                    bool lookupFromSigma = false);
+    // Strings the solver invents for equality-only variables, from the value tables
+    string solverString(const string &varName, int variant) const;
+
+    // The app's value tables (defaults to the common table alone)
+    void setValueGenerators(ValueGeneratorRegistry *registry) { valueGenerators = registry; }
+    ValueGeneratorRegistry &getValueGenerators() { return *valueGenerators; }
 
     // Getters for testing
     SEE &getSEE() { return see; }
+    MirroredFunctionFactory *getMirror() { return mirror.get(); }
     Z3Solver &getSolver() { return solver; }
     vector<Expr *> &getPathConstraints() { return pathConstraints; }
     const vector<string> &getApiSequence() const { return currentApiSequence; } 
@@ -0,0 +1,383 @@
+#include "valuegenerators.hh"
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+/* ============================================================
+ * Table helpers
+ * ============================================================ */
+
+static ValueGenerator fixedStr(const string &value)
+{
+    ValueGenerator g;
+    g.kind = GenKind::FIXED;
+    g.text = value;
+    return g;
+}
+
+static ValueGenerator fixedNum(int value)
+{
+    ValueGenerator g;
+    g.kind = GenKind::FIXED;
+    g.isNum = true;
+    g.number = value;
+    return g;
+}
+
+static ValueGenerator sequence(const string &prefix, int start, const string &suffix = "", int modulo = 0)
+{
+    ValueGenerator g;
+    g.kind = GenKind::SEQUENCE;
+    g.text = prefix;
+    g.number = start;
+    g.suffix = suffix;
+    g.modulo = modulo;
+    return g;
+}
+
+static ValueGenerator perActor(const string &prefix, const string &suffix = "", int width = 0)
+{
+    ValueGenerator g;
+    g.kind = GenKind::PER_ACTOR;
+    g.text = prefix;
+    g.suffix = suffix;
+    g.width = width;
+    return g;
+}
+
+static ValueGenerator pooled(const vector<string> &corpus, bool cache)
+{
+    ValueGenerator g;
+    g.kind = GenKind::POOLED;
+    g.corpus = corpus;
+    g.cache = cache;
+    return g;
+}
+
+static ValueGenerator sigmaKey(const string &global, const string &placeholder)
+{
+    ValueGenerator g;
+    g.kind = GenKind::SIGMA_KEY;
+    g.text = global;
+    g.suffix = placeholder;
+    return g;
+}
+
+/* ============================================================
+ * App data tables
+ * ============================================================ */
+
+// Generic names shared by several specs (one value per input slot)
+const vector<ValueGenEntry> &commonValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"email", perActor("testuser", "@example.com")},
+        {"password", perActor("Password", "!")},
+        {"fullName", perActor("Test User ")},
+        {"mobile", perActor("555000", "", 4)},
+        {"token", perActor("token_")},
+        {"name", perActor("TestName")},
+        {"address", perActor("123 Test Street ")},
+        {"contact", perActor("contact", "@test.com")},
+    };
+    return table;
+}
+
+const vector<ValueGenEntry> &restaurantValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        // Owner / customer / agent roles
+        {"ownerEmail", fixedStr("owner@example.com")},
+        {"ownerPassword", fixedStr("OwnerPass1!")},
+        {"ownerFullName", fixedStr("Test Owner")},
+        {"ownerMobile", fixedStr("5550000001")},
+        {"customerEmail", fixedStr("customer@example.com")},
+        {"customerPassword", fixedStr("CustomerPass1!")},
+        {"customerFullName", fixedStr("Test Customer")},
+        {"customerMobile", fixedStr("5550000002")},
+        {"wrongPassword", fixedStr("WrongPass123!")},
+        {"agentEmail", fixedStr("agent@example.com")},
+        {"agentPassword", fixedStr("AgentPass1!")},
+        {"agentFullName", fixedStr("Test Agent")},
+        {"agentMobile", fixedStr("5550000003")},
+
+        // Constraint-aware IDs
+        {"restaurantId", sigmaKey("R", "__NEEDS_RESTAURANT_ID__")},
+        {"menuItemId", sigmaKey("M", "__NEEDS_MENUITEM_ID__")},
+        {"orderId", sigmaKey("O", "__NEEDS_ORDER_ID__")},
+
+        {"quantity", fixedNum(2)},
+        {"itemPrice", fixedNum(150)},
+        {"restaurantRating", fixedNum(5)},
+        {"deliveryRating", fixedNum(4)},
+        {"restaurantName", fixedStr("Test Restaurant")},
+        {"restaurantAddress", fixedStr("123 Restaurant Street")},
+        {"restaurantContact", fixedStr("restaurant@test.com")},
+        {"itemName", fixedStr("Delicious Dish")},
+        {"itemDescription", fixedStr("A very tasty menu item")},
+        {"itemCategory", fixedStr("Main Course")},
+        {"deliveryAddress", fixedStr("456 Customer Lane, Apt 7")},
+        {"paymentMethod", fixedStr("card")},
+        {"reviewComment", fixedStr("Great food and fast delivery!")},
+
+        // Owner: accepted -> preparing -> ready, agent: picked_up -> delivered
+        {"orderStatus", pooled({"accepted", "preparing", "ready", "picked_up", "delivered"}, false)},
+    };
+    return table;
+}
+
+const vector<ValueGenEntry> &ecommerceValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"buyerEmail", fixedStr("buyer@example.com")},
+        {"buyerPassword", fixedStr("BuyerPass123!")},
+        {"buyerFullName", fixedStr("Test Buyer")},
+        {"sellerEmail", fixedStr("seller@example.com")},
+        {"sellerPassword", fixedStr("SellerPass123!")},
+        {"sellerFullName", fixedStr("Test Seller")},
+        {"storeName", fixedStr("Test Store")},
+        {"storeDescription", fixedStr("A quality test store")},
+        {"title", fixedStr("Test Product")},
+        {"description", fixedStr("A great test product description")},
+        {"category", fixedStr("Electronics")},
+        {"price", fixedNum(99)},
+
+        {"productId", sigmaKey("P", "__NEEDS_PRODUCT_ID__")},
+        {"cartId", sigmaKey("C", "__NEEDS_CART_ID__")},
+        {"reviewId", sigmaKey("Rev", "__NEEDS_REVIEW_ID__")},
+
+        {"shippingAddress", fixedStr("123 Test St,Test City,TS,12345,USA")},
+        {"rating", fixedNum(5)},
+        {"comment", fixedStr("Great product, highly recommend!")},
+        {"status", pooled({"Processing", "Shipped", "Delivered"}, false)},
+    };
+    return table;
+}
+
+const vector<ValueGenEntry> &libraryValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"bookTitle", sequence("Test Book ", 1)},
+        {"bookAuthor", fixedStr("Test Author")},
+        {"bookDesc", fixedStr("A comprehensive test book description")},
+        {"bookCode", sigmaKey("B", "__NEEDS_BOOK_CODE__")},
+
+        {"studentName", sequence("Test Student ", 1)},
+        {"studentEmail", sequence("student", 1, "@library.edu")},
+        {"studentPhone", sequence("555-000-", 1000)},
+        {"studentId", sigmaKey("S", "__NEEDS_STUDENT_ID__")},
+
+        {"requestId", sigmaKey("Req", "__NEEDS_REQUEST_ID__")},
+        {"loanId", sigmaKey("Loans", "__NEEDS_LOAN_ID__")},
+        {"startDate", sequence("2025-02-", 10, "T00:00:00.000Z", 15)},
+        {"endDate", sequence("2025-02-", 24, "T00:00:00.000Z", 5)},
+    };
+    return table;
+}
+
+const vector<ValueGenEntry> &tripVaultValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"userEmail", sequence("traveler", 1, "@tripvault.test")},
+        {"userPassword", fixedStr("TravelPass1!")},
+        {"user2Email", sequence("companion", 1, "@tripvault.test")},
+        {"user2Password", fixedStr("CompanionPass1!")},
+        {"adminEmail", sequence("tripadmin", 1, "@tripvault.test")},
+        {"memberEmail", sequence("member", 1, "@tripvault.test")},
+
+        {"tripId", sigmaKey("Trips", "__NEEDS_TRIP_ID__")},
+        {"expenseId", sigmaKey("E", "__NEEDS_EXPENSE_ID__")},
+        {"proposalId", sigmaKey("Proposals", "__NEEDS_PROPOSAL_ID__")},
+
+        {"tripName", sequence("Test Trip ", 1)},
+        {"destination", fixedStr("Lisbon")},
+        {"expenseTitle", fixedStr("Group Dinner")},
+        {"amount", fixedNum(120)},
+        // The backend's expense categories
+        {"category", pooled({"food", "travel", "accommodation", "others"}, true)},
+        {"proposalTitle", fixedStr("Day Trip Proposal")},
+        {"proposalType", fixedStr("activity")},
+    };
+    return table;
+}
+
+const vector<ValueGenEntry> &ghostSocketValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"userEmail", sequence("ghost", 1, "@ghostsocket.test")},
+        {"user2Email", sequence("peer", 1, "@ghostsocket.test")},
+        // Chosen by the client when it registers the device
+        {"devId", sequence("device-", 1)},
+        {"sessId", sigmaKey("S", "__NEEDS_SESSION_ID__")},
+    };
+    return table;
+}
+
+// Unique per test, cached so every occurrence in one test shares the value
+const vector<ValueGenEntry> &serveezValueTable()
+{
+    static const vector<ValueGenEntry> table = {
+        {"userEmail", sequence("testuser", 1, "@serveez.com")},
+        {"adminEmail", sequence("admin", 1, "@serveez.com")},
+        {"provEmail", sequence("provider", 1, "@serveez.com")},
+        {"catName", sequence("TestCategory", 1)},
+        {"listingTitle", sequence("TestListing", 1)},
+    };
+    return table;
+}
+
+/* ============================================================
+ * ValueGenerator
+ * ============================================================ */
+
+static string padDigits(int n, int width)
+{
+    string s = to_string(n);
+    if (width <= 0)
+        return s;
+    while ((int)s.length() < width)
+        s = "0" + s;
+    return s.substr(s.length() - width);
+}
+
+Expr *ValueGenerator::generate(int index) const
+{
+    switch (kind)
+    {
+    case GenKind::FIXED:
+        if (isNum)
+            return new Num(number);
+        return new String(text);
+    case GenKind::SEQUENCE:
+    {
+        int n = number + (modulo > 0 ? counter % modulo : counter);
+        counter++;
+        if (isNum)
+            return new Num(n);
+        return new String(text + to_string(n) + suffix);
+    }
+    case GenKind::PER_ACTOR:
+        return new String(text + padDigits(index, width) + suffix);
+    case GenKind::POOLED:
+    {
+        const string &v = corpus[counter % corpus.size()];
+        counter++;
+        return new String(v);
+    }
+    case GenKind::SIGMA_KEY:
+        break;
+    }
+    throw runtime_error("ValueGenerator: SIGMA_KEY values come from sigma");
+}
+
+Expr *ValueGenerator::generateVariant(int index, int variant) const
+{
+    switch (kind)
+    {
+    case GenKind::FIXED:
+    {
+        if (variant == 0)
+            return generate(index);
+        if (isNum)
+            return new Num(number + variant);
+        // Keep e-mail addresses well formed: owner@x.com -> owner+2@x.com
+        size_t at = text.find('@');
+        if (at != string::npos)
+            return new String(text.substr(0, at) + "+" + to_string(variant) + text.substr(at));
+        return new String(text + " " + to_string(variant));
+    }
+    case GenKind::SEQUENCE:
+        return generate(index);
+    case GenKind::PER_ACTOR:
+        return generate(variant * 100 + index);
+    case GenKind::POOLED:
+        return new String(corpus[variant % corpus.size()]);
+    case GenKind::SIGMA_KEY:
+        return new Placeholder(text, suffix);
+    }
+    return nullptr;
+}
+
+string ValueGenerator::sample(int variant) const
+{
+    if (isNum || kind == GenKind::SIGMA_KEY)
+        return "";
+    if (kind == GenKind::SEQUENCE)
+        return text + to_string(number + (modulo > 0 ? variant % modulo : variant)) + suffix;
+    unique_ptr<Expr> value(generateVariant(0, variant));
+    const String *s = value ? value->as<String>() : nullptr;
+    return s ? s->value : "";
+}
+
+/* ============================================================
+ * ValueGeneratorRegistry
+ * ============================================================ */
+
+void ValueGeneratorRegistry::add(const string &baseName, const ValueGenerator &gen)
+{
+    auto it = ids.find(baseName);
+    if (it != ids.end())
+    {
+        generators[it->second] = gen;
+        return;
+    }
+    ids[baseName] = generators.size();
+    generators.push_back(gen);
+}
+
+void ValueGeneratorRegistry::addTable(const vector<ValueGenEntry> &table)
+{
+    for (const auto &entry : table)
+        add(entry.baseName, entry.gen);
+}
+
+size_t ValueGeneratorRegistry::intern(const string &baseName) const
+{
+    auto it = ids.find(baseName);
+    return it == ids.end() ? npos : it->second;
+}
+
+const ValueGenerator *ValueGeneratorRegistry::find(size_t id) const
+{
+    return id < generators.size() ? &generators[id] : nullptr;
+}
+
+bool ValueGeneratorRegistry::isSigmaKey(const string &baseName) const
+{
+    const ValueGenerator *gen = find(baseName);
+    return gen && gen->kind == GenKind::SIGMA_KEY;
+}
+
+Expr *ValueGeneratorRegistry::fallback(int index)
+{
+    return new String("value_" + to_string(index));
+}
+
+ValueGeneratorRegistry &ValueGeneratorRegistry::forApp(const string &app)
+{
+    // Built together on first use and never modified after, only their counters
+    static map<string, ValueGeneratorRegistry> registries = []
+    {
+        const map<string, const vector<ValueGenEntry> *> tables = {
+            {"", nullptr},
+            {"restaurant", &restaurantValueTable()},
+            {"ecommerce", &ecommerceValueTable()},
+            {"library", &libraryValueTable()},
+            {"tripvault", &tripVaultValueTable()},
+            {"ghostsocket", &ghostSocketValueTable()},
+            {"serveez", &serveezValueTable()},
+        };
+        map<string, ValueGeneratorRegistry> built;
+        for (const auto &entry : tables)
+        {
+            ValueGeneratorRegistry &r = built[entry.first];
+            r.addTable(commonValueTable());
+            if (entry.second)
+                r.addTable(*entry.second);
+        }
+        return built;
+    }();
+    auto it = registries.find(app);
+    return it != registries.end() ? it->second : registries.at("");
+}
@@ -0,0 +1,101 @@
+#ifndef VALUEGENERATORS_HH
+#define VALUEGENERATORS_HH
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ast.hh"
+
+using namespace std;
+
+/**
+ * Value generators for input() slots, keyed by variable base name
+ * ("ownerEmail", "bookTitle", ...). Each app contributes a data table
+ * (see valuegenerators.cc) and gets its own registry, so two apps can
+ * give the same name different values; adding an app means adding a
+ * table, not another branch in the Tester.
+ */
+enum class GenKind
+{
+    FIXED,      // same value every time
+    SEQUENCE,   // prefix + (start + counter [% modulo]) + suffix, counter per generator
+    PER_ACTOR,  // prefix + input index (zero padded to `width`) + suffix
+    POOLED,     // next entry of a corpus, round robin
+    SIGMA_KEY   // key of the latest materialized tmp_G_i map, else a placeholder
+};
+
+struct ValueGenerator
+{
+    GenKind kind;
+    bool isNum = false;
+    string text;   // FIXED value / prefix / SIGMA_KEY global ("P")
+    string suffix; // SEQUENCE/PER_ACTOR suffix, SIGMA_KEY placeholder marker
+    int number = 0;  // FIXED numeric value / SEQUENCE start
+    int modulo = 0;  // SEQUENCE wrap-around (0 = none)
+    int width = 0;   // PER_ACTOR: zero pad and keep the last `width` digits
+    vector<string> corpus;
+    bool cache = true; // false: every slot gets a fresh value (status progressions)
+
+    mutable int counter = 0; // unsynchronized: generators are used from one thread
+
+    // Concrete value for one slot; `index` is the input slot (actor) number.
+    // Not valid for SIGMA_KEY, which needs sigma (see Tester).
+    Expr *generate(int index) const;
+
+    // Value for the `variant`-th of N distinct values (see sample)
+    Expr *generateVariant(int index, int variant) const;
+
+    // String for the `variant`-th distinct value a solver model invents;
+    // empty for numeric and SIGMA_KEY generators. Leaves `counter` alone.
+    string sample(int variant) const;
+};
+
+// Row of an app's data table
+struct ValueGenEntry
+{
+    const char *baseName;
+    ValueGenerator gen;
+};
+
+class ValueGeneratorRegistry
+{
+private:
+    // Interned base names: name -> slot in `generators`
+    unordered_map<string, size_t> ids;
+    vector<ValueGenerator> generators;
+
+public:
+    static const size_t npos = (size_t)-1;
+
+    // A name added again takes the new generator (app tables override
+    // the common one)
+    void add(const string &baseName, const ValueGenerator &gen);
+    void addTable(const vector<ValueGenEntry> &table);
+
+    // O(1): id of an interned base name, npos when unknown
+    size_t intern(const string &baseName) const;
+    const ValueGenerator *find(size_t id) const;
+    const ValueGenerator *find(const string &baseName) const { return find(intern(baseName)); }
+
+    bool isSigmaKey(const string &baseName) const;
+
+    // Unknown base names: "value_<index>"
+    static Expr *fallback(int index);
+
+    // Process-wide registry of an app ("library", ...): the common table
+    // plus the app's own; any other name gets the common table alone.
+    // Shared so the SEQUENCE/POOLED counters keep advancing across the
+    // app's tests in one run; not safe to use from several threads.
+    static ValueGeneratorRegistry &forApp(const string &app);
+};
+
+// Per-app data tables
+const vector<ValueGenEntry> &commonValueTable();
+const vector<ValueGenEntry> &restaurantValueTable();
+const vector<ValueGenEntry> &ecommerceValueTable();
+const vector<ValueGenEntry> &libraryValueTable();
+const vector<ValueGenEntry> &tripVaultValueTable();
+const vector<ValueGenEntry> &ghostSocketValueTable();
+const vector<ValueGenEntry> &serveezValueTable();
+
+#endif
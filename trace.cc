@@ -0,0 +1,170 @@
+#include "trace.hh"
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+/* ============================================================
+ * Per-thread buffers
+ * ============================================================ */
+
+namespace {
+
+struct TraceEvent {
+    string name;
+    const char* category;
+    double ts;      // microseconds since start()
+    double dur;
+    string args;    // JSON members without braces
+};
+
+struct ThreadBuffer {
+    int tid = 0;
+    vector<TraceEvent> events;
+    vector<string> blocks;
+    string sequence;    // blocks joined, as a span attribute
+    string block;       // "<index>:<name>"
+};
+
+mutex registryLock;
+vector<shared_ptr<ThreadBuffer>> buffers;   // outlive their threads
+string outputPath;
+chrono::steady_clock::time_point origin;
+
+ThreadBuffer& localBuffer() {
+    thread_local shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = make_shared<ThreadBuffer>();
+        lock_guard<mutex> guard(registryLock);
+        buffer->tid = (int)buffers.size() + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+double nowMicros() {
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - origin).count();
+}
+
+void appendArg(string& args, const char* key, const string& jsonValue) {
+    if (!args.empty()) args += ',';
+    args += json(key).dump();
+    args += ':';
+    args += jsonValue;
+}
+
+} // namespace
+
+/* ============================================================
+ * Tracer
+ * ============================================================ */
+
+void Tracer::start(const string& path) {
+    static bool hooked = false;
+    outputPath = path;
+    origin = chrono::steady_clock::now();
+    enabled = true;
+    if (!hooked) {
+        hooked = true;
+        atexit([] { Tracer::finish(); });
+    }
+}
+
+void Tracer::finish() {
+    if (!enabled) return;
+    enabled = false;
+
+    ofstream out(outputPath);
+    if (!out) {
+        cerr << "[Trace] Cannot write " << outputPath << endl;
+        return;
+    }
+
+    lock_guard<mutex> guard(registryLock);
+    size_t count = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"testgen\"}}";
+    for (const auto& buffer : buffers) {
+        out << ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+        for (const auto& e : buffer->events) {
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"name\":" << json(e.name).dump()
+                << ",\"cat\":\"" << e.category << "\""
+                << ",\"ts\":" << e.ts << ",\"dur\":" << e.dur
+                << ",\"args\":{" << e.args << "}}";
+            count++;
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}\n";
+    cerr << "[Trace] Wrote " << count << " spans to " << outputPath << endl;
+}
+
+bool Tracer::sampleEval() {
+    thread_local unsigned counter = 0;
+    return ++counter % evalSampleRate == 0;
+}
+
+void Tracer::setSequence(const vector<string>& sequence) {
+    if (!enabled) return;
+    ThreadBuffer& buffer = localBuffer();
+    buffer.blocks = sequence;
+    buffer.sequence.clear();
+    for (const auto& block : sequence) {
+        if (!buffer.sequence.empty()) buffer.sequence += " -> ";
+        buffer.sequence += block;
+    }
+    buffer.block.clear();
+}
+
+void Tracer::setBlockIndex(size_t index) {
+    if (!enabled) return;
+    ThreadBuffer& buffer = localBuffer();
+    buffer.block = to_string(index);
+    if (index < buffer.blocks.size()) buffer.block += ":" + buffer.blocks[index];
+}
+
+/* ============================================================
+ * TraceSpan
+ * ============================================================ */
+
+void TraceSpan::begin(const char* name, const char* category) {
+    ThreadBuffer& buffer = localBuffer();
+    slot = (long)buffer.events.size();
+    buffer.events.push_back({name, category, nowMicros(), 0, ""});
+
+    string& args = buffer.events.back().args;
+    if (!buffer.sequence.empty()) appendArg(args, "sequence", json(buffer.sequence).dump());
+    if (!buffer.block.empty()) appendArg(args, "block", json(buffer.block).dump());
+}
+
+void TraceSpan::end() {
+    ThreadBuffer& buffer = localBuffer();
+    // finish() may have drained the buffer while this span was open
+    if ((size_t)slot < buffer.events.size()) {
+        TraceEvent& e = buffer.events[slot];
+        e.dur = nowMicros() - e.ts;
+    }
+    slot = -1;
+}
+
+void TraceSpan::addArg(const char* key, const string& value) {
+    ThreadBuffer& buffer = localBuffer();
+    if ((size_t)slot < buffer.events.size())
+        appendArg(buffer.events[slot].args, key, json(value).dump());
+}
+
+void TraceSpan::addArg(const char* key, long long value) {
+    ThreadBuffer& buffer = localBuffer();
+    if ((size_t)slot < buffer.events.size())
+        appendArg(buffer.events[slot].args, key, to_string(value));
+}
@@ -0,0 +1,97 @@
+#ifndef TRACE_HH
+#define TRACE_HH
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Tracer - Chrome trace-event export of pipeline phases
+ *
+ * Spans are recorded into per-thread buffers and written as one JSON file
+ * (load it in Perfetto or chrome://tracing) when the run finishes. Enable
+ * with `--trace FILE` or TESTGEN_TRACE=FILE.
+ *
+ * Disabled, a TRACE_SPAN costs one predictable branch on a bool and never
+ * allocates. Building with -DTESTGEN_NO_TRACE compiles the spans out.
+ *
+ * Context: the current sequence (set by Tester::generateATC) and block
+ * (set by SEE per API call) are attached to every span on that thread.
+ */
+class Tracer {
+public:
+    static inline bool enabled = false;
+
+    // Starts recording; the file is written by finish() or at exit
+    static void start(const string& path);
+    static void finish();
+
+    // Every Nth evaluateExpr gets a span (default 64)
+    static void setEvalSampleRate(unsigned rate) { evalSampleRate = rate ? rate : 1; }
+    static bool sampleEval();
+
+    // Per-thread context attached to spans: the sequence under test and
+    // the position of the block being executed in it
+    static void setSequence(const vector<string>& sequence);
+    static void setBlockIndex(size_t index);
+
+    static inline unsigned evalSampleRate = 64;
+};
+
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) {
+        if (Tracer::enabled) begin(name, category);
+    }
+    TraceSpan(const string& name, const char* category) {
+        if (Tracer::enabled) begin(name.c_str(), category);
+    }
+    // Conditional span, e.g. sampled ones
+    TraceSpan(bool on, const char* name, const char* category) {
+        if (on) begin(name, category);
+    }
+    ~TraceSpan() {
+        if (slot >= 0) end();
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    bool active() const { return slot >= 0; }
+
+    // No-ops on an inactive span; guard expensive values with active()
+    TraceSpan& arg(const char* key, const string& value) {
+        if (slot >= 0) addArg(key, value);
+        return *this;
+    }
+    TraceSpan& arg(const char* key, long long value) {
+        if (slot >= 0) addArg(key, value);
+        return *this;
+    }
+
+private:
+    long slot = -1;   // index into this thread's event buffer
+
+    void begin(const char* name, const char* category);
+    void end();
+    void addArg(const char* key, const string& value);
+    void addArg(const char* key, long long value);
+};
+
+// Stand-in for builds with tracing compiled out
+class NullTraceSpan {
+public:
+    constexpr bool active() const { return false; }
+    template <typename T>
+    const NullTraceSpan& arg(const char*, const T&) const { return *this; }
+};
+
+#ifdef TESTGEN_NO_TRACE
+#define TRACE_SPAN(var, name, category) NullTraceSpan var
+#define TRACE_SPAN_IF(var, on, name, category) NullTraceSpan var
+#else
+#define TRACE_SPAN(var, name, category) TraceSpan var(name, category)
+#define TRACE_SPAN_IF(var, on, name, category) TraceSpan var(Tracer::enabled && (on), name, category)
+#endif
+
+#endif // TRACE_HH
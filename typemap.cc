@@ -15,12 +15,12 @@ void TypeMap::print() {
             // Print type expression
             switch (d.second->typeExprType) {
                 case TypeExprType::TYPE_CONST: {
-                    TypeConst* tc = dynamic_cast<TypeConst*>(d.second);
+                    TypeConst* tc = d.second->as<TypeConst>();
                     cout << tc->name;
                     break;
                 }
                 case TypeExprType::MAP_TYPE: {
-                    MapType* mt = dynamic_cast<MapType*>(d.second);
+                    MapType* mt = d.second->as<MapType>();
                     cout << "map<...>";
                     break;
                 }
@@ -0,0 +1,95 @@
+#include <cassert>
+#include <iostream>
+#include "../ast.hh"
+#include "../env.hh"
+#include "../typemap.hh"
+#include "../see/z3solver.hh"
+
+using namespace std;
+
+static unique_ptr<Expr> call(const string &name, unique_ptr<Expr> a, unique_ptr<Expr> b)
+{
+    vector<unique_ptr<Expr>> args;
+    args.push_back(std::move(a));
+    args.push_back(std::move(b));
+    return make_unique<FuncCall>(name, std::move(args));
+}
+
+static unique_ptr<Expr> domOf(const string &map)
+{
+    vector<unique_ptr<Expr>> args;
+    args.push_back(make_unique<Var>(map));
+    return make_unique<FuncCall>("dom", std::move(args));
+}
+
+static unique_ptr<Map> mapOf(const vector<string> &keys)
+{
+    vector<pair<unique_ptr<Var>, unique_ptr<Expr>>> entries;
+    for (const auto &key : keys)
+        entries.emplace_back(make_unique<Var>(key), make_unique<String>("pw_" + key));
+    return make_unique<Map>(std::move(entries));
+}
+
+// "alice" in dom(U) AND U["alice"] = pw AND pw != "pw_alice"
+static unique_ptr<Expr> loginFormula()
+{
+    unique_ptr<Expr> f = call("in", make_unique<String>("alice"), domOf("U"));
+    f = call("And", std::move(f),
+             call("=", call("[]", make_unique<Var>("U"), make_unique<String>("alice")), make_unique<Var>("pw")));
+    return call("And", std::move(f), call("!=", make_unique<Var>("pw"), make_unique<String>("pw_alice")));
+}
+
+static bool encodedFinite(TypeMap &types, const Z3Solver &solver, size_t limit)
+{
+    Z3InputMaker inputMaker(&types);
+    inputMaker.setFiniteMaps(solver.getKeyUniverse(), limit);
+    unique_ptr<Expr> formula = loginFormula();
+    inputMaker.makeZ3Input(formula);
+    return inputMaker.isFiniteMap("U");
+}
+
+int main()
+{
+    cout << "test_finitemaps" << endl;
+    auto mapType = make_unique<MapType>(make_unique<TypeConst>("string"), make_unique<TypeConst>("string"));
+    auto strType = make_unique<TypeConst>("string");
+    TypeMap types(nullptr);
+    types.setValue("U", mapType.get());
+    types.setValue("S", mapType.get());
+    types.setValue("pw", strType.get());
+
+    // Keys of concrete maps in sigma, and of a tmp_G_i snapshot under G
+    ValueEnvironment sigma(nullptr);
+    sigma.setValue("U", mapOf({"alice", "bob", "carol"}).release());
+    sigma.setValue("tmp_S_0", mapOf({"dave"}).release());
+    sigma.setValue("pw", new String("x"));
+
+    Z3Solver solver(&types);
+    solver.useKeysFrom(sigma);
+    const auto &keys = solver.getKeyUniverse();
+    assert(keys.at("U") == set<string>({"alice", "bob", "carol"}));
+    assert(keys.at("S") == set<string>({"dave"}));
+    assert(keys.at("tmp_S_0") == set<string>({"dave"}));
+    assert(!keys.count("pw"));
+
+    // The sigma keys count toward the limit: three keys fit 16 but not 2
+    assert(encodedFinite(types, solver, 16));
+    assert(!encodedFinite(types, solver, 2));
+    assert(!encodedFinite(types, solver, 0));
+    // Without sigma's keys only the formula's literal "alice" is known
+    Z3Solver bare(&types);
+    assert(encodedFinite(types, bare, 2));
+
+    // Both encodings agree on the answer
+    for (size_t limit : {size_t(0), size_t(16)})
+    {
+        solver.setFiniteMapLimit(limit);
+        assert(solver.solve(loginFormula()).isSat);
+        unique_ptr<Expr> unsat = call("And", loginFormula(),
+                                      call("not_in", make_unique<String>("alice"), domOf("U")));
+        assert(!solver.solve(std::move(unsat)).isSat);
+    }
+
+    cout << "All finite map tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include "../specparser.hh"
+#include "../specbinary.hh"
+#include "../specs/SharedSpecs.hpp"
+
+using namespace std;
+
+// Runs f and checks it throws a runtime_error mentioning `expected`
+static void expectError(const string &expected, const function<void()> &f)
+{
+    try {
+        f();
+    } catch (const runtime_error &e) {
+        if (string(e.what()).find(expected) == string::npos) {
+            cerr << "expected \"" << expected << "\", got \"" << e.what() << "\"" << endl;
+            assert(false);
+        }
+        return;
+    }
+    cerr << "expected \"" << expected << "\", nothing thrown" << endl;
+    assert(false);
+}
+
+static void putU32(string &out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        out += (char)((v >> (8 * i)) & 0xff);
+}
+
+static void writeFile(const string &path, const string &bytes)
+{
+    ofstream out(path, ios::binary);
+    out.write(bytes.data(), bytes.size());
+    assert(out);
+}
+
+// Every bundled .spec parses to the builder's AST, and that AST survives
+// binary -> load, from memory and from a mapped file
+static void testRoundTrip(const string &app)
+{
+    auto builtin = builtinSpec(app);
+    assert(builtin);
+    string expected = serializeSpec(*builtin);
+
+    auto parsed = parseSpecFile("specs/" + app + ".spec");
+    string binary = serializeSpec(*parsed);
+    assert(binary == expected);
+
+    auto loaded = deserializeSpec(binary.data(), binary.size());
+    assert(serializeSpec(*loaded) == expected);
+    assert(loaded->blocks.size() == builtin->blocks.size());
+    for (size_t i = 0; i < loaded->blocks.size(); i++)
+        assert(loaded->blocks[i]->name == builtin->blocks[i]->name);
+
+    string path = "/tmp/test_specbinary_" + app + ".specb";
+    saveSpecBinary(*parsed, path);
+    assert(serializeSpec(*loadSpecBinary(path)) == expected);
+    assert(serializeSpec(*loadSpecFile(path)) == expected);
+    remove(path.c_str());
+
+    // And the text the tool writes reads back the same
+    assert(serializeSpec(*parseSpecText(writeSpecText(*loaded))) == expected);
+    cout << "  " << app << ": " << builtin->blocks.size() << " blocks OK" << endl;
+}
+
+static void testErrors()
+{
+    string good = serializeSpec(*builtinSpec("library"));
+
+    string badMagic = good;
+    badMagic[0] = 'X';
+    expectError("bad magic", [&] { deserializeSpec(badMagic.data(), badMagic.size()); });
+    expectError("bad magic", [&] { deserializeSpec(good.data(), 3); });
+
+    string badVersion = good;
+    badVersion[4] = (char)(SPEC_BINARY_VERSION + 1);
+    expectError("version " + to_string(SPEC_BINARY_VERSION + 1), [&] {
+        deserializeSpec(badVersion.data(), badVersion.size());
+    });
+
+    for (size_t size : {(size_t)8, good.size() / 2, good.size() - 1})
+        expectError("spec binary", [&] { deserializeSpec(good.data(), size); });
+
+    // A truncated file on disk names the file
+    string path = "/tmp/test_specbinary_truncated.specb";
+    writeFile(path, good.substr(0, good.size() - 1));
+    expectError(path + ": spec binary: truncated", [&] { loadSpecBinary(path); });
+    expectError(path + ": spec binary: truncated", [&] { loadSpecFile(path); });
+    remove(path.c_str());
+
+    // One block whose name refers past the (empty) string table
+    string dangling = "TGSB";
+    putU32(dangling, SPEC_BINARY_VERSION);
+    for (int section = 0; section < 4; section++)
+        putU32(dangling, 0);
+    putU32(dangling, 1);
+    putU32(dangling, 7);
+    expectError("bad string index", [&] { deserializeSpec(dangling.data(), dangling.size()); });
+
+    expectError("trailing bytes", [&] {
+        string longer = good + '\0';
+        deserializeSpec(longer.data(), longer.size());
+    });
+
+    expectError("spec:3:1: expected ',', found '}'", [] { parseSpecText("block b {\n    pre  (1 AND 1\n}\n"); });
+    expectError("Cannot open spec file", [] { loadSpecFile("/nonexistent/x.spec"); });
+    cout << "  error paths OK" << endl;
+}
+
+int main()
+{
+    cout << "test_specbinary" << endl;
+    for (const char *app : {"restaurant", "ecommerce", "library", "tripvault", "ghostsocket", "serveez"})
+        testRoundTrip(app);
+    testErrors();
+    cout << "All spec format tests passed" << endl;
+    return 0;
+}